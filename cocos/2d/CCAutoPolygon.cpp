@@ -30,7 +30,17 @@ THE SOFTWARE.
 #include "base/CCDirector.h"
 #include "renderer/CCTextureCache.h"
 #include "clipper/clipper.hpp"
+#include "platform/CCFileUtils.h"
+#include "base/CCAsyncTaskPool.h"
+#include "deprecated/CCString.h"
+#include "xxhash.h"
 #include <algorithm>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <math.h>
 
 USING_NS_CC;
@@ -38,6 +48,153 @@ USING_NS_CC;
 static unsigned short quadIndices[]={0,1,2, 3,2,1};
 const static float PRECISION = 10.0f;
 
+namespace
+{
+    const char POLYGON_BAKE_MAGIC[4] = { 'C', 'C', 'A', 'P' };
+    const unsigned int POLYGON_BAKE_VERSION = 1;
+
+    struct PolygonBakeHeader
+    {
+        char magic[4];
+        unsigned int version;
+        unsigned int count;
+    };
+
+    struct PolygonBakeEntry
+    {
+        unsigned int keyLength;
+        unsigned int vertCount;
+        unsigned int indexCount;
+        float rect[4];
+    };
+
+    struct CachedPolygon
+    {
+        PolygonInfo info;
+        size_t bytes;
+        std::list<std::string>::iterator lruIter;
+        // the s_polygonKeys entries pointing to it, removed with it
+        std::vector<std::string> pathKeys;
+    };
+
+    // key of a polygon: hash of the image file, rect, epsilon, threshold and content scale factor
+    std::unordered_map<std::string, CachedPolygon> s_polygonCache;
+    // full path and parameters to key, so that cached polygons don't need to read the image file again
+    std::unordered_map<std::string, std::string> s_polygonKeys;
+    // keys of the cached polygons, most recently used first
+    std::list<std::string> s_polygonLRU;
+    size_t s_polygonCacheBytes = 0;
+    size_t s_polygonCacheBudget = 0;
+    std::mutex s_polygonCacheMutex;
+
+    // the functions below are called with s_polygonCacheMutex locked
+
+    // the cached polygon of key, made the most recently used one, or nullptr
+    const PolygonInfo* findCachedPolygon(const std::string& key)
+    {
+        auto iter = s_polygonCache.find(key);
+        if (iter == s_polygonCache.end())
+            return nullptr;
+        s_polygonLRU.splice(s_polygonLRU.begin(), s_polygonLRU, iter->second.lruIter);
+        return &iter->second.info;
+    }
+
+    void removeCachedPolygon(std::unordered_map<std::string, CachedPolygon>::iterator iter)
+    {
+        for (const auto& pathKey : iter->second.pathKeys)
+        {
+            // the image file may have changed since, then its path points to another polygon
+            auto keyIter = s_polygonKeys.find(pathKey);
+            if (keyIter != s_polygonKeys.end() && keyIter->second == iter->first)
+            {
+                s_polygonKeys.erase(keyIter);
+            }
+        }
+        s_polygonCacheBytes -= iter->second.bytes;
+        s_polygonLRU.erase(iter->second.lruIter);
+        s_polygonCache.erase(iter);
+    }
+
+    void trimCachedPolygons(size_t bytesToKeep)
+    {
+        while (s_polygonCacheBytes > bytesToKeep && !s_polygonLRU.empty())
+        {
+            removeCachedPolygon(s_polygonCache.find(s_polygonLRU.back()));
+        }
+    }
+
+    void addCachedPolygon(const std::string& key, const PolygonInfo& info)
+    {
+        auto iter = s_polygonCache.find(key);
+        if (iter != s_polygonCache.end())
+        {
+            removeCachedPolygon(iter);
+        }
+
+        s_polygonLRU.push_front(key);
+        auto& cached = s_polygonCache[key];
+        cached.info = info;
+        cached.bytes = info.triangles.vertCount * sizeof(V3F_C4B_T2F) + info.triangles.indexCount * sizeof(unsigned short);
+        cached.lruIter = s_polygonLRU.begin();
+        s_polygonCacheBytes += cached.bytes;
+
+        if (s_polygonCacheBudget > 0)
+        {
+            trimCachedPolygons(s_polygonCacheBudget);
+        }
+    }
+
+    void addPolygonPathKey(const std::string& pathKey, const std::string& key)
+    {
+        auto iter = s_polygonCache.find(key);
+        if (iter == s_polygonCache.end())
+            return;
+
+        auto& mappedKey = s_polygonKeys[pathKey];
+        if (mappedKey != key)
+        {
+            mappedKey = key;
+            iter->second.pathKeys.push_back(pathKey);
+        }
+    }
+
+    std::string getPolygonParams(const Rect& rect, float epsilon, float threshold, float scaleFactor)
+    {
+        return StringUtils::format("%g,%g,%g,%g_%g_%g_%g", rect.origin.x, rect.origin.y, rect.size.width, rect.size.height,
+                                   epsilon, threshold, scaleFactor);
+    }
+
+    // runs func(0) ... func(count - 1) on threadCount worker threads and the calling thread
+    void parallelFor(int count, int threadCount, const std::function<void(int)>& func)
+    {
+        std::atomic<int> next(0);
+        auto run = [&]() {
+            for (int i = next++; i < count; i = next++)
+            {
+                func(i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threadCount = std::min(threadCount, count - 1);
+        for (int i = 0; i < threadCount; ++i)
+        {
+            threads.push_back(std::thread(run));
+        }
+        run();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    int getWorkerThreadCount()
+    {
+        int cores = (int)std::thread::hardware_concurrency();
+        return std::max(cores - 1, 0);
+    }
+}
+
 PolygonInfo::PolygonInfo(const PolygonInfo& other):
 triangles(),
 isVertsOwner(true),
@@ -139,6 +296,24 @@ AutoPolygon::AutoPolygon(const std::string &filename)
     _filename = filename;
     _image = new Image();
     _image->initWithImageFile(filename);
+    initWithImage();
+}
+
+AutoPolygon::AutoPolygon(const std::string& filename, const Data& data)
+:_image(nullptr)
+,_data(nullptr)
+,_filename(filename)
+,_width(0)
+,_height(0)
+,_scaleFactor(0)
+{
+    _image = new Image();
+    _image->initWithImageData(data.getBytes(), data.getSize());
+    initWithImage();
+}
+
+void AutoPolygon::initWithImage()
+{
     CCASSERT(_image->getRenderFormat()==Texture2D::PixelFormat::RGBA8888, "unsupported format, currently only supports rgba8888");
     _data = _image->getData();
     _width = _image->getWidth();
@@ -662,7 +837,349 @@ PolygonInfo AutoPolygon::generateTriangles(const Rect& rect, const float& epsilo
 }
 PolygonInfo AutoPolygon::generatePolygon(const std::string& filename, const Rect& rect, const float epsilon, const float threshold)
 {
-    AutoPolygon ap(filename);
-    auto ret = ap.generateTriangles(rect, epsilon, threshold);
-    return ret;
+    std::vector<Frame> frames(1);
+    frames[0].filename = filename;
+    frames[0].rect = rect;
+    std::vector<std::string> fullPaths(1, FileUtils::getInstance()->fullPathForFilename(filename));
+    std::vector<PolygonInfo> polygons;
+    generateCachedPolygons(frames, fullPaths, epsilon, threshold, 0, polygons, nullptr);
+    return polygons[0];
+}
+
+void AutoPolygon::generateCachedPolygons(const std::vector<Frame>& frames, const std::vector<std::string>& fullPaths, float epsilon, float threshold, int threadCount, std::vector<PolygonInfo>& polygons, std::vector<std::string>* keys)
+{
+    float scaleFactor = Director::getInstance()->getContentScaleFactor();
+    int frameCount = (int)frames.size();
+    std::vector<std::string> frameKeys(frameCount);
+    std::vector<bool> done(frameCount, false);
+    polygons.resize(frameCount);
+
+    // frames already generated with the same parameters don't read the image file at all
+    std::unordered_map<std::string, int> fileIndices;
+    std::vector<std::vector<int>> fileFrames;
+    {
+        std::lock_guard<std::mutex> lock(s_polygonCacheMutex);
+        for (int i = 0; i < frameCount; ++i)
+        {
+            auto keyIter = s_polygonKeys.find(fullPaths[i] + "|" + getPolygonParams(frames[i].rect, epsilon, threshold, scaleFactor));
+            if (keyIter != s_polygonKeys.end())
+            {
+                auto cached = findCachedPolygon(keyIter->second);
+                if (cached)
+                {
+                    polygons[i] = *cached;
+                    polygons[i].filename = frames[i].filename;
+                    frameKeys[i] = keyIter->second;
+                    done[i] = true;
+                    continue;
+                }
+            }
+
+            auto fileIter = fileIndices.find(fullPaths[i]);
+            if (fileIter == fileIndices.end())
+            {
+                fileIter = fileIndices.insert(std::make_pair(fullPaths[i], (int)fileFrames.size())).first;
+                fileFrames.push_back(std::vector<int>());
+            }
+            fileFrames[fileIter->second].push_back(i);
+        }
+    }
+
+    // read and hash each image file once, then decode it only if some of its frames aren't baked
+    std::vector<AutoPolygon*> images(fileFrames.size(), nullptr);
+    parallelFor((int)fileFrames.size(), threadCount, [&](int file) {
+        const auto& indices = fileFrames[file];
+        const std::string& fullPath = fullPaths[indices[0]];
+        Data data = FileUtils::getInstance()->getDataFromFile(fullPath);
+        if (data.isNull())
+        {
+            CCLOG("cocos2d: AutoPolygon: failed to load %s", fullPath.c_str());
+            return;
+        }
+
+        auto hash = StringUtils::format("%08x_", XXH32(data.getBytes(), (int)data.getSize(), 0));
+        bool needImage = false;
+        {
+            std::lock_guard<std::mutex> lock(s_polygonCacheMutex);
+            for (auto i : indices)
+            {
+                frameKeys[i] = hash + getPolygonParams(frames[i].rect, epsilon, threshold, scaleFactor);
+                auto cached = findCachedPolygon(frameKeys[i]);
+                if (cached)
+                {
+                    addPolygonPathKey(fullPath + "|" + getPolygonParams(frames[i].rect, epsilon, threshold, scaleFactor), frameKeys[i]);
+                    polygons[i] = *cached;
+                    polygons[i].filename = frames[i].filename;
+                    done[i] = true;
+                }
+                else
+                {
+                    needImage = true;
+                }
+            }
+        }
+
+        if (needImage)
+        {
+            images[file] = new (std::nothrow) AutoPolygon(frames[indices[0]].filename, data);
+        }
+    });
+
+    // the frames of one image are traced in parallel too, the AutoPolygon is only read
+    std::vector<std::pair<int, AutoPolygon*>> pending;
+    for (size_t file = 0; file < fileFrames.size(); ++file)
+    {
+        if (images[file] == nullptr)
+            continue;
+        for (auto i : fileFrames[file])
+        {
+            if (!done[i])
+                pending.push_back(std::make_pair(i, images[file]));
+        }
+    }
+
+    parallelFor((int)pending.size(), threadCount, [&](int n) {
+        int i = pending[n].first;
+        polygons[i] = pending[n].second->generateTriangles(frames[i].rect, epsilon, threshold);
+        polygons[i].filename = frames[i].filename;
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(s_polygonCacheMutex);
+        for (const auto& frame : pending)
+        {
+            int i = frame.first;
+            addCachedPolygon(frameKeys[i], polygons[i]);
+            addPolygonPathKey(fullPaths[i] + "|" + getPolygonParams(frames[i].rect, epsilon, threshold, scaleFactor), frameKeys[i]);
+        }
+    }
+
+    for (auto image : images)
+    {
+        CC_SAFE_DELETE(image);
+    }
+
+    if (keys)
+    {
+        *keys = frameKeys;
+    }
+}
+
+void AutoPolygon::generatePolygonsAsync(const std::vector<Frame>& frames, const std::function<void(std::vector<PolygonInfo>&)>& callback, const float epsilon, const float threshold)
+{
+    struct AsyncPolygons
+    {
+        std::vector<Frame> frames;
+        std::vector<std::string> fullPaths;
+        std::vector<PolygonInfo> polygons;
+    };
+
+    // FileUtils caches the full paths, resolve them in the main thread
+    auto async = std::make_shared<AsyncPolygons>();
+    async->frames = frames;
+    for (const auto& frame : frames)
+    {
+        async->fullPaths.push_back(FileUtils::getInstance()->fullPathForFilename(frame.filename));
+    }
+
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_OTHER, [async, callback](void*) {
+        if (callback)
+        {
+            callback(async->polygons);
+        }
+    }, nullptr, [async, epsilon, threshold]() {
+        generateCachedPolygons(async->frames, async->fullPaths, epsilon, threshold, getWorkerThreadCount(), async->polygons, nullptr);
+    });
+}
+
+bool AutoPolygon::bakePolygons(const std::vector<Frame>& frames, const std::string& fullPath, const float epsilon, const float threshold)
+{
+    std::vector<std::string> fullPaths;
+    for (const auto& frame : frames)
+    {
+        fullPaths.push_back(FileUtils::getInstance()->fullPathForFilename(frame.filename));
+    }
+
+    std::vector<PolygonInfo> polygons;
+    std::vector<std::string> keys;
+    generateCachedPolygons(frames, fullPaths, epsilon, threshold, getWorkerThreadCount(), polygons, &keys);
+
+    // frames sharing a key are written once, frames whose image is missing have no key
+    std::unordered_map<std::string, int> written;
+    std::vector<int> entries;
+    ssize_t size = sizeof(PolygonBakeHeader);
+    for (int i = 0; i < (int)frames.size(); ++i)
+    {
+        if (keys[i].empty() || !written.insert(std::make_pair(keys[i], i)).second)
+            continue;
+        entries.push_back(i);
+        size += sizeof(PolygonBakeEntry) + keys[i].size()
+            + polygons[i].triangles.vertCount * sizeof(V3F_C4B_T2F)
+            + polygons[i].triangles.indexCount * sizeof(unsigned short);
+    }
+
+    unsigned char* buffer = (unsigned char*)malloc(size);
+    if (buffer == nullptr)
+        return false;
+
+    PolygonBakeHeader header;
+    memcpy(header.magic, POLYGON_BAKE_MAGIC, sizeof(header.magic));
+    header.version = POLYGON_BAKE_VERSION;
+    header.count = (unsigned int)entries.size();
+    memcpy(buffer, &header, sizeof(header));
+    unsigned char* p = buffer + sizeof(header);
+
+    for (auto i : entries)
+    {
+        const auto& info = polygons[i];
+        PolygonBakeEntry entry;
+        entry.keyLength = (unsigned int)keys[i].size();
+        entry.vertCount = (unsigned int)info.triangles.vertCount;
+        entry.indexCount = (unsigned int)info.triangles.indexCount;
+        entry.rect[0] = info.rect.origin.x;
+        entry.rect[1] = info.rect.origin.y;
+        entry.rect[2] = info.rect.size.width;
+        entry.rect[3] = info.rect.size.height;
+        memcpy(p, &entry, sizeof(entry));
+        p += sizeof(entry);
+        memcpy(p, keys[i].data(), entry.keyLength);
+        p += entry.keyLength;
+        memcpy(p, info.triangles.verts, entry.vertCount * sizeof(V3F_C4B_T2F));
+        p += entry.vertCount * sizeof(V3F_C4B_T2F);
+        memcpy(p, info.triangles.indices, entry.indexCount * sizeof(unsigned short));
+        p += entry.indexCount * sizeof(unsigned short);
+    }
+
+    Data data;
+    data.fastSet(buffer, size);
+    if (!FileUtils::getInstance()->writeDataToFile(data, fullPath))
+    {
+        CCLOG("cocos2d: AutoPolygon: failed to write %s", fullPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool AutoPolygon::loadBakedPolygons(const std::string& filename)
+{
+    Data data = FileUtils::getInstance()->getDataFromFile(filename);
+    const unsigned char* p = data.getBytes();
+    const unsigned char* end = p + data.getSize();
+
+    PolygonBakeHeader header;
+    if ((size_t)(end - p) < sizeof(header))
+    {
+        CCLOG("cocos2d: AutoPolygon: failed to load %s", filename.c_str());
+        return false;
+    }
+    memcpy(&header, p, sizeof(header));
+    p += sizeof(header);
+    if (memcmp(header.magic, POLYGON_BAKE_MAGIC, sizeof(header.magic)) != 0 || header.version != POLYGON_BAKE_VERSION)
+    {
+        CCLOG("cocos2d: AutoPolygon: %s is not a baked polygon file", filename.c_str());
+        return false;
+    }
+
+    // the count comes from the file, each entry takes at least its header
+    if (header.count > (size_t)(end - p) / sizeof(PolygonBakeEntry))
+    {
+        CCLOG("cocos2d: AutoPolygon: %s is truncated", filename.c_str());
+        return false;
+    }
+
+    std::vector<std::pair<std::string, PolygonInfo>> polygons(header.count);
+    for (auto& polygon : polygons)
+    {
+        PolygonBakeEntry entry;
+        if ((size_t)(end - p) < sizeof(entry))
+        {
+            p = nullptr;
+            break;
+        }
+        memcpy(&entry, p, sizeof(entry));
+        p += sizeof(entry);
+
+        // checked span by span, so that the sizes can't overflow before they are compared
+        size_t remaining = (size_t)(end - p);
+        if (entry.keyLength > remaining)
+        {
+            p = nullptr;
+            break;
+        }
+        remaining -= entry.keyLength;
+        if (entry.vertCount > remaining / sizeof(V3F_C4B_T2F))
+        {
+            p = nullptr;
+            break;
+        }
+        size_t vertSize = (size_t)entry.vertCount * sizeof(V3F_C4B_T2F);
+        remaining -= vertSize;
+        if (entry.indexCount > remaining / sizeof(unsigned short))
+        {
+            p = nullptr;
+            break;
+        }
+        size_t indexSize = (size_t)entry.indexCount * sizeof(unsigned short);
+
+        polygon.first.assign((const char*)p, entry.keyLength);
+        p += entry.keyLength;
+
+        auto& info = polygon.second;
+        info.rect.setRect(entry.rect[0], entry.rect[1], entry.rect[2], entry.rect[3]);
+        info.triangles.verts = new V3F_C4B_T2F[entry.vertCount];
+        info.triangles.indices = new unsigned short[entry.indexCount];
+        info.triangles.vertCount = entry.vertCount;
+        info.triangles.indexCount = entry.indexCount;
+        memcpy(info.triangles.verts, p, vertSize);
+        p += vertSize;
+        memcpy(info.triangles.indices, p, indexSize);
+        p += indexSize;
+    }
+
+    if (p == nullptr || p != end)
+    {
+        CCLOG("cocos2d: AutoPolygon: %s is truncated", filename.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(s_polygonCacheMutex);
+    for (const auto& polygon : polygons)
+    {
+        addCachedPolygon(polygon.first, polygon.second);
+    }
+    return true;
+}
+
+void AutoPolygon::removeCachedPolygons(size_t bytesToKeep)
+{
+    std::lock_guard<std::mutex> lock(s_polygonCacheMutex);
+    trimCachedPolygons(bytesToKeep);
+}
+
+void AutoPolygon::setPolygonCacheBudget(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(s_polygonCacheMutex);
+    s_polygonCacheBudget = bytes;
+    if (s_polygonCacheBudget > 0)
+    {
+        trimCachedPolygons(s_polygonCacheBudget);
+    }
+}
+
+size_t AutoPolygon::getPolygonCacheBudget()
+{
+    std::lock_guard<std::mutex> lock(s_polygonCacheMutex);
+    return s_polygonCacheBudget;
+}
+
+size_t AutoPolygon::getCachedPolygonBytes()
+{
+    std::lock_guard<std::mutex> lock(s_polygonCacheMutex);
+    return s_polygonCacheBytes;
+}
+
+ssize_t AutoPolygon::getCachedPolygonCount()
+{
+    std::lock_guard<std::mutex> lock(s_polygonCacheMutex);
+    return s_polygonCache.size();
 }
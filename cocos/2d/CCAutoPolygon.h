@@ -30,6 +30,7 @@ THE SOFTWARE.
 
 #include <string>
 #include <vector>
+#include <functional>
 #include "platform/CCImage.h"
 #include "renderer/CCTrianglesCommand.h"
 
@@ -227,7 +228,8 @@ public:
     
     /**
      * a helper function, packing autoPolygon creation, trace, reduce, expand, triangulate and calculate uv in one function
-     * @warning if you want to repetitively generate polygons, consider create an AutoPolygon object, and use generateTriangles function, as it only reads the file once
+     * the result is cached, keyed by the hash of the image file, the rect, epsilon, threshold and content scale factor,
+     * so generating the same polygon again only copies it. See loadBakedPolygons() to skip the generation at runtime.
      * @param   filename     A path to image file, e.g., "scene1/monster.png".
      * @param   rect    texture rect, use Rect::ZERO for the size of the texture, default is Rect::ZERO
      * @param   epsilon the value used to reduce and expand, default to 2.0
@@ -238,7 +240,75 @@ public:
      * @endcode
      */
     static PolygonInfo generatePolygon(const std::string& filename, const Rect& rect = Rect::ZERO, const float epsilon = 2.0, const float threshold = 0.05);
+
+    /** An image file and a texture rect to generate a polygon for, used by the batch functions. */
+    struct Frame
+    {
+        std::string filename;
+        Rect rect;
+    };
+
+    /**
+     * generates the polygons of many frames on worker threads, using and filling the polygon cache
+     * each image file is read and decoded once, even if several frames use it
+     * @param   frames      the frames to generate, use Rect::ZERO as rect for the size of the texture
+     * @param   callback    called in the main thread with one PolygonInfo per frame, in the same order.
+     *                      The PolygonInfo of a frame whose image couldn't be loaded is empty.
+     * @param   epsilon     the value used to reduce and expand, default to 2.0
+     * @param   threshold   the value where bigger than the threshold will be counted as opaque, used in trace
+     * @code
+     * AutoPolygon::generatePolygonsAsync(frames, [](std::vector<PolygonInfo>& polygons){
+     *     auto sp = Sprite::create(polygons[0]);
+     * });
+     * @endcode
+     */
+    static void generatePolygonsAsync(const std::vector<Frame>& frames, const std::function<void(std::vector<PolygonInfo>&)>& callback, const float epsilon = 2.0, const float threshold = 0.05);
+
+    /**
+     * offline pre-bake: generates the polygons of the frames in parallel and writes them to a file
+     * that loadBakedPolygons() reads at runtime, e.g. from a tool or a debug build
+     * @param   frames      the frames to bake
+     * @param   fullPath    the file to write
+     * @param   epsilon     the value used to reduce and expand, default to 2.0
+     * @param   threshold   the value where bigger than the threshold will be counted as opaque, used in trace
+     * @return  true if the file was written
+     */
+    static bool bakePolygons(const std::vector<Frame>& frames, const std::string& fullPath, const float epsilon = 2.0, const float threshold = 0.05);
+
+    /**
+     * adds the polygons of a file written by bakePolygons() to the polygon cache
+     * generatePolygon() and generatePolygonsAsync() then only read the image file to check its hash,
+     * a baked polygon is ignored when the image, the rect, epsilon, threshold or content scale factor differ
+     * @param   filename    the baked file
+     * @return  true if the file was loaded
+     */
+    static bool loadBakedPolygons(const std::string& filename);
+
+    /**
+     * removes the generated and baked polygons from the polygon cache, least recently used first,
+     * until the cache uses at most bytesToKeep bytes
+     * @param   bytesToKeep the vertex and index bytes the cache may keep, 0 removes all the polygons
+     */
+    static void removeCachedPolygons(size_t bytesToKeep = 0);
+
+    /**
+     * sets the vertex and index bytes the polygon cache uses at most, 0 is unlimited, the default
+     * when it is exceeded, the least recently used polygons are removed
+     */
+    static void setPolygonCacheBudget(size_t bytes);
+    static size_t getPolygonCacheBudget();
+
+    /** vertex and index bytes of the polygons in the polygon cache */
+    static size_t getCachedPolygonBytes();
+
+    /** number of polygons in the polygon cache */
+    static ssize_t getCachedPolygonCount();
 protected:
+    AutoPolygon(const std::string& filename, const Data& data);
+    void initWithImage();
+
+    static void generateCachedPolygons(const std::vector<Frame>& frames, const std::vector<std::string>& fullPaths, float epsilon, float threshold, int threadCount, std::vector<PolygonInfo>& polygons, std::vector<std::string>* keys);
+
     Vec2 findFirstNoneTransparentPixel(const Rect& rect, const float& threshold);
     std::vector<cocos2d::Vec2> marchSquare(const Rect& rect, const Vec2& first, const float& threshold);
     unsigned int getSquareValue(const unsigned int& x, const unsigned int& y, const Rect& rect, const float& threshold);
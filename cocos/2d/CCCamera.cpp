@@ -35,6 +35,7 @@
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCFrameBuffer.h"
 #include "renderer/CCRenderState.h"
+#include "3d/CCOcclusionCuller.h"
 
 NS_CC_BEGIN
 
@@ -95,6 +96,7 @@ Camera::Camera()
 , _frustumDirty(true)
 , _depth(-1)
 , _fbo(nullptr)
+, _occlusionCuller(nullptr)
 {
     _frustum.setClipZ(true);
     _clearBrush = CameraBackgroundBrush::createDepthBrush(1.f);
@@ -105,6 +107,7 @@ Camera::~Camera()
 {
     CC_SAFE_RELEASE_NULL(_fbo);
     CC_SAFE_RELEASE(_clearBrush);
+    CC_SAFE_DELETE(_occlusionCuller);
 }
 
 const Mat4& Camera::getProjectionMatrix() const
@@ -323,13 +326,26 @@ void Camera::unprojectGL(const Size& viewport, const Vec3* src, Vec3* dst) const
 }
 
 bool Camera::isVisibleInFrustum(const AABB* aabb) const
+{
+    return !getFrustum().isOutOfFrustum(*aabb);
+}
+
+const Frustum& Camera::getFrustum() const
 {
     if (_frustumDirty)
     {
         _frustum.initFrustum(this);
         _frustumDirty = false;
     }
-    return !_frustum.isOutOfFrustum(*aabb);
+    return _frustum;
+}
+
+void Camera::setOcclusionCullingEnabled(bool enabled)
+{
+    if (enabled && !_occlusionCuller)
+        _occlusionCuller = new (std::nothrow) OcclusionCuller();
+    else if (!enabled)
+        CC_SAFE_DELETE(_occlusionCuller);
 }
 
 float Camera::getDepthInView(const Mat4& transform) const
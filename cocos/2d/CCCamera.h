@@ -37,6 +37,7 @@ NS_CC_BEGIN
 
 class Scene;
 class CameraBackgroundBrush;
+class OcclusionCuller;
 
 /**
  * Note: 
@@ -193,6 +194,24 @@ public:
      */
     bool isVisibleInFrustum(const AABB* aabb) const;
     
+    /**
+     * Get the frustum of the camera, updated if the camera moved
+     */
+    const Frustum& getFrustum() const;
+    
+    /**
+     * Enable software occlusion culling, disabled by default.
+     * Before the camera visits its scene, the occluders of the scene (see Sprite3D::setOccluderMesh) are
+     * rasterized on the CPU, and the Sprite3Ds hidden behind them aren't drawn.
+     */
+    void setOcclusionCullingEnabled(bool enabled);
+    bool isOcclusionCullingEnabled() const { return _occlusionCuller != nullptr; }
+    
+    /**
+     * Get the occlusion culler of the camera, nullptr if occlusion culling is disabled
+     */
+    OcclusionCuller* getOcclusionCuller() const { return _occlusionCuller; }
+    
     /**
      * Get object depth towards camera
      */
@@ -317,6 +336,8 @@ protected:
     experimental::Viewport _viewport;
     
     experimental::FrameBuffer* _fbo;
+    
+    OcclusionCuller* _occlusionCuller;
 protected:
     static experimental::Viewport _defaultViewport;
 public:
@@ -102,6 +102,23 @@ static inline Tex2F __t(const Vec2 &v)
     return *(Tex2F*)&v;
 }
 
+// Uploads the vertices appended since the last upload. The whole buffer is
+// respecified when it was cleared or reallocated, which also orphans the old storage.
+static void uploadVertices(GLuint vbo, const V2F_C4B_T2F *buffer, int capacity, GLsizei count, int &vboCapacity, GLsizei &uploadedCount)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if (uploadedCount == 0 || vboCapacity != capacity || count < uploadedCount)
+    {
+        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*capacity, buffer, GL_STREAM_DRAW);
+        vboCapacity = capacity;
+    }
+    else if (count > uploadedCount)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*uploadedCount, sizeof(V2F_C4B_T2F)*(count - uploadedCount), buffer + uploadedCount);
+    }
+    uploadedCount = count;
+}
+
 // implementation of DrawNode
 
 static const int DEFAULT_LINE_WIDTH = 2;
@@ -126,6 +143,18 @@ DrawNode::DrawNode()
 , _dirtyGLPoint(false)
 , _dirtyGLLine(false)
 , _lineWidth(DEFAULT_LINE_WIDTH)
+, _bufferCountUploaded(0)
+, _bufferCountUploadedGLPoint(0)
+, _bufferCountUploadedGLLine(0)
+, _vboCapacity(0)
+, _vboCapacityGLPoint(0)
+, _vboCapacityGLLine(0)
+, _batchingEnabled(false)
+, _batchCapacity(0)
+, _batchCount(0)
+, _batchVertices(nullptr)
+, _batchIndices(nullptr)
+, _batchGLProgramState(nullptr)
 {
     _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
 }
@@ -138,6 +167,11 @@ DrawNode::~DrawNode()
     _bufferGLPoint = nullptr;
     free(_bufferGLLine);
     _bufferGLLine = nullptr;
+    free(_batchVertices);
+    _batchVertices = nullptr;
+    free(_batchIndices);
+    _batchIndices = nullptr;
+    CC_SAFE_RELEASE(_batchGLProgramState);
     
     glDeleteBuffers(1, &_vbo);
     glDeleteBuffers(1, &_vboGLLine);
@@ -287,6 +321,13 @@ bool DrawNode::init()
     _dirty = true;
     _dirtyGLLine = true;
     _dirtyGLPoint = true;
+    // the VBOs were just filled with the whole buffers
+    _bufferCountUploaded = _bufferCount;
+    _bufferCountUploadedGLPoint = _bufferCountGLPoint;
+    _bufferCountUploadedGLLine = _bufferCountGLLine;
+    _vboCapacity = _bufferCapacity;
+    _vboCapacityGLPoint = _bufferCapacityGLPoint;
+    _vboCapacityGLLine = _bufferCapacityGLLine;
     
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     // Need to listen the event only when not use batchnode, because it will use VBO
@@ -301,13 +342,59 @@ bool DrawNode::init()
     return true;
 }
 
+void DrawNode::updateBatchVertices()
+{
+    if (_bufferCount > _batchCapacity)
+    {
+        int capacity = MIN(_bufferCapacity, Renderer::VBO_SIZE);
+        _batchVertices = (V3F_C4B_T2F*)realloc(_batchVertices, capacity*sizeof(V3F_C4B_T2F));
+        _batchIndices = (unsigned short*)realloc(_batchIndices, capacity*sizeof(unsigned short));
+        
+        // the triangles aren't indexed, the indices only depend on the capacity
+        for (int i = _batchCapacity; i < capacity; ++i)
+        {
+            _batchIndices[i] = (unsigned short)i;
+        }
+        _batchCapacity = capacity;
+    }
+    
+    // clear() resets _batchCount, so only the appended vertices need to be converted
+    for (GLsizei i = _batchCount; i < _bufferCount; ++i)
+    {
+        const V2F_C4B_T2F& src = _buffer[i];
+        V3F_C4B_T2F& dst = _batchVertices[i];
+        dst.vertices.set(src.vertices.x, src.vertices.y, 0.0f);
+        dst.colors = src.colors;
+        dst.texCoords = src.texCoords;
+    }
+    _batchCount = _bufferCount;
+}
+
 void DrawNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
     if(_bufferCount)
     {
-        _customCommand.init(_globalZOrder, transform, flags);
-        _customCommand.func = CC_CALLBACK_0(DrawNode::onDraw, this, transform, flags);
-        renderer->addCommand(&_customCommand);
+        bool batched = _batchingEnabled && _bufferCount < Renderer::VBO_SIZE
+            && getGLProgram() == GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR);
+        
+        if (batched)
+        {
+            updateBatchVertices();
+            
+            TrianglesCommand::Triangles triangles;
+            triangles.verts = _batchVertices;
+            triangles.indices = _batchIndices;
+            triangles.vertCount = _bufferCount;
+            triangles.indexCount = _bufferCount;
+            _trianglesCommand.init(_globalZOrder, 0, _batchGLProgramState, _blendFunc, triangles, transform, flags);
+            renderer->addCommand(&_trianglesCommand);
+        }
+        else
+        {
+            _customCommand.init(_globalZOrder, transform, flags);
+            _customCommand.func = CC_CALLBACK_0(DrawNode::onDraw, this, transform, flags);
+            renderer->addCommand(&_customCommand);
+        }
     }
     
     if(_bufferCountGLPoint)
@@ -335,9 +422,7 @@ void DrawNode::onDraw(const Mat4 &transform, uint32_t flags)
 
     if (_dirty)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacity, _buffer, GL_STREAM_DRAW);
-        
+        uploadVertices(_vbo, _buffer, _bufferCapacity, _bufferCount, _vboCapacity, _bufferCountUploaded);
         _dirty = false;
     }
     if (Configuration::getInstance()->supportsShareableVAO())
@@ -379,8 +464,7 @@ void DrawNode::onDrawGLLine(const Mat4 &transform, uint32_t flags)
 
     if (_dirtyGLLine)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLLine, _bufferGLLine, GL_STREAM_DRAW);
+        uploadVertices(_vboGLLine, _bufferGLLine, _bufferCapacityGLLine, _bufferCountGLLine, _vboCapacityGLLine, _bufferCountUploadedGLLine);
         _dirtyGLLine = false;
     }
     if (Configuration::getInstance()->supportsShareableVAO())
@@ -422,9 +506,7 @@ void DrawNode::onDrawGLPoint(const Mat4 &transform, uint32_t flags)
 
     if (_dirtyGLPoint)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLPoint, _bufferGLPoint, GL_STREAM_DRAW);
-        
+        uploadVertices(_vboGLPoint, _bufferGLPoint, _bufferCapacityGLPoint, _bufferCountGLPoint, _vboCapacityGLPoint, _bufferCountUploadedGLPoint);
         _dirtyGLPoint = false;
     }
     
@@ -923,10 +1005,14 @@ void DrawNode::drawQuadraticBezier(const Vec2& from, const Vec2& control, const
 void DrawNode::clear()
 {
     _bufferCount = 0;
+    _bufferCountUploaded = 0;
+    _batchCount = 0;
     _dirty = true;
     _bufferCountGLLine = 0;
+    _bufferCountUploadedGLLine = 0;
     _dirtyGLLine = true;
     _bufferCountGLPoint = 0;
+    _bufferCountUploadedGLPoint = 0;
     _dirtyGLPoint = true;
     _lineWidth = DEFAULT_LINE_WIDTH;
 }
@@ -946,4 +1032,14 @@ void DrawNode::setLineWidth(int lineWidth)
     _lineWidth = lineWidth;
 }
 
+void DrawNode::setBatchingEnabled(bool enabled)
+{
+    if (enabled && _batchGLProgramState == nullptr)
+    {
+        _batchGLProgramState = GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR_NO_MVP);
+        CC_SAFE_RETAIN(_batchGLProgramState);
+    }
+    _batchingEnabled = enabled;
+}
+
 NS_CC_END
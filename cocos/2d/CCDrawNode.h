@@ -34,6 +34,7 @@
 #include "2d/CCNode.h"
 #include "base/ccTypes.h"
 #include "renderer/CCCustomCommand.h"
+#include "renderer/CCTrianglesCommand.h"
 #include "math/CCMath.h"
 
 NS_CC_BEGIN
@@ -312,6 +313,18 @@ public:
     virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
     
     void setLineWidth(int lineWidth);
+
+    /** Enables or disables batching. Disabled by default.
+     * When enabled, the filled shapes are rendered with a TrianglesCommand instead of a CustomCommand,
+     * so consecutive DrawNodes with the same blend function are drawn in a single draw call.
+     * Points and lines (drawPoint, drawLine, drawRect, drawPoly, ...) are still drawn by the node itself.
+     * Batching isn't used while the node has a custom GLProgram, or more than Renderer::VBO_SIZE vertices.
+     *
+     * @param enabled True to batch the node with the other DrawNodes.
+     */
+    void setBatchingEnabled(bool enabled);
+    /** Whether batching is enabled. */
+    bool isBatchingEnabled() const { return _batchingEnabled; }
     
 CC_CONSTRUCTOR_ACCESS:
     DrawNode();
@@ -322,6 +335,7 @@ protected:
     void ensureCapacity(int count);
     void ensureCapacityGLPoint(int count);
     void ensureCapacityGLLine(int count);
+    void updateBatchVertices();
 
     GLuint      _vao;
     GLuint      _vbo;
@@ -355,6 +369,22 @@ protected:
     
     int         _lineWidth;
 
+    // number of vertices of each buffer already in its VBO, only the ones after it are uploaded
+    GLsizei     _bufferCountUploaded;
+    GLsizei     _bufferCountUploadedGLPoint;
+    GLsizei     _bufferCountUploadedGLLine;
+    int         _vboCapacity;
+    int         _vboCapacityGLPoint;
+    int         _vboCapacityGLLine;
+
+    bool        _batchingEnabled;
+    int         _batchCapacity;
+    GLsizei     _batchCount;
+    V3F_C4B_T2F *_batchVertices;
+    unsigned short *_batchIndices;
+    GLProgramState *_batchGLProgramState;
+    TrianglesCommand _trianglesCommand;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(DrawNode);
 };
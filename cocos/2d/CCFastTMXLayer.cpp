@@ -52,6 +52,8 @@ namespace experimental {
 const int TMXLayer::FAST_TMX_ORIENTATION_ORTHO = 0;
 const int TMXLayer::FAST_TMX_ORIENTATION_HEX = 1;
 const int TMXLayer::FAST_TMX_ORIENTATION_ISO = 2;
+// 32x32 tiles use 4096 vertices, within the range of 16 bit indices
+const int TMXLayer::TILE_CHUNK_SIZE = 32;
 
 // FastTMXLayer - init & alloc & dealloc
 TMXLayer * TMXLayer::create(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *layerInfo, TMXMapInfo *mapInfo)
@@ -78,7 +80,12 @@ bool TMXLayer::initWithTilesetInfo(TMXTilesetInfo *tilesetInfo, TMXLayerInfo *la
     _layerName = layerInfo->_name;
     _layerSize = layerInfo->_layerSize;
     _tiles = layerInfo->_tiles;
-    _quadsDirty = true;
+    if (_tiles == nullptr)
+    {
+        _tileSource = layerInfo->_tileSource;
+        CC_SAFE_RETAIN(_tileSource);
+    }
+    _chunkColumns = ((int)_layerSize.width + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
     setOpacity( layerInfo->_opacity );
     setProperties(layerInfo->getProperties());
 
@@ -112,34 +119,30 @@ TMXLayer::TMXLayer()
 , _layerSize(Size::ZERO)
 , _mapTileSize(Size::ZERO)
 , _tiles(nullptr)
+, _tileSource(nullptr)
 , _tileSet(nullptr)
 , _layerOrientation(FAST_TMX_ORIENTATION_ORTHO)
 , _texture(nullptr)
 , _vertexZvalue(0)
 , _useAutomaticVertexZ(false)
-, _quadsDirty(true)
 , _dirty(true)
-, _vertexBuffer(nullptr)
-, _vData(nullptr)
-, _indexBuffer(nullptr)
+, _chunkColumns(0)
+, _maxCachedChunks(0)
+, _chunkVisit(0)
 {
 }
 
 TMXLayer::~TMXLayer()
 {
+    removeAllChunks();
     CC_SAFE_RELEASE(_tileSet);
     CC_SAFE_RELEASE(_texture);
     CC_SAFE_DELETE_ARRAY(_tiles);
-    CC_SAFE_RELEASE(_vData);
-    CC_SAFE_RELEASE(_vertexBuffer);
-    CC_SAFE_RELEASE(_indexBuffer);
-    
+    CC_SAFE_RELEASE(_tileSource);
 }
 
 void TMXLayer::draw(Renderer *renderer, const Mat4& transform, uint32_t flags)
 {
-    updateTotalQuads();
-
     bool isViewProjectionUpdated = true;
     auto visitingCamera = Camera::getVisitingCamera();
     auto defaultCamera = Camera::getDefaultCamera();
@@ -147,7 +150,7 @@ void TMXLayer::draw(Renderer *renderer, const Mat4& transform, uint32_t flags)
         isViewProjectionUpdated = visitingCamera->isViewProjectionUpdated();
     }
     
-    if( flags != 0 || _dirty || _quadsDirty || isViewProjectionUpdated)
+    if( flags != 0 || _dirty || isViewProjectionUpdated)
     {
         Size s = Director::getInstance()->getVisibleSize();
         auto rect = Rect(Camera::getVisitingCamera()->getPositionX() - s.width * 0.5,
@@ -160,20 +163,29 @@ void TMXLayer::draw(Renderer *renderer, const Mat4& transform, uint32_t flags)
         rect = RectApplyTransform(rect, inv);
         
         updateTiles(rect);
-        updateIndexBuffer();
-        updatePrimitives();
         _dirty = false;
     }
     
-    if(_renderCommands.size() < static_cast<size_t>(_primitives.size()))
+    size_t commandCount = 0;
+    for (auto chunk : _visibleChunks)
+    {
+        if (chunk->quadsDirty)
+        {
+            buildChunk(chunk);
+        }
+        commandCount += chunk->primitives.size();
+    }
+    
+    // the commands can't be moved once they are added to the renderer
+    if(_renderCommands.size() < commandCount)
     {
-        _renderCommands.resize(_primitives.size());
+        _renderCommands.resize(commandCount);
     }
     
     int index = 0;
-    for(const auto& iter : _primitives)
+    for (auto chunk : _visibleChunks)
     {
-        if(iter.second->getCount() > 0)
+        for (const auto& iter : chunk->primitives)
         {
             auto& cmd = _renderCommands[index++];
             cmd.init(iter.first, _texture->getName(), getGLProgramState(), BlendFunc::ALPHA_NON_PREMULTIPLIED, iter.second, _modelViewTransform, flags);
@@ -240,82 +252,37 @@ void TMXLayer::updateTiles(const Rect& culledRect)
         //CCASSERT(0, "TMX invalid value");
     }
     
-    _indicesVertexZNumber.clear();
-    
-    for(const auto& iter : _indicesVertexZOffsets)
-    {
-        _indicesVertexZNumber[iter.first] = iter.second;
-    }
-    
     int yBegin = std::max(0.f,visibleTiles.origin.y - tilesOverY);
     int yEnd = std::min(_layerSize.height,visibleTiles.origin.y + visibleTiles.size.height + tilesOverY);
     int xBegin = std::max(0.f,visibleTiles.origin.x - tilesOverX);
     int xEnd = std::min(_layerSize.width,visibleTiles.origin.x + visibleTiles.size.width + tilesOverX);
     
-    for (int y =  yBegin; y < yEnd; ++y)
+    ++_chunkVisit;
+    _visibleChunks.clear();
+    if (xBegin >= xEnd || yBegin >= yEnd)
     {
-        for (int x = xBegin; x < xEnd; ++x)
-        {
-            int tileIndex = getTileIndexByPos(x, y);
-            if(_tiles[tileIndex] == 0) continue;
-            
-            int vertexZ = getVertexZForPos(Vec2(x,y));
-            auto iter = _indicesVertexZNumber.find(vertexZ);
-            int offset = iter->second;
-            iter->second++;
-            
-            int quadIndex = _tileToQuadIndex[tileIndex];
-            CC_ASSERT(-1 != quadIndex);
-            _indices[6 * offset + 0] = quadIndex * 4 + 0;
-            _indices[6 * offset + 1] = quadIndex * 4 + 1;
-            _indices[6 * offset + 2] = quadIndex * 4 + 2;
-            _indices[6 * offset + 3] = quadIndex * 4 + 3;
-            _indices[6 * offset + 4] = quadIndex * 4 + 2;
-            _indices[6 * offset + 5] = quadIndex * 4 + 1;
-            
-        } // for x
-    } // for y
-    
-    for(const auto& iter : _indicesVertexZOffsets)
-    {
-        _indicesVertexZNumber[iter.first] -= iter.second;
-        if(_indicesVertexZNumber[iter.first] == 0)
-        {
-            _indicesVertexZNumber.erase(iter.first);
-        }
+        evictChunks();
+        return;
     }
     
-}
-
-void TMXLayer::updateVertexBuffer()
-{
-    GL::bindVAO(0);
-    if(nullptr == _vData)
-    {
-        _vertexBuffer = VertexBuffer::create(sizeof(V3F_C4B_T2F), (int)_totalQuads.size() * 4);
-        _vData = VertexData::create();
-        _vData->setStream(_vertexBuffer, VertexStreamAttribute(0, GLProgram::VERTEX_ATTRIB_POSITION, GL_FLOAT, 3));
-        _vData->setStream(_vertexBuffer, VertexStreamAttribute(offsetof(V3F_C4B_T2F, colors), GLProgram::VERTEX_ATTRIB_COLOR, GL_UNSIGNED_BYTE, 4, true));
-        _vData->setStream(_vertexBuffer, VertexStreamAttribute(offsetof(V3F_C4B_T2F, texCoords), GLProgram::VERTEX_ATTRIB_TEX_COORD, GL_FLOAT, 2));
-        CC_SAFE_RETAIN(_vData);
-        CC_SAFE_RETAIN(_vertexBuffer);
-    }
-    if(_vertexBuffer)
-    {
-        _vertexBuffer->updateVertices((void*)&_totalQuads[0], (int)_totalQuads.size() * 4, 0);
-    }
+    int chunkXBegin = xBegin / TILE_CHUNK_SIZE;
+    int chunkXEnd = (xEnd - 1) / TILE_CHUNK_SIZE;
+    int chunkYBegin = yBegin / TILE_CHUNK_SIZE;
+    int chunkYEnd = (yEnd - 1) / TILE_CHUNK_SIZE;
     
-}
-
-void TMXLayer::updateIndexBuffer()
-{
-    if(nullptr == _indexBuffer)
+    // chunks are drawn row by row, like the tiles inside a chunk
+    for (int y = chunkYBegin; y <= chunkYEnd; ++y)
     {
-        _indexBuffer = IndexBuffer::create(IndexBuffer::IndexType::INDEX_TYPE_SHORT_16, (int)_indices.size());
-        CC_SAFE_RETAIN(_indexBuffer);
+        for (int x = chunkXBegin; x <= chunkXEnd; ++x)
+        {
+            auto chunk = getChunk(x + y * _chunkColumns);
+            chunk->lastVisit = _chunkVisit;
+            touchChunk(chunk);
+            _visibleChunks.push_back(chunk);
+        }
     }
-    _indexBuffer->updateIndices(&_indices[0], (int)_indices.size(), 0);
     
+    evictChunks();
 }
 
 // FastTMXLayer - setup Tiles
@@ -357,6 +324,13 @@ void TMXLayer::setupTiles()
 
     _screenTileCount = _screenGridSize.width * _screenGridSize.height;
 
+    if (_maxCachedChunks == 0)
+    {
+        int columns = (int)ceil(_screenGridSize.width / TILE_CHUNK_SIZE) + 1;
+        int rows = (int)ceil(_screenGridSize.height / TILE_CHUNK_SIZE) + 1;
+        _maxCachedChunks = 2 * columns * rows;
+    }
+
 }
 
 Mat4 TMXLayer::tileToNodeTransform()
@@ -411,165 +385,311 @@ Mat4 TMXLayer::tileToNodeTransform()
     
 }
 
-void TMXLayer::updatePrimitives()
+TMXLayer::TileChunk* TMXLayer::getChunk(int key)
+{
+    auto iter = _chunks.find(key);
+    if (iter != _chunks.end())
+    {
+        return iter->second;
+    }
+    
+    auto chunk = new (std::nothrow) TileChunk();
+    chunk->x = (key % _chunkColumns) * TILE_CHUNK_SIZE;
+    chunk->y = (key / _chunkColumns) * TILE_CHUNK_SIZE;
+    chunk->width = std::min(TILE_CHUNK_SIZE, (int)_layerSize.width - chunk->x);
+    chunk->height = std::min(TILE_CHUNK_SIZE, (int)_layerSize.height - chunk->y);
+    chunk->tiles = nullptr;
+    chunk->modified = false;
+    chunk->quadsDirty = true;
+    chunk->lastVisit = 0;
+    chunk->cached = false;
+    chunk->vertexBuffer = nullptr;
+    chunk->vertexData = nullptr;
+    chunk->indexBuffer = nullptr;
+    
+    if (_tiles == nullptr)
+    {
+        size_t count = chunk->width * chunk->height;
+        chunk->tiles = (uint32_t*)calloc(count, sizeof(uint32_t));
+        if (_tileSource == nullptr || !_tileSource->loadTiles(chunk->x, chunk->y, chunk->width, chunk->height, chunk->tiles))
+        {
+            CCLOG("cocos2d: TMXLayer '%s': failed to load the tiles at %d,%d", _layerName.c_str(), chunk->x, chunk->y);
+            memset(chunk->tiles, 0, count * sizeof(uint32_t));
+        }
+    }
+    
+    _chunks[key] = chunk;
+    touchChunk(chunk);
+    return chunk;
+}
+
+void TMXLayer::touchChunk(TileChunk* chunk)
 {
-    for(const auto& iter : _indicesVertexZNumber)
+    int key = getChunkKey(chunk->x, chunk->y);
+    if (chunk->cached)
     {
-        int start = _indicesVertexZOffsets.at(iter.first);
+        _chunkLRU.splice(_chunkLRU.begin(), _chunkLRU, chunk->lruIter);
+    }
+    else
+    {
+        _chunkLRU.push_front(key);
+        chunk->cached = true;
+    }
+    chunk->lruIter = _chunkLRU.begin();
+}
+
+void TMXLayer::evictChunks()
+{
+    while (_maxCachedChunks > 0 && (int)_chunkLRU.size() > _maxCachedChunks)
+    {
+        int key = _chunkLRU.back();
+        auto iter = _chunks.find(key);
+        auto chunk = iter->second;
+        // the visible chunks are at the front
+        if (chunk->lastVisit == _chunkVisit)
+            break;
         
-        auto primitiveIter= _primitives.find(iter.first);
-        if(primitiveIter == _primitives.end())
+        _chunkLRU.pop_back();
+        chunk->cached = false;
+        
+        if (chunk->modified)
         {
-            auto primitive = Primitive::create(_vData, _indexBuffer, GL_TRIANGLES);
-            primitive->setCount(iter.second * 6);
-            primitive->setStart(start * 6);
-            
-            _primitives.insert(iter.first, primitive);
+            // keep the changed tiles, only the buffers are released
+            releaseChunkBuffers(chunk);
+            chunk->quadsDirty = true;
         }
         else
         {
-            primitiveIter->second->setCount(iter.second * 6);
-            primitiveIter->second->setStart(start * 6);
+            releaseChunkBuffers(chunk);
+            free(chunk->tiles);
+            delete chunk;
+            _chunks.erase(iter);
         }
     }
 }
 
-void TMXLayer::updateTotalQuads()
+void TMXLayer::releaseChunkBuffers(TileChunk* chunk)
 {
-    if(_quadsDirty)
-    {
-        Size tileSize = CC_SIZE_PIXELS_TO_POINTS(_tileSet->_tileSize);
-        Size texSize = _tileSet->_imageSize;
-        _tileToQuadIndex.clear();
-        _totalQuads.resize(int(_layerSize.width * _layerSize.height));
-        _indices.resize(6 * int(_layerSize.width * _layerSize.height));
-        _tileToQuadIndex.resize(int(_layerSize.width * _layerSize.height),-1);
-        _indicesVertexZOffsets.clear();
-        
-        int quadIndex = 0;
-        for(int y = 0; y < _layerSize.height; ++y)
-        {
-            for(int x =0; x < _layerSize.width; ++x)
-            {
-                int tileIndex = getTileIndexByPos(x, y);
-                int tileGID = _tiles[tileIndex];
-                
-                if(tileGID == 0) continue;
-                
-                _tileToQuadIndex[tileIndex] = quadIndex;
-                
-                auto& quad = _totalQuads[quadIndex];
-                
-                Vec3 nodePos(float(x), float(y), 0);
-                _tileToNodeTransform.transformPoint(&nodePos);
-                
-                float left, right, top, bottom, z;
-                
-                z = getVertexZForPos(Vec2(x, y));
-                auto iter = _indicesVertexZOffsets.find(z);
-                if(iter == _indicesVertexZOffsets.end())
-                {
-                    _indicesVertexZOffsets[z] = 1;
-                }
-                else
-                {
-                    iter->second++;
-                }
-                // vertices
-                if (tileGID & kTMXTileDiagonalFlag)
-                {
-                    left = nodePos.x;
-                    right = nodePos.x + tileSize.height;
-                    bottom = nodePos.y + tileSize.width;
-                    top = nodePos.y;
-                }
-                else
-                {
-                    left = nodePos.x;
-                    right = nodePos.x + tileSize.width;
-                    bottom = nodePos.y + tileSize.height;
-                    top = nodePos.y;
-                }
-                
-                if(tileGID & kTMXTileVerticalFlag)
-                    std::swap(top, bottom);
-                if(tileGID & kTMXTileHorizontalFlag)
-                    std::swap(left, right);
-                
-                if(tileGID & kTMXTileDiagonalFlag)
-                {
-                    // FIXME: not working correcly
-                    quad.bl.vertices.x = left;
-                    quad.bl.vertices.y = bottom;
-                    quad.bl.vertices.z = z;
-                    quad.br.vertices.x = left;
-                    quad.br.vertices.y = top;
-                    quad.br.vertices.z = z;
-                    quad.tl.vertices.x = right;
-                    quad.tl.vertices.y = bottom;
-                    quad.tl.vertices.z = z;
-                    quad.tr.vertices.x = right;
-                    quad.tr.vertices.y = top;
-                    quad.tr.vertices.z = z;
-                }
-                else
-                {
-                    quad.bl.vertices.x = left;
-                    quad.bl.vertices.y = bottom;
-                    quad.bl.vertices.z = z;
-                    quad.br.vertices.x = right;
-                    quad.br.vertices.y = bottom;
-                    quad.br.vertices.z = z;
-                    quad.tl.vertices.x = left;
-                    quad.tl.vertices.y = top;
-                    quad.tl.vertices.z = z;
-                    quad.tr.vertices.x = right;
-                    quad.tr.vertices.y = top;
-                    quad.tr.vertices.z = z;
-                }
-                
-                // texcoords
-                Rect tileTexture = _tileSet->getRectForGID(tileGID);
-                left   = (tileTexture.origin.x / texSize.width);
-                right  = left + (tileTexture.size.width / texSize.width);
-                bottom = (tileTexture.origin.y / texSize.height);
-                top    = bottom + (tileTexture.size.height / texSize.height);
-                
-                quad.bl.texCoords.u = left;
-                quad.bl.texCoords.v = bottom;
-                quad.br.texCoords.u = right;
-                quad.br.texCoords.v = bottom;
-                quad.tl.texCoords.u = left;
-                quad.tl.texCoords.v = top;
-                quad.tr.texCoords.u = right;
-                quad.tr.texCoords.v = top;
-                
-                quad.bl.colors = Color4B::WHITE;
-                quad.br.colors = Color4B::WHITE;
-                quad.tl.colors = Color4B::WHITE;
-                quad.tr.colors = Color4B::WHITE;
-                
-                ++quadIndex;
-            }
-        }
-        
-        int offset = 0;
-        for(auto iter = _indicesVertexZOffsets.begin(); iter != _indicesVertexZOffsets.end(); ++iter)
+    for (auto& iter : chunk->primitives)
+    {
+        iter.second->release();
+    }
+    chunk->primitives.clear();
+    CC_SAFE_RELEASE_NULL(chunk->vertexData);
+    CC_SAFE_RELEASE_NULL(chunk->vertexBuffer);
+    CC_SAFE_RELEASE_NULL(chunk->indexBuffer);
+}
+
+void TMXLayer::removeAllChunks()
+{
+    for (auto& iter : _chunks)
+    {
+        releaseChunkBuffers(iter.second);
+        free(iter.second->tiles);
+        delete iter.second;
+    }
+    _chunks.clear();
+    _chunkLRU.clear();
+    _visibleChunks.clear();
+}
+
+void TMXLayer::setTiles(uint32_t* tiles)
+{
+    _tiles = tiles;
+    // the chunks built from, or streamed, the previous tiles are all stale
+    removeAllChunks();
+    _dirty = true;
+}
+
+uint32_t* TMXLayer::getTileData(int x, int y)
+{
+    if (_tiles)
+    {
+        return &_tiles[getTileIndexByPos(x, y)];
+    }
+    
+    auto chunk = getChunk(getChunkKey(x, y));
+    evictChunks();
+    return &chunk->tiles[(x - chunk->x) + (y - chunk->y) * chunk->width];
+}
+
+void TMXLayer::buildChunk(TileChunk* chunk)
+{
+    chunk->quadsDirty = false;
+    _chunkQuads.clear();
+    _chunkQuadsZ.clear();
+    
+    // number of quads for each vertexZ, then their offset
+    std::map<int, int> vertexZOffsets;
+    for (int y = chunk->y; y < chunk->y + chunk->height; ++y)
+    {
+        for (int x = chunk->x; x < chunk->x + chunk->width; ++x)
         {
-            std::swap(offset, iter->second);
-            offset += iter->second;
+            uint32_t tileGID = chunk->tiles ? chunk->tiles[(x - chunk->x) + (y - chunk->y) * chunk->width] : _tiles[getTileIndexByPos(x, y)];
+            if (tileGID == 0) continue;
+            
+            int z = getVertexZForPos(Vec2(x, y));
+            _chunkQuads.push_back(V3F_C4B_T2F_Quad());
+            fillTileQuad(_chunkQuads.back(), x, y, tileGID, z);
+            _chunkQuadsZ.push_back(z);
+            vertexZOffsets[z]++;
         }
-        updateVertexBuffer();
-        
-        _quadsDirty = false;
+    }
+    
+    int quadCount = (int)_chunkQuads.size();
+    if (quadCount == 0)
+    {
+        releaseChunkBuffers(chunk);
+        return;
+    }
+    
+    std::vector<std::pair<int, int>> ranges;
+    int offset = 0;
+    for (auto& iter : vertexZOffsets)
+    {
+        ranges.push_back(std::make_pair(offset, iter.second));
+        std::swap(offset, iter.second);
+        offset += iter.second;
+    }
+    
+    _chunkIndices.resize(quadCount * 6);
+    for (int i = 0; i < quadCount; ++i)
+    {
+        int quadOffset = vertexZOffsets[_chunkQuadsZ[i]]++;
+        GLushort* indices = &_chunkIndices[6 * quadOffset];
+        indices[0] = i * 4 + 0;
+        indices[1] = i * 4 + 1;
+        indices[2] = i * 4 + 2;
+        indices[3] = i * 4 + 3;
+        indices[4] = i * 4 + 2;
+        indices[5] = i * 4 + 1;
+    }
+    
+    GL::bindVAO(0);
+    if (chunk->vertexBuffer == nullptr || chunk->vertexBuffer->getVertexNumber() < quadCount * 4)
+    {
+        releaseChunkBuffers(chunk);
+        chunk->vertexBuffer = VertexBuffer::create(sizeof(V3F_C4B_T2F), quadCount * 4);
+        chunk->vertexData = VertexData::create();
+        chunk->vertexData->setStream(chunk->vertexBuffer, VertexStreamAttribute(0, GLProgram::VERTEX_ATTRIB_POSITION, GL_FLOAT, 3));
+        chunk->vertexData->setStream(chunk->vertexBuffer, VertexStreamAttribute(offsetof(V3F_C4B_T2F, colors), GLProgram::VERTEX_ATTRIB_COLOR, GL_UNSIGNED_BYTE, 4, true));
+        chunk->vertexData->setStream(chunk->vertexBuffer, VertexStreamAttribute(offsetof(V3F_C4B_T2F, texCoords), GLProgram::VERTEX_ATTRIB_TEX_COORD, GL_FLOAT, 2));
+        chunk->indexBuffer = IndexBuffer::create(IndexBuffer::IndexType::INDEX_TYPE_SHORT_16, quadCount * 6);
+        CC_SAFE_RETAIN(chunk->vertexBuffer);
+        CC_SAFE_RETAIN(chunk->vertexData);
+        CC_SAFE_RETAIN(chunk->indexBuffer);
+    }
+    chunk->vertexBuffer->updateVertices(&_chunkQuads[0], quadCount * 4, 0);
+    chunk->indexBuffer->updateIndices(&_chunkIndices[0], quadCount * 6, 0);
+    
+    for (auto& iter : chunk->primitives)
+    {
+        iter.second->release();
+    }
+    chunk->primitives.clear();
+    
+    auto rangeIter = ranges.begin();
+    for (auto& iter : vertexZOffsets)
+    {
+        auto primitive = Primitive::create(chunk->vertexData, chunk->indexBuffer, GL_TRIANGLES);
+        primitive->setStart(rangeIter->first * 6);
+        primitive->setCount(rangeIter->second * 6);
+        primitive->retain();
+        chunk->primitives.push_back(std::make_pair(iter.first, primitive));
+        ++rangeIter;
     }
 }
 
+void TMXLayer::fillTileQuad(V3F_C4B_T2F_Quad& quad, int x, int y, uint32_t tileGID, float z)
+{
+    Size tileSize = CC_SIZE_PIXELS_TO_POINTS(_tileSet->_tileSize);
+    Size texSize = _tileSet->_imageSize;
+    
+    Vec3 nodePos(float(x), float(y), 0);
+    _tileToNodeTransform.transformPoint(&nodePos);
+    
+    float left, right, top, bottom;
+    
+    // vertices
+    if (tileGID & kTMXTileDiagonalFlag)
+    {
+        left = nodePos.x;
+        right = nodePos.x + tileSize.height;
+        bottom = nodePos.y + tileSize.width;
+        top = nodePos.y;
+    }
+    else
+    {
+        left = nodePos.x;
+        right = nodePos.x + tileSize.width;
+        bottom = nodePos.y + tileSize.height;
+        top = nodePos.y;
+    }
+    
+    if(tileGID & kTMXTileVerticalFlag)
+        std::swap(top, bottom);
+    if(tileGID & kTMXTileHorizontalFlag)
+        std::swap(left, right);
+    
+    if(tileGID & kTMXTileDiagonalFlag)
+    {
+        // FIXME: not working correcly
+        quad.bl.vertices.x = left;
+        quad.bl.vertices.y = bottom;
+        quad.bl.vertices.z = z;
+        quad.br.vertices.x = left;
+        quad.br.vertices.y = top;
+        quad.br.vertices.z = z;
+        quad.tl.vertices.x = right;
+        quad.tl.vertices.y = bottom;
+        quad.tl.vertices.z = z;
+        quad.tr.vertices.x = right;
+        quad.tr.vertices.y = top;
+        quad.tr.vertices.z = z;
+    }
+    else
+    {
+        quad.bl.vertices.x = left;
+        quad.bl.vertices.y = bottom;
+        quad.bl.vertices.z = z;
+        quad.br.vertices.x = right;
+        quad.br.vertices.y = bottom;
+        quad.br.vertices.z = z;
+        quad.tl.vertices.x = left;
+        quad.tl.vertices.y = top;
+        quad.tl.vertices.z = z;
+        quad.tr.vertices.x = right;
+        quad.tr.vertices.y = top;
+        quad.tr.vertices.z = z;
+    }
+    
+    // texcoords
+    Rect tileTexture = _tileSet->getRectForGID(tileGID);
+    left   = (tileTexture.origin.x / texSize.width);
+    right  = left + (tileTexture.size.width / texSize.width);
+    bottom = (tileTexture.origin.y / texSize.height);
+    top    = bottom + (tileTexture.size.height / texSize.height);
+    
+    quad.bl.texCoords.u = left;
+    quad.bl.texCoords.v = bottom;
+    quad.br.texCoords.u = right;
+    quad.br.texCoords.v = bottom;
+    quad.tl.texCoords.u = left;
+    quad.tl.texCoords.v = top;
+    quad.tr.texCoords.u = right;
+    quad.tr.texCoords.v = top;
+    
+    quad.bl.colors = Color4B::WHITE;
+    quad.br.colors = Color4B::WHITE;
+    quad.tl.colors = Color4B::WHITE;
+    quad.tr.colors = Color4B::WHITE;
+}
+
 // removing / getting tiles
 Sprite* TMXLayer::getTileAt(const Vec2& tileCoordinate)
 {
     CCASSERT( tileCoordinate.x < _layerSize.width && tileCoordinate.y < _layerSize.height && tileCoordinate.x >=0 && tileCoordinate.y >=0, "TMXLayer: invalid position");
-    CCASSERT( _tiles, "TMXLayer: the tiles map has been released");
+    CCASSERT( _tiles || _tileSource, "TMXLayer: the tiles map has been released");
     
     Sprite *tile = nullptr;
     int gid = this->getTileGIDAt(tileCoordinate);
@@ -609,12 +729,12 @@ Sprite* TMXLayer::getTileAt(const Vec2& tileCoordinate)
 int TMXLayer::getTileGIDAt(const Vec2& tileCoordinate, TMXTileFlags* flags/* = nullptr*/)
 {
     CCASSERT(tileCoordinate.x < _layerSize.width && tileCoordinate.y < _layerSize.height && tileCoordinate.x >=0 && tileCoordinate.y >=0, "TMXLayer: invalid position");
-    CCASSERT(_tiles, "TMXLayer: the tiles map has been released");
+    CCASSERT(_tiles || _tileSource, "TMXLayer: the tiles map has been released");
     
     int idx = static_cast<int>((tileCoordinate.x + tileCoordinate.y * _layerSize.width));
     
     // Bits on the far end of the 32-bit global tile ID are used for tile flags
-    int tile = _tiles[idx];
+    int tile = *getTileData((int)tileCoordinate.x, (int)tileCoordinate.y);
     auto it = _spriteContainer.find(idx);
     
     // converted to sprite.
@@ -693,9 +813,18 @@ void TMXLayer::removeTileAt(const Vec2& tileCoordinate)
 
 void TMXLayer::setFlaggedTileGIDByIndex(int index, int gid)
 {
-    if(gid == _tiles[index]) return;
-    _tiles[index] = gid;
-    _quadsDirty = true;
+    int x = index % (int)_layerSize.width;
+    int y = index / (int)_layerSize.width;
+    uint32_t* tile = getTileData(x, y);
+    if(gid == *tile) return;
+    *tile = gid;
+    
+    auto iter = _chunks.find(getChunkKey(x, y));
+    if (iter != _chunks.end())
+    {
+        iter->second->quadsDirty = true;
+        iter->second->modified = iter->second->tiles != nullptr;
+    }
     _dirty = true;
 }
 
@@ -778,7 +907,7 @@ void TMXLayer::setTileGID(int gid, const Vec2& tileCoordinate)
 void TMXLayer::setTileGID(int gid, const Vec2& tileCoordinate, TMXTileFlags flags)
 {
     CCASSERT(tileCoordinate.x < _layerSize.width && tileCoordinate.y < _layerSize.height && tileCoordinate.x >=0 && tileCoordinate.y >=0, "TMXLayer: invalid position");
-    CCASSERT(_tiles, "TMXLayer: the tiles map has been released");
+    CCASSERT(_tiles || _tileSource, "TMXLayer: the tiles map has been released");
     CCASSERT(gid == 0 || gid >= _tileSet->_firstGid, "TMXLayer: invalid gid" );
     
     TMXTileFlags currentFlags;
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #define __CC_FAST_TMX_LAYER_H__
 
 #include <map>
+#include <list>
 #include <unordered_map>
 #include "2d/CCNode.h"
 #include "2d/CCTMXXMLParser.h"
@@ -71,6 +72,12 @@ namespace experimental{
  
  * For further information, please see the programming guide:
  * http://www.cocos2d-iphone.org/wiki/doku.php/prog_guide:tiled_maps
+
+ * The layer is split in chunks of TILE_CHUNK_SIZE x TILE_CHUNK_SIZE tiles. Each chunk owns the vertex and index
+ * buffers of its tiles, which are built when the chunk comes into view and kept in a LRU cache of
+ * getMaxCachedChunks() chunks, so the memory used by the vertices doesn't depend on the size of the layer.
+ * If the layer info has a TMXTileSource, the GIDs are also read chunk by chunk from it instead of being kept for the
+ * whole layer. Chunks whose tiles were modified are never evicted in that case.
  
  * @since v3.2
  * @js NA
@@ -186,15 +193,26 @@ public:
     /** Pointer to the map of tiles.
      * @js NA
      * @lua NA
-     * @return The pointer to the map of tiles.
+     * @return The pointer to the map of tiles, nullptr if the tiles are streamed from a TMXTileSource.
      */
     const uint32_t* getTiles() const { return _tiles; };
     
-    /** Set the pointer to the map of tiles.
+    /** Set the pointer to the map of tiles. It replaces every tile of the layer, streamed or changed ones included.
      *
      * @param tiles The pointer to the map of tiles.
      */
-    void setTiles(uint32_t* tiles) { _tiles = tiles; _quadsDirty = true;};
+    void setTiles(uint32_t* tiles);
+
+    /** Set the maximum number of chunks kept in memory. The least recently visible ones are released first.
+     * By default it is twice the number of chunks needed to cover the screen.
+     *
+     * @param count The maximum number of chunks.
+     */
+    void setMaxCachedChunks(int count) { _maxCachedChunks = count; }
+    /** The maximum number of chunks kept in memory. */
+    int getMaxCachedChunks() const { return _maxCachedChunks; }
+    /** The number of chunks currently in memory. */
+    int getCachedChunkCount() const { return (int)_chunkLRU.size(); }
     
     /** Tileset information for the layer.
      *
@@ -287,15 +305,40 @@ protected:
     //Flip flags is packed into gid
     void setFlaggedTileGIDByIndex(int index, int gid);
     
-    //
-    void updateTotalQuads();
-    
     void onDraw(Primitive* primitive);
     inline int getTileIndexByPos(int x, int y) const { return x + y * (int) _layerSize.width; }
-    
-    void updateVertexBuffer();
-    void updateIndexBuffer();
-    void updatePrimitives();
+
+    struct TileChunk
+    {
+        // first tile and size in tiles, the chunks on the right and bottom edges can be smaller
+        int x;
+        int y;
+        int width;
+        int height;
+        // GIDs of the chunk, only used when the tiles are streamed from _tileSource
+        uint32_t* tiles;
+        // streamed tiles were changed, they can't be read from the source again
+        bool modified;
+        bool quadsDirty;
+        unsigned int lastVisit;
+        bool cached;
+        std::list<int>::iterator lruIter;
+        VertexBuffer* vertexBuffer;
+        VertexData* vertexData;
+        IndexBuffer* indexBuffer;
+        std::vector<std::pair<int/*vertexZ*/, Primitive*>> primitives;
+    };
+
+    inline int getChunkKey(int x, int y) const { return x / TILE_CHUNK_SIZE + (y / TILE_CHUNK_SIZE) * _chunkColumns; }
+    // returns the storage of the flagged GID of a tile, reading its chunk from _tileSource if needed
+    uint32_t* getTileData(int x, int y);
+    TileChunk* getChunk(int key);
+    void touchChunk(TileChunk* chunk);
+    void buildChunk(TileChunk* chunk);
+    void releaseChunkBuffers(TileChunk* chunk);
+    void removeAllChunks();
+    void evictChunks();
+    void fillTileQuad(V3F_C4B_T2F_Quad& quad, int x, int y, uint32_t gid, float z);
 protected:
     
     //! name of the layer
@@ -307,6 +350,8 @@ protected:
     Size _mapTileSize;
     /** pointer to the map of tiles */
     uint32_t* _tiles;
+    /** streams the tiles when _tiles is nullptr */
+    TMXTileSource* _tileSource;
     /** Tileset information for the layer */
     TMXTilesetInfo* _tileSet;
     /** Layer orientation, which is the same as the map orientation */
@@ -331,24 +376,26 @@ protected:
     /** tile coordinate to node coordinate transform */
     Mat4 _tileToNodeTransform;
     /** data for rendering */
-    bool _quadsDirty;
-    std::vector<int> _tileToQuadIndex;
-    std::vector<V3F_C4B_T2F_Quad> _totalQuads;
-    std::vector<GLushort> _indices;
-    std::map<int/*vertexZ*/, int/*offset to _indices by quads*/> _indicesVertexZOffsets;
-    std::unordered_map<int/*vertexZ*/, int/*number to quads*/> _indicesVertexZNumber;
     std::vector<PrimitiveCommand> _renderCommands;
     bool _dirty;
-    
-    VertexBuffer* _vertexBuffer;
-    
-    VertexData* _vData;
-    
-    IndexBuffer* _indexBuffer;
-    
-    Map<int , Primitive*> _primitives;
+
+    /** chunks of the layer, by chunk index */
+    int _chunkColumns;
+    int _maxCachedChunks;
+    unsigned int _chunkVisit;
+    std::unordered_map<int, TileChunk*> _chunks;
+    /** keys of the cached chunks, the most recently visible first */
+    std::list<int> _chunkLRU;
+    /** visible chunks, row by row */
+    std::vector<TileChunk*> _visibleChunks;
+    /** scratch buffers used to build the chunks */
+    std::vector<V3F_C4B_T2F_Quad> _chunkQuads;
+    std::vector<int> _chunkQuadsZ;
+    std::vector<GLushort> _chunkIndices;
     
 public:
+    /** Width and height of the chunks in tiles. */
+    static const int TILE_CHUNK_SIZE;
     /** Possible orientations of the TMX map */
     static const int FAST_TMX_ORIENTATION_ORTHO;
     static const int FAST_TMX_ORIENTATION_HEX;
@@ -123,12 +123,24 @@ TMXTilesetInfo * TMXTiledMap::tilesetForLayer(TMXLayerInfo *layerInfo, TMXMapInf
         TMXTilesetInfo* tilesetInfo = *iter;
         if (tilesetInfo)
         {
+            // streamed layers are scanned one row at a time
+            std::vector<uint32_t> row;
+            if (layerInfo->_tiles == nullptr)
+            {
+                if (layerInfo->_tileSource == nullptr)
+                    break;
+                row.resize((size_t)size.width);
+            }
+            
             for( int y=0; y < size.height; y++ )
             {
+                if (!row.empty() && !layerInfo->_tileSource->loadTiles(0, y, (int)size.width, 1, row.data()))
+                    continue;
+                
                 for( int x=0; x < size.width; x++ )
                 {
                     int pos = static_cast<int>(x + size.width * y);
-                    int gid = layerInfo->_tiles[ pos ];
+                    int gid = row.empty() ? layerInfo->_tiles[ pos ] : row[x];
                     
                     // gid are stored in little endian.
                     // if host is big endian, then swap
@@ -35,23 +35,54 @@
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventType.h"
+#include "base/CCScheduler.h"
+#include "base/CCAsyncTaskPool.h"
+#include "renderer/ccGLStateCache.h"
+#include "platform/CCFileUtils.h"
 
 NS_CC_BEGIN
 
+static Texture2D::PixelFormat getPagePixelFormat(int bytesPerPixel)
+{
+    switch (bytesPerPixel)
+    {
+    case 2:
+        // outline in alpha, glyph in intensity
+        return Texture2D::PixelFormat::AI88;
+    case 4:
+        // multi-channel distance field
+        return Texture2D::PixelFormat::RGBA8888;
+    default:
+        return Texture2D::PixelFormat::A8;
+    }
+}
+
 const int FontAtlas::CacheTextureWidth = 512;
 const int FontAtlas::CacheTextureHeight = 512;
 const char* FontAtlas::CMD_PURGE_FONTATLAS = "__cc_PURGE_FONTATLAS";
 const char* FontAtlas::CMD_RESET_FONTATLAS = "__cc_RESET_FONTATLAS";
+const char* FontAtlas::CMD_LETTERS_ADDED = "__cc_FONTATLAS_LETTERS_ADDED";
 
 FontAtlas::FontAtlas(Font &theFont) 
 : _font(&theFont)
 , _fontFreeType(nullptr)
 , _iconv(nullptr)
 , _currentPageData(nullptr)
+, _bytesPerPixel(1)
 , _fontAscender(0)
 , _rendererRecreatedListener(nullptr)
 , _antialiasEnabled(true)
 , _currLineHeight(0)
+, _dirtyMinX(CacheTextureWidth)
+, _dirtyMinY(CacheTextureHeight)
+, _dirtyMaxX(0)
+, _dirtyMaxY(0)
+, _diskCacheDirty(false)
+, _diskCachePageWritten(false)
+, _diskDirtyMinX(CacheTextureWidth)
+, _diskDirtyMinY(CacheTextureHeight)
+, _diskDirtyMaxX(0)
+, _diskDirtyMaxY(0)
 {
     _font->retain();
 
@@ -71,20 +102,24 @@ FontAtlas::FontAtlas(Font &theFont)
         {
             _letterPadding += 2 * FontFreeType::DistanceMapSpread;    
         }
-        _currentPageDataSize = CacheTextureWidth * CacheTextureHeight;
+        _bytesPerPixel = 1;
         auto outlineSize = _fontFreeType->getOutlineSize();
         if(outlineSize > 0)
         {
             _lineHeight += 2 * outlineSize;
-            _currentPageDataSize *= 2;
+            _bytesPerPixel = 2;
         }
+        else if (_fontFreeType->isMultiChannelDistanceField())
+        {
+            _bytesPerPixel = 4;
+        }
+        _currentPageDataSize = CacheTextureWidth * CacheTextureHeight * _bytesPerPixel;
 
         _currentPageData = new unsigned char[_currentPageDataSize];
         memset(_currentPageData, 0, _currentPageDataSize);
 
-        auto  pixelFormat = outlineSize > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8; 
         texture->initWithData(_currentPageData, _currentPageDataSize, 
-            pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth,CacheTextureHeight) );
+            getPagePixelFormat(_bytesPerPixel), CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth,CacheTextureHeight) );
 
         addTexture(texture,0);
         texture->release();
@@ -100,6 +135,9 @@ FontAtlas::FontAtlas(Font &theFont)
 
 FontAtlas::~FontAtlas()
 {
+    // pending glyph jobs retain the atlas, so none is left here
+    saveDiskCache();
+
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     if (_fontFreeType && _rendererRecreatedListener)
     {
@@ -300,117 +338,499 @@ bool FontAtlas::prepareLetterDefinitions(const std::u16string& utf16Text)
         return false;
     }
 
-    int adjustForDistanceMap = _letterPadding / 2;
-    int adjustForExtend = _letterEdgeExtend / 2;
-    long bitmapWidth;
-    long bitmapHeight;
-    Rect tempRect;
-    FontLetterDefinition tempDef;
+    GlyphBitmap glyph;
+    for (auto&& it : codeMapOfNewChar)
+    {
+        glyph.utf16Char = it.first;
+        glyph.charCode = it.second;
+        renderGlyph(glyph);
+        addGlyph(glyph);
+        delete [] glyph.bitmap;
+    }
+    updateTextureContent();
 
-    auto scaleFactor = CC_CONTENT_SCALE_FACTOR();
-    auto  pixelFormat = _fontFreeType->getOutlineSize() > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
+    return true;
+}
 
-    float startY = _currentPageOrigY;
+void FontAtlas::prepareLetterDefinitionsAsync(const std::u16string& utf16Text, const std::function<void(FontAtlas*)>& callback)
+{
+    std::unordered_map<unsigned short, unsigned short> codeMapOfNewChar;
+    if (_fontFreeType)
+    {
+        findNewCharacters(utf16Text, codeMapOfNewChar);
+    }
 
+    std::vector<GlyphBitmap> glyphs;
+    glyphs.reserve(codeMapOfNewChar.size());
     for (auto&& it : codeMapOfNewChar)
     {
-        auto bitmap = _fontFreeType->getGlyphBitmap(it.second, bitmapWidth, bitmapHeight, tempRect, tempDef.xAdvance);
-        if (bitmap && bitmapWidth > 0 && bitmapHeight > 0)
+        // the jobs complete in order, so a letter queued by an earlier job is added before this callback
+        if (_pendingLetters.insert(it.first).second)
         {
-            tempDef.validDefinition = true;
-            tempDef.width = tempRect.size.width + _letterPadding + _letterEdgeExtend;
-            tempDef.height = tempRect.size.height + _letterPadding + _letterEdgeExtend;
-            tempDef.offsetX = tempRect.origin.x + adjustForDistanceMap + adjustForExtend;
-            tempDef.offsetY = _fontAscender + tempRect.origin.y - adjustForDistanceMap - adjustForExtend;
+            GlyphBitmap glyph;
+            glyph.utf16Char = it.first;
+            glyph.charCode = it.second;
+            glyph.bitmap = nullptr;
+            glyphs.push_back(glyph);
+        }
+    }
+
+    if (glyphs.empty() && (!callback || _pendingLetters.empty()))
+    {
+        // nothing to wait for
+        if (callback)
+        {
+            callback(this);
+        }
+        return;
+    }
+
+    auto job = new (std::nothrow) GlyphJob;
+    job->glyphs.swap(glyphs);
+    job->callback = callback;
+    addGlyphJob(job);
+}
 
-            if (bitmapHeight > _currLineHeight)
+void FontAtlas::addGlyphJob(GlyphJob* job)
+{
+    // released when the glyphs are added on the cocos thread
+    retain();
+
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_OTHER, [this, job](void*) {
+        for (auto& glyph : job->glyphs)
+        {
+            _pendingLetters.erase(glyph.utf16Char);
+            // it may have been added by prepareLetterDefinitions meanwhile
+            if (_letterDefinitions.find(glyph.utf16Char) == _letterDefinitions.end())
             {
-                _currLineHeight = static_cast<int>(bitmapHeight) + _letterPadding + _letterEdgeExtend + 1;
+                addGlyph(glyph);
             }
-            if (_currentPageOrigX + tempDef.width > CacheTextureWidth)
+            delete [] glyph.bitmap;
+        }
+        if (!job->glyphs.empty())
+        {
+            updateTextureContent();
+            Director::getInstance()->getEventDispatcher()->dispatchCustomEvent(CMD_LETTERS_ADDED, this);
+        }
+
+        if (job->callback)
+        {
+            job->callback(this);
+        }
+        delete job;
+        release();
+    }, nullptr, [this, job]() {
+        for (auto& glyph : job->glyphs)
+        {
+            renderGlyph(glyph);
+        }
+    });
+}
+
+void FontAtlas::renderGlyph(GlyphBitmap& glyph)
+{
+    glyph.xAdvance = 0;
+    glyph.bitmap = _fontFreeType->renderGlyphBitmap(glyph.charCode, glyph.width, glyph.height, glyph.rect, glyph.xAdvance);
+}
+
+void FontAtlas::addGlyph(const GlyphBitmap& glyph)
+{
+    int adjustForDistanceMap = _letterPadding / 2;
+    int adjustForExtend = _letterEdgeExtend / 2;
+    auto scaleFactor = CC_CONTENT_SCALE_FACTOR();
+    int bytesPerPixel = _bytesPerPixel;
+
+    FontLetterDefinition tempDef;
+    tempDef.xAdvance = glyph.xAdvance;
+
+    if (glyph.bitmap)
+    {
+        const Rect& tempRect = glyph.rect;
+        tempDef.validDefinition = true;
+        tempDef.width = tempRect.size.width + _letterPadding + _letterEdgeExtend;
+        tempDef.height = tempRect.size.height + _letterPadding + _letterEdgeExtend;
+        tempDef.offsetX = tempRect.origin.x + adjustForDistanceMap + adjustForExtend;
+        tempDef.offsetY = _fontAscender + tempRect.origin.y - adjustForDistanceMap - adjustForExtend;
+
+        // the rendered bitmap already includes the distance map padding
+        if (glyph.height > _currLineHeight)
+        {
+            _currLineHeight = static_cast<int>(glyph.height) + _letterEdgeExtend + 1;
+        }
+        if (_currentPageOrigX + tempDef.width > CacheTextureWidth)
+        {
+            _currentPageOrigY += _currLineHeight;
+            _currLineHeight = 0;
+            _currentPageOrigX = 0;
+            if (_currentPageOrigY + _lineHeight >= CacheTextureHeight)
             {
-                _currentPageOrigY += _currLineHeight;
-                _currLineHeight = 0;
-                _currentPageOrigX = 0;
-                if (_currentPageOrigY + _lineHeight >= CacheTextureHeight)
-                {
-                    unsigned char *data = nullptr;
-                    if (pixelFormat == Texture2D::PixelFormat::AI88)
-                    {
-                        data = _currentPageData + CacheTextureWidth * (int)startY * 2;
-                    }
-                    else
-                    {
-                        data = _currentPageData + CacheTextureWidth * (int)startY;
-                    }
-                    _atlasTextures[_currentPage]->updateWithData(data, 0, startY,
-                        CacheTextureWidth, CacheTextureHeight - startY);
-
-                    startY = 0.0f;
-
-                    _currentPageOrigY = 0;
-                    memset(_currentPageData, 0, _currentPageDataSize);
-                    _currentPage++;
-                    auto tex = new (std::nothrow) Texture2D;
-                    if (_antialiasEnabled)
-                    {
-                        tex->setAntiAliasTexParameters();
-                    }
-                    else
-                    {
-                        tex->setAliasTexParameters();
-                    }
-                    tex->initWithData(_currentPageData, _currentPageDataSize,
-                        pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth, CacheTextureHeight));
-                    addTexture(tex, _currentPage);
-                    tex->release();
-                }
+                updateTextureContent();
+                // full pages don't change anymore, this is their last write
+                saveCurrentPageToDiskCache();
+                _diskCachePageWritten = false;
+
+                _currentPageOrigY = 0;
+                memset(_currentPageData, 0, _currentPageDataSize);
+                _currentPage++;
+                addPageTexture(_currentPageData, _currentPage);
             }
-            _fontFreeType->renderCharAt(_currentPageData, _currentPageOrigX + adjustForExtend, _currentPageOrigY + adjustForExtend, bitmap, bitmapWidth, bitmapHeight);
-
-            tempDef.U = _currentPageOrigX;
-            tempDef.V = _currentPageOrigY;
-            tempDef.textureID = _currentPage;
-            _currentPageOrigX += tempDef.width + 1;
-            // take from pixels to points
-            tempDef.width = tempDef.width / scaleFactor;
-            tempDef.height = tempDef.height / scaleFactor;
-            tempDef.U = tempDef.U / scaleFactor;
-            tempDef.V = tempDef.V / scaleFactor;
         }
-        else{
-            if (tempDef.xAdvance)
-                tempDef.validDefinition = true;
-            else
-                tempDef.validDefinition = false;
-
-            tempDef.width = 0;
-            tempDef.height = 0;
-            tempDef.U = 0;
-            tempDef.V = 0;
-            tempDef.offsetX = 0;
-            tempDef.offsetY = 0;
-            tempDef.textureID = 0;
-            _currentPageOrigX += 1;
+
+        int posX = (int)_currentPageOrigX + adjustForExtend;
+        int posY = (int)_currentPageOrigY + adjustForExtend;
+        long width = MIN(glyph.width, CacheTextureWidth - posX);
+        long height = MIN(glyph.height, CacheTextureHeight - posY);
+        for (long y = 0; y < height; ++y)
+        {
+            memcpy(_currentPageData + ((posY + y) * CacheTextureWidth + posX) * bytesPerPixel,
+                glyph.bitmap + y * glyph.width * bytesPerPixel, width * bytesPerPixel);
+        }
+
+        if (width > 0 && height > 0)
+        {
+            _dirtyMinX = MIN(_dirtyMinX, posX);
+            _dirtyMinY = MIN(_dirtyMinY, posY);
+            _dirtyMaxX = MAX(_dirtyMaxX, posX + (int)width);
+            _dirtyMaxY = MAX(_dirtyMaxY, posY + (int)height);
+            _diskDirtyMinX = MIN(_diskDirtyMinX, posX);
+            _diskDirtyMinY = MIN(_diskDirtyMinY, posY);
+            _diskDirtyMaxX = MAX(_diskDirtyMaxX, posX + (int)width);
+            _diskDirtyMaxY = MAX(_diskDirtyMaxY, posY + (int)height);
         }
 
-        _letterDefinitions[it.first] = tempDef;
+        tempDef.U = _currentPageOrigX;
+        tempDef.V = _currentPageOrigY;
+        tempDef.textureID = _currentPage;
+        _currentPageOrigX += tempDef.width + 1;
+        // take from pixels to points
+        tempDef.width = tempDef.width / scaleFactor;
+        tempDef.height = tempDef.height / scaleFactor;
+        tempDef.U = tempDef.U / scaleFactor;
+        tempDef.V = tempDef.V / scaleFactor;
+    }
+    else{
+        if (tempDef.xAdvance)
+            tempDef.validDefinition = true;
+        else
+            tempDef.validDefinition = false;
+
+        tempDef.width = 0;
+        tempDef.height = 0;
+        tempDef.U = 0;
+        tempDef.V = 0;
+        tempDef.offsetX = 0;
+        tempDef.offsetY = 0;
+        tempDef.textureID = 0;
+        _currentPageOrigX += 1;
     }
 
-    unsigned char *data = nullptr;
-    if (pixelFormat == Texture2D::PixelFormat::AI88)
+    _letterDefinitions[glyph.utf16Char] = tempDef;
+    _diskCacheDirty = true;
+}
+
+void FontAtlas::addPageTexture(const unsigned char* data, int slot)
+{
+    auto tex = new (std::nothrow) Texture2D;
+    if (_antialiasEnabled)
     {
-        data = _currentPageData + CacheTextureWidth * (int)startY * 2;
+        tex->setAntiAliasTexParameters();
     }
     else
     {
-        data = _currentPageData + CacheTextureWidth * (int)startY;
+        tex->setAliasTexParameters();
     }
-    _atlasTextures[_currentPage]->updateWithData(data, 0, startY, CacheTextureWidth, _currentPageOrigY - startY + _lineHeight);
+    tex->initWithData(data, _currentPageDataSize,
+        getPagePixelFormat(_bytesPerPixel), CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth, CacheTextureHeight));
+    addTexture(tex, slot);
+    tex->release();
+}
+
+namespace
+{
+    const char DISK_CACHE_MAGIC[4] = { 'C', 'C', 'F', 'A' };
+    const unsigned int DISK_CACHE_VERSION = 2;
 
+    // path.atlas holds the header and the letters, the pages are in their own files
+    struct DiskCacheHeader
+    {
+        char magic[4];
+        unsigned int version;
+        int pageWidth;
+        int pageHeight;
+        int pageDataSize;
+        int currentPage;
+        float currentPageOrigX;
+        float currentPageOrigY;
+        int currLineHeight;
+        float contentScaleFactor;
+        unsigned int letterCount;
+    };
+
+    struct DiskCacheLetter
+    {
+        unsigned int utf16Char;
+        float U;
+        float V;
+        float width;
+        float height;
+        float offsetX;
+        float offsetY;
+        int textureID;
+        int validDefinition;
+        int xAdvance;
+    };
+
+    std::string getDiskCachePagePath(const std::string& path, int page)
+    {
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), "_%d.page", page);
+        return path + suffix;
+    }
+
+    // overwrites a rect of a page file which already holds the whole page
+    bool writeDiskCachePageRect(const std::string& filename, const unsigned char* pageData, int bytesPerPixel,
+                                int minX, int minY, int maxX, int maxY)
+    {
+        FILE* fp = fopen(FileUtils::getInstance()->getSuitableFOpen(filename).c_str(), "r+b");
+        if (fp == nullptr)
+        {
+            return false;
+        }
+
+        bool ret = true;
+        size_t rowSize = static_cast<size_t>(maxX - minX) * bytesPerPixel;
+        for (int y = minY; y < maxY && ret; ++y)
+        {
+            long offset = (static_cast<long>(y) * FontAtlas::CacheTextureWidth + minX) * bytesPerPixel;
+            ret = fseek(fp, offset, SEEK_SET) == 0 && fwrite(pageData + offset, 1, rowSize, fp) == rowSize;
+        }
+        fclose(fp);
+        return ret;
+    }
+}
+
+bool FontAtlas::loadDiskCache(const std::string& path)
+{
+    if (_fontFreeType == nullptr)
+    {
+        return false;
+    }
+    _diskCachePath = path;
+
+    auto fileUtils = FileUtils::getInstance();
+    Data data = fileUtils->getDataFromFile(path + ".atlas");
+    if (data.getSize() < (ssize_t)sizeof(DiskCacheHeader))
+    {
+        return false;
+    }
+
+    DiskCacheHeader header;
+    memcpy(&header, data.getBytes(), sizeof(header));
+    // computed in size_t and checked against the bytes read, so a corrupted count can't overflow it
+    size_t lettersSize = static_cast<size_t>(data.getSize()) - sizeof(DiskCacheHeader);
+    size_t pageDataSize = static_cast<size_t>(CacheTextureWidth) * CacheTextureHeight * _bytesPerPixel;
+    if (memcmp(header.magic, DISK_CACHE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != DISK_CACHE_VERSION
+        || header.pageWidth != CacheTextureWidth
+        || header.pageHeight != CacheTextureHeight
+        || header.pageDataSize < 0
+        || static_cast<size_t>(header.pageDataSize) != pageDataSize
+        || header.contentScaleFactor != CC_CONTENT_SCALE_FACTOR()
+        || header.currentPage < 0
+        || header.letterCount > lettersSize / sizeof(DiskCacheLetter)
+        || lettersSize != header.letterCount * sizeof(DiskCacheLetter))
+    {
+        CCLOG("cocos2d: FontAtlas: ignoring invalid disk cache %s", path.c_str());
+        return false;
+    }
+
+    std::vector<Data> pages(header.currentPage + 1);
+    for (int page = 0; page <= header.currentPage; ++page)
+    {
+        pages[page] = fileUtils->getDataFromFile(getDiskCachePagePath(path, page));
+        if (static_cast<size_t>(pages[page].getSize()) != pageDataSize)
+        {
+            CCLOG("cocos2d: FontAtlas: disk cache page %d of %s is missing", page, path.c_str());
+            return false;
+        }
+    }
+
+    relaseTextures();
+    for (int page = 0; page < header.currentPage; ++page)
+    {
+        addPageTexture(pages[page].getBytes(), page);
+    }
+
+    auto letters = reinterpret_cast<const DiskCacheLetter*>(data.getBytes() + sizeof(DiskCacheHeader));
+    for (unsigned int i = 0; i < header.letterCount; ++i)
+    {
+        FontLetterDefinition& def = _letterDefinitions[static_cast<char16_t>(letters[i].utf16Char)];
+        def.U = letters[i].U;
+        def.V = letters[i].V;
+        def.width = letters[i].width;
+        def.height = letters[i].height;
+        def.offsetX = letters[i].offsetX;
+        def.offsetY = letters[i].offsetY;
+        def.textureID = letters[i].textureID;
+        def.validDefinition = letters[i].validDefinition != 0;
+        def.xAdvance = letters[i].xAdvance;
+    }
+
+    memcpy(_currentPageData, pages[header.currentPage].getBytes(), _currentPageDataSize);
+    _currentPage = header.currentPage;
+    _currentPageOrigX = header.currentPageOrigX;
+    _currentPageOrigY = header.currentPageOrigY;
+    _currLineHeight = header.currLineHeight;
+    addPageTexture(_currentPageData, _currentPage);
+
+    _diskCacheDirty = false;
+    _diskCachePageWritten = true;
+    _diskDirtyMinX = CacheTextureWidth;
+    _diskDirtyMinY = CacheTextureHeight;
+    _diskDirtyMaxX = 0;
+    _diskDirtyMaxY = 0;
+    return true;
+}
+
+bool FontAtlas::saveCurrentPageToDiskCache()
+{
+    if (_diskCachePath.empty())
+    {
+        return false;
+    }
+
+    bool ret = true;
+    std::string pagePath = getDiskCachePagePath(_diskCachePath, _currentPage);
+    if (_diskCachePageWritten)
+    {
+        // only the glyphs added since the last save are written
+        if (_diskDirtyMaxX > _diskDirtyMinX && _diskDirtyMaxY > _diskDirtyMinY)
+        {
+            ret = writeDiskCachePageRect(pagePath, _currentPageData, _bytesPerPixel,
+                                         _diskDirtyMinX, _diskDirtyMinY, _diskDirtyMaxX, _diskDirtyMaxY);
+        }
+    }
+    else
+    {
+        auto fileUtils = FileUtils::getInstance();
+        fileUtils->createDirectory(fileUtils->getWritablePath() + "fontcache/");
+
+        Data data;
+        data.copy(_currentPageData, _currentPageDataSize);
+        ret = fileUtils->writeDataToFile(data, pagePath);
+    }
+
+    if (ret)
+    {
+        _diskCachePageWritten = true;
+        _diskDirtyMinX = CacheTextureWidth;
+        _diskDirtyMinY = CacheTextureHeight;
+        _diskDirtyMaxX = 0;
+        _diskDirtyMaxY = 0;
+    }
+    return ret;
+}
+
+bool FontAtlas::saveDiskCache()
+{
+    if (_diskCachePath.empty() || !_diskCacheDirty || _fontFreeType == nullptr)
+    {
+        return false;
+    }
+
+    // the page is written first, so the index never refers to letters missing from it
+    if (!saveCurrentPageToDiskCache())
+    {
+        CCLOG("cocos2d: FontAtlas: failed to write disk cache page %s", _diskCachePath.c_str());
+        return false;
+    }
+
+    DiskCacheHeader header;
+    memcpy(header.magic, DISK_CACHE_MAGIC, sizeof(header.magic));
+    header.version = DISK_CACHE_VERSION;
+    header.pageWidth = CacheTextureWidth;
+    header.pageHeight = CacheTextureHeight;
+    header.pageDataSize = _currentPageDataSize;
+    header.currentPage = _currentPage;
+    header.currentPageOrigX = _currentPageOrigX;
+    header.currentPageOrigY = _currentPageOrigY;
+    header.currLineHeight = _currLineHeight;
+    header.contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+    header.letterCount = static_cast<unsigned int>(_letterDefinitions.size());
+
+    size_t size = sizeof(DiskCacheHeader) + _letterDefinitions.size() * sizeof(DiskCacheLetter);
+    auto bytes = static_cast<unsigned char*>(malloc(size));
+    memcpy(bytes, &header, sizeof(header));
+
+    auto letters = reinterpret_cast<DiskCacheLetter*>(bytes + sizeof(DiskCacheHeader));
+    for (auto&& item : _letterDefinitions)
+    {
+        const FontLetterDefinition& def = item.second;
+        letters->utf16Char = item.first;
+        letters->U = def.U;
+        letters->V = def.V;
+        letters->width = def.width;
+        letters->height = def.height;
+        letters->offsetX = def.offsetX;
+        letters->offsetY = def.offsetY;
+        letters->textureID = def.textureID;
+        letters->validDefinition = def.validDefinition ? 1 : 0;
+        letters->xAdvance = def.xAdvance;
+        ++letters;
+    }
+
+    Data data;
+    data.fastSet(bytes, static_cast<ssize_t>(size));
+
+    if (!FileUtils::getInstance()->writeDataToFile(data, _diskCachePath + ".atlas"))
+    {
+        CCLOG("cocos2d: FontAtlas: failed to write disk cache %s", _diskCachePath.c_str());
+        return false;
+    }
+
+    _diskCacheDirty = false;
     return true;
 }
 
+void FontAtlas::updateTextureContent()
+{
+    if (_dirtyMaxX <= _dirtyMinX || _dirtyMaxY <= _dirtyMinY)
+    {
+        return;
+    }
+
+    int bytesPerPixel = _bytesPerPixel;
+    int width = _dirtyMaxX - _dirtyMinX;
+    int height = _dirtyMaxY - _dirtyMinY;
+    unsigned char* data = nullptr;
+
+    if (width == CacheTextureWidth)
+    {
+        data = _currentPageData + _dirtyMinY * CacheTextureWidth * bytesPerPixel;
+    }
+    else
+    {
+        // GLES 2.0 has no GL_UNPACK_ROW_LENGTH, pack the rows of the dirty rect
+        int rowSize = width * bytesPerPixel;
+        _uploadBuffer.resize(rowSize * height);
+        for (int y = 0; y < height; ++y)
+        {
+            memcpy(&_uploadBuffer[y * rowSize],
+                _currentPageData + ((_dirtyMinY + y) * CacheTextureWidth + _dirtyMinX) * bytesPerPixel, rowSize);
+        }
+        data = _uploadBuffer.data();
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    _atlasTextures[_currentPage]->updateWithData(data, _dirtyMinX, _dirtyMinY, width, height);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    _dirtyMinX = CacheTextureWidth;
+    _dirtyMinY = CacheTextureHeight;
+    _dirtyMaxX = 0;
+    _dirtyMaxY = 0;
+}
+
 void FontAtlas::addTexture(Texture2D *texture, int slot)
 {
     texture->retain();
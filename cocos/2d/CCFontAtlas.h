@@ -30,9 +30,13 @@
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <functional>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/CCRef.h"
+#include "math/CCGeometry.h"
 #include "platform/CCStdC.h" // ssize_t on windows
 
 NS_CC_BEGIN
@@ -63,6 +67,8 @@ public:
     static const int CacheTextureHeight;
     static const char* CMD_PURGE_FONTATLAS;
     static const char* CMD_RESET_FONTATLAS;
+    /** Dispatched with the atlas as user data when letters rasterized in the background are added. */
+    static const char* CMD_LETTERS_ADDED;
     /**
      * @js ctor
      */
@@ -78,6 +84,28 @@ public:
     
     bool prepareLetterDefinitions(const std::u16string& utf16String);
 
+    /** Rasterizes the new characters of utf16String on the AsyncTaskPool TASK_OTHER thread, shared by all the atlases,
+     then adds them to the atlas on the cocos thread, dispatches CMD_LETTERS_ADDED and calls callback.
+     Characters already being rasterized in the background aren't requested again.
+     Characters requested by prepareLetterDefinitions in the meantime are rasterized synchronously as usual.
+     Labels with async glyph rendering enabled use it, it can also build atlases during loading screens.
+     */
+    void prepareLetterDefinitionsAsync(const std::u16string& utf16String, const std::function<void(FontAtlas*)>& callback);
+
+    /** Returns true if the character is being rasterized in the background and isn't in the atlas yet. */
+    bool isLetterPending(char16_t utf16Char) const { return _pendingLetters.find(utf16Char) != _pendingLetters.end(); }
+
+    /** Loads the glyphs saved at path by a previous launch, and saves the new ones there later.
+     path is a prefix, the atlas uses path.atlas for the letters and one path_N.page file per page.
+     Returns false if nothing valid was saved there yet.
+     */
+    bool loadDiskCache(const std::string& path);
+
+    /** Saves the glyphs added since the atlas was loaded or last saved.
+     Only the rect of the current page which changed since the last save is written.
+     */
+    bool saveDiskCache();
+
     inline const std::unordered_map<ssize_t, Texture2D*>& getTextures() const{ return _atlasTextures;}
     void  addTexture(Texture2D *texture, int slot);
     float getLineHeight() const { return _lineHeight; }
@@ -115,6 +143,32 @@ protected:
 
     void conversionU16TOGB2312(const std::u16string& u16Text, std::unordered_map<unsigned short, unsigned short>& charCodeMap);
 
+    struct GlyphBitmap
+    {
+        char16_t utf16Char;
+        unsigned short charCode;
+        unsigned char* bitmap;
+        long width;
+        long height;
+        Rect rect;
+        int xAdvance;
+    };
+
+    struct GlyphJob
+    {
+        std::vector<GlyphBitmap> glyphs;
+        std::function<void(FontAtlas*)> callback;
+    };
+
+    void renderGlyph(GlyphBitmap& glyph);
+    void addGlyph(const GlyphBitmap& glyph);
+    /** uploads the dirty rect of the current page */
+    void updateTextureContent();
+    void addGlyphJob(GlyphJob* job);
+
+    void addPageTexture(const unsigned char* data, int slot);
+    bool saveCurrentPageToDiskCache();
+
     std::unordered_map<ssize_t, Texture2D*> _atlasTextures;
     std::unordered_map<char16_t, FontLetterDefinition> _letterDefinitions;
     float _lineHeight;
@@ -126,6 +180,7 @@ protected:
     int _currentPage;
     unsigned char *_currentPageData;
     int _currentPageDataSize;
+    int _bytesPerPixel;
     float _currentPageOrigX;
     float _currentPageOrigY;
     int _letterPadding;
@@ -136,6 +191,26 @@ protected:
     bool _antialiasEnabled;
     int _currLineHeight;
 
+    // rect of the current page modified since the last upload, in pixels
+    int _dirtyMinX;
+    int _dirtyMinY;
+    int _dirtyMaxX;
+    int _dirtyMaxY;
+    std::vector<unsigned char> _uploadBuffer;
+
+    // letters queued by prepareLetterDefinitionsAsync, only used on the cocos thread
+    std::unordered_set<char16_t> _pendingLetters;
+
+    std::string _diskCachePath;
+    bool _diskCacheDirty;
+    // false until the current page file holds the whole page
+    bool _diskCachePageWritten;
+    // rect of the current page modified since the last disk cache save, in pixels
+    int _diskDirtyMinX;
+    int _diskDirtyMinY;
+    int _diskDirtyMaxX;
+    int _diskDirtyMaxY;
+
     friend class Label;
 };
 
@@ -26,16 +26,20 @@
 
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 #include "base/CCDirector.h"
 #include "2d/CCFontFNT.h"
 #include "2d/CCFontFreeType.h"
 #include "2d/CCFontAtlas.h"
 #include "2d/CCFontCharMap.h"
 #include "2d/CCLabel.h"
+#include "base/ccUTF8.h"
+#include "platform/CCFileUtils.h"
 
 NS_CC_BEGIN
 
 std::unordered_map<std::string, FontAtlas *> FontAtlasCache::_atlasMap;
+bool FontAtlasCache::_diskCacheEnabled = false;
 
 void FontAtlasCache::purgeCachedData()
 {
@@ -46,6 +50,14 @@ void FontAtlasCache::purgeCachedData()
     }
 }
 
+void FontAtlasCache::saveDiskCache()
+{
+    for (auto&& atlas : _atlasMap)
+    {
+        atlas.second->saveDiskCache();
+    }
+}
+
 FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
 {  
     bool useDistanceField = config->distanceFieldEnabled;
@@ -55,6 +67,10 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
     }
 
     auto atlasName = generateFontName(config->fontFilePath, config->fontSize, useDistanceField);
+    if (useDistanceField && FontFreeType::isMultiChannelDistanceFieldEnabled())
+    {
+        atlasName.append("_msdf");
+    }
     atlasName.append("_outline_");
     std::stringstream ss;
     ss << config->outlineSize;
@@ -85,6 +101,27 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
     return nullptr;
 }
 
+FontAtlas* FontAtlasCache::prewarmFontAtlasTTF(const _ttfConfig* config, const std::string& charsetFile, const std::function<void(FontAtlas*)>& callback /* = nullptr */)
+{
+    auto atlas = getFontAtlasTTF(config);
+    if (atlas == nullptr)
+    {
+        return nullptr;
+    }
+
+    std::u16string utf16;
+    std::string charset = FileUtils::getInstance()->getStringFromFile(charsetFile);
+    if (charset.empty() || !StringUtils::UTF8ToUTF16(charset, utf16))
+    {
+        CCLOG("cocos2d: FontAtlasCache: can't load charset %s", charsetFile.c_str());
+    }
+    // line breaks of the charset file
+    utf16.erase(std::remove_if(utf16.begin(), utf16.end(), [](char16_t ch){ return ch < u' '; }), utf16.end());
+
+    atlas->prepareLetterDefinitionsAsync(utf16, callback);
+    return atlas;
+}
+
 FontAtlas* FontAtlasCache::getFontAtlasFNT(const std::string& fontFileName, const Vec2& imageOffset /* = Vec2::ZERO */)
 {
     std::string atlasName = generateFontName(fontFileName, 0,false);
@@ -29,6 +29,7 @@
 /// @cond DO_NOT_SHOW
 
 #include <unordered_map>
+#include <functional>
 #include "base/ccTypes.h"
 
 NS_CC_BEGIN
@@ -49,14 +50,33 @@ public:
     
     static bool releaseFontAtlas(FontAtlas *atlas);
 
+    /** Builds the atlas of a TTF font with the characters of a UTF-8 charset file, rasterizing them
+     on a background thread, e.g. during a loading screen. callback is called on the cocos thread when it's done.
+     The atlas is returned retained like getFontAtlasTTF(), release it with releaseFontAtlas() when the font isn't needed anymore.
+     */
+    static FontAtlas* prewarmFontAtlasTTF(const _ttfConfig* config, const std::string& charsetFile, const std::function<void(FontAtlas*)>& callback = nullptr);
+
     /** Removes cached data.
      It will purge the textures atlas and if multiple texture exist in one FontAtlas.
      */
     static void purgeCachedData();
+
+    /** Enables saving the glyphs of TTF atlases to the writable path, and loading them back
+     instead of rendering them again with FreeType on the next launch. Disabled by default.
+     Set it before creating labels.
+     */
+    static void setDiskCacheEnabled(bool enabled) { _diskCacheEnabled = enabled; }
+    static bool isDiskCacheEnabled() { return _diskCacheEnabled; }
+
+    /** Saves the glyphs added to the TTF atlases since they were loaded or last saved.
+     Atlases are also saved when they are released, call it e.g. when the application enters the background.
+     */
+    static void saveDiskCache();
     
 private:
     static std::string generateFontName(const std::string& fontFileName, int size, bool useDistanceField);
     static std::unordered_map<std::string, FontAtlas *> _atlasMap;
+    static bool _diskCacheEnabled;
 };
 
 NS_CC_END
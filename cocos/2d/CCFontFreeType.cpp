@@ -25,17 +25,29 @@ THE SOFTWARE.
 
 #include "2d/CCFontFreeType.h"
 #include FT_BBOX_H
-#include "edtaa3func.h"
+#include FT_OUTLINE_H
+#include <algorithm>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include "CCFontAtlas.h"
 #include "base/CCDirector.h"
 #include "base/ccUTF8.h"
 #include "platform/CCFileUtils.h"
+#include "2d/CCFontAtlasCache.h"
+#include "xxhash.h"
 
 NS_CC_BEGIN
 
 
 FT_Library FontFreeType::_FTlibrary;
 bool       FontFreeType::_FTInitialized = false;
+std::recursive_mutex FontFreeType::_FTMutex;
+bool       FontFreeType::_multiChannelDistanceFieldEnabled = false;
 const int  FontFreeType::DistanceMapSpread = 3;
 
 const char* FontFreeType::_glyphASCII = "\"!#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~¡¢£¤¥¦§¨©ª«¬­®¯°±²³´µ¶·¸¹º»¼½¾¿ÀÁÂÃÄÅÆÇÈÉÊËÌÍÎÏÐÑÒÓÔÕÖ×ØÙÚÛÜÝÞßàáâãäåæçèéêëìíîïðñòóôõö÷øùúûüýþ ";
@@ -45,6 +57,7 @@ typedef struct _DataRef
 {
     Data data;
     unsigned int referenceCount;
+    unsigned int hash;
 }DataRef;
 
 static std::unordered_map<std::string, DataRef> s_cacheFontData;
@@ -68,6 +81,7 @@ FontFreeType * FontFreeType::create(const std::string &fontName, int fontSize, G
 
 bool FontFreeType::initFreeType()
 {
+    std::lock_guard<std::recursive_mutex> lock(_FTMutex);
     if (_FTInitialized == false)
     {
         // begin freetype
@@ -82,6 +96,7 @@ bool FontFreeType::initFreeType()
 
 void FontFreeType::shutdownFreeType()
 {
+    std::lock_guard<std::recursive_mutex> lock(_FTMutex);
     if (_FTInitialized == true)
     {
         FT_Done_FreeType(_FTlibrary);
@@ -99,6 +114,7 @@ FontFreeType::FontFreeType(bool distanceFieldEnabled /* = false */,int outline /
 : _fontRef(nullptr)
 , _stroker(nullptr)
 , _distanceFieldEnabled(distanceFieldEnabled)
+, _multiChannelDistanceField(distanceFieldEnabled && _multiChannelDistanceFieldEnabled)
 , _outlineSize(0.0f)
 , _lineHeight(0)
 , _fontAtlas(nullptr)
@@ -108,6 +124,7 @@ FontFreeType::FontFreeType(bool distanceFieldEnabled /* = false */,int outline /
     if (outline > 0)
     {
         _outlineSize = outline * CC_CONTENT_SCALE_FACTOR();
+        std::lock_guard<std::recursive_mutex> lock(_FTMutex);
         FT_Stroker_New(FontFreeType::getFTLibrary(), &_stroker);
         FT_Stroker_Set(_stroker,
             (int)(_outlineSize * 64),
@@ -137,8 +154,10 @@ bool FontFreeType::createFontObject(const std::string &fontName, int fontSize)
         {
             return false;
         }
+        s_cacheFontData[fontName].hash = 0;
     }
 
+    std::lock_guard<std::recursive_mutex> lock(_FTMutex);
     if (FT_New_Memory_Face(getFTLibrary(), s_cacheFontData[fontName].data.getBytes(), s_cacheFontData[fontName].data.getSize(), 0, &face ))
         return false;
     
@@ -180,15 +199,34 @@ bool FontFreeType::createFontObject(const std::string &fontName, int fontSize)
     return true;
 }
 
-FontFreeType::~FontFreeType()
+std::string FontFreeType::getDiskCachePath() const
 {
-    if (_stroker)
+    // hashed lazily, only fonts using the disk cache pay for it
+    auto& fontData = s_cacheFontData[_fontName];
+    if (fontData.hash == 0)
     {
-        FT_Stroker_Done(_stroker);
+        fontData.hash = XXH32(fontData.data.getBytes(), (int)fontData.data.getSize(), 0);
     }
-    if (_fontRef)
+    unsigned int hash = fontData.hash;
+
+    char name[64];
+    snprintf(name, sizeof(name), "%08x_%d_%d_%d", hash, (int)_fontRef->size->metrics.y_ppem,
+        _multiChannelDistanceField ? 2 : (_distanceFieldEnabled ? 1 : 0), (int)_outlineSize);
+    return FileUtils::getInstance()->getWritablePath() + "fontcache/" + name;
+}
+
+FontFreeType::~FontFreeType()
+{
     {
-        FT_Done_Face(_fontRef);
+        std::lock_guard<std::recursive_mutex> lock(_FTMutex);
+        if (_stroker)
+        {
+            FT_Stroker_Done(_stroker);
+        }
+        if (_fontRef)
+        {
+            FT_Done_Face(_fontRef);
+        }
     }
 
     s_cacheFontData[_fontName].referenceCount -= 1;
@@ -203,6 +241,10 @@ FontAtlas * FontFreeType::createFontAtlas()
     if (_fontAtlas == nullptr)
     {
         _fontAtlas = new (std::nothrow) FontAtlas(*this);
+        if (_fontAtlas && FontAtlasCache::isDiskCacheEnabled())
+        {
+            _fontAtlas->loadDiskCache(getDiskCachePath());
+        }
         if (_fontAtlas && _usedGlyphs != GlyphCollection::DYNAMIC)
         {
             std::u16string utf16;
@@ -232,6 +274,7 @@ int * FontFreeType::getHorizontalKerningForTextUTF16(const std::u16string& text,
         return nullptr;
     memset(sizes,0,outNumLetters * sizeof(int));
 
+    std::lock_guard<std::recursive_mutex> lock(_FTMutex);
     bool hasKerning = FT_HAS_KERNING( _fontRef ) != 0;
     if (hasKerning)
     {
@@ -275,6 +318,7 @@ unsigned char* FontFreeType::getGlyphBitmap(unsigned short theChar, long &outWid
 {
     bool invalidChar = true;
     unsigned char* ret = nullptr;
+    std::lock_guard<std::recursive_mutex> lock(_FTMutex);
 
     do
     {
@@ -438,87 +482,498 @@ unsigned char * FontFreeType::getGlyphBitmapWithOutline(unsigned short theChar,
     return ret;
 }
 
-unsigned char * makeDistanceMap( unsigned char *img, long width, long height)
+namespace
+{
+    const float DISTANCE_FIELD_INF = 1e20f;
+    // distance field values per pixel of distance, 0.5 is the edge
+    const float DISTANCE_FIELD_SCALE = 16.0f;
+
+    // distances farther than this saturate distanceToByte, 128 / DISTANCE_FIELD_SCALE
+    const int DISTANCE_FIELD_RADIUS = 8;
+
+    // dst[i] = MIN(dst[i], src[i] + offset)
+    void minWithOffset(float* dst, const float* src, float offset, int count)
+    {
+        int i = 0;
+#if defined(__SSE__)
+        __m128 offset4 = _mm_set1_ps(offset);
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm_storeu_ps(dst + i, _mm_min_ps(_mm_loadu_ps(dst + i), _mm_add_ps(_mm_loadu_ps(src + i), offset4)));
+        }
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+        float32x4_t offset4 = vdupq_n_f32(offset);
+        for (; i + 4 <= count; i += 4)
+        {
+            vst1q_f32(dst + i, vminq_f32(vld1q_f32(dst + i), vaddq_f32(vld1q_f32(src + i), offset4)));
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            dst[i] = MIN(dst[i], src[i] + offset);
+        }
+    }
+
+    // Squared Euclidean distance transform of grid, searching DISTANCE_FIELD_RADIUS pixels around each pixel.
+    // Distances up to the radius are exact, farther ones are at least the radius, which is all distanceToByte
+    // can tell apart. Both separable passes combine whole rows, so they run 4 pixels at a time.
+    void distanceTransform2D(float* grid, int width, int height)
+    {
+        const int radius = DISTANCE_FIELD_RADIUS;
+        std::vector<float> columns(width * height);
+        // a row with radius pixels of padding on both sides, so the row pass needs no bounds checks
+        std::vector<float> line(width + 2 * radius, DISTANCE_FIELD_INF);
+
+        for (int y = 0; y < height; ++y)
+        {
+            float* dst = columns.data() + y * width;
+            memcpy(dst, grid + y * width, width * sizeof(float));
+            for (int dy = 1; dy <= radius; ++dy)
+            {
+                if (y - dy >= 0)
+                {
+                    minWithOffset(dst, grid + (y - dy) * width, (float)(dy * dy), width);
+                }
+                if (y + dy < height)
+                {
+                    minWithOffset(dst, grid + (y + dy) * width, (float)(dy * dy), width);
+                }
+            }
+        }
+
+        for (int y = 0; y < height; ++y)
+        {
+            float* dst = grid + y * width;
+            memcpy(line.data() + radius, columns.data() + y * width, width * sizeof(float));
+            memcpy(dst, line.data() + radius, width * sizeof(float));
+            for (int dx = 1; dx <= radius; ++dx)
+            {
+                minWithOffset(dst, line.data() + radius - dx, (float)(dx * dx), width);
+                minWithOffset(dst, line.data() + radius + dx, (float)(dx * dx), width);
+            }
+        }
+    }
+
+    unsigned char distanceToByte(float insideDistance)
+    {
+        float value = 128.0f + insideDistance * DISTANCE_FIELD_SCALE;
+        return (unsigned char)(value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value));
+    }
+}
+
+// Partially covered pixels seed the transforms with their subpixel distance to the edge.
+unsigned char* FontFreeType::makeDistanceMap(const unsigned char* img, long width, long height)
 {
-    long pixelAmount = (width + 2 * FontFreeType::DistanceMapSpread) * (height + 2 * FontFreeType::DistanceMapSpread);
-
-    short * xdist = (short *)  malloc( pixelAmount * sizeof(short) );
-    short * ydist = (short *)  malloc( pixelAmount * sizeof(short) );
-    double * gx   = (double *) calloc( pixelAmount, sizeof(double) );
-    double * gy      = (double *) calloc( pixelAmount, sizeof(double) );
-    double * data    = (double *) calloc( pixelAmount, sizeof(double) );
-    double * outside = (double *) calloc( pixelAmount, sizeof(double) );
-    double * inside  = (double *) calloc( pixelAmount, sizeof(double) );
-    long i,j;
-
-    // Convert img into double (data) rescale image levels between 0 and 1
     long outWidth = width + 2 * FontFreeType::DistanceMapSpread;
-    for (i = 0; i < width; ++i)
-    {
-        for (j = 0; j < height; ++j)
-        {
-            data[j * outWidth + FontFreeType::DistanceMapSpread + i] = img[j * width + i] / 255.0;
-        }
-    }
-
-    width += 2 * FontFreeType::DistanceMapSpread;
-    height += 2 * FontFreeType::DistanceMapSpread;
-
-    // Transform background (outside contour, in areas of 0's)   
-    computegradient( data, (int)width, (int)height, gx, gy);
-    edtaa3(data, gx, gy, (int)width, (int)height, xdist, ydist, outside);
-    for( i=0; i< pixelAmount; i++)
-        if( outside[i] < 0.0 )
-            outside[i] = 0.0;
-
-    // Transform foreground (inside contour, in areas of 1's)   
-    for( i=0; i< pixelAmount; i++)
-        data[i] = 1 - data[i];
-    computegradient( data, (int)width, (int)height, gx, gy);
-    edtaa3(data, gx, gy, (int)width, (int)height, xdist, ydist, inside);
-    for( i=0; i< pixelAmount; i++)
-        if( inside[i] < 0.0 )
-            inside[i] = 0.0;
-
-    // The bipolar distance field is now outside-inside
-    double dist;
-    /* Single channel 8-bit output (bad precision and range, but simple) */    
-    unsigned char *out = (unsigned char *) malloc( pixelAmount * sizeof(unsigned char) );
-    for( i=0; i < pixelAmount; i++)
-    {
-        dist = outside[i] - inside[i];
-        dist = 128.0 - dist*16;
-        if( dist < 0 ) dist = 0;
-        if( dist > 255 ) dist = 255;
-        out[i] = (unsigned char) dist;
-    }
-    /* Dual channel 16-bit output (more complicated, but good precision and range) */
-    /*unsigned char *out = (unsigned char *) malloc( pixelAmount * 3 * sizeof(unsigned char) ); 
-    for( i=0; i< pixelAmount; i++)
-    {
-        dist = outside[i] - inside[i];
-        dist = 128.0 - dist*16;
-        if( dist < 0.0 ) dist = 0.0;
-        if( dist >= 256.0 ) dist = 255.999;
-        // R channel is a copy of the original grayscale image
-        out[3*i] = img[i];
-        // G channel is fraction
-        out[3*i + 1] = (unsigned char) ( 256 - (dist - floor(dist)* 256.0 ));
-        // B channel is truncated integer part
-        out[3*i + 2] = (unsigned char)dist; 
-    }*/
-    
-    free( xdist );
-    free( ydist );
-    free( gx );
-    free( gy );
-    free( data );
-    free( outside );
-    free( inside );
+    long outHeight = height + 2 * FontFreeType::DistanceMapSpread;
+    long pixelAmount = outWidth * outHeight;
+
+    std::vector<float> outside(pixelAmount, DISTANCE_FIELD_INF);
+    std::vector<float> inside(pixelAmount, 0.0f);
+
+    for (long y = 0; y < height; ++y)
+    {
+        const unsigned char* row = img + y * width;
+        long index = (y + FontFreeType::DistanceMapSpread) * outWidth + FontFreeType::DistanceMapSpread;
+        for (long x = 0; x < width; ++x, ++index)
+        {
+            float coverage = row[x] / 255.0f;
+            if (coverage >= 1.0f)
+            {
+                outside[index] = 0.0f;
+                inside[index] = DISTANCE_FIELD_INF;
+            }
+            else if (coverage > 0.0f)
+            {
+                float out = MAX(0.0f, 0.5f - coverage);
+                float in = MAX(0.0f, coverage - 0.5f);
+                outside[index] = out * out;
+                inside[index] = in * in;
+            }
+        }
+    }
+
+    distanceTransform2D(outside.data(), (int)outWidth, (int)outHeight);
+    distanceTransform2D(inside.data(), (int)outWidth, (int)outHeight);
+
+    unsigned char *out = new unsigned char[pixelAmount];
+    long i = 0;
+#if defined(__SSE__)
+    __m128 bias = _mm_set1_ps(128.0f);
+    __m128 scale = _mm_set1_ps(DISTANCE_FIELD_SCALE);
+    __m128 zero = _mm_setzero_ps();
+    __m128 maxValue = _mm_set1_ps(255.0f);
+    float values[4];
+    for (; i + 4 <= pixelAmount; i += 4)
+    {
+        __m128 distance = _mm_sub_ps(_mm_sqrt_ps(_mm_loadu_ps(&inside[i])), _mm_sqrt_ps(_mm_loadu_ps(&outside[i])));
+        __m128 value = _mm_add_ps(bias, _mm_mul_ps(distance, scale));
+        _mm_storeu_ps(values, _mm_min_ps(_mm_max_ps(value, zero), maxValue));
+        out[i] = (unsigned char)values[0];
+        out[i + 1] = (unsigned char)values[1];
+        out[i + 2] = (unsigned char)values[2];
+        out[i + 3] = (unsigned char)values[3];
+    }
+#endif
+    for (; i < pixelAmount; ++i)
+    {
+        out[i] = distanceToByte(sqrtf(inside[i]) - sqrtf(outside[i]));
+    }
 
     return out;
 }
 
+namespace
+{
+    enum EdgeColor
+    {
+        EDGE_RED = 1,
+        EDGE_GREEN = 2,
+        EDGE_BLUE = 4,
+        EDGE_YELLOW = EDGE_RED | EDGE_GREEN,
+        EDGE_MAGENTA = EDGE_RED | EDGE_BLUE,
+        EDGE_CYAN = EDGE_GREEN | EDGE_BLUE,
+        EDGE_WHITE = EDGE_RED | EDGE_GREEN | EDGE_BLUE
+    };
+
+    // an outline segment, curves are flattened into a polyline
+    struct OutlineEdge
+    {
+        std::vector<Vec2> points;
+        int color;
+    };
+
+    struct OutlineContours
+    {
+        std::vector<std::vector<OutlineEdge>> contours;
+        Vec2 current;
+    };
+
+    const int CURVE_STEPS = 8;
+
+    Vec2 toVec2(const FT_Vector* v)
+    {
+        return Vec2(v->x / 64.0f, v->y / 64.0f);
+    }
+
+    int outlineMoveTo(const FT_Vector* to, void* user)
+    {
+        auto outline = static_cast<OutlineContours*>(user);
+        outline->contours.push_back(std::vector<OutlineEdge>());
+        outline->current = toVec2(to);
+        return 0;
+    }
+
+    int outlineLineTo(const FT_Vector* to, void* user)
+    {
+        auto outline = static_cast<OutlineContours*>(user);
+        Vec2 p = toVec2(to);
+        if (!outline->contours.empty() && !p.equals(outline->current))
+        {
+            OutlineEdge edge;
+            edge.points.push_back(outline->current);
+            edge.points.push_back(p);
+            edge.color = EDGE_WHITE;
+            outline->contours.back().push_back(edge);
+        }
+        outline->current = p;
+        return 0;
+    }
+
+    int outlineConicTo(const FT_Vector* control, const FT_Vector* to, void* user)
+    {
+        auto outline = static_cast<OutlineContours*>(user);
+        Vec2 p0 = outline->current;
+        Vec2 p1 = toVec2(control);
+        Vec2 p2 = toVec2(to);
+        if (!outline->contours.empty())
+        {
+            OutlineEdge edge;
+            edge.points.push_back(p0);
+            for (int i = 1; i <= CURVE_STEPS; ++i)
+            {
+                float t = (float)i / CURVE_STEPS;
+                float mt = 1.0f - t;
+                edge.points.push_back(p0 * (mt * mt) + p1 * (2 * mt * t) + p2 * (t * t));
+            }
+            edge.color = EDGE_WHITE;
+            outline->contours.back().push_back(edge);
+        }
+        outline->current = p2;
+        return 0;
+    }
+
+    int outlineCubicTo(const FT_Vector* control1, const FT_Vector* control2, const FT_Vector* to, void* user)
+    {
+        auto outline = static_cast<OutlineContours*>(user);
+        Vec2 p0 = outline->current;
+        Vec2 p1 = toVec2(control1);
+        Vec2 p2 = toVec2(control2);
+        Vec2 p3 = toVec2(to);
+        if (!outline->contours.empty())
+        {
+            OutlineEdge edge;
+            edge.points.push_back(p0);
+            for (int i = 1; i <= CURVE_STEPS; ++i)
+            {
+                float t = (float)i / CURVE_STEPS;
+                float mt = 1.0f - t;
+                edge.points.push_back(p0 * (mt * mt * mt) + p1 * (3 * mt * mt * t) + p2 * (3 * mt * t * t) + p3 * (t * t * t));
+            }
+            edge.color = EDGE_WHITE;
+            outline->contours.back().push_back(edge);
+        }
+        outline->current = p3;
+        return 0;
+    }
+
+    Vec2 edgeStartDirection(const OutlineEdge& edge)
+    {
+        Vec2 dir = edge.points[1] - edge.points[0];
+        dir.normalize();
+        return dir;
+    }
+
+    Vec2 edgeEndDirection(const OutlineEdge& edge)
+    {
+        size_t n = edge.points.size();
+        Vec2 dir = edge.points[n - 1] - edge.points[n - 2];
+        dir.normalize();
+        return dir;
+    }
+
+    // assigns two channels to each edge, switching colors at corners so that
+    // the edges meeting at a corner never share both channels
+    void colorEdges(OutlineContours& outline)
+    {
+        const float cornerThreshold = sinf(3.0f);
+        for (auto& contour : outline.contours)
+        {
+            size_t count = contour.size();
+            std::vector<size_t> corners;
+            for (size_t i = 0; i < count; ++i)
+            {
+                Vec2 prev = edgeEndDirection(contour[(i + count - 1) % count]);
+                Vec2 next = edgeStartDirection(contour[i]);
+                if (prev.dot(next) <= 0 || fabsf(prev.cross(next)) > cornerThreshold)
+                {
+                    corners.push_back(i);
+                }
+            }
+
+            if (corners.size() < 2)
+            {
+                continue;
+            }
+
+            const int colors[3] = { EDGE_CYAN, EDGE_MAGENTA, EDGE_YELLOW };
+            size_t spans = corners.size();
+            for (size_t span = 0; span < spans; ++span)
+            {
+                int color = colors[span % 3];
+                // the last span also touches the first one
+                if (span == spans - 1 && span % 3 == 0)
+                {
+                    color = colors[1];
+                }
+                size_t begin = corners[span];
+                size_t end = corners[(span + 1) % spans];
+                for (size_t i = begin; i != end; i = (i + 1) % count)
+                {
+                    contour[i].color = color;
+                }
+            }
+        }
+    }
+
+    struct EdgeDistance
+    {
+        float distance;
+        float orthogonality;
+        float pseudoDistance;
+    };
+
+    // distance from p to an edge, signed positive on the left of its direction;
+    // past the ends of the edge the distance to the extended line is used as pseudo distance
+    void measureEdge(const OutlineEdge& edge, const Vec2& p, EdgeDistance& result)
+    {
+        size_t last = edge.points.size() - 1;
+        for (size_t i = 0; i < last; ++i)
+        {
+            const Vec2& a = edge.points[i];
+            Vec2 ab = edge.points[i + 1] - a;
+            float lengthSq = ab.lengthSquared();
+            if (lengthSq <= 0)
+            {
+                continue;
+            }
+            Vec2 ap = p - a;
+            float t = ap.dot(ab) / lengthSq;
+            float clamped = t < 0 ? 0 : (t > 1 ? 1 : t);
+            Vec2 closest = a + ab * clamped;
+            Vec2 offset = p - closest;
+            float distance = offset.length();
+            float orthogonality = 1.0f;
+            if (distance > 0)
+            {
+                orthogonality = fabsf(ab.cross(offset)) / (sqrtf(lengthSq) * distance);
+            }
+
+            if (distance < result.distance - 1e-5f
+                || (distance < result.distance + 1e-5f && orthogonality > result.orthogonality))
+            {
+                float sign = ab.cross(ap) >= 0 ? 1.0f : -1.0f;
+                result.distance = distance;
+                result.orthogonality = orthogonality;
+                result.pseudoDistance = sign * distance;
+                if ((i == 0 && t < 0) || (i == last - 1 && t > 1))
+                {
+                    result.pseudoDistance = ab.cross(ap) / sqrtf(lengthSq);
+                }
+            }
+        }
+    }
+
+    // x of the outline crossings of the horizontal line at y, with their winding direction
+    void findCrossings(const OutlineContours& outline, float y, std::vector<std::pair<float, int>>& crossings)
+    {
+        crossings.clear();
+        for (const auto& contour : outline.contours)
+        {
+            for (const auto& edge : contour)
+            {
+                for (size_t i = 0; i + 1 < edge.points.size(); ++i)
+                {
+                    const Vec2& a = edge.points[i];
+                    const Vec2& b = edge.points[i + 1];
+                    if ((a.y <= y) != (b.y <= y))
+                    {
+                        float x = a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y);
+                        crossings.push_back(std::make_pair(x, b.y > a.y ? 1 : -1));
+                    }
+                }
+            }
+        }
+        std::sort(crossings.begin(), crossings.end());
+    }
+
+    float median(float a, float b, float c)
+    {
+        return MAX(MIN(a, b), MIN(MAX(a, b), c));
+    }
+
+    // RGBA8888 multi-channel distance field, with the true distance in alpha
+    unsigned char* makeMultiChannelDistanceMap(const OutlineContours& outline, bool insideOnLeft,
+        float left, float top, long width, long height)
+    {
+        unsigned char* out = new unsigned char[width * height * 4];
+        float orientation = insideOnLeft ? 1.0f : -1.0f;
+
+        std::vector<Rect> bounds;
+        for (const auto& contour : outline.contours)
+        {
+            for (const auto& edge : contour)
+            {
+                Vec2 minPoint = edge.points[0];
+                Vec2 maxPoint = edge.points[0];
+                for (const auto& point : edge.points)
+                {
+                    minPoint.x = MIN(minPoint.x, point.x);
+                    minPoint.y = MIN(minPoint.y, point.y);
+                    maxPoint.x = MAX(maxPoint.x, point.x);
+                    maxPoint.y = MAX(maxPoint.y, point.y);
+                }
+                bounds.push_back(Rect(minPoint.x, minPoint.y, maxPoint.x - minPoint.x, maxPoint.y - minPoint.y));
+            }
+        }
+
+        EdgeDistance farthest;
+        farthest.distance = DISTANCE_FIELD_INF;
+        farthest.orthogonality = 0;
+        farthest.pseudoDistance = -DISTANCE_FIELD_INF;
+
+        std::vector<std::pair<float, int>> crossings;
+        for (long y = 0; y < height; ++y)
+        {
+            float rowY = top - y - 0.5f;
+            findCrossings(outline, rowY, crossings);
+            size_t crossing = 0;
+            int winding = 0;
+
+            for (long x = 0; x < width; ++x)
+            {
+                Vec2 p(left + x + 0.5f, rowY);
+                while (crossing < crossings.size() && crossings[crossing].first < p.x)
+                {
+                    winding += crossings[crossing].second;
+                    ++crossing;
+                }
+                bool inside = winding != 0;
+
+                EdgeDistance nearest = farthest;
+                EdgeDistance channels[3] = { farthest, farthest, farthest };
+
+                size_t edgeIndex = 0;
+                for (const auto& contour : outline.contours)
+                {
+                    for (const auto& edge : contour)
+                    {
+                        // skip the edges whose bounds are farther than what their channels already have
+                        const Rect& rect = bounds[edgeIndex++];
+                        float dx = MAX(MAX(rect.origin.x - p.x, p.x - rect.getMaxX()), 0.0f);
+                        float dy = MAX(MAX(rect.origin.y - p.y, p.y - rect.getMaxY()), 0.0f);
+                        float boundsDistance = sqrtf(dx * dx + dy * dy) - 1e-4f;
+                        bool closer = boundsDistance < nearest.distance;
+                        for (int c = 0; c < 3 && !closer; ++c)
+                        {
+                            closer = (edge.color & (1 << c)) && boundsDistance < channels[c].distance;
+                        }
+                        if (!closer)
+                        {
+                            continue;
+                        }
+
+                        EdgeDistance distance = farthest;
+                        measureEdge(edge, p, distance);
+                        if (distance.distance < nearest.distance)
+                        {
+                            nearest.distance = distance.distance;
+                        }
+                        for (int c = 0; c < 3; ++c)
+                        {
+                            if ((edge.color & (1 << c))
+                                && (distance.distance < channels[c].distance - 1e-5f
+                                    || (distance.distance < channels[c].distance + 1e-5f && distance.orthogonality > channels[c].orthogonality)))
+                            {
+                                channels[c] = distance;
+                            }
+                        }
+                    }
+                }
+
+                float r = channels[0].pseudoDistance * orientation;
+                float g = channels[1].pseudoDistance * orientation;
+                float b = channels[2].pseudoDistance * orientation;
+                float trueDistance = inside ? nearest.distance : -nearest.distance;
+
+                // fall back to the single channel distance where the channels disagree with the outline
+                if ((median(r, g, b) > 0) != inside)
+                {
+                    r = g = b = trueDistance;
+                }
+
+                unsigned char* pixel = out + (y * width + x) * 4;
+                pixel[0] = distanceToByte(r);
+                pixel[1] = distanceToByte(g);
+                pixel[2] = distanceToByte(b);
+                pixel[3] = distanceToByte(trueDistance);
+            }
+        }
+
+        return out;
+    }
+}
+
 void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight)
 {
     int iX = posX;
@@ -553,7 +1008,7 @@ void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned
             iX  = posX;
             iY += 1;
         }
-        free(distanceMap);
+        delete [] distanceMap;
     }
     else if(_outlineSize > 0)
     {
@@ -599,6 +1054,114 @@ void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned
     } 
 }
 
+unsigned char* FontFreeType::renderGlyphBitmap(unsigned short theChar, long &outWidth, long &outHeight, Rect &outRect, int &xAdvance)
+{
+    if (_multiChannelDistanceField)
+    {
+        return renderMultiChannelDistanceField(theChar, outWidth, outHeight, outRect, xAdvance);
+    }
+
+    unsigned char* bitmap = nullptr;
+    {
+        std::lock_guard<std::recursive_mutex> lock(_FTMutex);
+        bitmap = getGlyphBitmap(theChar, outWidth, outHeight, outRect, xAdvance);
+        if (bitmap == nullptr)
+        {
+            return nullptr;
+        }
+
+        // the outline bitmap is allocated by getGlyphBitmap, the others belong to the face, so they are copied before unlocking
+        if (_outlineSize > 0)
+        {
+            if (outWidth > 0 && outHeight > 0)
+            {
+                return bitmap;
+            }
+            delete [] bitmap;
+            return nullptr;
+        }
+        if (outWidth <= 0 || outHeight <= 0)
+        {
+            return nullptr;
+        }
+
+        auto copyBitmap = new unsigned char[outWidth * outHeight];
+        memcpy(copyBitmap, bitmap, outWidth * outHeight);
+        bitmap = copyBitmap;
+    }
+
+    if (_distanceFieldEnabled)
+    {
+        auto distanceMap = makeDistanceMap(bitmap, outWidth, outHeight);
+        delete [] bitmap;
+        bitmap = distanceMap;
+        outWidth += 2 * DistanceMapSpread;
+        outHeight += 2 * DistanceMapSpread;
+    }
+
+    return bitmap;
+}
+
+unsigned char* FontFreeType::renderMultiChannelDistanceField(unsigned short theChar, long &outWidth, long &outHeight, Rect &outRect, int &xAdvance)
+{
+    OutlineContours outline;
+    bool insideOnLeft = true;
+    {
+        std::lock_guard<std::recursive_mutex> lock(_FTMutex);
+        xAdvance = 0;
+        outRect.size.width = 0;
+        outRect.size.height = 0;
+        if (_fontRef == nullptr || FT_Load_Char(_fontRef, theChar, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING | FT_LOAD_NO_AUTOHINT))
+        {
+            return nullptr;
+        }
+
+        auto& metrics = _fontRef->glyph->metrics;
+        outRect.origin.x = metrics.horiBearingX >> 6;
+        outRect.origin.y = -(metrics.horiBearingY >> 6);
+        outRect.size.width = (metrics.width >> 6);
+        outRect.size.height = (metrics.height >> 6);
+        xAdvance = (static_cast<int>(metrics.horiAdvance >> 6));
+
+        if (_fontRef->glyph->format != FT_GLYPH_FORMAT_OUTLINE || outRect.size.width <= 0 || outRect.size.height <= 0)
+        {
+            return nullptr;
+        }
+
+        FT_Outline_Funcs funcs;
+        funcs.move_to = outlineMoveTo;
+        funcs.line_to = outlineLineTo;
+        funcs.conic_to = outlineConicTo;
+        funcs.cubic_to = outlineCubicTo;
+        funcs.shift = 0;
+        funcs.delta = 0;
+        if (FT_Outline_Decompose(&_fontRef->glyph->outline, &funcs, &outline))
+        {
+            return nullptr;
+        }
+        insideOnLeft = FT_Outline_Get_Orientation(&_fontRef->glyph->outline) != FT_ORIENTATION_TRUETYPE;
+    }
+
+    // close the contours which don't end where they started
+    for (auto& contour : outline.contours)
+    {
+        if (!contour.empty() && !contour.back().points.back().equals(contour.front().points.front()))
+        {
+            OutlineEdge edge;
+            edge.points.push_back(contour.back().points.back());
+            edge.points.push_back(contour.front().points.front());
+            edge.color = EDGE_WHITE;
+            contour.push_back(edge);
+        }
+    }
+    colorEdges(outline);
+
+    outWidth = (long)outRect.size.width + 2 * DistanceMapSpread;
+    outHeight = (long)outRect.size.height + 2 * DistanceMapSpread;
+    return makeMultiChannelDistanceMap(outline, insideOnLeft,
+        outRect.origin.x - DistanceMapSpread, -outRect.origin.y + DistanceMapSpread, outWidth, outHeight);
+}
+
 void FontFreeType::setGlyphCollection(GlyphCollection glyphs, const char* customGlyphs /* = nullptr */)
 {
     _usedGlyphs = glyphs;
@@ -31,6 +31,7 @@
 #include "CCFont.h"
 
 #include <string>
+#include <mutex>
 #include <ft2build.h>
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
@@ -60,15 +61,38 @@ public:
 
     bool isDistanceFieldEnabled() const { return _distanceFieldEnabled;}
 
+    /** Makes the distance field fonts created afterwards use a multi-channel distance field computed from
+     the glyph outlines. Corners stay sharp, so smaller font sizes can be used for the atlas.
+     The atlas pages are RGBA8888, with the single channel distance field in alpha for the glow effect.
+     */
+    static void setMultiChannelDistanceFieldEnabled(bool enabled) { _multiChannelDistanceFieldEnabled = enabled; }
+    static bool isMultiChannelDistanceFieldEnabled() { return _multiChannelDistanceFieldEnabled; }
+
+    bool isMultiChannelDistanceField() const { return _multiChannelDistanceField; }
+
     float getOutlineSize() const { return _outlineSize; }
 
-    void renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight); 
+    /** @deprecated Use renderGlyphBitmap, which returns the glyph the way the atlas stores it, and copy it instead.
+     * bitmap must come from getGlyphBitmap, and is deleted if the outline is enabled.
+     */
+    CC_DEPRECATED_ATTRIBUTE void renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight);
 
     FT_Encoding getEncoding() const { return _encoding; }
 
     int* getHorizontalKerningForTextUTF16(const std::u16string& text, int &outNumLetters) const override;
     
     unsigned char* getGlyphBitmap(unsigned short theChar, long &outWidth, long &outHeight, Rect &outRect,int &xAdvance);
+
+    /** Renders a glyph the way it is stored in the atlas, with the distance field or the outline applied.
+     * It can be called from any thread. The returned bitmap has 2 bytes per pixel when the outline is enabled,
+     * 1 otherwise, and must be freed with delete[]. Returns nullptr for empty glyphs.
+     */
+    unsigned char* renderGlyphBitmap(unsigned short theChar, long &outWidth, long &outHeight, Rect &outRect, int &xAdvance);
+
+    /** Computes the single channel distance field of an 8 bit coverage bitmap, as stored by distance field atlases.
+     * The result is padded by DistanceMapSpread pixels on each side, 128 is the edge, and must be freed with delete[].
+     */
+    static unsigned char* makeDistanceMap(const unsigned char* bitmap, long width, long height);
     
     int getFontAscender() const;
 
@@ -79,17 +103,25 @@ private:
     static const char* _glyphNEHE;
     static FT_Library _FTlibrary;
     static bool _FTInitialized;
+    // FreeType isn't thread safe, the faces share _FTlibrary and its raster pool, so every FreeType call is made with it locked.
+    // It is recursive because getGlyphBitmap is also called by renderGlyphBitmap, which keeps it locked to copy the bitmap
+    static std::recursive_mutex _FTMutex;
+    static bool _multiChannelDistanceFieldEnabled;
 
     FontFreeType(bool distanceFieldEnabled = false, int outline = 0);
     virtual ~FontFreeType();
 
     bool createFontObject(const std::string &fontName, int fontSize);
 
+    /** Path prefix of the atlas disk cache, keyed by the font data and the rendering settings. */
+    std::string getDiskCachePath() const;
+
     bool initFreeType();
     FT_Library getFTLibrary();
     
     int getHorizontalKerningForChars(unsigned short firstChar, unsigned short secondChar) const;
     unsigned char* getGlyphBitmapWithOutline(unsigned short code, FT_BBox &bbox);
+    unsigned char* renderMultiChannelDistanceField(unsigned short theChar, long &outWidth, long &outHeight, Rect &outRect, int &xAdvance);
 
     void setGlyphCollection(GlyphCollection glyphs, const char* customGlyphs = nullptr);
     const char* getGlyphCollection() const;
@@ -100,6 +132,7 @@ private:
 
     std::string _fontName;
     bool _distanceFieldEnabled;
+    bool _multiChannelDistanceField;
     float _outlineSize;
     int _lineHeight;
     FontAtlas* _fontAtlas;
@@ -27,6 +27,7 @@
 #include "2d/CCFont.h"
 #include "2d/CCFontAtlasCache.h"
 #include "2d/CCFontAtlas.h"
+#include "2d/CCFontFreeType.h"
 #include "2d/CCSprite.h"
 #include "2d/CCSpriteBatchNode.h"
 #include "2d/CCDrawNode.h"
@@ -348,6 +349,8 @@ Label::Label(TextHAlignment hAlignment /* = TextHAlignment::LEFT */,
 , _fontAtlas(nullptr)
 , _reusedLetter(nullptr)
 , _horizontalKernings(nullptr)
+, _lettersAddedListener(nullptr)
+, _asyncGlyphRendering(false)
 {
     setAnchorPoint(Vec2::ANCHOR_MIDDLE);
     reset();
@@ -367,6 +370,7 @@ Label::Label(TextHAlignment hAlignment /* = TextHAlignment::LEFT */,
                 it.second->setTexture(nullptr);
             }
             _batchNodes.clear();
+            _unchangedPrefixLength = 0;
 
             if (_fontAtlas)
             {
@@ -403,6 +407,10 @@ Label::~Label()
     }
     _eventDispatcher->removeEventListener(_purgeTextureListener);
     _eventDispatcher->removeEventListener(_resetTextureListener);
+    if (_lettersAddedListener)
+    {
+        _eventDispatcher->removeEventListener(_lettersAddedListener);
+    }
 
     CC_SAFE_RELEASE_NULL(_textSprite);
     CC_SAFE_RELEASE_NULL(_shadowNode);
@@ -430,6 +438,8 @@ void Label::reset()
     _lengthOfString = 0;
     _utf16Text.clear();
     _utf8Text.clear();
+    _unchangedPrefixLength = 0;
+    _linesState.clear();
 
     TTFConfig temp;
     _fontConfig = temp;
@@ -479,7 +489,13 @@ void Label::updateShaderProgram()
     {
     case cocos2d::LabelEffect::NORMAL:
         if (_useDistanceField)
-            setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL));
+        {
+            auto fontFreeType = _fontAtlas ? dynamic_cast<const FontFreeType*>(_fontAtlas->getFont()) : nullptr;
+            if (fontFreeType && fontFreeType->isMultiChannelDistanceField())
+                setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_MULTICHANNEL));
+            else
+                setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL));
+        }
         else if (_useA8Shader)
             setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_LABEL_NORMAL));
         else if (_shadowEnabled)
@@ -522,6 +538,7 @@ void Label::setFontAtlas(FontAtlas* atlas,bool distanceFieldEnabled /* = false *
     }
 
     _fontAtlas = atlas;
+    _unchangedPrefixLength = 0;
     if (_reusedLetter == nullptr)
     {
         _reusedLetter = Sprite::create();
@@ -603,7 +620,15 @@ void Label::setString(const std::string& text)
         std::u16string utf16String;
         if (StringUtils::UTF8ToUTF16(_utf8Text, utf16String))
         {
-            _utf16Text  = utf16String;
+            // the layout of the common prefix can be kept by the next updateContent
+            int prefixLength = 0;
+            int maxLength = static_cast<int>(std::min(utf16String.length(), _utf16Text.length()));
+            while (prefixLength < maxLength && utf16String[prefixLength] == _utf16Text[prefixLength])
+            {
+                ++prefixLength;
+            }
+            _unchangedPrefixLength = std::min(_unchangedPrefixLength, prefixLength);
+            _utf16Text.swap(utf16String);
         }
     }
 }
@@ -700,6 +725,23 @@ void Label::updateLabelLetters()
     }
 }
 
+void Label::setAsyncGlyphRenderingEnabled(bool enabled)
+{
+    _asyncGlyphRendering = enabled;
+    if (enabled && _lettersAddedListener == nullptr)
+    {
+        _lettersAddedListener = EventListenerCustom::create(FontAtlas::CMD_LETTERS_ADDED, [this](EventCustom* event){
+            if (_fontAtlas && _currentLabelType == LabelType::TTF && event->getUserData() == _fontAtlas)
+            {
+                // the new letters can be anywhere in the text, so every line is laid out again
+                _unchangedPrefixLength = 0;
+                _contentDirty = true;
+            }
+        });
+        _eventDispatcher->addEventListenerWithFixedPriority(_lettersAddedListener, 1);
+    }
+}
+
 void Label::alignText()
 {
     if (_fontAtlas == nullptr || _utf16Text.empty())
@@ -708,11 +750,29 @@ void Label::alignText()
         return;
     }
 
-    _fontAtlas->prepareLetterDefinitions(_utf16Text);
+    // lines before startLine keep their layout, see getRelayoutStartLine
+    int startLine = getRelayoutStartLine();
+    int startIndex = startLine > 0 ? _linesState[startLine].startIndex : 0;
+    _unchangedPrefixLength = 0;
+
+    if (_asyncGlyphRendering)
+    {
+        // the letters missing now are laid out again when they are added, see setAsyncGlyphRenderingEnabled
+        _fontAtlas->prepareLetterDefinitionsAsync(startIndex > 0 ? _utf16Text.substr(startIndex) : _utf16Text, nullptr);
+    }
+    else if (startIndex > 0)
+    {
+        _fontAtlas->prepareLetterDefinitions(_utf16Text.substr(startIndex));
+    }
+    else
+    {
+        _fontAtlas->prepareLetterDefinitions(_utf16Text);
+    }
     auto& textures = _fontAtlas->getTextures();
-    if (textures.size() > _batchNodes.size())
+    auto textureCount = static_cast<ssize_t>(textures.size());
+    if (textureCount > _batchNodes.size())
     {
-        for (auto index = _batchNodes.size(); index < textures.size(); ++index)
+        for (auto index = _batchNodes.size(); index < textureCount; ++index)
         {
             auto batchNode = SpriteBatchNode::createWithTexture(textures.at(index));
             if (batchNode)
@@ -731,35 +791,109 @@ void Label::alignText()
     }
     _reusedLetter->setBatchNode(_batchNodes.at(0));
 
+    std::vector<float> previousOffsetsX;
+    float previousOffsetY = _letterOffsetY;
+    float previousTopY = _tailoredTopY;
+    float previousBottomY = _tailoredBottomY;
+    if (startLine > 0)
+    {
+        previousOffsetsX.assign(_linesOffsetX.begin(), _linesOffsetX.begin() + startLine);
+    }
+
     _lengthOfString = 0;
     _textDesiredHeight = 0.f;
-    _linesWidth.clear();
+    _linesWidth.resize(startLine);
     if (_maxLineWidth > 0.f && !_lineBreakWithoutSpaces)
     {
-        multilineTextWrapByWord();
+        multilineTextWrapByWord(startLine);
     }
     else
     {
-        multilineTextWrapByChar();
+        multilineTextWrapByChar(startLine);
     }
     computeAlignmentOffset();
 
-    updateQuads();
+    // the quads of the kept lines are still valid if those lines didn't move or get clipped differently
+    bool reuseQuads = startLine > 0 && previousOffsetY == _letterOffsetY
+        && std::equal(previousOffsetsX.begin(), previousOffsetsX.end(), _linesOffsetX.begin())
+        && (_labelHeight <= 0.f || (previousTopY == _tailoredTopY && previousBottomY == _tailoredBottomY));
+
+    updateQuads(reuseQuads ? startIndex : 0);
 
     updateLabelLetters();
 
-    updateColor();
+    updateQuadsColor(reuseQuads);
+
+    _layoutParams.lineHeight = _lineHeight;
+    _layoutParams.additionalKerning = _additionalKerning;
+    _layoutParams.lineBreakWithoutSpaces = _lineBreakWithoutSpaces;
+    _layoutParams.maxLineWidth = _maxLineWidth;
+    _layoutParams.labelWidth = _labelWidth;
+    _layoutParams.labelHeight = _labelHeight;
+    _layoutParams.hAlignment = _hAlignment;
+    _layoutParams.vAlignment = _vAlignment;
+    _unchangedPrefixLength = _lengthOfString;
+}
+
+int Label::getRelayoutStartLine() const
+{
+    if (_unchangedPrefixLength <= 0 || _linesState.empty()
+        || _layoutParams.lineHeight != _lineHeight
+        || _layoutParams.additionalKerning != _additionalKerning
+        || _layoutParams.lineBreakWithoutSpaces != _lineBreakWithoutSpaces
+        || _layoutParams.maxLineWidth != _maxLineWidth
+        || _layoutParams.labelWidth != _labelWidth
+        || _layoutParams.labelHeight != _labelHeight
+        || _layoutParams.hAlignment != _hAlignment
+        || _layoutParams.vAlignment != _vAlignment)
+    {
+        return 0;
+    }
+
+    // A line which starts after a line feed only depends on the text after it.
+    // Wrapping by char breaks a line at the first letter that overflows, so the break is known
+    // once that letter is unchanged. Wrapping by word may move the whole word being broken,
+    // and it can extend into the changed text.
+    bool wrapByWord = _maxLineWidth > 0.f && !_lineBreakWithoutSpaces;
+    for (int line = static_cast<int>(_linesState.size()) - 1; line > 0; --line)
+    {
+        auto& lineState = _linesState[line];
+        if (lineState.afterLineFeed ? lineState.startIndex <= _unchangedPrefixLength
+            : (!wrapByWord && lineState.startIndex < _unchangedPrefixLength))
+        {
+            return line;
+        }
+    }
+
+    return 0;
 }
 
 bool Label::computeHorizontalKernings(const std::u16string& stringToRender)
 {
+    int letterCount = 0;
+    if (_horizontalKernings && _unchangedPrefixLength > 1 && stringToRender.length() > static_cast<size_t>(_unchangedPrefixLength))
+    {
+        // the kerning of a letter only depends on the one before it, so only the tail is computed
+        int prefixLength = _unchangedPrefixLength;
+        auto tailKernings = _fontAtlas->getFont()->getHorizontalKerningForTextUTF16(stringToRender.substr(prefixLength - 1), letterCount);
+        if (tailKernings)
+        {
+            auto kernings = new int[stringToRender.length()];
+            memcpy(kernings, _horizontalKernings, prefixLength * sizeof(int));
+            memcpy(kernings + prefixLength, tailKernings + 1, (letterCount - 1) * sizeof(int));
+            delete [] tailKernings;
+            delete [] _horizontalKernings;
+            _horizontalKernings = kernings;
+            return true;
+        }
+    }
+
     if (_horizontalKernings)
     {
         delete [] _horizontalKernings;
         _horizontalKernings = nullptr;
     }
 
-    int letterCount = 0;
     _horizontalKernings = _fontAtlas->getFont()->getHorizontalKerningForTextUTF16(stringToRender, letterCount);
 
     if(!_horizontalKernings)
@@ -768,15 +902,37 @@ bool Label::computeHorizontalKernings(const std::u16string& stringToRender)
         return true;
 }
 
-void Label::updateQuads()
+void Label::updateQuads(int startIndex /* = 0 */)
 {
-    for (auto&& batchNode : _batchNodes)
+    // the quads of the letters before startIndex are kept, they are the first ones of each atlas
+    _reusedQuadsCount.assign(_batchNodes.size(), 0);
+    for (int ctr = 0; ctr < startIndex; ++ctr)
+    {
+        auto& letterInfo = _lettersInfo[ctr];
+        if (letterInfo.valid && letterInfo.atlasIndex >= 0)
+        {
+            auto textureID = _fontAtlas->_letterDefinitions[letterInfo.utf16Char].textureID;
+            _reusedQuadsCount[textureID] = std::max(_reusedQuadsCount[textureID], static_cast<ssize_t>(letterInfo.atlasIndex + 1));
+        }
+    }
+
+    for (ssize_t index = 0; index < _batchNodes.size(); ++index)
     {
-        batchNode->getTextureAtlas()->removeAllQuads();
+        auto textureAtlas = _batchNodes.at(index)->getTextureAtlas();
+        auto removedCount = textureAtlas->getTotalQuads() - _reusedQuadsCount[index];
+        if (_reusedQuadsCount[index] == 0)
+        {
+            textureAtlas->removeAllQuads();
+        }
+        else if (removedCount > 0)
+        {
+            textureAtlas->removeQuadsAtIndex(_reusedQuadsCount[index], removedCount);
+        }
     }
     
-    for (int ctr = 0; ctr < _lengthOfString; ++ctr)
+    for (int ctr = startIndex; ctr < _lengthOfString; ++ctr)
     {
+        _lettersInfo[ctr].atlasIndex = -1;
         if (_lettersInfo[ctr].valid)
         {
             auto& letterDef = _fontAtlas->_letterDefinitions[_lettersInfo[ctr].utf16Char];
@@ -1096,6 +1252,7 @@ void Label::updateContent()
             FontAtlasCache::releaseFontAtlas(_fontAtlas);
             _fontAtlas = nullptr;
         }
+        _unchangedPrefixLength = 0;
 
         _systemFontDirty = false;
     }
@@ -1105,12 +1262,6 @@ void Label::updateContent()
 
     if (_fontAtlas)
     {
-        std::u16string utf16String;
-        if (StringUtils::UTF8ToUTF16(_utf8Text, utf16String))
-        {
-            _utf16Text = utf16String;
-        }
-
         computeHorizontalKernings(_utf16Text);
         alignText();
     }
@@ -1592,6 +1743,11 @@ void Label::setTextColor(const Color4B &color)
 }
 
 void Label::updateColor()
+{
+    updateQuadsColor(false);
+}
+
+void Label::updateQuadsColor(bool onlyNewQuads)
 {
     if (_batchNodes.empty())
     {
@@ -1610,13 +1766,19 @@ void Label::updateColor()
 
     cocos2d::TextureAtlas* textureAtlas;
     V3F_C4B_T2F_Quad *quads;
-    for (auto&& batchNode:_batchNodes)
+    for (ssize_t batchIndex = 0; batchIndex < _batchNodes.size(); ++batchIndex)
     {
-        textureAtlas = batchNode->getTextureAtlas();
+        textureAtlas = _batchNodes.at(batchIndex)->getTextureAtlas();
         quads = textureAtlas->getQuads();
         auto count = textureAtlas->getTotalQuads();
 
-        for (int index = 0; index < count; ++index)
+        // the reused quads already have the displayed color
+        ssize_t firstIndex = 0;
+        if (onlyNewQuads && batchIndex < static_cast<ssize_t>(_reusedQuadsCount.size()))
+        {
+            firstIndex = _reusedQuadsCount[batchIndex];
+        }
+        for (ssize_t index = firstIndex; index < count; ++index)
         {
             quads[index].bl.colors = color4;
             quads[index].br.colors = color4;
@@ -402,6 +402,16 @@ public:
 
     bool isClipMarginEnabled() const { return _clipEnabled; }
 
+    /** Makes a TTF label rasterize the characters missing from its font atlas in the background,
+     * instead of on the cocos thread when the text is laid out. The label shows the characters
+     * already in the atlas, then lays the text out again once the missing ones are added.
+     * Useful for labels showing arbitrary text, like chat messages in CJK fonts.
+     * By default it is disabled.
+     */
+    void setAsyncGlyphRenderingEnabled(bool enabled);
+
+    bool isAsyncGlyphRenderingEnabled() const { return _asyncGlyphRendering; }
+
     /** Sets the line height of the Label.
      * @warning Not support system font.
      * @since v3.2.0
@@ -488,6 +498,30 @@ protected:
         int lineIndex;
     };
 
+    // formatter state at the start of a line, layout can resume from it
+    struct LineState
+    {
+        int startIndex;
+        bool afterLineFeed;
+        float positionY;
+        float highestY;
+        float lowestY;
+        float longestLine;
+    };
+
+    // inputs of the last layout besides the text
+    struct LayoutParams
+    {
+        float lineHeight;
+        float additionalKerning;
+        bool lineBreakWithoutSpaces;
+        float maxLineWidth;
+        float labelWidth;
+        float labelHeight;
+        TextHAlignment hAlignment;
+        TextVAlignment vAlignment;
+    };
+
     enum class LabelType {
         TTF,
         BMFONT,
@@ -503,8 +537,10 @@ protected:
     void onDrawShadow(GLProgram* glProgram);
     void drawSelf(bool visibleByCamera, Renderer* renderer, uint32_t flags);
 
-    bool multilineTextWrapByChar();
-    bool multilineTextWrapByWord();
+    bool multilineTextWrapByChar(int startLine = 0);
+    bool multilineTextWrapByWord(int startLine = 0);
+    void recordLineState(int startIndex, bool afterLineFeed, float positionY, float highestY, float lowestY, float longestLine);
+    int getRelayoutStartLine() const;
 
     void updateLabelLetters();
     virtual void alignText();
@@ -514,7 +550,8 @@ protected:
     void recordLetterInfo(const cocos2d::Vec2& point, char16_t utf16Char, int letterIndex, int lineIndex);
     void recordPlaceholderInfo(int letterIndex, char16_t utf16Char);
     
-    void updateQuads();
+    void updateQuads(int startIndex = 0);
+    void updateQuadsColor(bool onlyNewQuads);
 
     void createSpriteForSystemFont(const FontDefinition& fontDef);
     void createShadowSpriteForSystemFont(const FontDefinition& fontDef);
@@ -571,6 +608,12 @@ protected:
     float _tailoredTopY;
     float _tailoredBottomY;
 
+    // incremental relayout: the text before _unchangedPrefixLength was laid out by the last layout
+    int _unchangedPrefixLength;
+    LayoutParams _layoutParams;
+    std::vector<LineState> _linesState;
+    std::vector<ssize_t> _reusedQuadsCount;
+
     LabelEffect _currLabelEffect;
     Color4F _effectColorF;
     Color4B _textColor;
@@ -606,6 +649,9 @@ protected:
 
     EventListenerCustom* _purgeTextureListener;
     EventListenerCustom* _resetTextureListener;
+    // only created when async glyph rendering is enabled
+    EventListenerCustom* _lettersAddedListener;
+    bool _asyncGlyphRendering;
 
 #if CC_LABEL_DEBUG_DRAW
     DrawNode* _debugDrawNode;
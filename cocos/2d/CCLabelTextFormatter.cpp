@@ -93,22 +93,30 @@ static int getFirstWordLen(const std::u16string& utf16Text, int startIndex, int
     return len;
 }
 
-bool Label::multilineTextWrapByWord()
+bool Label::multilineTextWrapByWord(int startLine /* = 0 */)
 {
     int textLen = getStringLength();
-    int lineIndex = 0;
+    if (startLine == 0)
+    {
+        _linesState.clear();
+        recordLineState(0, true, 0.f, 0.f, 0.f, 0.f);
+    }
+    _linesState.resize(startLine + 1);
+    auto lineState = _linesState[startLine];
+
+    int lineIndex = startLine;
     float nextWordX = 0.f;
-    float nextWordY = 0.f;
-    float longestLine = 0.f;
+    float nextWordY = lineState.positionY;
+    float longestLine = lineState.longestLine;
     float letterRight = 0.f;
 
     auto contentScaleFactor = CC_CONTENT_SCALE_FACTOR();  
-    float highestY = 0.f;
-    float lowestY = 0.f;
+    float highestY = lineState.highestY;
+    float lowestY = lineState.lowestY;
     FontLetterDefinition letterDef;
     Vec2 letterPosition;
     
-    for (int index = 0; index < textLen; )
+    for (int index = lineState.startIndex; index < textLen; )
     {
         auto character = _utf16Text[index];
         if (character == '\n')
@@ -120,6 +128,7 @@ bool Label::multilineTextWrapByWord()
             nextWordY -= _lineHeight;
             recordPlaceholderInfo(index, character);
             index++;
+            recordLineState(index, true, nextWordY, highestY, lowestY, longestLine);
             continue;
         }
 
@@ -141,7 +150,10 @@ bool Label::multilineTextWrapByWord()
             if (_fontAtlas->getLetterDefinitionForChar(character, letterDef) == false)
             {
                 recordPlaceholderInfo(letterIndex, character);
-                CCLOG("LabelTextFormatter error:can't find letter definition in font file for letter: %c", character);
+                if (!_fontAtlas->isLetterPending(character))
+                {
+                    CCLOG("LabelTextFormatter error:can't find letter definition in font file for letter: %c", character);
+                }
                 continue;
             }
 
@@ -154,6 +166,7 @@ bool Label::multilineTextWrapByWord()
                 nextWordX = 0.f;
                 nextWordY -= _lineHeight;
                 newLine = true;
+                recordLineState(index, false, nextWordY, highestY, lowestY, longestLine);
                 break;
             }
             else
@@ -213,22 +226,30 @@ bool Label::multilineTextWrapByWord()
     return true;
 }
 
-bool Label::multilineTextWrapByChar()
+bool Label::multilineTextWrapByChar(int startLine /* = 0 */)
 {
     int textLen = getStringLength();
-    int lineIndex = 0;
+    if (startLine == 0)
+    {
+        _linesState.clear();
+        recordLineState(0, true, 0.f, 0.f, 0.f, 0.f);
+    }
+    _linesState.resize(startLine + 1);
+    auto lineState = _linesState[startLine];
+
+    int lineIndex = startLine;
     float nextLetterX = 0.f;
-    float nextLetterY = 0.f;
-    float longestLine = 0.f;
+    float nextLetterY = lineState.positionY;
+    float longestLine = lineState.longestLine;
     float letterRight = 0.f;
 
     auto contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
-    float highestY = 0.f;
-    float lowestY = 0.f;
+    float highestY = lineState.highestY;
+    float lowestY = lineState.lowestY;
     FontLetterDefinition letterDef;
     Vec2 letterPosition;
 
-    for (int index = 0; index < textLen; index++)
+    for (int index = lineState.startIndex; index < textLen; index++)
     {
         auto character = _utf16Text[index];
         if (character == '\r')
@@ -244,13 +265,17 @@ bool Label::multilineTextWrapByChar()
             nextLetterX = 0.f;
             nextLetterY -= _lineHeight;
             recordPlaceholderInfo(index, character);
+            recordLineState(index + 1, true, nextLetterY, highestY, lowestY, longestLine);
             continue;
         }
 
         if (_fontAtlas->getLetterDefinitionForChar(character, letterDef) == false)
         {
             recordPlaceholderInfo(index, character);
-            CCLOG("LabelTextFormatter error:can't find letter definition in font file for letter: %c", character);
+            if (!_fontAtlas->isLetterPending(character))
+            {
+                CCLOG("LabelTextFormatter error:can't find letter definition in font file for letter: %c", character);
+            }
             continue;
         }
 
@@ -262,6 +287,7 @@ bool Label::multilineTextWrapByChar()
             lineIndex++;
             nextLetterX = 0.f;
             nextLetterY -= _lineHeight;
+            recordLineState(index, false, nextLetterY, highestY, lowestY, longestLine);
             letterPosition.x = letterDef.offsetX / contentScaleFactor;
         }
         else
@@ -320,6 +346,18 @@ void Label::recordLetterInfo(const cocos2d::Vec2& point, char16_t utf16Char, int
     _lettersInfo[letterIndex].positionY = point.y;
 }
 
+void Label::recordLineState(int startIndex, bool afterLineFeed, float positionY, float highestY, float lowestY, float longestLine)
+{
+    LineState lineState;
+    lineState.startIndex = startIndex;
+    lineState.afterLineFeed = afterLineFeed;
+    lineState.positionY = positionY;
+    lineState.highestY = highestY;
+    lineState.lowestY = lowestY;
+    lineState.longestLine = longestLine;
+    _linesState.push_back(lineState);
+}
+
 void Label::recordPlaceholderInfo(int letterIndex, char16_t utf16Char)
 {
     if (static_cast<std::size_t>(letterIndex) >= _lettersInfo.size())
@@ -46,7 +46,14 @@ THE SOFTWARE.
 
 #include <string>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include "2d/CCParticleBatchNode.h"
+#include "2d/CCParticleSystemManager.h"
 #include "renderer/CCTextureAtlas.h"
 #include "base/base64.h"
 #include "base/ZipUtils.h"
@@ -77,15 +84,260 @@ NS_CC_BEGIN
 //  cocos2d uses a another approach, but the results are almost identical. 
 //
 
+// number of float arrays in ParticleData, atlasIndex follows them
+static const int PARTICLE_DATA_FLOAT_ARRAYS = 25;
+
+ParticleData::ParticleData()
+: _data(nullptr)
+, _stride(0)
+, _maxCount(0)
+{
+    release();
+}
+
+ParticleData::~ParticleData()
+{
+    release();
+}
+
+bool ParticleData::init(int count)
+{
+    release();
+
+    // the arrays are padded to a multiple of 4 floats, they stay 16 bytes aligned relative to each other
+    int stride = (count + 3) & ~3;
+    _data = (float*)calloc(stride * (PARTICLE_DATA_FLOAT_ARRAYS + 1), sizeof(float));
+    if (!_data)
+    {
+        return false;
+    }
+    _stride = stride;
+    _maxCount = count;
+
+    float* arrays[PARTICLE_DATA_FLOAT_ARRAYS];
+    for (int i = 0; i < PARTICLE_DATA_FLOAT_ARRAYS; ++i)
+    {
+        arrays[i] = _data + i * stride;
+    }
+    posx = arrays[0];
+    posy = arrays[1];
+    startPosX = arrays[2];
+    startPosY = arrays[3];
+    colorR = arrays[4];
+    colorG = arrays[5];
+    colorB = arrays[6];
+    colorA = arrays[7];
+    deltaColorR = arrays[8];
+    deltaColorG = arrays[9];
+    deltaColorB = arrays[10];
+    deltaColorA = arrays[11];
+    size = arrays[12];
+    deltaSize = arrays[13];
+    rotation = arrays[14];
+    deltaRotation = arrays[15];
+    timeToLive = arrays[16];
+    modeA.dirX = arrays[17];
+    modeA.dirY = arrays[18];
+    modeA.radialAccel = arrays[19];
+    modeA.tangentialAccel = arrays[20];
+    modeB.angle = arrays[21];
+    modeB.degreesPerSecond = arrays[22];
+    modeB.radius = arrays[23];
+    modeB.deltaRadius = arrays[24];
+    atlasIndex = reinterpret_cast<unsigned int*>(_data + PARTICLE_DATA_FLOAT_ARRAYS * stride);
+
+    return true;
+}
+
+void ParticleData::release()
+{
+    CC_SAFE_FREE(_data);
+    _stride = 0;
+    _maxCount = 0;
+
+    posx = posy = startPosX = startPosY = nullptr;
+    colorR = colorG = colorB = colorA = nullptr;
+    deltaColorR = deltaColorG = deltaColorB = deltaColorA = nullptr;
+    size = deltaSize = rotation = deltaRotation = timeToLive = nullptr;
+    atlasIndex = nullptr;
+    modeA.dirX = modeA.dirY = modeA.radialAccel = modeA.tangentialAccel = nullptr;
+    modeB.angle = modeB.degreesPerSecond = modeB.radius = modeB.deltaRadius = nullptr;
+}
+
+void ParticleData::copyParticle(int p1, int p2)
+{
+    for (int i = 0; i < PARTICLE_DATA_FLOAT_ARRAYS; ++i)
+    {
+        float* array = _data + i * _stride;
+        array[p1] = array[p2];
+    }
+    atlasIndex[p1] = atlasIndex[p2];
+}
+
+// value[i] += delta[i] * dt
+static void integrateParticles(float* value, const float* delta, float dt, int count)
+{
+    int i = 0;
+#if defined(__SSE__)
+    __m128 dt4 = _mm_set1_ps(dt);
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(value + i, _mm_add_ps(_mm_loadu_ps(value + i), _mm_mul_ps(_mm_loadu_ps(delta + i), dt4)));
+    }
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+    float32x4_t dt4 = vdupq_n_f32(dt);
+    for (; i + 4 <= count; i += 4)
+    {
+        vst1q_f32(value + i, vaddq_f32(vld1q_f32(value + i), vmulq_f32(vld1q_f32(delta + i), dt4)));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        value[i] += delta[i] * dt;
+    }
+}
+
+// value[i] = MAX(0, value[i] + delta[i] * dt)
+static void integrateParticlesNonNegative(float* value, const float* delta, float dt, int count)
+{
+    int i = 0;
+#if defined(__SSE__)
+    __m128 dt4 = _mm_set1_ps(dt);
+    __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 v = _mm_add_ps(_mm_loadu_ps(value + i), _mm_mul_ps(_mm_loadu_ps(delta + i), dt4));
+        _mm_storeu_ps(value + i, _mm_max_ps(v, zero));
+    }
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+    float32x4_t dt4 = vdupq_n_f32(dt);
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t v = vaddq_f32(vld1q_f32(value + i), vmulq_f32(vld1q_f32(delta + i), dt4));
+        vst1q_f32(value + i, vmaxq_f32(v, zero));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        value[i] = MAX(0, value[i] + delta[i] * dt);
+    }
+}
+
+// value[i] -= amount
+static void decreaseParticles(float* value, float amount, int count)
+{
+    int i = 0;
+#if defined(__SSE__)
+    __m128 amount4 = _mm_set1_ps(amount);
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(value + i, _mm_sub_ps(_mm_loadu_ps(value + i), amount4));
+    }
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+    float32x4_t amount4 = vdupq_n_f32(amount);
+    for (; i + 4 <= count; i += 4)
+    {
+        vst1q_f32(value + i, vsubq_f32(vld1q_f32(value + i), amount4));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        value[i] -= amount;
+    }
+}
+
+// Mode A: the direction gets gravity, radial and tangential accelerations, then moves the position
+static void updateGravityParticles(ParticleData& data, const Vec2& gravity, float dt, float flippedDt, int count)
+{
+    float* posx = data.posx;
+    float* posy = data.posy;
+    float* dirX = data.modeA.dirX;
+    float* dirY = data.modeA.dirY;
+    const float* radialAccel = data.modeA.radialAccel;
+    const float* tangentialAccel = data.modeA.tangentialAccel;
+
+    int i = 0;
+#if defined(__SSE__)
+    __m128 dt4 = _mm_set1_ps(dt);
+    __m128 flippedDt4 = _mm_set1_ps(flippedDt);
+    __m128 gravityX = _mm_set1_ps(gravity.x);
+    __m128 gravityY = _mm_set1_ps(gravity.y);
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(posx + i);
+        __m128 y = _mm_loadu_ps(posy + i);
+        __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+        __m128 scale = _mm_and_ps(_mm_cmpgt_ps(length, zero), _mm_div_ps(one, length));
+        __m128 radialX = _mm_mul_ps(x, scale);
+        __m128 radialY = _mm_mul_ps(y, scale);
+        __m128 radial = _mm_loadu_ps(radialAccel + i);
+        __m128 tangential = _mm_loadu_ps(tangentialAccel + i);
+
+        __m128 accelX = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(radialX, radial), _mm_mul_ps(radialY, tangential)), gravityX);
+        __m128 accelY = _mm_add_ps(_mm_add_ps(_mm_mul_ps(radialY, radial), _mm_mul_ps(radialX, tangential)), gravityY);
+        __m128 newDirX = _mm_add_ps(_mm_loadu_ps(dirX + i), _mm_mul_ps(accelX, dt4));
+        __m128 newDirY = _mm_add_ps(_mm_loadu_ps(dirY + i), _mm_mul_ps(accelY, dt4));
+        _mm_storeu_ps(dirX + i, newDirX);
+        _mm_storeu_ps(dirY + i, newDirY);
+        _mm_storeu_ps(posx + i, _mm_add_ps(x, _mm_mul_ps(newDirX, flippedDt4)));
+        _mm_storeu_ps(posy + i, _mm_add_ps(y, _mm_mul_ps(newDirY, flippedDt4)));
+    }
+#elif defined(__aarch64__)
+    float32x4_t dt4 = vdupq_n_f32(dt);
+    float32x4_t flippedDt4 = vdupq_n_f32(flippedDt);
+    float32x4_t gravityX = vdupq_n_f32(gravity.x);
+    float32x4_t gravityY = vdupq_n_f32(gravity.y);
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t one = vdupq_n_f32(1.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4_t x = vld1q_f32(posx + i);
+        float32x4_t y = vld1q_f32(posy + i);
+        float32x4_t length = vsqrtq_f32(vaddq_f32(vmulq_f32(x, x), vmulq_f32(y, y)));
+        float32x4_t scale = vbslq_f32(vcgtq_f32(length, zero), vdivq_f32(one, length), zero);
+        float32x4_t radialX = vmulq_f32(x, scale);
+        float32x4_t radialY = vmulq_f32(y, scale);
+        float32x4_t radial = vld1q_f32(radialAccel + i);
+        float32x4_t tangential = vld1q_f32(tangentialAccel + i);
+
+        float32x4_t accelX = vaddq_f32(vsubq_f32(vmulq_f32(radialX, radial), vmulq_f32(radialY, tangential)), gravityX);
+        float32x4_t accelY = vaddq_f32(vaddq_f32(vmulq_f32(radialY, radial), vmulq_f32(radialX, tangential)), gravityY);
+        float32x4_t newDirX = vaddq_f32(vld1q_f32(dirX + i), vmulq_f32(accelX, dt4));
+        float32x4_t newDirY = vaddq_f32(vld1q_f32(dirY + i), vmulq_f32(accelY, dt4));
+        vst1q_f32(dirX + i, newDirX);
+        vst1q_f32(dirY + i, newDirY);
+        vst1q_f32(posx + i, vaddq_f32(x, vmulq_f32(newDirX, flippedDt4)));
+        vst1q_f32(posy + i, vaddq_f32(y, vmulq_f32(newDirY, flippedDt4)));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        // radial acceleration
+        float length = sqrtf(posx[i] * posx[i] + posy[i] * posy[i]);
+        float scale = length > 0 ? 1.0f / length : 0.0f;
+        float radialX = posx[i] * scale;
+        float radialY = posy[i] * scale;
+
+        // (gravity + radial + tangential) * dt
+        dirX[i] += (radialX * radialAccel[i] - radialY * tangentialAccel[i] + gravity.x) * dt;
+        dirY[i] += (radialY * radialAccel[i] + radialX * tangentialAccel[i] + gravity.y) * dt;
+
+        // this is cocos2d-x v3.0
+        posx[i] += dirX[i] * flippedDt;
+        posy[i] += dirY[i] * flippedDt;
+    }
+}
+
 ParticleSystem::ParticleSystem()
 : _isBlendAdditive(false)
 , _isAutoRemoveOnFinish(false)
 , _plistFile("")
 , _elapsed(0)
-, _particles(nullptr)
 , _configName("")
 , _emitCounter(0)
-, _particleIdx(0)
 , _batchNode(nullptr)
 , _atlasIndex(0)
 , _transformSystemDirty(false)
@@ -128,6 +380,8 @@ ParticleSystem::ParticleSystem()
     modeB.endRadiusVar = 0;            
     modeB.rotatePerSecond = 0;
     modeB.rotatePerSecondVar = 0;
+
+    _randomEngine.seed(RandomHelper::random_int<unsigned int>(0, UINT_MAX));
 }
 // implementation ParticleSystem
 
@@ -427,11 +681,7 @@ bool ParticleSystem::initWithTotalParticles(int numberOfParticles)
 {
     _totalParticles = numberOfParticles;
 
-    CC_SAFE_FREE(_particles);
-    
-    _particles = (tParticle*)calloc(_totalParticles, sizeof(tParticle));
-
-    if( ! _particles )
+    if( ! _particleData.init(_totalParticles) )
     {
         CCLOG("Particle system: not enough memory");
         this->release();
@@ -443,7 +693,7 @@ bool ParticleSystem::initWithTotalParticles(int numberOfParticles)
     {
         for (int i = 0; i < _totalParticles; i++)
         {
-            _particles[i].atlasIndex=i;
+            _particleData.atlasIndex[i] = i;
         }
     }
     // default, active
@@ -478,7 +728,7 @@ ParticleSystem::~ParticleSystem()
     // Since the scheduler retains the "target (in this case the ParticleSystem)
 	// it is not needed to call "unscheduleUpdate" here. In fact, it will be called in "cleanup"
     //unscheduleUpdate();
-    CC_SAFE_FREE(_particles);
+    _particleData.release();
     CC_SAFE_RELEASE(_texture);
 }
 
@@ -489,123 +739,203 @@ bool ParticleSystem::addParticle()
         return false;
     }
 
-    tParticle * particle = &_particles[ _particleCount ];
-    this->initParticle(particle);
-    ++_particleCount;
+    addParticles(1);
 
     return true;
 }
 
-void ParticleSystem::initParticle(tParticle* particle)
+void ParticleSystem::addParticles(int count)
+{
+    updateEmitterTransform();
+    emitParticles(count);
+}
+
+void ParticleSystem::setRandomSeed(unsigned int seed)
+{
+    _randomEngine.seed(seed);
+}
+
+float ParticleSystem::randomMinus1To1()
+{
+    // not a std::uniform_real_distribution, its sequence depends on the standard library
+    const float scale = 2.0f / (std::minstd_rand::max() - std::minstd_rand::min());
+    return (_randomEngine() - std::minstd_rand::min()) * scale - 1.0f;
+}
+
+void ParticleSystem::updateEmitterTransform()
 {
+    if (_positionType == PositionType::FREE)
+    {
+        _emitterPosition = this->convertToWorldSpace(Vec2::ZERO);
+        _worldToNodeTransform = getWorldToNodeTransform();
+    }
+    else if (_positionType == PositionType::RELATIVE)
+    {
+        _emitterPosition = _position;
+    }
+}
+
+void ParticleSystem::emitParticles(int count)
+{
+    count = MIN(count, _totalParticles - _particleCount);
+    if (count <= 0)
+    {
+        return;
+    }
+
+    int start = _particleCount;
+    int end = _particleCount + count;
+    _particleCount += count;
+
     // timeToLive
     // no negative life. prevent division by 0
-    particle->timeToLive = _life + _lifeVar * CCRANDOM_MINUS1_1();
-    particle->timeToLive = MAX(0, particle->timeToLive);
+    float* timeToLive = _particleData.timeToLive;
+    for (int i = start; i < end; ++i)
+    {
+        float life = _life + _lifeVar * randomMinus1To1();
+        timeToLive[i] = MAX(0, life);
+    }
 
     // position
-    particle->pos.x = _sourcePosition.x + _posVar.x * CCRANDOM_MINUS1_1();
-
-    particle->pos.y = _sourcePosition.y + _posVar.y * CCRANDOM_MINUS1_1();
-
+    for (int i = start; i < end; ++i)
+    {
+        _particleData.posx[i] = _sourcePosition.x + _posVar.x * randomMinus1To1();
+    }
+    for (int i = start; i < end; ++i)
+    {
+        _particleData.posy[i] = _sourcePosition.y + _posVar.y * randomMinus1To1();
+    }
 
     // Color
-    Color4F start;
-    start.r = clampf(_startColor.r + _startColorVar.r * CCRANDOM_MINUS1_1(), 0, 1);
-    start.g = clampf(_startColor.g + _startColorVar.g * CCRANDOM_MINUS1_1(), 0, 1);
-    start.b = clampf(_startColor.b + _startColorVar.b * CCRANDOM_MINUS1_1(), 0, 1);
-    start.a = clampf(_startColor.a + _startColorVar.a * CCRANDOM_MINUS1_1(), 0, 1);
-
-    Color4F end;
-    end.r = clampf(_endColor.r + _endColorVar.r * CCRANDOM_MINUS1_1(), 0, 1);
-    end.g = clampf(_endColor.g + _endColorVar.g * CCRANDOM_MINUS1_1(), 0, 1);
-    end.b = clampf(_endColor.b + _endColorVar.b * CCRANDOM_MINUS1_1(), 0, 1);
-    end.a = clampf(_endColor.a + _endColorVar.a * CCRANDOM_MINUS1_1(), 0, 1);
-
-    particle->color = start;
-    particle->deltaColor.r = (end.r - start.r) / particle->timeToLive;
-    particle->deltaColor.g = (end.g - start.g) / particle->timeToLive;
-    particle->deltaColor.b = (end.b - start.b) / particle->timeToLive;
-    particle->deltaColor.a = (end.a - start.a) / particle->timeToLive;
+    const float* startColor[4] = { &_startColor.r, &_startColor.g, &_startColor.b, &_startColor.a };
+    const float* startColorVar[4] = { &_startColorVar.r, &_startColorVar.g, &_startColorVar.b, &_startColorVar.a };
+    const float* endColor[4] = { &_endColor.r, &_endColor.g, &_endColor.b, &_endColor.a };
+    const float* endColorVar[4] = { &_endColorVar.r, &_endColorVar.g, &_endColorVar.b, &_endColorVar.a };
+    float* color[4] = { _particleData.colorR, _particleData.colorG, _particleData.colorB, _particleData.colorA };
+    float* deltaColor[4] = { _particleData.deltaColorR, _particleData.deltaColorG, _particleData.deltaColorB, _particleData.deltaColorA };
+    for (int channel = 0; channel < 4; ++channel)
+    {
+        for (int i = start; i < end; ++i)
+        {
+            color[channel][i] = clampf(*startColor[channel] + *startColorVar[channel] * randomMinus1To1(), 0, 1);
+        }
+        for (int i = start; i < end; ++i)
+        {
+            float endValue = clampf(*endColor[channel] + *endColorVar[channel] * randomMinus1To1(), 0, 1);
+            deltaColor[channel][i] = (endValue - color[channel][i]) / timeToLive[i];
+        }
+    }
 
     // size
-    float startS = _startSize + _startSizeVar * CCRANDOM_MINUS1_1();
-    startS = MAX(0, startS); // No negative value
-
-    particle->size = startS;
+    for (int i = start; i < end; ++i)
+    {
+        float startS = _startSize + _startSizeVar * randomMinus1To1();
+        _particleData.size[i] = MAX(0, startS); // No negative value
+    }
 
     if (_endSize == START_SIZE_EQUAL_TO_END_SIZE)
     {
-        particle->deltaSize = 0;
+        for (int i = start; i < end; ++i)
+        {
+            _particleData.deltaSize[i] = 0;
+        }
     }
     else
     {
-        float endS = _endSize + _endSizeVar * CCRANDOM_MINUS1_1();
-        endS = MAX(0, endS); // No negative values
-        particle->deltaSize = (endS - startS) / particle->timeToLive;
+        for (int i = start; i < end; ++i)
+        {
+            float endS = _endSize + _endSizeVar * randomMinus1To1();
+            endS = MAX(0, endS); // No negative values
+            _particleData.deltaSize[i] = (endS - _particleData.size[i]) / timeToLive[i];
+        }
     }
 
     // rotation
-    float startA = _startSpin + _startSpinVar * CCRANDOM_MINUS1_1();
-    float endA = _endSpin + _endSpinVar * CCRANDOM_MINUS1_1();
-    particle->rotation = startA;
-    particle->deltaRotation = (endA - startA) / particle->timeToLive;
-
-    // position
-    if (_positionType == PositionType::FREE)
+    for (int i = start; i < end; ++i)
     {
-        particle->startPos = this->convertToWorldSpace(Vec2::ZERO);
+        _particleData.rotation[i] = _startSpin + _startSpinVar * randomMinus1To1();
     }
-    else if (_positionType == PositionType::RELATIVE)
+    for (int i = start; i < end; ++i)
     {
-        particle->startPos = _position;
+        float endA = _endSpin + _endSpinVar * randomMinus1To1();
+        _particleData.deltaRotation[i] = (endA - _particleData.rotation[i]) / timeToLive[i];
     }
 
-    // direction
-    float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * CCRANDOM_MINUS1_1() );    
+    // position
+    for (int i = start; i < end; ++i)
+    {
+        _particleData.startPosX[i] = _emitterPosition.x;
+        _particleData.startPosY[i] = _emitterPosition.y;
+    }
 
     // Mode Gravity: A
     if (_emitterMode == Mode::GRAVITY)
     {
-        Vec2 v(cosf( a ), sinf( a ));
-        float s = modeA.speed + modeA.speedVar * CCRANDOM_MINUS1_1();
-
         // direction
-        particle->modeA.dir = v * s ;
+        for (int i = start; i < end; ++i)
+        {
+            float a = CC_DEGREES_TO_RADIANS( _angle + _angleVar * randomMinus1To1() );
+            float s = modeA.speed + modeA.speedVar * randomMinus1To1();
+            _particleData.modeA.dirX[i] = cosf(a) * s;
+            _particleData.modeA.dirY[i] = sinf(a) * s;
+        }
 
         // radial accel
-        particle->modeA.radialAccel = modeA.radialAccel + modeA.radialAccelVar * CCRANDOM_MINUS1_1();
- 
+        for (int i = start; i < end; ++i)
+        {
+            _particleData.modeA.radialAccel[i] = modeA.radialAccel + modeA.radialAccelVar * randomMinus1To1();
+        }
 
         // tangential accel
-        particle->modeA.tangentialAccel = modeA.tangentialAccel + modeA.tangentialAccelVar * CCRANDOM_MINUS1_1();
+        for (int i = start; i < end; ++i)
+        {
+            _particleData.modeA.tangentialAccel[i] = modeA.tangentialAccel + modeA.tangentialAccelVar * randomMinus1To1();
+        }
 
         // rotation is dir
-        if(modeA.rotationIsDir)
-            particle->rotation = -CC_RADIANS_TO_DEGREES(particle->modeA.dir.getAngle());
+        if (modeA.rotationIsDir)
+        {
+            for (int i = start; i < end; ++i)
+            {
+                _particleData.rotation[i] = -CC_RADIANS_TO_DEGREES(atan2f(_particleData.modeA.dirY[i], _particleData.modeA.dirX[i]));
+            }
+        }
     }
 
     // Mode Radius: B
     else 
     {
         // Set the default diameter of the particle from the source position
-        float startRadius = modeB.startRadius + modeB.startRadiusVar * CCRANDOM_MINUS1_1();
-        float endRadius = modeB.endRadius + modeB.endRadiusVar * CCRANDOM_MINUS1_1();
-
-        particle->modeB.radius = startRadius;
+        for (int i = start; i < end; ++i)
+        {
+            _particleData.modeB.radius[i] = modeB.startRadius + modeB.startRadiusVar * randomMinus1To1();
+        }
 
         if (modeB.endRadius == START_RADIUS_EQUAL_TO_END_RADIUS)
         {
-            particle->modeB.deltaRadius = 0;
+            for (int i = start; i < end; ++i)
+            {
+                _particleData.modeB.deltaRadius[i] = 0;
+            }
         }
         else
         {
-            particle->modeB.deltaRadius = (endRadius - startRadius) / particle->timeToLive;
+            for (int i = start; i < end; ++i)
+            {
+                float endRadius = modeB.endRadius + modeB.endRadiusVar * randomMinus1To1();
+                _particleData.modeB.deltaRadius[i] = (endRadius - _particleData.modeB.radius[i]) / timeToLive[i];
+            }
         }
 
-        particle->modeB.angle = a;
-        particle->modeB.degreesPerSecond = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * CCRANDOM_MINUS1_1());
-    }    
+        for (int i = start; i < end; ++i)
+        {
+            _particleData.modeB.angle[i] = CC_DEGREES_TO_RADIANS( _angle + _angleVar * randomMinus1To1() );
+        }
+        for (int i = start; i < end; ++i)
+        {
+            _particleData.modeB.degreesPerSecond[i] = CC_DEGREES_TO_RADIANS(modeB.rotatePerSecond + modeB.rotatePerSecondVar * randomMinus1To1());
+        }
+    }
 }
 
 void ParticleSystem::onEnter()
@@ -649,10 +979,9 @@ void ParticleSystem::resetSystem()
 {
     _isActive = true;
     _elapsed = 0;
-    for (_particleIdx = 0; _particleIdx < _particleCount; ++_particleIdx)
+    for (int i = 0; i < _particleCount; ++i)
     {
-        tParticle *p = &_particles[_particleIdx];
-        p->timeToLive = 0;
+        _particleData.timeToLive[i] = 0;
     }
 }
 bool ParticleSystem::isFull()
@@ -663,8 +992,25 @@ bool ParticleSystem::isFull()
 // ParticleSystem - MainLoop
 void ParticleSystem::update(float dt)
 {
+    updateEmitterTransform();
+
+    auto manager = ParticleSystemManager::getInstance();
+    if (manager->isEnabled())
+    {
+        // simulated with the other systems after the scheduler update
+        manager->scheduleSystem(this, dt);
+        return;
+    }
+
     CC_PROFILER_START_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+    bool removeSystem = simulate(dt);
+    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+
+    finishUpdate(removeSystem);
+}
 
+bool ParticleSystem::simulate(float dt)
+{
     if (_isActive && _emissionRate)
     {
         float rate = 1.0f / _emissionRate;
@@ -674,11 +1020,13 @@ void ParticleSystem::update(float dt)
             _emitCounter += dt;
         }
         
-        while (_particleCount < _totalParticles && _emitCounter > rate) 
+        int emitCount = 0;
+        while (_particleCount + emitCount < _totalParticles && _emitCounter > rate) 
         {
-            this->addParticle();
+            ++emitCount;
             _emitCounter -= rate;
         }
+        emitParticles(emitCount);
 
         _elapsed += dt;
         if (_duration != -1 && _duration < _elapsed)
@@ -687,174 +1035,106 @@ void ParticleSystem::update(float dt)
         }
     }
 
-    _particleIdx = 0;
+    // life
+    decreaseParticles(_particleData.timeToLive, dt, _particleCount);
 
-    Vec2 currentPosition;
-    if (_positionType == PositionType::FREE)
+    for (int i = 0; i < _particleCount; )
     {
-        currentPosition = this->convertToWorldSpace(Vec2::ZERO);
-    }
-    else if (_positionType == PositionType::RELATIVE)
-    {
-        currentPosition = _position;
-    }
-
-    {
-        Mat4 worldToNodeTM = getWorldToNodeTransform();
-        
-        while (_particleIdx < _particleCount)
+        if (_particleData.timeToLive[i] > 0)
         {
-            tParticle *p = &_particles[_particleIdx];
-
-            // life
-            p->timeToLive -= dt;
-
-            if (p->timeToLive > 0) 
-            {
-                // Mode A: gravity, direction, tangential accel & radial accel
-                if (_emitterMode == Mode::GRAVITY)
-                {
-                    Vec2 tmp, radial, tangential;
-
-                    // radial acceleration
-                    if (p->pos.x || p->pos.y)
-                    {
-                        radial = p->pos.getNormalized();
-                    }
-                    tangential = radial;
-                    radial = radial * p->modeA.radialAccel;
-
-                    // tangential acceleration
-                    float newy = tangential.x;
-                    tangential.x = -tangential.y;
-                    tangential.y = newy;
-                    tangential = tangential * p->modeA.tangentialAccel;
-
-                    // (gravity + radial + tangential) * dt
-                    tmp = radial + tangential + modeA.gravity;
-                    tmp = tmp * dt;
-                    p->modeA.dir = p->modeA.dir + tmp;
-                    
-                    // this is cocos2d-x v3.0
-//                    if (_configName.length()>0 && _yCoordFlipped != -1)
-
-                    // this is cocos2d-x v3.0
-                    tmp = p->modeA.dir * dt * _yCoordFlipped;
-                    p->pos = p->pos + tmp;
-                }
-
-                // Mode B: radius movement
-                else 
-                {                
-                    // Update the angle and radius of the particle.
-                    p->modeB.angle += p->modeB.degreesPerSecond * dt;
-                    p->modeB.radius += p->modeB.deltaRadius * dt;
-
-                    p->pos.x = - cosf(p->modeB.angle) * p->modeB.radius;
-                    p->pos.y = - sinf(p->modeB.angle) * p->modeB.radius;
-                    p->pos.y *= _yCoordFlipped;
-				}
+            ++i;
+            continue;
+        }
 
-                // color
-                p->color.r += (p->deltaColor.r * dt);
-                p->color.g += (p->deltaColor.g * dt);
-                p->color.b += (p->deltaColor.b * dt);
-                p->color.a += (p->deltaColor.a * dt);
+        // life < 0, the last particle takes its place
+        unsigned int currentIndex = _particleData.atlasIndex[i];
+        if( i != _particleCount-1 )
+        {
+            _particleData.copyParticle(i, _particleCount-1);
+        }
+        if (_batchNode)
+        {
+            //disable the switched particle
+            _batchNode->disableParticle(_atlasIndex+currentIndex);
 
-                // size
-                p->size += (p->deltaSize * dt);
-                p->size = MAX( 0, p->size );
+            //switch indexes
+            _particleData.atlasIndex[_particleCount-1] = currentIndex;
+        }
 
-                // angle
-                p->rotation += (p->deltaRotation * dt);
+        --_particleCount;
 
-                //
-                // update values in quad
-                //
+        if( _particleCount == 0 && _isAutoRemoveOnFinish )
+        {
+            return true;
+        }
+    }
 
-                Vec2    newPos;
+    // Mode A: gravity, direction, tangential accel & radial accel
+    if (_emitterMode == Mode::GRAVITY)
+    {
+        updateGravityParticles(_particleData, modeA.gravity, dt, dt * _yCoordFlipped, _particleCount);
+    }
 
-                if (_positionType == PositionType::FREE)
-                {
-                    Vec3 p1(currentPosition.x,currentPosition.y,0),p2(p->startPos.x,p->startPos.y,0);
-                    worldToNodeTM.transformPoint(&p1);
-                    worldToNodeTM.transformPoint(&p2);
-                    p1 = p1 - p2;
-                    newPos = p->pos - Vec2(p1.x,p1.y);
-                }
-                else if(_positionType == PositionType::RELATIVE)
-                {
-                    Vec2 diff = currentPosition - p->startPos;
-                    newPos = p->pos - diff;
-                } 
-                else
-                {
-                    newPos = p->pos;
-                }
+    // Mode B: radius movement
+    else 
+    {
+        // Update the angle and radius of the particle.
+        integrateParticles(_particleData.modeB.angle, _particleData.modeB.degreesPerSecond, dt, _particleCount);
+        integrateParticles(_particleData.modeB.radius, _particleData.modeB.deltaRadius, dt, _particleCount);
 
-                // translate newPos to correct position, since matrix transform isn't performed in batchnode
-                // don't update the particle with the new position information, it will interfere with the radius and tangential calculations
-                if (_batchNode)
-                {
-                    newPos.x+=_position.x;
-                    newPos.y+=_position.y;
-                }
+        for (int i = 0; i < _particleCount; ++i)
+        {
+            _particleData.posx[i] = - cosf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i];
+            _particleData.posy[i] = - sinf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i] * _yCoordFlipped;
+        }
+    }
 
-                updateQuadWithParticle(p, newPos);
-                //updateParticleImp(self, updateParticleSel, p, newPos);
+    // color
+    integrateParticles(_particleData.colorR, _particleData.deltaColorR, dt, _particleCount);
+    integrateParticles(_particleData.colorG, _particleData.deltaColorG, dt, _particleCount);
+    integrateParticles(_particleData.colorB, _particleData.deltaColorB, dt, _particleCount);
+    integrateParticles(_particleData.colorA, _particleData.deltaColorA, dt, _particleCount);
 
-                // update particle counter
-                ++_particleIdx;
-            } 
-            else 
-            {
-                // life < 0
-                int currentIndex = p->atlasIndex;
-                if( _particleIdx != _particleCount-1 )
-                {
-                    _particles[_particleIdx] = _particles[_particleCount-1];
-                }
-                if (_batchNode)
-                {
-                    //disable the switched particle
-                    _batchNode->disableParticle(_atlasIndex+currentIndex);
+    // size
+    integrateParticlesNonNegative(_particleData.size, _particleData.deltaSize, dt, _particleCount);
 
-                    //switch indexes
-                    _particles[_particleCount-1].atlasIndex = currentIndex;
-                }
+    // angle
+    integrateParticles(_particleData.rotation, _particleData.deltaRotation, dt, _particleCount);
 
+    updateParticleQuads();
+    _transformSystemDirty = false;
 
-                --_particleCount;
+    return false;
+}
 
-                if( _particleCount == 0 && _isAutoRemoveOnFinish )
-                {
-                    this->unscheduleUpdate();
-                    _parent->removeChild(this, true);
-                    return;
-                }
-            }
-        } //while
-        _transformSystemDirty = false;
+void ParticleSystem::finishUpdate(bool removeSystem)
+{
+    if (removeSystem)
+    {
+        this->unscheduleUpdate();
+        if (_parent)
+        {
+            _parent->removeChild(this, true);
+        }
+        return;
     }
-    
+
     // only update gl buffer when visible
     if (_visible && ! _batchNode)
     {
         postStep();
     }
-
-    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
 }
 
 void ParticleSystem::updateWithNoTime(void)
 {
-    this->update(0.0f);
+    // always immediate, even when the systems are simulated by ParticleSystemManager
+    updateEmitterTransform();
+    finishUpdate(simulate(0.0f));
 }
 
-void ParticleSystem::updateQuadWithParticle(tParticle* particle, const Vec2& newPosition)
+void ParticleSystem::updateParticleQuads()
 {
-    CC_UNUSED_PARAM(particle);
-    CC_UNUSED_PARAM(newPosition);
     // should be overridden
 }
 
@@ -1152,7 +1432,7 @@ void ParticleSystem::setBatchNode(ParticleBatchNode* batchNode)
             //each particle needs a unique index
             for (int i = 0; i < _totalParticles; i++)
             {
-                _particles[i].atlasIndex=i;
+                _particleData.atlasIndex[i] = i;
             }
         }
     }
@@ -27,6 +27,8 @@ THE SOFTWARE.
 #ifndef __CCPARTICLE_SYSTEM_H__
 #define __CCPARTICLE_SYSTEM_H__
 
+#include <random>
+
 #include "base/CCProtocols.h"
 #include "2d/CCNode.h"
 #include "base/CCValue.h"
@@ -40,48 +42,71 @@ NS_CC_BEGIN
 
 class ParticleBatchNode;
 
-/** @struct sParticle
-Structure that contains the values of each particle.
-*/
-typedef struct sParticle {
-    Vec2     pos;
-    Vec2     startPos;
-
-    Color4F    color;
-    Color4F    deltaColor;
-
-    float        size;
-    float        deltaSize;
-
-    float        rotation;
-    float        deltaRotation;
-
-    float        timeToLive;
-
-    unsigned int    atlasIndex;
-
-    /** @struct modeA
-     Mode A: gravity, direction, radial accel, tangential accel.
-     */
+/** @class ParticleData
+ * @brief The values of the particles of a ParticleSystem, stored as a structure of arrays.
+ * Each attribute is a contiguous array of getMaxCount() values, particle i is at index i of every array,
+ * so the system updates one attribute of all the particles in a tight loop.
+ */
+class CC_DLL ParticleData
+{
+public:
+    float* posx;
+    float* posy;
+    float* startPosX;
+    float* startPosY;
+
+    float* colorR;
+    float* colorG;
+    float* colorB;
+    float* colorA;
+
+    float* deltaColorR;
+    float* deltaColorG;
+    float* deltaColorB;
+    float* deltaColorA;
+
+    float* size;
+    float* deltaSize;
+    float* rotation;
+    float* deltaRotation;
+    float* timeToLive;
+    unsigned int* atlasIndex;
+
+    //! Mode A: gravity, direction, radial accel, tangential accel
     struct {
-        Vec2        dir;
-        float        radialAccel;
-        float        tangentialAccel;
+        float* dirX;
+        float* dirY;
+        float* radialAccel;
+        float* tangentialAccel;
     } modeA;
 
-    /** @struct modeB
-     Mode B: radius mode.
-     */
+    //! Mode B: radius mode
     struct {
-        float        angle;
-        float        degreesPerSecond;
-        float        radius;
-        float        deltaRadius;
+        float* angle;
+        float* degreesPerSecond;
+        float* radius;
+        float* deltaRadius;
     } modeB;
 
-}tParticle;
+    ParticleData();
+    ~ParticleData();
+
+    /** Allocates the arrays for count particles, set to 0. The previous values are released. */
+    bool init(int count);
+    /** Releases the arrays. */
+    void release();
+    unsigned int getMaxCount() const { return _maxCount; }
 
-//typedef void (*CC_UPDATE_PARTICLE_IMP)(id, SEL, tParticle*, Vec2);
+    /** Copies the values of the particle p2 to the particle p1. */
+    void copyParticle(int p1, int p2);
+
+private:
+    float* _data;
+    int _stride;
+    unsigned int _maxCount;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(ParticleData);
+};
 
 class Texture2D;
 
@@ -199,11 +224,11 @@ public:
      * @js ctor
      */
     bool addParticle();
-    /** Initializes a particle.
-     * 
-     * @param particle A given particle pointer.
+    /** Add particles to the emitter, they are initialized together.
+     *
+     * @param count The number of particles, it is clamped to the free room of the system.
      */
-    void initParticle(tParticle* particle);
+    void addParticles(int count);
     /** Stop emitting particles. Running particles will continue to run until they die.
      */
     void stopSystem();
@@ -216,13 +241,10 @@ public:
      */
     bool isFull();
 
-    /** Update the verts position data of particle,
+    /** Update the verts position data of all the living particles,
      should be overridden by subclasses. 
-     *
-     * @param particle A certain particle.
-     * @param newPosition A new position.
      */
-    virtual void updateQuadWithParticle(tParticle* particle, const Vec2& newPosition);
+    virtual void updateParticleQuads();
     /** Update the VBO verts buffer which does not use batch node,
      should be overridden by subclasses. */
     virtual void postStep();
@@ -696,6 +718,14 @@ public:
      * @param type The particles movement type.
      */
     inline void setPositionType(PositionType type) { _positionType = type; };
+
+    /** Seeds the random engine of the system, the same seed emits the same particles.
+     * By default each system is seeded from cocos2d::random() when it is created,
+     * use RandomHelper::seed() to make all the systems reproducible.
+     *
+     * @param seed The seed.
+     */
+    void setRandomSeed(unsigned int seed);
     
     // Overrides
     virtual void onEnter() override;
@@ -751,8 +781,22 @@ CC_CONSTRUCTOR_ACCESS:
     virtual bool initWithTotalParticles(int numberOfParticles);
 
 protected:
+    friend class ParticleSystemManager;
+
     virtual void updateBlendFunc();
 
+    // reads the emitter position and transform, it must be called from the main thread before simulate()
+    void updateEmitterTransform();
+    // initializes count new particles
+    void emitParticles(int count);
+    // emits, moves and removes the particles and fills the quads, returns true if the system must be auto removed
+    // without a batch node it only touches the system's own data, so systems can be simulated in parallel,
+    // batched systems write the quads of the batch node's atlas and are simulated on the main thread
+    bool simulate(float dt);
+    // main thread part of update(): uploads the quads, or removes the system
+    void finishUpdate(bool removeSystem);
+    float randomMinus1To1();
+
     /** whether or not the particles are using blend additive.
      If enabled, the following blending function will be used.
      @code
@@ -809,8 +853,15 @@ protected:
         float rotatePerSecondVar;
     } modeB;
 
-    //! Array of particles
-    tParticle *_particles;
+    //! Values of the particles
+    ParticleData _particleData;
+
+    //! random engine of the system, particles don't use std::rand so they can be emitted from any thread
+    std::minstd_rand _randomEngine;
+    //! emitter position, in world space for free particles or in parent space for relative ones
+    Vec2 _emitterPosition;
+    //! world to node transform of the emitter, only used for free particles
+    Mat4 _worldToNodeTransform;
 
     //Emitter name
     std::string _configName;
@@ -821,9 +872,6 @@ protected:
     //! How many particles can be emitted per second
     float _emitCounter;
 
-    //!  particle idx
-    int _particleIdx;
-
     // Optimization
     //CC_UPDATE_PARTICLE_IMP    updateParticleImp;
     //SEL                        updateParticleSel;
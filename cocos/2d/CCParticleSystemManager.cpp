@@ -0,0 +1,162 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "2d/CCParticleSystemManager.h"
+#include "2d/CCParticleSystem.h"
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCJobPool.h"
+
+NS_CC_BEGIN
+
+ParticleSystemManager* ParticleSystemManager::s_sharedManager = nullptr;
+
+ParticleSystemManager* ParticleSystemManager::getInstance()
+{
+    if (s_sharedManager == nullptr)
+    {
+        s_sharedManager = new (std::nothrow) ParticleSystemManager();
+    }
+    return s_sharedManager;
+}
+
+void ParticleSystemManager::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedManager);
+}
+
+ParticleSystemManager::ParticleSystemManager()
+: _enabled(false)
+, _simulatedSystemCount(0)
+, _afterUpdateListener(nullptr)
+{
+}
+
+ParticleSystemManager::~ParticleSystemManager()
+{
+    setEnabled(false);
+}
+
+void ParticleSystemManager::setEnabled(bool enabled)
+{
+    if (_enabled == enabled)
+    {
+        return;
+    }
+
+    if (enabled)
+    {
+        _afterUpdateListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [this](EventCustom* /*event*/){
+            simulateSystems();
+        });
+        _enabled = true;
+    }
+    else
+    {
+        simulateSystems();
+        _enabled = false;
+        if (_afterUpdateListener)
+        {
+            Director::getInstance()->getEventDispatcher()->removeEventListener(_afterUpdateListener);
+            _afterUpdateListener = nullptr;
+        }
+    }
+}
+
+void ParticleSystemManager::scheduleSystem(ParticleSystem* system, float dt)
+{
+    // a system updated twice in a tick is simulated once, over both steps, so no two threads share a system
+    auto found = _jobIndices.find(system);
+    if (found != _jobIndices.end())
+    {
+        _jobs[found->second].dt += dt;
+        return;
+    }
+
+    // released once the main thread has finished its update
+    system->retain();
+    _jobIndices[system] = _jobs.size();
+
+    Job job;
+    job.system = system;
+    job.dt = dt;
+    job.removeSystem = false;
+    job.mainThread = false;
+    job.skip = false;
+    _jobs.push_back(job);
+}
+
+void ParticleSystemManager::simulateSystems()
+{
+    if (_jobs.empty())
+    {
+        _simulatedSystemCount = 0;
+        return;
+    }
+
+    // a system can be removed later in the tick it was queued in
+    _simulatedSystemCount = 0;
+    for (auto& job : _jobs)
+    {
+        job.skip = !job.system->isRunning() || job.system->getParent() == nullptr;
+        // the quads of batched systems are in the atlas of the batch node, which the systems share
+        job.mainThread = job.system->getBatchNode() != nullptr;
+        if (!job.skip)
+        {
+            ++_simulatedSystemCount;
+        }
+    }
+
+    JobPool::getInstance()->parallelFor(static_cast<int>(_jobs.size()), [this](int index) {
+        auto& job = _jobs[index];
+        if (!job.mainThread && !job.skip)
+        {
+            job.removeSystem = job.system->simulate(job.dt);
+        }
+    });
+
+    for (auto& job : _jobs)
+    {
+        if (job.mainThread && !job.skip)
+        {
+            job.removeSystem = job.system->simulate(job.dt);
+        }
+    }
+
+    // systems may remove themselves, or others, so the queue is swapped out first
+    std::vector<Job> jobs;
+    jobs.swap(_jobs);
+    _jobIndices.clear();
+    for (auto& job : jobs)
+    {
+        if (!job.skip && job.system->isRunning() && job.system->getParent())
+        {
+            job.system->finishUpdate(job.removeSystem);
+        }
+        job.system->release();
+    }
+}
+
+NS_CC_END
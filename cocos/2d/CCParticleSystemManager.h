@@ -0,0 +1,111 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCPARTICLE_SYSTEM_MANAGER_H__
+#define __CCPARTICLE_SYSTEM_MANAGER_H__
+
+#include <vector>
+#include <unordered_map>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+class ParticleSystem;
+class EventListenerCustom;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class ParticleSystemManager
+ * @brief Simulates the particle systems of a frame in parallel, as jobs of the shared JobPool.
+ *
+ * When it is enabled, ParticleSystem::update() only reads the emitter transform and queues the system.
+ * Once the scheduler update is done (Director::EVENT_AFTER_UPDATE), the queued systems are simulated
+ * by the JobPool worker threads and the main thread, quads included, and the manager waits for them before
+ * the scene is visited. Uploading the vertex buffers and auto removing finished systems stay on the main thread,
+ * and so does the simulation of systems in a ParticleBatchNode, whose quads are in the shared atlas of the batch node.
+ * Systems removed from the scene after they were queued are skipped.
+ *
+ * Each system emits particles with its own random engine, so the output doesn't depend on which
+ * thread simulated it. Seed them with ParticleSystem::setRandomSeed() or RandomHelper::seed().
+ * It is disabled by default.
+ */
+class CC_DLL ParticleSystemManager
+{
+public:
+    /** Returns the shared instance of the manager. */
+    static ParticleSystemManager* getInstance();
+
+    /** Destroys the shared instance. */
+    static void destroyInstance();
+
+    /** Enables or disables the parallel simulation. Queued systems are simulated before it is disabled. */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return _enabled; }
+
+    /** Queues a system for this frame, it is called by ParticleSystem::update().
+     * A system queued again in the same frame is simulated once, with the sum of the steps.
+     */
+    void scheduleSystem(ParticleSystem* system, float dt);
+
+    /** Simulates the queued systems and waits for them. It is called after the scheduler update. */
+    void simulateSystems();
+
+    /** Number of systems simulated by the last simulateSystems(). */
+    int getSimulatedSystemCount() const { return _simulatedSystemCount; }
+
+protected:
+    struct Job
+    {
+        ParticleSystem* system;
+        float dt;
+        bool removeSystem;
+        // simulated on the main thread, or not at all if the system left the scene
+        bool mainThread;
+        bool skip;
+    };
+
+    ParticleSystemManager();
+    ~ParticleSystemManager();
+
+    bool _enabled;
+    int _simulatedSystemCount;
+    std::vector<Job> _jobs;
+    // index of each queued system in _jobs
+    std::unordered_map<ParticleSystem*, size_t> _jobIndices;
+
+    EventListenerCustom* _afterUpdateListener;
+
+    static ParticleSystemManager* s_sharedManager;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCPARTICLE_SYSTEM_MANAGER_H__
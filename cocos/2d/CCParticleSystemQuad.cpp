@@ -263,93 +263,137 @@ void ParticleSystemQuad::initIndices()
     }
 }
 
-void ParticleSystemQuad::updateQuadWithParticle(tParticle* particle, const Vec2& newPosition)
+void ParticleSystemQuad::updateParticleQuads()
 {
-    V3F_C4B_T2F_Quad *quad;
+    if (_particleCount <= 0)
+    {
+        return;
+    }
 
+    // set by updateEmitterTransform() on the main thread
+    const Vec2& currentPosition = _emitterPosition;
+
+    V3F_C4B_T2F_Quad *startQuad;
+    Vec2 offset;
     if (_batchNode)
     {
         V3F_C4B_T2F_Quad *batchQuads = _batchNode->getTextureAtlas()->getQuads();
-        quad = &(batchQuads[_atlasIndex+particle->atlasIndex]);
+        startQuad = &(batchQuads[_atlasIndex]);
+
+        // translate newPos to correct position, since matrix transform isn't performed in batchnode
+        offset = _position;
     }
     else
     {
-        quad = &(_quads[_particleIdx]);
+        startQuad = _quads;
     }
-    Color4B color = (_opacityModifyRGB)
-        ? Color4B( particle->color.r*particle->color.a*255, particle->color.g*particle->color.a*255, particle->color.b*particle->color.a*255, particle->color.a*255)
-        : Color4B( particle->color.r*255, particle->color.g*255, particle->color.b*255, particle->color.a*255);
 
-    quad->bl.colors = color;
-    quad->br.colors = color;
-    quad->tl.colors = color;
-    quad->tr.colors = color;
-
-    // vertices
-    GLfloat size_2 = particle->size/2;
-    if (particle->rotation) 
+    const float* posx = _particleData.posx;
+    const float* posy = _particleData.posy;
+    const float* startPosX = _particleData.startPosX;
+    const float* startPosY = _particleData.startPosY;
+    const float* size = _particleData.size;
+    const float* rotation = _particleData.rotation;
+    const float* colorR = _particleData.colorR;
+    const float* colorG = _particleData.colorG;
+    const float* colorB = _particleData.colorB;
+    const float* colorA = _particleData.colorA;
+    const float* m = _worldToNodeTransform.m;
+
+    for (int i = 0; i < _particleCount; ++i)
     {
-        GLfloat x1 = -size_2;
-        GLfloat y1 = -size_2;
-
-        GLfloat x2 = size_2;
-        GLfloat y2 = size_2;
-        GLfloat x = newPosition.x;
-        GLfloat y = newPosition.y;
-
-        GLfloat r = (GLfloat)-CC_DEGREES_TO_RADIANS(particle->rotation);
-        GLfloat cr = cosf(r);
-        GLfloat sr = sinf(r);
-        GLfloat ax = x1 * cr - y1 * sr + x;
-        GLfloat ay = x1 * sr + y1 * cr + y;
-        GLfloat bx = x2 * cr - y1 * sr + x;
-        GLfloat by = x2 * sr + y1 * cr + y;
-        GLfloat cx = x2 * cr - y2 * sr + x;
-        GLfloat cy = x2 * sr + y2 * cr + y;
-        GLfloat dx = x1 * cr - y2 * sr + x;
-        GLfloat dy = x1 * sr + y2 * cr + y;
-
-        // bottom-left
-        quad->bl.vertices.x = ax;
-        quad->bl.vertices.y = ay;
+        V3F_C4B_T2F_Quad *quad = _batchNode ? startQuad + _particleData.atlasIndex[i] : startQuad + i;
 
-        // bottom-right vertex:
-        quad->br.vertices.x = bx;
-        quad->br.vertices.y = by;
+        // the world to node transform is affine, only its linear part applies to the emitter movement
+        GLfloat x = posx[i] + offset.x;
+        GLfloat y = posy[i] + offset.y;
+        if (_positionType == PositionType::FREE)
+        {
+            GLfloat diffX = currentPosition.x - startPosX[i];
+            GLfloat diffY = currentPosition.y - startPosY[i];
+            x -= m[0] * diffX + m[4] * diffY;
+            y -= m[1] * diffX + m[5] * diffY;
+        }
+        else if (_positionType == PositionType::RELATIVE)
+        {
+            x -= currentPosition.x - startPosX[i];
+            y -= currentPosition.y - startPosY[i];
+        }
 
-        // top-left vertex:
-        quad->tl.vertices.x = dx;
-        quad->tl.vertices.y = dy;
+        Color4B color = (_opacityModifyRGB)
+            ? Color4B( colorR[i]*colorA[i]*255, colorG[i]*colorA[i]*255, colorB[i]*colorA[i]*255, colorA[i]*255)
+            : Color4B( colorR[i]*255, colorG[i]*255, colorB[i]*255, colorA[i]*255);
 
-        // top-right vertex:
-        quad->tr.vertices.x = cx;
-        quad->tr.vertices.y = cy;
-    } 
-    else 
-    {
-        // bottom-left vertex:
-        quad->bl.vertices.x = newPosition.x - size_2;
-        quad->bl.vertices.y = newPosition.y - size_2;
+        quad->bl.colors = color;
+        quad->br.colors = color;
+        quad->tl.colors = color;
+        quad->tr.colors = color;
 
-        // bottom-right vertex:
-        quad->br.vertices.x = newPosition.x + size_2;
-        quad->br.vertices.y = newPosition.y - size_2;
+        // vertices
+        GLfloat size_2 = size[i]/2;
+        if (rotation[i]) 
+        {
+            GLfloat x1 = -size_2;
+            GLfloat y1 = -size_2;
+
+            GLfloat x2 = size_2;
+            GLfloat y2 = size_2;
+
+            GLfloat r = (GLfloat)-CC_DEGREES_TO_RADIANS(rotation[i]);
+            GLfloat cr = cosf(r);
+            GLfloat sr = sinf(r);
+            GLfloat ax = x1 * cr - y1 * sr + x;
+            GLfloat ay = x1 * sr + y1 * cr + y;
+            GLfloat bx = x2 * cr - y1 * sr + x;
+            GLfloat by = x2 * sr + y1 * cr + y;
+            GLfloat cx = x2 * cr - y2 * sr + x;
+            GLfloat cy = x2 * sr + y2 * cr + y;
+            GLfloat dx = x1 * cr - y2 * sr + x;
+            GLfloat dy = x1 * sr + y2 * cr + y;
+
+            // bottom-left
+            quad->bl.vertices.x = ax;
+            quad->bl.vertices.y = ay;
+
+            // bottom-right vertex:
+            quad->br.vertices.x = bx;
+            quad->br.vertices.y = by;
+
+            // top-left vertex:
+            quad->tl.vertices.x = dx;
+            quad->tl.vertices.y = dy;
+
+            // top-right vertex:
+            quad->tr.vertices.x = cx;
+            quad->tr.vertices.y = cy;
+        } 
+        else 
+        {
+            // bottom-left vertex:
+            quad->bl.vertices.x = x - size_2;
+            quad->bl.vertices.y = y - size_2;
 
-        // top-left vertex:
-        quad->tl.vertices.x = newPosition.x - size_2;
-        quad->tl.vertices.y = newPosition.y + size_2;
+            // bottom-right vertex:
+            quad->br.vertices.x = x + size_2;
+            quad->br.vertices.y = y - size_2;
 
-        // top-right vertex:
-        quad->tr.vertices.x = newPosition.x + size_2;
-        quad->tr.vertices.y = newPosition.y + size_2;                
+            // top-left vertex:
+            quad->tl.vertices.x = x - size_2;
+            quad->tl.vertices.y = y + size_2;
+
+            // top-right vertex:
+            quad->tr.vertices.x = x + size_2;
+            quad->tr.vertices.y = y + size_2;
+        }
     }
 }
+
 void ParticleSystemQuad::postStep()
 {
     glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
     
     // Option 1: Sub Data
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(_quads[0])*_totalParticles, _quads);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(_quads[0])*_particleCount, _quads);
     
     // Option 2: Data
     //  glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * particleCount, quads_, GL_DYNAMIC_DRAW);
@@ -368,11 +412,10 @@ void ParticleSystemQuad::postStep()
 // overriding draw method
 void ParticleSystemQuad::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
-    CCASSERT( _particleIdx == 0 || _particleIdx == _particleCount, "Abnormal error in particle quad");
     //quad command
-    if(_particleIdx > 0)
+    if(_particleCount > 0)
     {
-        _quadCommand.init(_globalZOrder, _texture->getName(), getGLProgramState(), _blendFunc, _quads, _particleIdx, transform, flags);
+        _quadCommand.init(_globalZOrder, _texture->getName(), getGLProgramState(), _blendFunc, _quads, _particleCount, transform, flags);
         renderer->addCommand(&_quadCommand);
     }
 }
@@ -384,23 +427,20 @@ void ParticleSystemQuad::setTotalParticles(int tp)
     if( tp > _allocatedParticles )
     {
         // Allocate new memory
-        size_t particlesSize = tp * sizeof(tParticle);
         size_t quadsSize = sizeof(_quads[0]) * tp * 1;
         size_t indicesSize = sizeof(_indices[0]) * tp * 6 * 1;
 
-        tParticle* particlesNew = (tParticle*)realloc(_particles, particlesSize);
+        bool particlesAllocated = _particleData.init(tp);
         V3F_C4B_T2F_Quad* quadsNew = (V3F_C4B_T2F_Quad*)realloc(_quads, quadsSize);
         GLushort* indicesNew = (GLushort*)realloc(_indices, indicesSize);
 
-        if (particlesNew && quadsNew && indicesNew)
+        if (particlesAllocated && quadsNew && indicesNew)
         {
             // Assign pointers
-            _particles = particlesNew;
             _quads = quadsNew;
             _indices = indicesNew;
 
             // Clear the memory
-            memset(_particles, 0, particlesSize);
             memset(_quads, 0, quadsSize);
             memset(_indices, 0, indicesSize);
             
@@ -409,9 +449,15 @@ void ParticleSystemQuad::setTotalParticles(int tp)
         else
         {
             // Out of memory, failed to resize some array
-            if (particlesNew) _particles = particlesNew;
             if (quadsNew) _quads = quadsNew;
             if (indicesNew) _indices = indicesNew;
+            if (!particlesAllocated)
+            {
+                // the particle data was released
+                _particleCount = 0;
+                _totalParticles = 0;
+                _allocatedParticles = 0;
+            }
 
             CCLOG("Particle system: out of memory");
             return;
@@ -424,7 +470,7 @@ void ParticleSystemQuad::setTotalParticles(int tp)
         {
             for (int i = 0; i < _totalParticles; i++)
             {
-                _particles[i].atlasIndex=i;
+                _particleData.atlasIndex[i] = i;
             }
         }
 
@@ -32,6 +32,9 @@ THE SOFTWARE.
 #include "base/CCEventListenerCustom.h"
 #include "renderer/CCRenderer.h"
 #include "renderer/CCFrameBuffer.h"
+#include "3d/CCAABBTree.h"
+#include "3d/CCOcclusionCuller.h"
+#include "3d/CCSprite3D.h"
 #include "deprecated/CCString.h"
 
 #if CC_USE_PHYSICS
@@ -50,8 +53,12 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 Scene::Scene()
+: _spatialIndex(nullptr)
+, _spatialIndexGeneration(0)
+, _culledCamera(nullptr)
+, _cullStamp(0)
 #if CC_USE_PHYSICS
-: _physicsWorld(nullptr)
+, _physicsWorld(nullptr)
 #endif
 {
 #if CC_USE_3D_PHYSICS && CC_ENABLE_BULLET_INTEGRATION
@@ -91,6 +98,84 @@ Scene::~Scene()
 #endif
     Director::getInstance()->getEventDispatcher()->removeEventListener(_event);
     CC_SAFE_RELEASE(_event);
+    CC_SAFE_DELETE(_spatialIndex);
+}
+
+void Scene::setSpatialIndexEnabled(bool enabled)
+{
+    if (enabled == (_spatialIndex != nullptr))
+        return;
+    
+    if (enabled)
+    {
+        // the nodes add themselves when they are visited
+        _spatialIndex = new (std::nothrow) AABBTree();
+    }
+    else
+    {
+        CC_SAFE_DELETE(_spatialIndex);
+        _proxyCullStamps.clear();
+        _visibleNodes.clear();
+        ++_spatialIndexGeneration;
+    }
+}
+
+const std::vector<Node*>& Scene::cullSpatialIndex(const Camera* camera)
+{
+    _visibleNodes.clear();
+    if (_spatialIndex == nullptr)
+        return _visibleNodes;
+    
+    _culledProxies.clear();
+    _spatialIndex->query(camera->getFrustum(), _culledProxies);
+    
+    ++_cullStamp;
+    for (auto proxy : _culledProxies)
+    {
+        _proxyCullStamps[proxy] = _cullStamp;
+        _visibleNodes.push_back(static_cast<Node*>(_spatialIndex->getUserData(proxy)));
+    }
+    return _visibleNodes;
+}
+
+void Scene::updateSpatialIndex(Node* node, SpatialIndexEntry& entry, const AABB& aabb)
+{
+    if (_spatialIndex == nullptr)
+        return;
+    
+    if (isInSpatialIndex(entry))
+    {
+        // the result of the last cull is stale if the proxy is reinserted
+        if (_spatialIndex->moveProxy(entry.proxy, aabb))
+            entry.cullStamp = _cullStamp;
+    }
+    else if (!aabb.isEmpty())
+    {
+        entry.proxy = _spatialIndex->createProxy(aabb, node);
+        entry.generation = _spatialIndexGeneration;
+        entry.cullStamp = _cullStamp;
+        if (entry.proxy >= (int)_proxyCullStamps.size())
+            _proxyCullStamps.resize(entry.proxy + 1, 0);
+        _proxyCullStamps[entry.proxy] = 0;
+    }
+}
+
+void Scene::removeFromSpatialIndex(SpatialIndexEntry& entry)
+{
+    if (isInSpatialIndex(entry))
+    {
+        _spatialIndex->destroyProxy(entry.proxy);
+    }
+    entry.proxy = -1;
+}
+
+bool Scene::getSpatialIndexVisibility(const SpatialIndexEntry& entry, const Camera* camera, bool* visible) const
+{
+    if (!isInSpatialIndex(entry) || camera != _culledCamera || entry.cullStamp >= _cullStamp)
+        return false;
+    
+    *visible = (_proxyCullStamps[entry.proxy] == _cullStamp);
+    return true;
 }
 
 #if CC_USE_NAVMESH
@@ -175,6 +260,37 @@ const std::vector<Camera*>& Scene::getCameras()
     return _cameras;
 }
 
+// a node is drawn only if it and all its ancestors are visible
+static bool isVisibleInScene(const Node* node)
+{
+    for (; node; node = node->getParent())
+    {
+        if (!node->isVisible())
+            return false;
+    }
+    return true;
+}
+
+void Scene::rasterizeOccluders(const Camera* camera)
+{
+    auto culler = camera->getOcclusionCuller();
+    if (culler == nullptr)
+        return;
+    
+    culler->begin(camera->getViewProjectionMatrix());
+    for (const auto& occluder : _occluders)
+    {
+        if (!((unsigned short)camera->getCameraFlag() & occluder->getCameraMask()) || !isVisibleInScene(occluder))
+            continue;
+        if (!camera->isVisibleInFrustum(&occluder->getAABB()))
+            continue;
+        
+        const auto& positions = occluder->getOccluderPositions();
+        const auto& indices = occluder->getOccluderIndices();
+        culler->addOccluder(&positions[0], (int)positions.size(), &indices[0], (int)indices.size(), occluder->getNodeToWorldTransform());
+    }
+}
+
 void Scene::render(Renderer* renderer)
 {
     auto director = Director::getInstance();
@@ -197,6 +313,17 @@ void Scene::render(Renderer* renderer)
         camera->apply();
         //clear background with max depth
         camera->clearBackground();
+        //cull the spatial index for the nodes visited below
+        if (_spatialIndex)
+        {
+            cullSpatialIndex(camera);
+            _culledCamera = camera;
+        }
+        //rasterize the occluders for the occlusion tests of the nodes visited below
+        if (camera->getOcclusionCuller())
+        {
+            rasterizeOccluders(camera);
+        }
         //visit the scene
         visit(renderer, transform, 0);
 #if CC_USE_NAVMESH
@@ -223,6 +350,7 @@ void Scene::render(Renderer* renderer)
 #endif
 
     Camera::_visitingCamera = nullptr;
+    _culledCamera = nullptr;
     experimental::FrameBuffer::applyDefaultFBO();
 }
 
@@ -35,6 +35,9 @@ NS_CC_BEGIN
 
 class Camera;
 class BaseLight;
+class AABB;
+class AABBTree;
+class Sprite3D;
 class Renderer;
 class EventListenerCustom;
 class EventCustom;
@@ -53,6 +56,26 @@ class NavMesh;
  * @{
  */
 
+/** @brief The entry of a node in the spatial index of its scene, see Scene::setSpatialIndexEnabled().
+ * Sprite3D and BillBoard keep one and update it when they are visited.
+ */
+struct SpatialIndexEntry
+{
+    Scene* scene; // weak ref, set while the node is running in a scene
+    int proxy;
+    // the index the proxy belongs to, and the cull after which it was last reinserted
+    unsigned int generation;
+    unsigned int cullStamp;
+    
+    SpatialIndexEntry()
+    : scene(nullptr)
+    , proxy(-1)
+    , generation(0)
+    , cullStamp(0)
+    {
+    }
+};
+
 /** @class Scene
 * @brief Scene is a subclass of Node that is used only as an abstract concept.
 
@@ -114,6 +137,56 @@ public:
     /** override function */
     virtual void removeAllChildren() override;
     
+    /** Enables a spatial index of the Sprite3Ds and BillBoards of the scene, disabled by default.
+     * The index is a dynamic AABB tree of their world bounds, updated when they are visited with a dirty transform.
+     * Before each camera visits the scene, render() culls the tree, rejecting whole subtrees at once, and the
+     * nodes use the result instead of testing their own bounds against the frustum.
+     * It pays off for scenes with many 3D objects, e.g. open worlds.
+     */
+    void setSpatialIndexEnabled(bool enabled);
+    bool isSpatialIndexEnabled() const { return _spatialIndex != nullptr; }
+    
+    /** Get the spatial index, nullptr if it is disabled.
+     * @js NA
+     */
+    AABBTree* getSpatialIndex() const { return _spatialIndex; }
+    
+    /** Culls the spatial index with the frustum of camera, render() calls it for each camera.
+     * @return The nodes which may be visible by camera, valid until the next call or until nodes leave the scene.
+     * @js NA
+     */
+    const std::vector<Node*>& cullSpatialIndex(const Camera* camera);
+    
+    /** Adds the node to the spatial index or updates its bounds, called by the nodes of the index when they are visited.
+     * @js NA
+     */
+    void updateSpatialIndex(Node* node, SpatialIndexEntry& entry, const AABB& aabb);
+    
+    /** Removes the node from the spatial index.
+     * @js NA
+     */
+    void removeFromSpatialIndex(SpatialIndexEntry& entry);
+    
+    /** Returns true if the node is in the spatial index. */
+    bool isInSpatialIndex(const SpatialIndexEntry& entry) const { return _spatialIndex && entry.proxy >= 0 && entry.generation == _spatialIndexGeneration; }
+    
+    /** Gets whether the last cull found the node visible by camera.
+     * @return false if the last cull wasn't done for camera, or the node moved since, so it must be tested by itself.
+     * @js NA
+     */
+    bool getSpatialIndexVisibility(const SpatialIndexEntry& entry, const Camera* camera, bool* visible) const;
+    
+    /** Get the occluders, the Sprite3Ds of the scene with an occluder mesh.
+     * @js NA
+     */
+    const std::vector<Sprite3D*>& getOccluders() const { return _occluders; }
+    
+    /** Rasterizes the occluders visible by camera into its occlusion culler, render() calls it for each camera
+     * with occlusion culling enabled, see Camera::setOcclusionCullingEnabled().
+     * @js NA
+     */
+    void rasterizeOccluders(const Camera* camera);
+    
 CC_CONSTRUCTOR_ACCESS:
     Scene();
     virtual ~Scene();
@@ -132,6 +205,7 @@ protected:
     friend class Camera;
     friend class BaseLight;
     friend class Renderer;
+    friend class Sprite3D;
     
     std::vector<Camera*> _cameras; //weak ref to Camera
     Camera*              _defaultCamera; //weak ref, default camera created by scene, _cameras[0], Caution that the default camera can not be added to _cameras before onEnter is called
@@ -140,6 +214,16 @@ protected:
 
     std::vector<BaseLight *> _lights;
     
+    AABBTree*            _spatialIndex;
+    unsigned int         _spatialIndexGeneration; // incremented when the index is disabled, invalidating the entries
+    const Camera*        _culledCamera; // weak ref, the camera of the last cull while rendering
+    unsigned int         _cullStamp; // incremented by each cull
+    std::vector<unsigned int> _proxyCullStamps; // last cull which found the proxy visible
+    std::vector<int>     _culledProxies;
+    std::vector<Node*>   _visibleNodes;
+    
+    std::vector<Sprite3D*> _occluders; // weak ref
+    
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Scene);
     
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCSpriteFrameCache.h"
 #include "renderer/CCTextureCache.h"
+#include "renderer/CCDynamicAtlas.h"
 #include "renderer/CCTexture2D.h"
 #include "renderer/CCRenderer.h"
 #include "base/CCDirector.h"
@@ -166,7 +167,17 @@ bool Sprite::initWithFile(const std::string& filename)
 {
     CCASSERT(filename.size()>0, "Invalid filename for sprite");
 
-    Texture2D *texture = Director::getInstance()->getTextureCache()->addImage(filename);
+    auto textureCache = Director::getInstance()->getTextureCache();
+    if (textureCache->isDynamicAtlasEnabled())
+    {
+        SpriteFrame *frame = textureCache->getDynamicAtlas()->addImage(filename);
+        if (frame)
+        {
+            return initWithSpriteFrame(frame);
+        }
+    }
+
+    Texture2D *texture = textureCache->addImage(filename);
     if (texture)
     {
         Rect rect = Rect::ZERO;
@@ -50,6 +50,112 @@ NS_CC_BEGIN
 
 static SpriteFrameCache *_sharedSpriteFrameCache = nullptr;
 
+namespace
+{
+    // Binary sprite frames, written by tools/spriteframe/convert_plist_to_binary.py.
+    // Little endian, laid out as: header, frames, aliases, string table.
+    // Strings are referenced by offset into the string table and are null terminated.
+    static const char SPRITE_FRAMES_MAGIC[4] = { 'C', 'C', 'S', 'F' };
+    static const uint32_t SPRITE_FRAMES_VERSION = 1;
+    static const uint32_t SPRITE_FRAMES_NO_STRING = 0xffffffff;
+
+    struct SpriteFramesHeader
+    {
+        char     magic[4];
+        uint32_t version;
+        uint32_t frameCount;
+        uint32_t aliasCount;
+        uint32_t stringTableOffset;
+        uint32_t stringTableSize;
+        uint32_t textureFileName;
+        uint32_t reserved;
+    };
+
+    // the values are the ones passed to SpriteFrame::createWithTexture, whatever the plist format was
+    struct SpriteFramesFrame
+    {
+        uint32_t name;
+        float    x;
+        float    y;
+        float    width;
+        float    height;
+        float    offsetX;
+        float    offsetY;
+        float    originalWidth;
+        float    originalHeight;
+        uint32_t rotated;
+    };
+
+    struct SpriteFramesAlias
+    {
+        uint32_t name;
+        uint32_t frameIndex;
+    };
+
+    // returns the header if data is valid binary sprite frames
+    const SpriteFramesHeader* getSpriteFramesHeader(const Data& data)
+    {
+        if (data.getSize() < static_cast<ssize_t>(sizeof(SpriteFramesHeader)))
+        {
+            return nullptr;
+        }
+
+        auto header = reinterpret_cast<const SpriteFramesHeader*>(data.getBytes());
+        if (memcmp(header->magic, SPRITE_FRAMES_MAGIC, sizeof(SPRITE_FRAMES_MAGIC)) != 0)
+        {
+            return nullptr;
+        }
+        if (header->version != SPRITE_FRAMES_VERSION)
+        {
+            CCLOG("cocos2d: SpriteFrameCache: unsupported binary sprite frames version %u", header->version);
+            return nullptr;
+        }
+
+        // every count is checked against the bytes left, so nothing below can overflow
+        size_t remaining = static_cast<size_t>(data.getSize()) - sizeof(SpriteFramesHeader);
+        bool valid = header->frameCount <= remaining / sizeof(SpriteFramesFrame);
+        if (valid)
+        {
+            remaining -= header->frameCount * sizeof(SpriteFramesFrame);
+            valid = header->aliasCount <= remaining / sizeof(SpriteFramesAlias);
+        }
+        if (valid)
+        {
+            remaining -= header->aliasCount * sizeof(SpriteFramesAlias);
+            size_t tablesSize = static_cast<size_t>(data.getSize()) - remaining;
+            valid = header->stringTableOffset >= tablesSize
+                && header->stringTableOffset <= static_cast<size_t>(data.getSize())
+                && header->stringTableSize != 0
+                && header->stringTableSize <= static_cast<size_t>(data.getSize()) - header->stringTableOffset
+                && data.getBytes()[header->stringTableOffset + header->stringTableSize - 1] == 0;
+        }
+        if (!valid)
+        {
+            CCLOG("cocos2d: SpriteFrameCache: corrupted binary sprite frames");
+            return nullptr;
+        }
+        return header;
+    }
+
+    const char* getSpriteFramesString(const Data& data, const SpriteFramesHeader* header, uint32_t offset)
+    {
+        if (offset >= header->stringTableSize)
+        {
+            return nullptr;
+        }
+        return reinterpret_cast<const char*>(data.getBytes() + header->stringTableOffset + offset);
+    }
+
+    ValueMap getValueMapFromPlistData(const Data& data)
+    {
+        if (data.isNull())
+        {
+            return ValueMap();
+        }
+        return FileUtils::getInstance()->getValueMapFromData(reinterpret_cast<const char*>(data.getBytes()), static_cast<int>(data.getSize()));
+    }
+}
+
 SpriteFrameCache* SpriteFrameCache::getInstance()
 {
     if (! _sharedSpriteFrameCache)
@@ -104,9 +210,8 @@ void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, Textu
     // check the format
     CCASSERT(format >=0 && format <= 3, "format is not supported for SpriteFrameCache addSpriteFramesWithDictionary:textureFilename:");
 
-    auto textureFileName = Director::getInstance()->getTextureCache()->getTextureFilePath(texture);
-    auto image = new Image();
-    image->initWithImageFile(textureFileName);
+    // the texture image is only decoded again if a 9-patch frame needs parsing
+    Image* image = nullptr;
     NinePatchImageParser parser;
     for (auto iter = framesDict.begin(); iter != framesDict.end(); ++iter)
     {
@@ -199,6 +304,11 @@ void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, Textu
         bool flag = NinePatchImageParser::isNinePatchImage(spriteFrameName);
         if(flag)
         {
+            if (image == nullptr)
+            {
+                image = new Image();
+                image->initWithImageFile(Director::getInstance()->getTextureCache()->getTextureFilePath(texture));
+            }
             parser.setSpriteFrameInfo(image, spriteFrame->getRectInPixels(), spriteFrame->isRotated());
             texture->addSpriteFrameCapInset(spriteFrame, parser.parseCapInset());
         }
@@ -208,6 +318,115 @@ void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, Textu
     CC_SAFE_DELETE(image);
 }
 
+bool SpriteFrameCache::addSpriteFramesWithBinaryData(const Data& data, Texture2D* texture)
+{
+    const SpriteFramesHeader* header = getSpriteFramesHeader(data);
+    if (header == nullptr)
+    {
+        return false;
+    }
+
+    auto frames = reinterpret_cast<const SpriteFramesFrame*>(data.getBytes() + sizeof(SpriteFramesHeader));
+    auto aliases = reinterpret_cast<const SpriteFramesAlias*>(frames + header->frameCount);
+
+    _spriteFrames.reserve(_spriteFrames.size() + header->frameCount);
+
+    // aliases are only added for frames which are in the cache
+    std::vector<bool> frameLoaded(header->frameCount, false);
+    Image* image = nullptr;
+    NinePatchImageParser parser;
+    for (uint32_t i = 0; i < header->frameCount; ++i)
+    {
+        const SpriteFramesFrame& frame = frames[i];
+        const char* name = getSpriteFramesString(data, header, frame.name);
+        if (name == nullptr)
+        {
+            CCLOG("cocos2d: SpriteFrameCache: corrupted binary sprite frame %u", i);
+            continue;
+        }
+        frameLoaded[i] = true;
+
+        std::string spriteFrameName(name);
+        if (_spriteFrames.at(spriteFrameName))
+        {
+            continue;
+        }
+
+        SpriteFrame* spriteFrame = SpriteFrame::createWithTexture(texture,
+                                                                  Rect(frame.x, frame.y, frame.width, frame.height),
+                                                                  frame.rotated != 0,
+                                                                  Vec2(frame.offsetX, frame.offsetY),
+                                                                  Size(frame.originalWidth, frame.originalHeight));
+
+        if (NinePatchImageParser::isNinePatchImage(spriteFrameName))
+        {
+            if (image == nullptr)
+            {
+                image = new Image();
+                image->initWithImageFile(Director::getInstance()->getTextureCache()->getTextureFilePath(texture));
+            }
+            parser.setSpriteFrameInfo(image, spriteFrame->getRectInPixels(), spriteFrame->isRotated());
+            texture->addSpriteFrameCapInset(spriteFrame, parser.parseCapInset());
+        }
+        _spriteFrames.insert(spriteFrameName, spriteFrame);
+    }
+    CC_SAFE_DELETE(image);
+
+    for (uint32_t i = 0; i < header->aliasCount; ++i)
+    {
+        const char* alias = getSpriteFramesString(data, header, aliases[i].name);
+        const char* name = aliases[i].frameIndex < header->frameCount && frameLoaded[aliases[i].frameIndex]
+            ? getSpriteFramesString(data, header, frames[aliases[i].frameIndex].name) : nullptr;
+        if (alias == nullptr || name == nullptr)
+        {
+            CCLOG("cocos2d: SpriteFrameCache: corrupted binary sprite frame alias %u", i);
+            continue;
+        }
+
+        if (_spriteFramesAliases.find(alias) != _spriteFramesAliases.end())
+        {
+            CCLOGWARN("cocos2d: WARNING: an alias with name %s already exists", alias);
+        }
+        _spriteFramesAliases[alias] = Value(name);
+    }
+
+    return true;
+}
+
+std::string SpriteFrameCache::getTextureFileNameFromBinaryData(const Data& data) const
+{
+    const SpriteFramesHeader* header = getSpriteFramesHeader(data);
+    if (header == nullptr || header->textureFileName == SPRITE_FRAMES_NO_STRING)
+    {
+        return "";
+    }
+
+    const char* textureFileName = getSpriteFramesString(data, header, header->textureFileName);
+    return textureFileName ? textureFileName : "";
+}
+
+void SpriteFrameCache::removeSpriteFramesFromBinaryData(const Data& data)
+{
+    const SpriteFramesHeader* header = getSpriteFramesHeader(data);
+    if (header == nullptr)
+    {
+        return;
+    }
+
+    auto frames = reinterpret_cast<const SpriteFramesFrame*>(data.getBytes() + sizeof(SpriteFramesHeader));
+    std::vector<std::string> keysToRemove;
+    for (uint32_t i = 0; i < header->frameCount; ++i)
+    {
+        const char* name = getSpriteFramesString(data, header, frames[i].name);
+        if (name && _spriteFrames.at(name))
+        {
+            keysToRemove.push_back(name);
+        }
+    }
+
+    _spriteFrames.erase(keysToRemove);
+}
+
 void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, Texture2D *texture)
 {
     if (_loadedFileNames->find(plist) != _loadedFileNames->end())
@@ -216,9 +435,13 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, Texture
     }
     
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
-    ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
+    Data data = FileUtils::getInstance()->getDataFromFile(fullPath);
 
-    addSpriteFramesWithDictionary(dict, texture);
+    if (!addSpriteFramesWithBinaryData(data, texture))
+    {
+        ValueMap dict = getValueMapFromPlistData(data);
+        addSpriteFramesWithDictionary(dict, texture);
+    }
     _loadedFileNames->insert(plist);
 }
 
@@ -257,16 +480,26 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist)
 
     if (_loadedFileNames->find(plist) == _loadedFileNames->end())
     {
-        
-        ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
+        Data data = FileUtils::getInstance()->getDataFromFile(fullPath);
+        bool isBinary = getSpriteFramesHeader(data) != nullptr;
 
+        ValueMap dict;
         string texturePath("");
 
-        if (dict.find("metadata") != dict.end())
+        if (isBinary)
         {
-            ValueMap& metadataDict = dict["metadata"].asValueMap();
-            // try to read  texture file name from meta data
-            texturePath = metadataDict["textureFileName"].asString();
+            texturePath = getTextureFileNameFromBinaryData(data);
+        }
+        else
+        {
+            dict = getValueMapFromPlistData(data);
+
+            if (dict.find("metadata") != dict.end())
+            {
+                ValueMap& metadataDict = dict["metadata"].asValueMap();
+                // try to read  texture file name from meta data
+                texturePath = metadataDict["textureFileName"].asString();
+            }
         }
 
         if (!texturePath.empty())
@@ -293,7 +526,14 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist)
 
         if (texture)
         {
-            addSpriteFramesWithDictionary(dict, texture);
+            if (isBinary)
+            {
+                addSpriteFramesWithBinaryData(data, texture);
+            }
+            else
+            {
+                addSpriteFramesWithDictionary(dict, texture);
+            }
             _loadedFileNames->insert(plist);
         }
         else
@@ -380,13 +620,21 @@ void SpriteFrameCache::removeSpriteFrameByName(const std::string& name)
 void SpriteFrameCache::removeSpriteFramesFromFile(const std::string& plist)
 {
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
-    ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
-    if (dict.empty())
+    Data data = FileUtils::getInstance()->getDataFromFile(fullPath);
+    if (getSpriteFramesHeader(data) != nullptr)
     {
-        CCLOG("cocos2d:SpriteFrameCache:removeSpriteFramesFromFile: create dict by %s fail.",plist.c_str());
-        return;
+        removeSpriteFramesFromBinaryData(data);
+    }
+    else
+    {
+        ValueMap dict = getValueMapFromPlistData(data);
+        if (dict.empty())
+        {
+            CCLOG("cocos2d:SpriteFrameCache:removeSpriteFramesFromFile: create dict by %s fail.",plist.c_str());
+            return;
+        }
+        removeSpriteFramesFromDictionary(dict);
     }
-    removeSpriteFramesFromDictionary(dict);
 
     // remove it from the cache
     set<string>::iterator ret = _loadedFileNames->find(plist);
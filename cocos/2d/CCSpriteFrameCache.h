@@ -33,6 +33,10 @@ THE SOFTWARE.
 /*
  * To create sprite frames and texture atlas, use this tool:
  * http://zwoptex.zwopple.com/
+ *
+ * Sprite frame plists can be converted to a binary format which loads without
+ * going through XML and ValueMap, using tools/spriteframe/convert_plist_to_binary.py.
+ * The binary files are loaded by the same addSpriteFramesWithFile methods.
  */
 #include <set>
 #include <string>
@@ -40,6 +44,7 @@ THE SOFTWARE.
 #include "base/CCRef.h"
 #include "base/CCValue.h"
 #include "base/CCMap.h"
+#include "base/CCData.h"
 
 NS_CC_BEGIN
 
@@ -94,7 +99,7 @@ public:
      */
     bool init();
 
-    /** Adds multiple Sprite Frames from a plist file.
+    /** Adds multiple Sprite Frames from a plist file, or from its binary conversion.
      * A texture will be loaded automatically. The texture name will composed by replacing the .plist suffix with .png.
      * If you want to use another texture, you should use the addSpriteFramesWithFile(const std::string& plist, const std::string& textureFileName) method.
      * @js addSpriteFrames
@@ -218,6 +223,19 @@ protected:
      */
     void addSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D *texture);
 
+    /*Adds multiple Sprite Frames from the binary format. The frames are built straight from the
+     file data, without creating a ValueMap. Returns false if data isn't in the binary format.
+     */
+    bool addSpriteFramesWithBinaryData(const Data& data, Texture2D *texture);
+
+    /*Returns the texture file name stored in the binary format, or an empty string.
+     */
+    std::string getTextureFileNameFromBinaryData(const Data& data) const;
+
+    /*Removes the Sprite Frames listed in the binary format.
+     */
+    void removeSpriteFramesFromBinaryData(const Data& data);
+
     /** Removes multiple Sprite Frames from Dictionary.
     * @since v0.99.5
     */
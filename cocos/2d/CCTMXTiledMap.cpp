@@ -101,6 +101,21 @@ TMXTiledMap::~TMXTiledMap()
 // private
 TMXLayer * TMXTiledMap::parseLayer(TMXLayerInfo *layerInfo, TMXMapInfo *mapInfo)
 {
+    if (layerInfo->_tiles == nullptr && layerInfo->_tileSource)
+    {
+        // TMXLayer needs all the tiles, read them from the binary map
+        int width = (int)layerInfo->_layerSize.width;
+        int height = (int)layerInfo->_layerSize.height;
+        uint32_t* tiles = (uint32_t*)malloc((size_t)width * height * sizeof(uint32_t));
+        if (tiles == nullptr || !layerInfo->_tileSource->loadTiles(0, 0, width, height, tiles))
+        {
+            free(tiles);
+            return nullptr;
+        }
+        layerInfo->_tiles = tiles;
+        layerInfo->_ownTiles = true;
+    }
+
     TMXTilesetInfo *tileset = tilesetForLayer(layerInfo, mapInfo);
     if (tileset == nullptr)
         return nullptr;
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "base/base64.h"
 #include "base/CCDirector.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCMappedFile.h"
 
 using namespace std;
 
@@ -43,6 +44,7 @@ NS_CC_BEGIN
 TMXLayerInfo::TMXLayerInfo()
 : _name("")
 , _tiles(nullptr)
+, _tileSource(nullptr)
 , _ownTiles(true)
 {
 }
@@ -55,6 +57,7 @@ TMXLayerInfo::~TMXLayerInfo()
         free(_tiles);
         _tiles = nullptr;
     }
+    CC_SAFE_RELEASE(_tileSource);
 }
 
 ValueMap& TMXLayerInfo::getProperties()
@@ -156,10 +159,553 @@ bool TMXMapInfo::initWithXML(const std::string& tmxString, const std::string& re
 
 bool TMXMapInfo::initWithTMXFile(const std::string& tmxFile)
 {
+    if (FileUtils::getInstance()->getFileExtension(tmxFile) == ".tmb")
+    {
+        return initWithBinaryFile(tmxFile);
+    }
     internalInit(tmxFile, "");
     return parseXMLFile(_TMXFileName.c_str());
 }
 
+// binary tile map format
+namespace
+{
+    const char TMX_BINARY_MAGIC[4] = { 'C', 'C', 'T', 'M' };
+    const uint32_t TMX_BINARY_VERSION = 1;
+    // nested vectors and maps deeper than this are rejected
+    const int TMX_BINARY_MAX_VALUE_DEPTH = 32;
+
+    struct TMXBinaryHeader
+    {
+        char magic[4];
+        uint32_t version;
+        int32_t orientation;
+        float mapWidth;
+        float mapHeight;
+        float tileWidth;
+        float tileHeight;
+        uint32_t tilesetCount;
+        uint32_t objectGroupCount;
+        uint32_t layerCount;
+    };
+
+    struct TMXBinaryTileset
+    {
+        int32_t firstGid;
+        float tileWidth;
+        float tileHeight;
+        int32_t spacing;
+        int32_t margin;
+        float imageWidth;
+        float imageHeight;
+    };
+
+    struct TMXBinaryLayer
+    {
+        int32_t width;
+        int32_t height;
+        float offsetX;
+        float offsetY;
+        uint32_t visible;
+        uint32_t opacity;
+        // offset of the width * height GIDs in the file, 4 bytes aligned
+        uint64_t tilesOffset;
+    };
+
+    class TMXBinaryWriter
+    {
+    public:
+        void writeBytes(const void* data, size_t size)
+        {
+            auto bytes = static_cast<const unsigned char*>(data);
+            _buffer.insert(_buffer.end(), bytes, bytes + size);
+        }
+
+        template <typename T>
+        void write(const T& value) { writeBytes(&value, sizeof(T)); }
+
+        void writeString(const std::string& str)
+        {
+            write((uint32_t)str.size());
+            writeBytes(str.data(), str.size());
+        }
+
+        void writeValue(const Value& value)
+        {
+            write((uint8_t)value.getType());
+            switch (value.getType())
+            {
+                case Value::Type::BYTE:
+                    write(value.asByte());
+                    break;
+                case Value::Type::INTEGER:
+                    write((int32_t)value.asInt());
+                    break;
+                case Value::Type::FLOAT:
+                    write(value.asFloat());
+                    break;
+                case Value::Type::DOUBLE:
+                    write(value.asDouble());
+                    break;
+                case Value::Type::BOOLEAN:
+                    write((uint8_t)value.asBool());
+                    break;
+                case Value::Type::STRING:
+                    writeString(value.asString());
+                    break;
+                case Value::Type::VECTOR:
+                    writeValueVector(value.asValueVector());
+                    break;
+                case Value::Type::MAP:
+                    writeValueMap(value.asValueMap());
+                    break;
+                case Value::Type::INT_KEY_MAP:
+                    writeValueMapIntKey(value.asIntKeyMap());
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void writeValueVector(const ValueVector& vector)
+        {
+            write((uint32_t)vector.size());
+            for (const auto& value : vector)
+            {
+                writeValue(value);
+            }
+        }
+
+        void writeValueMap(const ValueMap& map)
+        {
+            write((uint32_t)map.size());
+            for (const auto& iter : map)
+            {
+                writeString(iter.first);
+                writeValue(iter.second);
+            }
+        }
+
+        void writeValueMapIntKey(const ValueMapIntKey& map)
+        {
+            write((uint32_t)map.size());
+            for (const auto& iter : map)
+            {
+                write((int32_t)iter.first);
+                writeValue(iter.second);
+            }
+        }
+
+        std::vector<unsigned char>& getBuffer() { return _buffer; }
+
+    private:
+        std::vector<unsigned char> _buffer;
+    };
+
+    class TMXBinaryReader
+    {
+    public:
+        TMXBinaryReader(const unsigned char* data, size_t size)
+        : _data(data)
+        , _end(data + size)
+        , _valid(true)
+        {
+        }
+
+        bool isValid() const { return _valid; }
+
+        const unsigned char* readBytes(size_t size)
+        {
+            if (!_valid || (size_t)(_end - _data) < size)
+            {
+                _valid = false;
+                return nullptr;
+            }
+            auto ret = _data;
+            _data += size;
+            return ret;
+        }
+
+        template <typename T>
+        T read()
+        {
+            T value = T();
+            auto bytes = readBytes(sizeof(T));
+            if (bytes)
+            {
+                memcpy(&value, bytes, sizeof(T));
+            }
+            return value;
+        }
+
+        std::string readString()
+        {
+            uint32_t size = read<uint32_t>();
+            auto bytes = readBytes(size);
+            return bytes ? std::string((const char*)bytes, size) : std::string();
+        }
+
+        Value readValue(int depth)
+        {
+            if (depth > TMX_BINARY_MAX_VALUE_DEPTH)
+            {
+                _valid = false;
+                return Value::Null;
+            }
+
+            switch ((Value::Type)read<uint8_t>())
+            {
+                case Value::Type::NONE:
+                    return Value::Null;
+                case Value::Type::BYTE:
+                    return Value(read<unsigned char>());
+                case Value::Type::INTEGER:
+                    return Value((int)read<int32_t>());
+                case Value::Type::FLOAT:
+                    return Value(read<float>());
+                case Value::Type::DOUBLE:
+                    return Value(read<double>());
+                case Value::Type::BOOLEAN:
+                    return Value(read<uint8_t>() != 0);
+                case Value::Type::STRING:
+                    return Value(readString());
+                case Value::Type::VECTOR:
+                {
+                    ValueVector vector;
+                    readValueVector(vector, depth + 1);
+                    return Value(std::move(vector));
+                }
+                case Value::Type::MAP:
+                {
+                    ValueMap map;
+                    readValueMap(map, depth + 1);
+                    return Value(std::move(map));
+                }
+                case Value::Type::INT_KEY_MAP:
+                {
+                    ValueMapIntKey map;
+                    readValueMapIntKey(map, depth + 1);
+                    return Value(std::move(map));
+                }
+                default:
+                    _valid = false;
+                    return Value::Null;
+            }
+        }
+
+        void readValueVector(ValueVector& vector, int depth)
+        {
+            uint32_t count = read<uint32_t>();
+            for (uint32_t i = 0; i < count && _valid; ++i)
+            {
+                vector.push_back(readValue(depth));
+            }
+        }
+
+        void readValueMap(ValueMap& map, int depth)
+        {
+            uint32_t count = read<uint32_t>();
+            for (uint32_t i = 0; i < count && _valid; ++i)
+            {
+                std::string key = readString();
+                map[key] = readValue(depth);
+            }
+        }
+
+        void readValueMapIntKey(ValueMapIntKey& map, int depth)
+        {
+            uint32_t count = read<uint32_t>();
+            for (uint32_t i = 0; i < count && _valid; ++i)
+            {
+                int key = read<int32_t>();
+                map[key] = readValue(depth);
+            }
+        }
+
+    private:
+        const unsigned char* _data;
+        const unsigned char* _end;
+        bool _valid;
+    };
+
+    class TMXBinaryTileSource : public TMXTileSource
+    {
+    public:
+        TMXBinaryTileSource(MappedFile* file, const unsigned char* tiles, int width, int height)
+        : _file(file)
+        , _tiles(tiles)
+        , _width(width)
+        , _height(height)
+        {
+            _file->retain();
+        }
+
+        virtual ~TMXBinaryTileSource()
+        {
+            _file->release();
+        }
+
+        virtual bool loadTiles(int x, int y, int width, int height, uint32_t* gids) override
+        {
+            if (x < 0 || y < 0 || width < 0 || height < 0 || x + width > _width || y + height > _height)
+                return false;
+
+            for (int row = 0; row < height; ++row)
+            {
+                size_t offset = ((size_t)(y + row) * _width + x) * sizeof(uint32_t);
+                memcpy(gids + (size_t)row * width, _tiles + offset, width * sizeof(uint32_t));
+            }
+            return true;
+        }
+
+    private:
+        MappedFile* _file;
+        const unsigned char* _tiles;
+        int _width;
+        int _height;
+    };
+}
+
+TMXMapInfo * TMXMapInfo::createWithBinaryFile(const std::string& binaryFile)
+{
+    TMXMapInfo *ret = new (std::nothrow) TMXMapInfo();
+    if (ret->initWithBinaryFile(binaryFile))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+bool TMXMapInfo::initWithBinaryFile(const std::string& binaryFile)
+{
+    internalInit(binaryFile, "");
+
+    auto file = new (std::nothrow) MappedFile();
+    if (file == nullptr || !file->init(_TMXFileName))
+    {
+        CCLOG("cocos2d: TMXFormat: can't read %s", binaryFile.c_str());
+        CC_SAFE_RELEASE(file);
+        return false;
+    }
+
+    TMXBinaryReader reader(file->getBytes(), file->getSize());
+    auto header = reader.read<TMXBinaryHeader>();
+    if (!reader.isValid() || memcmp(header.magic, TMX_BINARY_MAGIC, sizeof(header.magic)) != 0 || header.version != TMX_BINARY_VERSION)
+    {
+        CCLOG("cocos2d: TMXFormat: %s isn't a binary tile map", binaryFile.c_str());
+        file->release();
+        return false;
+    }
+
+    _orientation = header.orientation;
+    _mapSize.setSize(header.mapWidth, header.mapHeight);
+    _tileSize.setSize(header.tileWidth, header.tileHeight);
+    reader.readValueMap(_properties, 0);
+    reader.readValueMapIntKey(_tileProperties, 0);
+
+    // images are stored relative to the map file
+    std::string dir;
+    if (_TMXFileName.find_last_of("/") != std::string::npos)
+    {
+        dir = _TMXFileName.substr(0, _TMXFileName.find_last_of("/") + 1);
+    }
+
+    for (uint32_t i = 0; i < header.tilesetCount && reader.isValid(); ++i)
+    {
+        auto info = reader.read<TMXBinaryTileset>();
+        TMXTilesetInfo* tileset = new (std::nothrow) TMXTilesetInfo();
+        tileset->_name = reader.readString();
+        tileset->_sourceImage = reader.readString();
+        if (!FileUtils::getInstance()->isAbsolutePath(tileset->_sourceImage))
+        {
+            tileset->_sourceImage = dir + tileset->_sourceImage;
+        }
+        tileset->_firstGid = info.firstGid;
+        tileset->_tileSize.setSize(info.tileWidth, info.tileHeight);
+        tileset->_spacing = info.spacing;
+        tileset->_margin = info.margin;
+        tileset->_imageSize.setSize(info.imageWidth, info.imageHeight);
+        _tilesets.pushBack(tileset);
+        tileset->release();
+    }
+
+    for (uint32_t i = 0; i < header.objectGroupCount && reader.isValid(); ++i)
+    {
+        TMXObjectGroup* objectGroup = new (std::nothrow) TMXObjectGroup();
+        objectGroup->setGroupName(reader.readString());
+        float x = reader.read<float>();
+        float y = reader.read<float>();
+        objectGroup->setPositionOffset(Vec2(x, y));
+        reader.readValueMap(objectGroup->getProperties(), 0);
+        reader.readValueVector(objectGroup->getObjects(), 0);
+        _objectGroups.pushBack(objectGroup);
+        objectGroup->release();
+    }
+
+    for (uint32_t i = 0; i < header.layerCount && reader.isValid(); ++i)
+    {
+        auto info = reader.read<TMXBinaryLayer>();
+        TMXLayerInfo* layer = new (std::nothrow) TMXLayerInfo();
+        layer->_name = reader.readString();
+        reader.readValueMap(layer->getProperties(), 0);
+        layer->_layerSize.setSize(info.width, info.height);
+        layer->_offset.set(info.offsetX, info.offsetY);
+        layer->_visible = info.visible != 0;
+        layer->_opacity = (unsigned char)info.opacity;
+        _layers.pushBack(layer);
+        layer->release();
+
+        uint64_t tilesSize = (uint64_t)info.width * info.height * sizeof(uint32_t);
+        if (info.width < 0 || info.height < 0 || info.tilesOffset > (size_t)file->getSize() || tilesSize > (size_t)file->getSize() - info.tilesOffset)
+        {
+            CCLOG("cocos2d: TMXFormat: the tiles of layer '%s' are out of %s", layer->_name.c_str(), binaryFile.c_str());
+            file->release();
+            return false;
+        }
+        layer->_tileSource = new (std::nothrow) TMXBinaryTileSource(file, file->getBytes() + info.tilesOffset, info.width, info.height);
+    }
+
+    file->release();
+    if (!reader.isValid())
+    {
+        CCLOG("cocos2d: TMXFormat: %s is truncated", binaryFile.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool TMXMapInfo::saveBinaryFile(const std::string& fullPath) const
+{
+    // images are stored relative to the map file
+    std::string dir;
+    if (_TMXFileName.find_last_of("/") != std::string::npos)
+    {
+        dir = _TMXFileName.substr(0, _TMXFileName.find_last_of("/") + 1);
+    }
+    else if (!_resources.empty())
+    {
+        dir = _resources + "/";
+    }
+
+    std::vector<uint64_t> tilesOffsets(_layers.size(), 0);
+    TMXBinaryWriter writer;
+    // the layer table depends on the size of the table itself, it is written twice
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        writer.getBuffer().clear();
+
+        TMXBinaryHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, TMX_BINARY_MAGIC, sizeof(header.magic));
+        header.version = TMX_BINARY_VERSION;
+        header.orientation = _orientation;
+        header.mapWidth = _mapSize.width;
+        header.mapHeight = _mapSize.height;
+        header.tileWidth = _tileSize.width;
+        header.tileHeight = _tileSize.height;
+        header.tilesetCount = (uint32_t)_tilesets.size();
+        header.objectGroupCount = (uint32_t)_objectGroups.size();
+        header.layerCount = (uint32_t)_layers.size();
+        writer.write(header);
+        writer.writeValueMap(_properties);
+        writer.writeValueMapIntKey(_tileProperties);
+
+        for (const auto& tileset : _tilesets)
+        {
+            TMXBinaryTileset info;
+            memset(&info, 0, sizeof(info));
+            info.firstGid = tileset->_firstGid;
+            info.tileWidth = tileset->_tileSize.width;
+            info.tileHeight = tileset->_tileSize.height;
+            info.spacing = tileset->_spacing;
+            info.margin = tileset->_margin;
+            info.imageWidth = tileset->_imageSize.width;
+            info.imageHeight = tileset->_imageSize.height;
+            writer.write(info);
+            writer.writeString(tileset->_name);
+
+            std::string image = tileset->_sourceImage;
+            if (!dir.empty() && image.compare(0, dir.size(), dir) == 0)
+            {
+                image = image.substr(dir.size());
+            }
+            writer.writeString(image);
+        }
+
+        for (const auto& objectGroup : _objectGroups)
+        {
+            writer.writeString(objectGroup->getGroupName());
+            writer.write(objectGroup->getPositionOffset().x);
+            writer.write(objectGroup->getPositionOffset().y);
+            writer.writeValueMap(objectGroup->getProperties());
+            writer.writeValueVector(objectGroup->getObjects());
+        }
+
+        for (ssize_t i = 0; i < _layers.size(); ++i)
+        {
+            auto layer = _layers.at(i);
+            TMXBinaryLayer info;
+            memset(&info, 0, sizeof(info));
+            info.width = (int32_t)layer->_layerSize.width;
+            info.height = (int32_t)layer->_layerSize.height;
+            info.offsetX = layer->_offset.x;
+            info.offsetY = layer->_offset.y;
+            info.visible = layer->_visible ? 1 : 0;
+            info.opacity = layer->_opacity;
+            info.tilesOffset = tilesOffsets[i];
+            writer.write(info);
+            writer.writeString(layer->_name);
+            writer.writeValueMap(layer->_properties);
+        }
+
+        uint64_t offset = (writer.getBuffer().size() + 3) & ~(uint64_t)3;
+        for (ssize_t i = 0; i < _layers.size(); ++i)
+        {
+            auto layer = _layers.at(i);
+            tilesOffsets[i] = offset;
+            offset += (uint64_t)layer->_layerSize.width * layer->_layerSize.height * sizeof(uint32_t);
+        }
+    }
+    writer.getBuffer().resize((writer.getBuffer().size() + 3) & ~(size_t)3, 0);
+
+    FILE* fp = fopen(FileUtils::getInstance()->getSuitableFOpen(fullPath).c_str(), "wb");
+    if (fp == nullptr)
+    {
+        CCLOG("cocos2d: TMXFormat: can't write %s", fullPath.c_str());
+        return false;
+    }
+
+    bool ret = fwrite(writer.getBuffer().data(), 1, writer.getBuffer().size(), fp) == writer.getBuffer().size();
+    std::vector<uint32_t> row;
+    for (const auto& layer : _layers)
+    {
+        int width = (int)layer->_layerSize.width;
+        int height = (int)layer->_layerSize.height;
+        row.resize(width);
+        for (int y = 0; y < height && ret; ++y)
+        {
+            if (layer->_tiles)
+            {
+                memcpy(row.data(), layer->_tiles + (size_t)y * width, width * sizeof(uint32_t));
+            }
+            else if (layer->_tileSource == nullptr || !layer->_tileSource->loadTiles(0, y, width, 1, row.data()))
+            {
+                std::fill(row.begin(), row.end(), 0);
+            }
+            ret = fwrite(row.data(), sizeof(uint32_t), width, fp) == (size_t)width;
+        }
+    }
+    fclose(fp);
+
+    if (!ret)
+    {
+        CCLOG("cocos2d: TMXFormat: failed to write %s", fullPath.c_str());
+    }
+    return ret;
+}
+
 TMXMapInfo::TMXMapInfo()
 : _mapSize(Size::ZERO)    
 , _tileSize(Size::ZERO)
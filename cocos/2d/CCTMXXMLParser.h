@@ -83,6 +83,25 @@ typedef enum TMXTileFlags_ {
 
 // Bits on the far end of the 32-bit global tile ID (GID's) are used for tile flags
 
+/** @brief TMXTileSource provides the tile GIDs of a layer on demand.
+ *
+ * experimental::TMXLayer reads the tiles of a layer that has a source chunk by chunk,
+ * when they come into view, instead of keeping the whole GID array in memory.
+ */
+class CC_DLL TMXTileSource : public Ref
+{
+public:
+    /** Reads a rectangle of tiles of the layer.
+     * @param x The first column.
+     * @param y The first row.
+     * @param width The number of columns.
+     * @param height The number of rows.
+     * @param gids Receives width * height flagged GIDs, row by row.
+     * @return False if the tiles couldn't be read, they are then treated as empty.
+     */
+    virtual bool loadTiles(int x, int y, int width, int height, uint32_t* gids) = 0;
+};
+
 /** @brief TMXLayerInfo contains the information about the layers like:
 - Layer name
 - Layer size
@@ -111,6 +130,8 @@ public:
     std::string         _name;
     Size                _layerSize;
     uint32_t            *_tiles;
+    // used instead of _tiles by streamed layers
+    TMXTileSource       *_tileSource;
     bool                _visible;
     unsigned char       _opacity;
     bool                _ownTiles;
@@ -172,6 +193,8 @@ public:
     static TMXMapInfo * create(const std::string& tmxFile);
     /** creates a TMX Format with an XML string and a TMX resource path */
     static TMXMapInfo * createWithXML(const std::string& tmxString, const std::string& resourcePath);
+    /** creates a TMX Format with a binary tile map file, see saveBinaryFile() */
+    static TMXMapInfo * createWithBinaryFile(const std::string& binaryFile);
     
     /** creates a TMX Format with a tmx file */
     CC_DEPRECATED_ATTRIBUTE static TMXMapInfo * formatWithTMXFile(const char *tmxFile) { return TMXMapInfo::create(tmxFile); };
@@ -187,8 +210,20 @@ public:
      */
     virtual ~TMXMapInfo();
     
-    /** initializes a TMX format with a  tmx file */
+    /** initializes a TMX format with a  tmx file. Files with the ".tmb" extension are loaded with initWithBinaryFile() */
     bool initWithTMXFile(const std::string& tmxFile);
+    /** initializes a TMX format with a binary tile map file.
+     * The file is memory mapped when possible. The layers don't copy their tiles, they get a TMXTileSource
+     * reading them from the file instead, which experimental::TMXLayer streams chunk by chunk.
+     */
+    bool initWithBinaryFile(const std::string& binaryFile);
+    /** Writes the map in the binary tile map format: map, layers, tilesets, object groups and all their properties.
+     * The tiles of each layer are stored uncompressed, so they can be read in place.
+     * Use it offline to convert the tmx files, and give the result the ".tmb" extension.
+     * @param fullPath The path of the file to write.
+     * @return True if the file was written.
+     */
+    bool saveBinaryFile(const std::string& fullPath) const;
     /** initializes a TMX format with an XML string and a TMX resource path */
     bool initWithXML(const std::string& tmxString, const std::string& resourcePath);
     /** initializes parsing of an XML file, either a tmx (Map) file or tsx (Tileset) file */
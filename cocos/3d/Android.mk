@@ -8,21 +8,27 @@ LOCAL_MODULE_FILENAME := libcocos3d
 LOCAL_SRC_FILES := \
 CCRay.cpp \
 CCAABB.cpp \
+CCAABBTree.cpp \
 CCOBB.cpp \
+CCOcclusionCuller.cpp \
 CCAnimate3D.cpp \
 CCAnimation3D.cpp \
 CCAttachNode.cpp \
 CCBillBoard.cpp \
+CCBillBoardBatch.cpp \
 CCBundle3D.cpp \
 CCBundleReader.cpp \
 CCMesh.cpp \
 CCMeshSkin.cpp \
+CCMeshUploadQueue.cpp \
 CCMeshVertexIndexData.cpp \
 CCSprite3DMaterial.cpp \
 CCObjLoader.cpp \
 CCSkeleton3D.cpp \
+CCSkeleton3DManager.cpp \
 CCSprite3D.cpp \
 CCTerrain.cpp \
+CCPagedTerrain.cpp \
 CCSkybox.cpp
 
 LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)/..
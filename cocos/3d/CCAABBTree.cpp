@@ -0,0 +1,444 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "3d/CCAABBTree.h"
+
+#include <algorithm>
+
+NS_CC_BEGIN
+
+AABBTree::AABBTree()
+: _root(NULL_NODE)
+, _freeList(NULL_NODE)
+, _proxyCount(0)
+, _margin(0.1f)
+{
+}
+
+AABBTree::~AABBTree()
+{
+}
+
+float AABBTree::getArea(const AABB& aabb)
+{
+    Vec3 size = aabb._max - aabb._min;
+    return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+AABB AABBTree::merge(const AABB& aabb1, const AABB& aabb2)
+{
+    AABB aabb;
+    aabb._min.set(std::min(aabb1._min.x, aabb2._min.x), std::min(aabb1._min.y, aabb2._min.y), std::min(aabb1._min.z, aabb2._min.z));
+    aabb._max.set(std::max(aabb1._max.x, aabb2._max.x), std::max(aabb1._max.y, aabb2._max.y), std::max(aabb1._max.z, aabb2._max.z));
+    return aabb;
+}
+
+bool AABBTree::contains(const AABB& outer, const AABB& inner)
+{
+    return outer._min.x <= inner._min.x && outer._min.y <= inner._min.y && outer._min.z <= inner._min.z
+        && outer._max.x >= inner._max.x && outer._max.y >= inner._max.y && outer._max.z >= inner._max.z;
+}
+
+int AABBTree::allocateNode()
+{
+    int node;
+    if (_freeList == NULL_NODE)
+    {
+        node = (int)_nodes.size();
+        _nodes.push_back(TreeNode());
+    }
+    else
+    {
+        node = _freeList;
+        _freeList = _nodes[node].parent;
+    }
+    
+    TreeNode& treeNode = _nodes[node];
+    treeNode.userData = nullptr;
+    treeNode.parent = NULL_NODE;
+    treeNode.child1 = NULL_NODE;
+    treeNode.child2 = NULL_NODE;
+    treeNode.height = 0;
+    return node;
+}
+
+void AABBTree::freeNode(int node)
+{
+    _nodes[node].parent = _freeList;
+    _nodes[node].height = -1;
+    _freeList = node;
+}
+
+int AABBTree::createProxy(const AABB& aabb, void* userData)
+{
+    int proxy = allocateNode();
+    
+    Vec3 margin = (aabb._max - aabb._min) * _margin;
+    TreeNode& node = _nodes[proxy];
+    node.aabb._min = aabb._min - margin;
+    node.aabb._max = aabb._max + margin;
+    node.userData = userData;
+    
+    insertLeaf(proxy);
+    ++_proxyCount;
+    return proxy;
+}
+
+void AABBTree::destroyProxy(int proxy)
+{
+    CCASSERT(proxy >= 0 && proxy < (int)_nodes.size() && _nodes[proxy].isLeaf() && _nodes[proxy].height == 0, "invalid proxy");
+    
+    removeLeaf(proxy);
+    freeNode(proxy);
+    --_proxyCount;
+}
+
+bool AABBTree::moveProxy(int proxy, const AABB& aabb)
+{
+    CCASSERT(proxy >= 0 && proxy < (int)_nodes.size() && _nodes[proxy].isLeaf() && _nodes[proxy].height == 0, "invalid proxy");
+    
+    if (contains(_nodes[proxy].aabb, aabb))
+        return false;
+    
+    removeLeaf(proxy);
+    
+    Vec3 margin = (aabb._max - aabb._min) * _margin;
+    _nodes[proxy].aabb._min = aabb._min - margin;
+    _nodes[proxy].aabb._max = aabb._max + margin;
+    
+    insertLeaf(proxy);
+    return true;
+}
+
+void AABBTree::clear()
+{
+    _nodes.clear();
+    _root = NULL_NODE;
+    _freeList = NULL_NODE;
+    _proxyCount = 0;
+}
+
+void AABBTree::insertLeaf(int leaf)
+{
+    if (_root == NULL_NODE)
+    {
+        _root = leaf;
+        _nodes[_root].parent = NULL_NODE;
+        return;
+    }
+    
+    // find the sibling for which the leaf grows the tree the least
+    AABB leafAABB = _nodes[leaf].aabb;
+    int index = _root;
+    while (!_nodes[index].isLeaf())
+    {
+        const TreeNode& node = _nodes[index];
+        float area = getArea(node.aabb);
+        float combinedArea = getArea(merge(node.aabb, leafAABB));
+        
+        // cost of creating a parent for this node and the leaf
+        float cost = 2.f * combinedArea;
+        // minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.f * (combinedArea - area);
+        
+        float cost1 = getArea(merge(leafAABB, _nodes[node.child1].aabb)) + inheritanceCost;
+        if (!_nodes[node.child1].isLeaf())
+            cost1 -= getArea(_nodes[node.child1].aabb);
+        float cost2 = getArea(merge(leafAABB, _nodes[node.child2].aabb)) + inheritanceCost;
+        if (!_nodes[node.child2].isLeaf())
+            cost2 -= getArea(_nodes[node.child2].aabb);
+        
+        if (cost < cost1 && cost < cost2)
+            break;
+        
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+    
+    int sibling = index;
+    int oldParent = _nodes[sibling].parent;
+    int newParent = allocateNode();
+    _nodes[newParent].parent = oldParent;
+    _nodes[newParent].aabb = merge(leafAABB, _nodes[sibling].aabb);
+    _nodes[newParent].height = _nodes[sibling].height + 1;
+    _nodes[newParent].child1 = sibling;
+    _nodes[newParent].child2 = leaf;
+    _nodes[sibling].parent = newParent;
+    _nodes[leaf].parent = newParent;
+    
+    if (oldParent != NULL_NODE)
+    {
+        if (_nodes[oldParent].child1 == sibling)
+            _nodes[oldParent].child1 = newParent;
+        else
+            _nodes[oldParent].child2 = newParent;
+    }
+    else
+    {
+        _root = newParent;
+    }
+    
+    // fix the heights and aabbs of the ancestors
+    index = _nodes[leaf].parent;
+    while (index != NULL_NODE)
+    {
+        index = balance(index);
+        
+        TreeNode& node = _nodes[index];
+        node.height = 1 + std::max(_nodes[node.child1].height, _nodes[node.child2].height);
+        node.aabb = merge(_nodes[node.child1].aabb, _nodes[node.child2].aabb);
+        
+        index = node.parent;
+    }
+}
+
+void AABBTree::removeLeaf(int leaf)
+{
+    if (leaf == _root)
+    {
+        _root = NULL_NODE;
+        return;
+    }
+    
+    int parent = _nodes[leaf].parent;
+    int grandParent = _nodes[parent].parent;
+    int sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+    
+    if (grandParent != NULL_NODE)
+    {
+        // replace the parent by the sibling
+        if (_nodes[grandParent].child1 == parent)
+            _nodes[grandParent].child1 = sibling;
+        else
+            _nodes[grandParent].child2 = sibling;
+        _nodes[sibling].parent = grandParent;
+        freeNode(parent);
+        
+        int index = grandParent;
+        while (index != NULL_NODE)
+        {
+            index = balance(index);
+            
+            TreeNode& node = _nodes[index];
+            node.height = 1 + std::max(_nodes[node.child1].height, _nodes[node.child2].height);
+            node.aabb = merge(_nodes[node.child1].aabb, _nodes[node.child2].aabb);
+            
+            index = node.parent;
+        }
+    }
+    else
+    {
+        _root = sibling;
+        _nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+    }
+}
+
+int AABBTree::balance(int iA)
+{
+    TreeNode& A = _nodes[iA];
+    if (A.isLeaf() || A.height < 2)
+        return iA;
+    
+    int iB = A.child1;
+    int iC = A.child2;
+    TreeNode& B = _nodes[iB];
+    TreeNode& C = _nodes[iC];
+    
+    int balance = C.height - B.height;
+    
+    // rotate C up
+    if (balance > 1)
+    {
+        int iF = C.child1;
+        int iG = C.child2;
+        TreeNode& F = _nodes[iF];
+        TreeNode& G = _nodes[iG];
+        
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+        
+        if (C.parent != NULL_NODE)
+        {
+            if (_nodes[C.parent].child1 == iA)
+                _nodes[C.parent].child1 = iC;
+            else
+                _nodes[C.parent].child2 = iC;
+        }
+        else
+        {
+            _root = iC;
+        }
+        
+        if (F.height > G.height)
+        {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+            A.aabb = merge(B.aabb, G.aabb);
+            C.aabb = merge(A.aabb, F.aabb);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        }
+        else
+        {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+            A.aabb = merge(B.aabb, F.aabb);
+            C.aabb = merge(A.aabb, G.aabb);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+        return iC;
+    }
+    
+    // rotate B up
+    if (balance < -1)
+    {
+        int iD = B.child1;
+        int iE = B.child2;
+        TreeNode& D = _nodes[iD];
+        TreeNode& E = _nodes[iE];
+        
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+        
+        if (B.parent != NULL_NODE)
+        {
+            if (_nodes[B.parent].child1 == iA)
+                _nodes[B.parent].child1 = iB;
+            else
+                _nodes[B.parent].child2 = iB;
+        }
+        else
+        {
+            _root = iB;
+        }
+        
+        if (D.height > E.height)
+        {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+            A.aabb = merge(C.aabb, E.aabb);
+            B.aabb = merge(A.aabb, D.aabb);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        }
+        else
+        {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+            A.aabb = merge(C.aabb, D.aabb);
+            B.aabb = merge(A.aabb, E.aabb);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+        return iB;
+    }
+    
+    return iA;
+}
+
+void AABBTree::addLeaves(int node, std::vector<int>& proxies) const
+{
+    const TreeNode& treeNode = _nodes[node];
+    if (treeNode.isLeaf())
+    {
+        proxies.push_back(node);
+    }
+    else
+    {
+        addLeaves(treeNode.child1, proxies);
+        addLeaves(treeNode.child2, proxies);
+    }
+}
+
+void AABBTree::query(const Frustum& frustum, std::vector<int>& proxies) const
+{
+    if (_root == NULL_NODE)
+        return;
+    
+    _stack.clear();
+    _stack.push_back(std::make_pair(_root, frustum.getAllPlanesMask()));
+    while (!_stack.empty())
+    {
+        int index = _stack.back().first;
+        unsigned int planeMask = _stack.back().second;
+        _stack.pop_back();
+        
+        const TreeNode& node = _nodes[index];
+        auto intersection = frustum.intersectAABB(node.aabb, &planeMask);
+        if (intersection == Frustum::Intersection::OUTSIDE)
+            continue;
+        
+        if (node.isLeaf())
+        {
+            proxies.push_back(index);
+        }
+        else if (intersection == Frustum::Intersection::INSIDE)
+        {
+            addLeaves(index, proxies);
+        }
+        else
+        {
+            _stack.push_back(std::make_pair(node.child1, planeMask));
+            _stack.push_back(std::make_pair(node.child2, planeMask));
+        }
+    }
+}
+
+void AABBTree::query(const AABB& aabb, std::vector<int>& proxies) const
+{
+    if (_root == NULL_NODE)
+        return;
+    
+    _stack.clear();
+    _stack.push_back(std::make_pair(_root, 0u));
+    while (!_stack.empty())
+    {
+        int index = _stack.back().first;
+        _stack.pop_back();
+        
+        const TreeNode& node = _nodes[index];
+        if (!node.aabb.intersects(aabb))
+            continue;
+        
+        if (node.isLeaf())
+        {
+            proxies.push_back(index);
+        }
+        else
+        {
+            _stack.push_back(std::make_pair(node.child1, 0u));
+            _stack.push_back(std::make_pair(node.child2, 0u));
+        }
+    }
+}
+
+NS_CC_END
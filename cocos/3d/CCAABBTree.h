@@ -0,0 +1,128 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CC_AABB_TREE_H__
+#define __CC_AABB_TREE_H__
+
+#include <vector>
+
+#include "3d/CCAABB.h"
+#include "3d/CCFrustum.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/**
+ * @brief A dynamic AABB tree, used as a spatial index for culling.
+ *
+ * Each object is a leaf (a proxy) with a fattened copy of its aabb, so an object moving a little doesn't
+ * change the tree. The leaves are inserted next to the sibling which grows the tree the least, and the
+ * tree is kept balanced with rotations. The queries reject whole subtrees whose box is out of the frustum,
+ * and accept whole subtrees whose box is inside it without testing their leaves.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL AABBTree
+{
+public:
+    AABBTree();
+    ~AABBTree();
+    
+    /** Adds an object, returns its proxy. */
+    int createProxy(const AABB& aabb, void* userData);
+    
+    /** Removes an object. */
+    void destroyProxy(int proxy);
+    
+    /** Updates the aabb of an object, returns true if it left its fat aabb and was reinserted. */
+    bool moveProxy(int proxy, const AABB& aabb);
+    
+    /** Removes all the objects. */
+    void clear();
+    
+    void* getUserData(int proxy) const { return _nodes[proxy].userData; }
+    const AABB& getFatAABB(int proxy) const { return _nodes[proxy].aabb; }
+    
+    /** Appends the proxies whose fat aabb isn't out of the frustum. */
+    void query(const Frustum& frustum, std::vector<int>& proxies) const;
+    
+    /** Appends the proxies whose fat aabb intersects aabb. */
+    void query(const AABB& aabb, std::vector<int>& proxies) const;
+    
+    /** How much the aabbs are fattened on each side, as a fraction of their size. Default is 0.1. */
+    void setMargin(float margin) { _margin = margin; }
+    float getMargin() const { return _margin; }
+    
+    int getProxyCount() const { return _proxyCount; }
+    /** Height of the tree, 0 if it is empty. */
+    int getHeight() const { return _root == NULL_NODE ? 0 : _nodes[_root].height + 1; }
+    
+protected:
+    static const int NULL_NODE = -1;
+    
+    struct TreeNode
+    {
+        AABB aabb;
+        void* userData;
+        // next free node when the node is free
+        int parent;
+        int child1;
+        int child2;
+        // 0 for leaves, -1 for free nodes
+        int height;
+        
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+    
+    int allocateNode();
+    void freeNode(int node);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int node);
+    void addLeaves(int node, std::vector<int>& proxies) const;
+    
+    static float getArea(const AABB& aabb);
+    static AABB merge(const AABB& aabb1, const AABB& aabb2);
+    static bool contains(const AABB& outer, const AABB& inner);
+    
+    std::vector<TreeNode> _nodes;
+    int _root;
+    int _freeList;
+    int _proxyCount;
+    float _margin;
+    // traversal stack of the queries, nodes and the planes left to test
+    mutable std::vector<std::pair<int, unsigned int>> _stack;
+};
+
+// end of 3d group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_AABB_TREE_H__
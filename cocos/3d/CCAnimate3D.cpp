@@ -25,6 +25,7 @@
 #include "3d/CCAnimate3D.h"
 #include "3d/CCSprite3D.h"
 #include "3d/CCSkeleton3D.h"
+#include "3d/CCSkeleton3DManager.h"
 #include "platform/CCFileUtils.h"
 #include "base/CCConfiguration.h"
 #include "base/CCEventCustom.h"
@@ -171,8 +172,7 @@ void Animate3D::startWithTarget(Node *target)
                         auto bone = skin->getBoneByName(boneName);
                         if (bone)
                         {
-                            auto curve = _animation->getBoneCurveByName(boneName);
-                            _boneCurves[bone] = curve;
+                            _boneCurves.push_back(std::make_pair(bone, iter.second));
                             hasCurve = true;
                         }
                         else
@@ -195,6 +195,20 @@ void Animate3D::startWithTarget(Node *target)
                         }
                     }
                 }
+                
+                // evaluated in the order the skeleton updates its bones
+                auto skeleton = sprite->getSkeleton();
+                if (skeleton && _boneCurves.size() > 1)
+                {
+                    std::vector<std::pair<int, std::pair<Bone3D*, Animation3D::Curve*>>> slots;
+                    for (const auto& it : _boneCurves)
+                        slots.push_back(std::make_pair(skeleton->getBoneSlot(it.first), it));
+                    std::sort(slots.begin(), slots.end(), [](const std::pair<int, std::pair<Bone3D*, Animation3D::Curve*>>& a, const std::pair<int, std::pair<Bone3D*, Animation3D::Curve*>>& b) {
+                        return a.first < b.first;
+                    });
+                    for (size_t i = 0; i < slots.size(); ++i)
+                        _boneCurves[i] = slots[i].second;
+                }
             }
         }
         else
@@ -334,7 +348,6 @@ void Animate3D::update(float t)
             if (_weight > 0.0f)
             {
                 float transDst[3], rotDst[4], scaleDst[3];
-                float* trans = nullptr, *rot = nullptr, *scale = nullptr;
                 if (_playReverse){
                     t = 1 - t;
                     lastTime = 1.0 - lastTime;
@@ -343,25 +356,15 @@ void Animate3D::update(float t)
                 t = _start + t * _last;
                 lastTime = _start + lastTime * _last;
                 
-                for (const auto& it : _boneCurves) {
-                    auto bone = it.first;
-                    auto curve = it.second;
-                    if (curve->translateCurve)
-                    {
-                        curve->translateCurve->evaluate(t, transDst, _translateEvaluate);
-                        trans = &transDst[0];
-                    }
-                    if (curve->rotCurve)
-                    {
-                        curve->rotCurve->evaluate(t, rotDst, _roteEvaluate);
-                        rot = &rotDst[0];
-                    }
-                    if (curve->scaleCurve)
-                    {
-                        curve->scaleCurve->evaluate(t, scaleDst, _scaleEvaluate);
-                        scale = &scaleDst[0];
-                    }
-                    bone->setAnimationValue(trans, rot, scale, this, _weight);
+                // only sprites with a skeleton have bone curves, the animation LOD may skip them this frame
+                auto sprite = static_cast<Sprite3D*>(_target);
+                if (!_boneCurves.empty() && sprite->isAnimationEvaluated())
+                {
+                    auto manager = Skeleton3DManager::getInstance();
+                    if (manager->isEnabled())
+                        manager->scheduleAnimation(sprite, this, t, _weight);
+                    else
+                        evaluateBoneCurves(t, _weight);
                 }
                 
                 for (const auto& it : _nodeCurves)
@@ -417,6 +420,32 @@ void Animate3D::update(float t)
     }
 }
 
+void Animate3D::evaluateBoneCurves(float t, float weight)
+{
+    float transDst[3], rotDst[4], scaleDst[3];
+    float* trans = nullptr, *rot = nullptr, *scale = nullptr;
+    for (const auto& it : _boneCurves) {
+        auto bone = it.first;
+        auto curve = it.second;
+        if (curve->translateCurve)
+        {
+            curve->translateCurve->evaluate(t, transDst, _translateEvaluate);
+            trans = &transDst[0];
+        }
+        if (curve->rotCurve)
+        {
+            curve->rotCurve->evaluate(t, rotDst, _roteEvaluate);
+            rot = &rotDst[0];
+        }
+        if (curve->scaleCurve)
+        {
+            curve->scaleCurve->evaluate(t, scaleDst, _scaleEvaluate);
+            scale = &scaleDst[0];
+        }
+        bone->setAnimationValue(trans, rot, scale, this, weight);
+    }
+}
+
 float Animate3D::getSpeed() const
 {
     return _playReverse ? -_absSpeed : _absSpeed;
@@ -130,6 +130,11 @@ public:
     const ValueMap* getKeyFrameUserInfo(int keyFrame) const;
     ValueMap* getKeyFrameUserInfo(int keyFrame);
     
+    /**
+     * evaluates the bone curves at animation time t and blends them into the bones with weight.
+     * It only touches the bones of the target's skeleton, the Skeleton3DManager calls it on worker threads.
+     */
+    void evaluateBoneCurves(float t, float weight);
 
     
 CC_CONSTRUCTOR_ACCESS:
@@ -172,7 +177,7 @@ protected:
     EvaluateType _scaleEvaluate;
     Animate3DQuality _quality;
     
-    std::unordered_map<Bone3D*, Animation3D::Curve*> _boneCurves; //weak ref
+    std::vector<std::pair<Bone3D*, Animation3D::Curve*>> _boneCurves; //weak ref, sorted by Skeleton3D::getBoneSlot()
     std::unordered_map<Node*, Animation3D::Curve*> _nodeCurves;
     
     std::unordered_map<int, ValueMap> _keyFrameUserInfos;
@@ -56,7 +56,8 @@ bool Animation3D::initWithFile(const std::string& filename, const std::string& a
     //load animation here
     auto bundle = Bundle3D::createBundle();
     Animation3DData animationdata;
-    if (bundle->load(fullPath) && bundle->loadAnimationData(animationName, &animationdata) && init(animationdata))
+    if (bundle->load(fullPath) && bundle->loadAnimationData(animationName, &animationdata)
+        && init(animationdata, Animation3DCache::getInstance()->getCompression()))
     {
         std::string key = fullPath + "#" + animationName;
         Animation3DCache::getInstance()->addAnimation(key, this);
@@ -106,6 +107,11 @@ Animation3D::Curve::~Curve()
 }
 
 bool Animation3D::init(const Animation3DData &data)
+{
+    return init(data, Compression());
+}
+
+bool Animation3D::init(const Animation3DData &data, const Compression& compression)
 {
     _duration = data._totalTime;
 
@@ -129,7 +135,10 @@ bool Animation3D::init(const Animation3DData &data)
             values.push_back(keyIter._key.z);
         }
         
-        curve->translateCurve = Curve::AnimationCurveVec3::create(&keys[0], &values[0], (int)keys.size());
+        if (compression.enabled)
+            curve->translateCurve = Curve::AnimationCurveVec3::createCompressed(&keys[0], &values[0], (int)keys.size(), compression.translationTolerance);
+        else
+            curve->translateCurve = Curve::AnimationCurveVec3::create(&keys[0], &values[0], (int)keys.size());
         if(curve->translateCurve) curve->translateCurve->retain();
     }
     
@@ -154,7 +163,10 @@ bool Animation3D::init(const Animation3DData &data)
             values.push_back(keyIter._key.w);
         }
         
-        curve->rotCurve = Curve::AnimationCurveQuat::create(&keys[0], &values[0], (int)keys.size());
+        if (compression.enabled)
+            curve->rotCurve = Curve::AnimationCurveQuat::createCompressed(&keys[0], &values[0], (int)keys.size(), compression.rotationTolerance);
+        else
+            curve->rotCurve = Curve::AnimationCurveQuat::create(&keys[0], &values[0], (int)keys.size());
         if(curve->rotCurve) curve->rotCurve->retain();
     }
     
@@ -178,13 +190,42 @@ bool Animation3D::init(const Animation3DData &data)
             values.push_back(keyIter._key.z);
         }
         
-        curve->scaleCurve = Curve::AnimationCurveVec3::create(&keys[0], &values[0], (int)keys.size());
+        if (compression.enabled)
+            curve->scaleCurve = Curve::AnimationCurveVec3::createCompressed(&keys[0], &values[0], (int)keys.size(), compression.scaleTolerance);
+        else
+            curve->scaleCurve = Curve::AnimationCurveVec3::create(&keys[0], &values[0], (int)keys.size());
         if(curve->scaleCurve) curve->scaleCurve->retain();
     }
     
     return true;
 }
 
+template <int componentSize>
+static void addCurveStats(const AnimationCurve<componentSize>* curve, Animation3D::Stats* stats, float* error)
+{
+    if (curve == nullptr)
+        return;
+    
+    stats->memorySize += curve->getMemorySize();
+    stats->uncompressedSize += curve->getSourceKeyCount() * (componentSize + 1) * sizeof(float);
+    stats->keyCount += curve->getKeyCount();
+    stats->sourceKeyCount += curve->getSourceKeyCount();
+    *error = std::max(*error, curve->getMaxError());
+}
+
+Animation3D::Stats Animation3D::getStats() const
+{
+    Stats stats = { 0, 0, 0, 0, 0.f, 0.f, 0.f };
+    for (const auto& it : _boneCurves)
+    {
+        auto curve = it.second;
+        addCurveStats(curve->translateCurve, &stats, &stats.translationError);
+        addCurveStats(curve->rotCurve, &stats, &stats.rotationError);
+        addCurveStats(curve->scaleCurve, &stats, &stats.scaleError);
+    }
+    return stats;
+}
+
 ////////////////////////////////////////////////////////////////
 Animation3DCache* Animation3DCache::_cacheInstance = nullptr;
 
@@ -239,6 +280,23 @@ void Animation3DCache::removeUnusedAnimation()
     }
 }
 
+Animation3D::Stats Animation3DCache::getStats() const
+{
+    Animation3D::Stats total = { 0, 0, 0, 0, 0.f, 0.f, 0.f };
+    for (const auto& it : _animations)
+    {
+        auto stats = it.second->getStats();
+        total.memorySize += stats.memorySize;
+        total.uncompressedSize += stats.uncompressedSize;
+        total.keyCount += stats.keyCount;
+        total.sourceKeyCount += stats.sourceKeyCount;
+        total.translationError = std::max(total.translationError, stats.translationError);
+        total.rotationError = std::max(total.rotationError, stats.rotationError);
+        total.scaleError = std::max(total.scaleError, stats.scaleError);
+    }
+    return total;
+}
+
 Animation3DCache::Animation3DCache()
 {
     
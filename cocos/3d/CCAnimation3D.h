@@ -86,11 +86,48 @@ public:
     /**get the bone Curves set*/
     const std::unordered_map<std::string, Curve*>& getBoneCurves() const {return _boneCurves;}
     
+    /**
+     * keyframe compression settings, see Animation3DCache::setCompression().
+     * The tolerances are the largest errors allowed when keys are removed, quantization adds a little more.
+     */
+    struct Compression
+    {
+        bool enabled;
+        float translationTolerance; // distance
+        float rotationTolerance; // angle in radians
+        float scaleTolerance;
+        
+        Compression()
+        : enabled(false)
+        , translationTolerance(0.001f)
+        , rotationTolerance(0.001f)
+        , scaleTolerance(0.001f)
+        {
+        }
+    };
+    
+    /** memory and error statistics of the curves */
+    struct Stats
+    {
+        size_t memorySize; // bytes used by the keys
+        size_t uncompressedSize; // bytes the keys would use without compression
+        int keyCount;
+        int sourceKeyCount; // keys before the compression removed some
+        float translationError; // largest error at the source keys, distance
+        float rotationError; // angle in radians
+        float scaleError;
+    };
+    
+    /** returns the statistics of the curves, the errors are 0 if the animation isn't compressed */
+    Stats getStats() const;
+    
 CC_CONSTRUCTOR_ACCESS:
     Animation3D();
     virtual ~Animation3D();  
     /**init Animation3D from bundle data*/
     bool init(const Animation3DData& data);
+    /**init Animation3D from bundle data, compressing the curves*/
+    bool init(const Animation3DData& data, const Compression& compression);
     
     /**init Animation3D with file name and animation name*/
     bool initWithFile(const std::string& filename, const std::string& animationName);
@@ -121,6 +158,16 @@ public:
     void removeAllAnimations();
     /**remove unused animation*/
     void removeUnusedAnimation();
+    
+    /**
+     * sets how the animations loaded from .c3b and .c3t files are compressed, disabled by default.
+     * It applies to the animations loaded afterwards.
+     */
+    void setCompression(const Animation3D::Compression& compression) { _compression = compression; }
+    const Animation3D::Compression& getCompression() const { return _compression; }
+    
+    /**returns the statistics of all the cached animations, the errors are the largest ones*/
+    Animation3D::Stats getStats() const;
 
 protected:
     Animation3DCache();
@@ -129,6 +176,7 @@ protected:
     static Animation3DCache* _cacheInstance; //cache instance
     
     std::unordered_map<std::string, Animation3D*> _animations; //cached animations
+    Animation3D::Compression _compression;
 };
 
 // end of 3d group
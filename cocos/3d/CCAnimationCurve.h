@@ -25,6 +25,7 @@
 #define __CCANIMATIONCURVE_H__
 
 #include <functional>
+#include <vector>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/CCRef.h"
@@ -65,6 +66,16 @@ public:
     /**create animation curve*/
     static AnimationCurve* create(float* keytime, float* value, int count);
     
+    /**
+     * create a compressed animation curve.
+     * Keys that interpolating their neighbours reproduces within tolerance are removed, then key times are
+     * stored in 16 bits, rotations with the smallest three encoding (3 x 15 bits) and translations or scales
+     * in 16 bits over the range of the curve. A lookup table finds the keys of a time without a binary search.
+     * Curves left with more than 65535 keys after the reduction are created uncompressed.
+     * @param tolerance largest error allowed when removing keys, a distance for vec3 curves, an angle in radians for rotations
+     */
+    static AnimationCurve* createCompressed(float* keytime, float* value, int count, float tolerance);
+    
     /**
      * evalute value of time
      * @param time Time to be estimated
@@ -82,6 +93,21 @@ public:
     /**get end time*/
     float getEndTime() const;
     
+    /**is the curve compressed*/
+    bool isCompressed() const { return _quantizedValue != nullptr; }
+    
+    /**number of keys stored*/
+    int getKeyCount() const { return _count; }
+    
+    /**number of keys before the keys were reduced*/
+    int getSourceKeyCount() const { return _sourceCount; }
+    
+    /**memory used by the keys in bytes*/
+    size_t getMemorySize() const;
+    
+    /**largest error at the source keys introduced by the compression, 0 if it isn't compressed*/
+    float getMaxError() const { return _maxError; }
+    
 CC_CONSTRUCTOR_ACCESS:
     
     AnimationCurve();
@@ -94,11 +120,33 @@ CC_CONSTRUCTOR_ACCESS:
     
 protected:
     
+    /** interpolates between two keys, t is the position between them */
+    void interpolate(const float* fromValue, const float* toValue, float t, float time, float* dst, EvaluateType type) const;
+    
+    /** compressed curves: finds and decodes the keys around time, returns false if time is out of the keys and fromValue is the result */
+    bool findQuantizedKeys(float time, float* fromValue, float* toValue, float* t) const;
+    void decodeValue(int index, float* dst) const;
+    
+    /** error between two values, distance for vec3, angle for quaternions */
+    static float getValueError(const float* a, const float* b);
+    
     float* _value;   //
     float* _keytime; //key time(0 - 1), start time _keytime[0], end time _keytime[_count - 1]
     int _count;
     int _componentSizeByte; //component size in byte, position and scale 3 * sizeof(float), rotation 4 * sizeof(float)
     
+    // compressed curves only, _value and _keytime are null
+    unsigned short* _quantizedKeytime; // (time - _startTime) / (_endTime - _startTime) * 65535
+    unsigned short* _quantizedValue; // 3 per key
+    unsigned short* _keyLookup; // last key at or before each of the _keyLookupSize time slots
+    int _keyLookupSize;
+    float _valueMin[3]; // vec3 curves, quantization range
+    float _valueScale[3];
+    float _startTime;
+    float _endTime;
+    int _sourceCount;
+    float _maxError;
+    
     std::function<void(float time, float* dst)> _evaluateFun; //user defined function
 };
 
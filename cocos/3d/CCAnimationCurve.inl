@@ -4,6 +4,16 @@ NS_CC_BEGIN
 template <int componentSize>
 void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateType type) const
 {
+    if (_quantizedValue)
+    {
+        float fromValue[4], toValue[4], t;
+        if (findQuantizedKeys(time, fromValue, toValue, &t))
+            interpolate(fromValue, toValue, t, time, dst, type);
+        else
+            memcpy(dst, fromValue, _componentSizeByte);
+        return;
+    }
+    
     if (_count == 1 || time <= _keytime[0])
     {
         memcpy(dst, _value, _componentSizeByte);
@@ -23,6 +33,12 @@ void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateTyp
     float* fromValue = &_value[index * componentSize];
     float* toValue = fromValue + componentSize;
     
+    interpolate(fromValue, toValue, t, time, dst, type);
+}
+
+template <int componentSize>
+void AnimationCurve<componentSize>::interpolate(const float* fromValue, const float* toValue, float t, float time, float* dst, EvaluateType type) const
+{
     switch (type) {
         case EvaluateType::INT_LINEAR:
         {
@@ -33,7 +49,7 @@ void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateTyp
         break;
         case EvaluateType::INT_NEAR:
         {
-            float* src = fabs(t) > 0.5f ? toValue : fromValue;
+            const float* src = fabs(t) > 0.5f ? toValue : fromValue;
             memcpy(dst, src, _componentSizeByte);
         }
         break;
@@ -41,10 +57,12 @@ void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateTyp
         {
             // Evaluate.
             Quaternion quat;
+            Quaternion from(fromValue[0], fromValue[1], fromValue[2], fromValue[3]);
+            Quaternion to(toValue[0], toValue[1], toValue[2], toValue[3]);
             if (t >= 0)
-                Quaternion::slerp(Quaternion(fromValue), Quaternion(toValue), t, &quat);
+                Quaternion::slerp(from, to, t, &quat);
             else
-                Quaternion::slerp(Quaternion(toValue), Quaternion(fromValue), t, &quat);
+                Quaternion::slerp(to, from, t, &quat);
             
             dst[0] = quat.x, dst[1] = quat.y, dst[2] = quat.z, dst[3] = quat.w;
         }
@@ -61,6 +79,78 @@ void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateTyp
     }
 }
 
+template <int componentSize>
+bool AnimationCurve<componentSize>::findQuantizedKeys(float time, float* fromValue, float* toValue, float* t) const
+{
+    if (_count == 1 || time <= _startTime)
+    {
+        decodeValue(0, fromValue);
+        return false;
+    }
+    else if (time >= _endTime)
+    {
+        decodeValue(_count - 1, fromValue);
+        return false;
+    }
+    
+    // the lookup table gives the key at the start of the time slot, the keys of the slot are scanned from there
+    float u = (time - _startTime) / (_endTime - _startTime);
+    float quantizedTime = u * 65535.f;
+    int slot = std::min((int)(u * _keyLookupSize), _keyLookupSize - 1);
+    int index = _keyLookup[slot];
+    while (index < _count - 2 && _quantizedKeytime[index + 1] <= quantizedTime)
+        ++index;
+    
+    float scale = (float)(_quantizedKeytime[index + 1] - _quantizedKeytime[index]);
+    *t = scale > 0.f ? clampf((quantizedTime - _quantizedKeytime[index]) / scale, 0.f, 1.f) : 0.f;
+    decodeValue(index, fromValue);
+    decodeValue(index + 1, toValue);
+    return true;
+}
+
+template <int componentSize>
+void AnimationCurve<componentSize>::decodeValue(int index, float* dst) const
+{
+    const unsigned short* src = &_quantizedValue[index * 3];
+    if (componentSize == 4)
+    {
+        // smallest three: the largest component is dropped and rebuilt from the unit length,
+        // its index is in the top bits of the first two values
+        static const float RANGE = 0.707106781f; // 1 / sqrt(2), the other components are in [-RANGE, RANGE]
+        int largest = (src[0] >> 15) | ((src[1] >> 15) << 1);
+        float sum = 0.f;
+        for (int i = 0, j = 0; i < 4; i++)
+        {
+            if (i == largest)
+                continue;
+            float v = ((src[j++] & 0x7fff) / 32767.f * 2.f - 1.f) * RANGE;
+            dst[i] = v;
+            sum += v * v;
+        }
+        dst[largest] = sqrtf(std::max(0.f, 1.f - sum));
+    }
+    else
+    {
+        for (int i = 0; i < componentSize; i++)
+            dst[i] = _valueMin[i] + src[i] * _valueScale[i];
+    }
+}
+
+template <int componentSize>
+float AnimationCurve<componentSize>::getValueError(const float* a, const float* b)
+{
+    if (componentSize == 4)
+    {
+        float dot = fabsf(a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]);
+        return 2.f * acosf(std::min(dot, 1.f));
+    }
+    
+    float sum = 0.f;
+    for (int i = 0; i < componentSize; i++)
+        sum += (a[i] - b[i]) * (a[i] - b[i]);
+    return sqrtf(sum);
+}
+
 template <int componentSize>
 void AnimationCurve<componentSize>::setEvaluateFun(std::function<void(float time, float* dst)> fun)
 {
@@ -82,7 +172,151 @@ AnimationCurve<componentSize>* AnimationCurve<componentSize>::create(float* keyt
     memcpy(curve->_value, value, totalByte);
     
     curve->_count = count;
+    curve->_sourceCount = count;
     curve->_componentSizeByte = compoentSizeByte;
+    curve->_startTime = keytime[0];
+    curve->_endTime = keytime[count - 1];
+    
+    curve->autorelease();
+    return curve;
+}
+
+template <int componentSize>
+AnimationCurve<componentSize>* AnimationCurve<componentSize>::createCompressed(float* keytime, float* value, int count, float tolerance)
+{
+    // reduction and quantization need two keys and increasing times
+    if (count < 2 || keytime[count - 1] <= keytime[0])
+        return create(keytime, value, count);
+    
+    // keys are removed while interpolating the last kept key and the next one reproduces them,
+    // a span is limited to MAX_SPAN keys to bound the cost
+    static const int MAX_SPAN = 64;
+    std::vector<int> kept;
+    kept.push_back(0);
+    int last = 0;
+    float interpolated[4];
+    for (int next = 2; next < count; next++)
+    {
+        bool fits = next - last <= MAX_SPAN;
+        float range = keytime[next] - keytime[last];
+        for (int i = last + 1; fits && i < next; i++)
+        {
+            float t = range > 0.f ? (keytime[i] - keytime[last]) / range : 0.f;
+            const float* from = &value[last * componentSize];
+            const float* to = &value[next * componentSize];
+            if (componentSize == 4)
+            {
+                Quaternion quat;
+                Quaternion::slerp(Quaternion(from[0], from[1], from[2], from[3]), Quaternion(to[0], to[1], to[2], to[3]), t, &quat);
+                interpolated[0] = quat.x, interpolated[1] = quat.y, interpolated[2] = quat.z, interpolated[3] = quat.w;
+            }
+            else
+            {
+                for (int j = 0; j < componentSize; j++)
+                    interpolated[j] = from[j] + (to[j] - from[j]) * t;
+            }
+            fits = getValueError(interpolated, &value[i * componentSize]) <= tolerance;
+        }
+        if (!fits)
+        {
+            last = next - 1;
+            kept.push_back(last);
+        }
+    }
+    kept.push_back(count - 1);
+    
+    // key indices and times are stored in 16 bits
+    static const int MAX_COMPRESSED_KEYS = 65535;
+    if ((int)kept.size() > MAX_COMPRESSED_KEYS)
+    {
+        CCLOG("warning: AnimationCurve::createCompressed, %d keys left after the reduction, the curve isn't compressed", (int)kept.size());
+        return create(keytime, value, count);
+    }
+    
+    AnimationCurve* curve = new (std::nothrow) AnimationCurve();
+    int keptCount = (int)kept.size();
+    curve->_count = keptCount;
+    curve->_sourceCount = count;
+    curve->_componentSizeByte = componentSize * sizeof(float);
+    curve->_startTime = keytime[0];
+    curve->_endTime = keytime[count - 1];
+    curve->_quantizedKeytime = new unsigned short[keptCount];
+    curve->_quantizedValue = new unsigned short[keptCount * 3];
+    
+    if (componentSize != 4)
+    {
+        for (int i = 0; i < componentSize; i++)
+        {
+            float minValue = value[i], maxValue = value[i];
+            for (auto key : kept)
+            {
+                minValue = std::min(minValue, value[key * componentSize + i]);
+                maxValue = std::max(maxValue, value[key * componentSize + i]);
+            }
+            curve->_valueMin[i] = minValue;
+            curve->_valueScale[i] = (maxValue - minValue) / 65535.f;
+        }
+    }
+    
+    float timeRange = curve->_endTime - curve->_startTime;
+    for (int k = 0; k < keptCount; k++)
+    {
+        int key = kept[k];
+        curve->_quantizedKeytime[k] = (unsigned short)(clampf((keytime[key] - curve->_startTime) / timeRange, 0.f, 1.f) * 65535.f + 0.5f);
+        
+        const float* src = &value[key * componentSize];
+        unsigned short* dst = &curve->_quantizedValue[k * 3];
+        if (componentSize == 4)
+        {
+            float quat[4] = { src[0], src[1], src[2], src[3] };
+            float length = sqrtf(quat[0] * quat[0] + quat[1] * quat[1] + quat[2] * quat[2] + quat[3] * quat[3]);
+            int largest = 0;
+            for (int i = 1; i < 4; i++)
+            {
+                if (fabsf(quat[i]) > fabsf(quat[largest]))
+                    largest = i;
+            }
+            // q and -q are the same rotation, the dropped component is made positive
+            float sign = quat[largest] < 0.f ? -1.f : 1.f;
+            float invLength = length > 0.f ? sign / length : 0.f;
+            for (int i = 0, j = 0; i < 4; i++)
+            {
+                if (i == largest)
+                    continue;
+                float v = clampf(quat[i] * invLength * 1.414213562f * 0.5f + 0.5f, 0.f, 1.f);
+                dst[j++] = (unsigned short)(v * 32767.f + 0.5f);
+            }
+            dst[0] |= (largest & 1) << 15;
+            dst[1] |= (largest >> 1) << 15;
+        }
+        else
+        {
+            for (int i = 0; i < componentSize; i++)
+            {
+                float scale = curve->_valueScale[i];
+                dst[i] = scale > 0.f ? (unsigned short)(clampf((src[i] - curve->_valueMin[i]) / scale, 0.f, 65535.f) + 0.5f) : 0;
+            }
+        }
+    }
+    
+    curve->_keyLookupSize = keptCount;
+    curve->_keyLookup = new unsigned short[keptCount];
+    int index = 0;
+    for (int slot = 0; slot < keptCount; slot++)
+    {
+        float slotTime = (float)slot / keptCount * 65535.f;
+        while (index < keptCount - 2 && curve->_quantizedKeytime[index + 1] <= slotTime)
+            ++index;
+        curve->_keyLookup[slot] = (unsigned short)index;
+    }
+    
+    // measured against every source key, removed keys included
+    EvaluateType type = componentSize == 4 ? EvaluateType::INT_QUAT_SLERP : EvaluateType::INT_LINEAR;
+    for (int i = 0; i < count; i++)
+    {
+        curve->evaluate(keytime[i], interpolated, type);
+        curve->_maxError = std::max(curve->_maxError, getValueError(interpolated, &value[i * componentSize]));
+    }
     
     curve->autorelease();
     return curve;
@@ -91,13 +325,21 @@ AnimationCurve<componentSize>* AnimationCurve<componentSize>::create(float* keyt
 template <int componentSize>
 float AnimationCurve<componentSize>::getStartTime() const
 {
-    return _keytime[0];
+    return _startTime;
 }
 
 template <int componentSize>
 float AnimationCurve<componentSize>::getEndTime() const
 {
-    return _keytime[_count - 1];
+    return _endTime;
+}
+
+template <int componentSize>
+size_t AnimationCurve<componentSize>::getMemorySize() const
+{
+    if (_quantizedValue)
+        return _count * 4 * sizeof(unsigned short) + _keyLookupSize * sizeof(unsigned short);
+    return _count * (componentSize + 1) * sizeof(float);
 }
 
 
@@ -107,6 +349,14 @@ AnimationCurve<componentSize>::AnimationCurve()
 , _keytime(nullptr)
 , _count(0)
 , _componentSizeByte(0)
+, _quantizedKeytime(nullptr)
+, _quantizedValue(nullptr)
+, _keyLookup(nullptr)
+, _keyLookupSize(0)
+, _startTime(0)
+, _endTime(0)
+, _sourceCount(0)
+, _maxError(0)
 , _evaluateFun(nullptr)
 {
     
@@ -116,6 +366,9 @@ AnimationCurve<componentSize>::~AnimationCurve()
 {
     CC_SAFE_DELETE_ARRAY(_keytime);
     CC_SAFE_DELETE_ARRAY(_value);
+    CC_SAFE_DELETE_ARRAY(_quantizedKeytime);
+    CC_SAFE_DELETE_ARRAY(_quantizedValue);
+    CC_SAFE_DELETE_ARRAY(_keyLookup);
 }
 
 template <int componentSize>
@@ -106,6 +106,14 @@ void BillBoard::visit(Renderer *renderer, const Mat4& parentTransform, uint32_t
     
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
     
+    // _modelViewTransform is the world transform of the node until it is billboarded below
+    auto scene = _spatialIndexEntry.scene;
+    if (scene && scene->isSpatialIndexEnabled()
+        && ((flags & FLAGS_DIRTY_MASK) || !scene->isInSpatialIndex(_spatialIndexEntry)))
+    {
+        scene->updateSpatialIndex(this, _spatialIndexEntry, getSpatialIndexAABB());
+    }
+    
     //Add 3D flag so all the children will be rendered as 3D object
     flags |= FLAGS_RENDER_AS_3D;
     
@@ -222,9 +230,48 @@ bool BillBoard::calculateBillbaordTransform()
     return false;
 }
 
+AABB BillBoard::getSpatialIndexAABB() const
+{
+    // the billboard turns around its anchor point, so it stays in the sphere of its farthest corner
+    Vec3 center;
+    _modelViewTransform.transformPoint(Vec3(_anchorPointInPoints.x, _anchorPointInPoints.y, 0.0f), &center);
+    
+    float width = std::max(_anchorPointInPoints.x, _contentSize.width - _anchorPointInPoints.x);
+    float height = std::max(_anchorPointInPoints.y, _contentSize.height - _anchorPointInPoints.y);
+    const float* m = _modelViewTransform.m;
+    float scale = std::max(sqrtf(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]), sqrtf(m[4] * m[4] + m[5] * m[5] + m[6] * m[6]));
+    float radius = sqrtf(width * width + height * height) * scale;
+    
+    Vec3 extents(radius, radius, radius);
+    return AABB(center - extents, center + extents);
+}
+
+void BillBoard::onEnter()
+{
+    _spatialIndexEntry.scene = getScene();
+    Sprite::onEnter();
+}
+
+void BillBoard::onExit()
+{
+    if (_spatialIndexEntry.scene)
+    {
+        _spatialIndexEntry.scene->removeFromSpatialIndex(_spatialIndexEntry);
+        _spatialIndexEntry.scene = nullptr;
+    }
+    Sprite::onExit();
+}
+
 void BillBoard::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
-    //FIXME: frustum culling here
+#if CC_USE_CULLING
+    // only culled with the spatial index, the billboard has no bounds of its own
+    bool visible;
+    auto scene = _spatialIndexEntry.scene;
+    if (scene && scene->getSpatialIndexVisibility(_spatialIndexEntry, Camera::getVisitingCamera(), &visible) && !visible)
+        return;
+#endif
+    
     flags |= Node::FLAGS_RENDER_AS_3D;
     _trianglesCommand.init(0, _texture->getName(), getGLProgramState(), _blendFunc, _polyInfo.triangles, _modelViewTransform, flags);
     _trianglesCommand.setTransparent(true);
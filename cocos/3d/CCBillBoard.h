@@ -26,6 +26,7 @@
 #define __CCBILLBOARD_H__
 
 #include "2d/CCSprite.h"
+#include "2d/CCScene.h"
 
 NS_CC_BEGIN
 /**
@@ -102,6 +103,9 @@ public:
      * @lua NA
      */
     virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
+    
+    virtual void onEnter() override;
+    virtual void onExit() override;
 
 
 CC_CONSTRUCTOR_ACCESS:
@@ -115,11 +119,16 @@ protected:
      */
     bool calculateBillbaordTransform();
     
+    /** bounds of the billboard whatever its orientation, from the world transform of the node */
+    AABB getSpatialIndexAABB() const;
+    
     Mat4 _camWorldMat;
     Mat4 _mvTransform;
 
     Mode _mode;
     bool _modeDirty;
+    
+    SpatialIndexEntry _spatialIndexEntry;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(BillBoard);
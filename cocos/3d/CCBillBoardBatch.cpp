@@ -0,0 +1,511 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "3d/CCBillBoardBatch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "2d/CCCamera.h"
+#include "renderer/CCGLProgramState.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/CCTexture2D.h"
+
+#if defined (__SSE__)
+#define USE_SSE
+#include <xmmintrin.h>
+#elif defined (__arm64__) || defined (__aarch64__) || ((CC_TARGET_PLATFORM == CC_PLATFORM_IOS) && defined (__ARM_NEON__))
+#define USE_NEON
+#include <arm_neon.h>
+#endif
+
+NS_CC_BEGIN
+
+// the renderer asserts on commands with more vertices than its vertex buffer, so big runs are split
+static const int MAX_QUADS_PER_COMMAND = 4096;
+
+// components of the visible billboards in _components, _stride floats each
+enum
+{
+    COMPONENT_X,
+    COMPONENT_Y,
+    COMPONENT_Z,
+    COMPONENT_WIDTH,
+    COMPONENT_HEIGHT,
+    COMPONENT_ANCHOR_X,
+    COMPONENT_ANCHOR_Y,
+    COMPONENT_CORNERS, // x, y, z of the bottom left, bottom right, top left and top right corners
+    COMPONENT_DEPTH = COMPONENT_CORNERS + 12,
+    COMPONENT_WORLD, // x, y, z of the world position
+    COMPONENT_COUNT = COMPONENT_WORLD + 3
+};
+
+#if defined (USE_SSE)
+typedef __m128 float4;
+static inline float4 load4(const float* p) { return _mm_loadu_ps(p); }
+static inline void store4(float* p, float4 v) { _mm_storeu_ps(p, v); }
+static inline float4 splat4(float v) { return _mm_set1_ps(v); }
+static inline float4 add4(float4 a, float4 b) { return _mm_add_ps(a, b); }
+static inline float4 sub4(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+static inline float4 mul4(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+static inline float4 madd4(float4 a, float4 b, float4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+static inline float4 rsqrt4(float4 v)
+{
+    // one Newton-Raphson step on the estimate
+    v = _mm_max_ps(v, _mm_set1_ps(1e-12f));
+    float4 e = _mm_rsqrt_ps(v);
+    return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), e), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_mul_ps(v, e), e)));
+}
+#elif defined (USE_NEON)
+typedef float32x4_t float4;
+static inline float4 load4(const float* p) { return vld1q_f32(p); }
+static inline void store4(float* p, float4 v) { vst1q_f32(p, v); }
+static inline float4 splat4(float v) { return vdupq_n_f32(v); }
+static inline float4 add4(float4 a, float4 b) { return vaddq_f32(a, b); }
+static inline float4 sub4(float4 a, float4 b) { return vsubq_f32(a, b); }
+static inline float4 mul4(float4 a, float4 b) { return vmulq_f32(a, b); }
+static inline float4 madd4(float4 a, float4 b, float4 c) { return vmlaq_f32(c, a, b); }
+static inline float4 rsqrt4(float4 v)
+{
+    v = vmaxq_f32(v, vdupq_n_f32(1e-12f));
+    float4 e = vrsqrteq_f32(v);
+    e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(v, e), e));
+    return vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(v, e), e));
+}
+#else
+struct float4
+{
+    float v[4];
+};
+static inline float4 load4(const float* p) { float4 r; for (int i = 0; i < 4; ++i) r.v[i] = p[i]; return r; }
+static inline void store4(float* p, const float4& a) { for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+static inline float4 splat4(float v) { float4 r; for (int i = 0; i < 4; ++i) r.v[i] = v; return r; }
+static inline float4 add4(const float4& a, const float4& b) { float4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] + b.v[i]; return r; }
+static inline float4 sub4(const float4& a, const float4& b) { float4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] - b.v[i]; return r; }
+static inline float4 mul4(const float4& a, const float4& b) { float4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] * b.v[i]; return r; }
+static inline float4 madd4(const float4& a, const float4& b, const float4& c) { float4 r; for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] * b.v[i] + c.v[i]; return r; }
+static inline float4 rsqrt4(const float4& a) { float4 r; for (int i = 0; i < 4; ++i) r.v[i] = 1.0f / sqrtf(std::max(a.v[i], 1e-12f)); return r; }
+#endif
+
+BillBoardBatch* BillBoardBatch::create(BillBoard::Mode mode)
+{
+    auto batch = new (std::nothrow) BillBoardBatch();
+    if (batch && batch->init(mode))
+    {
+        batch->autorelease();
+        return batch;
+    }
+    CC_SAFE_DELETE(batch);
+    return nullptr;
+}
+
+BillBoardBatch::BillBoardBatch()
+: _mode(BillBoard::Mode::VIEW_POINT_ORIENTED)
+, _transparent(true)
+, _sortMode(SortMode::PER_TEXTURE)
+, _blendFunc(BlendFunc::ALPHA_PREMULTIPLIED)
+, _visibleCount(0)
+, _stride(0)
+, _commandCount(0)
+{
+}
+
+BillBoardBatch::~BillBoardBatch()
+{
+}
+
+bool BillBoardBatch::init(BillBoard::Mode mode)
+{
+    if (!Node::init())
+        return false;
+
+    _mode = mode;
+    setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP));
+    return true;
+}
+
+int BillBoardBatch::addBillBoard(Texture2D* texture, const Rect& rect, const Vec3& position, const Size& size, const Color4B& color)
+{
+    CCASSERT(texture, "texture can't be null");
+
+    auto found = std::find(_textures.begin(), _textures.end(), texture);
+    int textureIndex = (int)(found - _textures.begin());
+    if (found == _textures.end())
+        _textures.pushBack(texture);
+
+    Item item;
+    item.position = position;
+    item.size = size;
+    item.anchorPoint.set(0.5f, 0.5f);
+    Rect pixels = rect.equals(Rect::ZERO) ? Rect(0, 0, texture->getPixelsWide(), texture->getPixelsHigh()) : rect;
+    item.u0 = pixels.origin.x / texture->getPixelsWide();
+    item.v0 = pixels.origin.y / texture->getPixelsHigh();
+    item.u1 = (pixels.origin.x + pixels.size.width) / texture->getPixelsWide();
+    item.v1 = (pixels.origin.y + pixels.size.height) / texture->getPixelsHigh();
+    item.color = color;
+    item.texture = textureIndex;
+    item.visible = true;
+
+    if (_freeIds.empty())
+    {
+        item.id = (int)_itemIndices.size();
+        _itemIndices.push_back(-1);
+    }
+    else
+    {
+        item.id = _freeIds.back();
+        _freeIds.pop_back();
+    }
+    _itemIndices[item.id] = (int)_items.size();
+    _items.push_back(item);
+    return item.id;
+}
+
+void BillBoardBatch::removeBillBoard(int id)
+{
+    if (!getItem(id))
+        return;
+
+    // move the last item into the hole so the items stay packed
+    int index = _itemIndices[id];
+    if (index != (int)_items.size() - 1)
+    {
+        _items[index] = _items.back();
+        _itemIndices[_items[index].id] = index;
+    }
+    _items.pop_back();
+    _itemIndices[id] = -1;
+    _freeIds.push_back(id);
+}
+
+void BillBoardBatch::removeAllBillBoards()
+{
+    _items.clear();
+    _itemIndices.clear();
+    _freeIds.clear();
+    _textures.clear();
+}
+
+BillBoardBatch::Item* BillBoardBatch::getItem(int id)
+{
+    if (id < 0 || id >= (int)_itemIndices.size() || _itemIndices[id] < 0)
+    {
+        CCLOG("BillBoardBatch: invalid billboard id %d", id);
+        return nullptr;
+    }
+    return &_items[_itemIndices[id]];
+}
+
+void BillBoardBatch::setBillBoardPosition(int id, const Vec3& position)
+{
+    auto item = getItem(id);
+    if (item)
+        item->position = position;
+}
+
+const Vec3& BillBoardBatch::getBillBoardPosition(int id) const
+{
+    auto item = const_cast<BillBoardBatch*>(this)->getItem(id);
+    return item ? item->position : Vec3::ZERO;
+}
+
+void BillBoardBatch::setBillBoardSize(int id, const Size& size)
+{
+    auto item = getItem(id);
+    if (item)
+        item->size = size;
+}
+
+void BillBoardBatch::setBillBoardColor(int id, const Color4B& color)
+{
+    auto item = getItem(id);
+    if (item)
+        item->color = color;
+}
+
+void BillBoardBatch::setBillBoardVisible(int id, bool visible)
+{
+    auto item = getItem(id);
+    if (item)
+        item->visible = visible;
+}
+
+void BillBoardBatch::setBillBoardAnchorPoint(int id, const Vec2& anchorPoint)
+{
+    auto item = getItem(id);
+    if (item)
+        item->anchorPoint = anchorPoint;
+}
+
+void BillBoardBatch::computeQuads(const Mat4& transform, const Camera* camera)
+{
+    // gather the visible billboards, padded to a multiple of 4 with empty ones
+    _visibleItems.clear();
+    for (int i = 0; i < (int)_items.size(); ++i)
+    {
+        if (_items[i].visible)
+            _visibleItems.push_back(i);
+    }
+    _visibleCount = (int)_visibleItems.size();
+    _stride = (_visibleCount + 3) & ~3;
+    _components.assign(_stride * COMPONENT_COUNT, 0.0f);
+    if (_visibleCount == 0)
+        return;
+
+    float* x = &_components[COMPONENT_X * _stride];
+    float* y = &_components[COMPONENT_Y * _stride];
+    float* z = &_components[COMPONENT_Z * _stride];
+    float* width = &_components[COMPONENT_WIDTH * _stride];
+    float* height = &_components[COMPONENT_HEIGHT * _stride];
+    float* anchorX = &_components[COMPONENT_ANCHOR_X * _stride];
+    float* anchorY = &_components[COMPONENT_ANCHOR_Y * _stride];
+    for (int i = 0; i < _visibleCount; ++i)
+    {
+        const Item& item = _items[_visibleItems[i]];
+        x[i] = item.position.x;
+        y[i] = item.position.y;
+        z[i] = item.position.z;
+        width[i] = item.size.width;
+        height[i] = item.size.height;
+        anchorX[i] = item.anchorPoint.x;
+        anchorY[i] = item.anchorPoint.y;
+    }
+
+    // the camera frame, as in BillBoard::calculateBillbaordTransform
+    const Mat4& camWorldMat = camera->getNodeToWorldTransform();
+    Vec3 camPos(camWorldMat.m[12], camWorldMat.m[13], camWorldMat.m[14]);
+    Vec3 camUp, camForward;
+    camWorldMat.transformVector(Vec3(0.0f, 1.0f, 0.0f), &camUp);
+    camWorldMat.transformVector(Vec3(0.0f, 0.0f, -1.0f), &camForward);
+    camForward.normalize();
+    Vec3 planeRight, planeUp;
+    Vec3::cross(camForward, camUp, &planeRight);
+    planeRight.normalize();
+    Vec3::cross(planeRight, camForward, &planeUp);
+
+    const float* m = transform.m;
+    float scaleX = sqrtf(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+    float scaleY = sqrtf(m[4] * m[4] + m[5] * m[5] + m[6] * m[6]);
+    bool viewPoint = _mode == BillBoard::Mode::VIEW_POINT_ORIENTED;
+
+    const float4 m0 = splat4(m[0]), m1 = splat4(m[1]), m2 = splat4(m[2]);
+    const float4 m4 = splat4(m[4]), m5 = splat4(m[5]), m6 = splat4(m[6]);
+    const float4 m8 = splat4(m[8]), m9 = splat4(m[9]), m10 = splat4(m[10]);
+    const float4 m12 = splat4(m[12]), m13 = splat4(m[13]), m14 = splat4(m[14]);
+    const float4 camX = splat4(camPos.x), camY = splat4(camPos.y), camZ = splat4(camPos.z);
+    const float4 upX = splat4(camUp.x), upY = splat4(camUp.y), upZ = splat4(camUp.z);
+    const float4 forwardX = splat4(camForward.x), forwardY = splat4(camForward.y), forwardZ = splat4(camForward.z);
+    const float4 sx = splat4(scaleX), sy = splat4(scaleY);
+    const float4 zero = splat4(0.0f);
+
+    float* corners = &_components[COMPONENT_CORNERS * _stride];
+    float* depth = &_components[COMPONENT_DEPTH * _stride];
+    float* world = &_components[COMPONENT_WORLD * _stride];
+    for (int i = 0; i < _stride; i += 4)
+    {
+        float4 lx = load4(x + i), ly = load4(y + i), lz = load4(z + i);
+        float4 wx = madd4(m8, lz, madd4(m4, ly, madd4(m0, lx, m12)));
+        float4 wy = madd4(m9, lz, madd4(m5, ly, madd4(m1, lx, m13)));
+        float4 wz = madd4(m10, lz, madd4(m6, ly, madd4(m2, lx, m14)));
+        store4(world + i, wx);
+        store4(world + _stride + i, wy);
+        store4(world + 2 * _stride + i, wz);
+        float4 dx = sub4(wx, camX), dy = sub4(wy, camY), dz = sub4(wz, camZ);
+        store4(depth + i, madd4(dz, forwardZ, madd4(dy, forwardY, mul4(dx, forwardX))));
+
+        float4 rx, ry, rz, ux, uy, uz;
+        if (viewPoint)
+        {
+            float4 inv = rsqrt4(madd4(dz, dz, madd4(dy, dy, mul4(dx, dx))));
+            dx = mul4(dx, inv);
+            dy = mul4(dy, inv);
+            dz = mul4(dz, inv);
+            rx = sub4(mul4(dy, upZ), mul4(dz, upY));
+            ry = sub4(mul4(dz, upX), mul4(dx, upZ));
+            rz = sub4(mul4(dx, upY), mul4(dy, upX));
+            inv = rsqrt4(madd4(rz, rz, madd4(ry, ry, mul4(rx, rx))));
+            rx = mul4(rx, inv);
+            ry = mul4(ry, inv);
+            rz = mul4(rz, inv);
+            ux = sub4(mul4(ry, dz), mul4(rz, dy));
+            uy = sub4(mul4(rz, dx), mul4(rx, dz));
+            uz = sub4(mul4(rx, dy), mul4(ry, dx));
+        }
+        else
+        {
+            rx = splat4(planeRight.x); ry = splat4(planeRight.y); rz = splat4(planeRight.z);
+            ux = splat4(planeUp.x); uy = splat4(planeUp.y); uz = splat4(planeUp.z);
+        }
+
+        float4 w = mul4(load4(width + i), sx);
+        float4 h = mul4(load4(height + i), sy);
+        float4 left = sub4(zero, mul4(load4(anchorX + i), w));
+        float4 right = add4(left, w);
+        float4 bottom = sub4(zero, mul4(load4(anchorY + i), h));
+        float4 top = add4(bottom, h);
+
+        // bottom left, bottom right, top left, top right
+        const float4* horizontal[4] = { &left, &right, &left, &right };
+        const float4* vertical[4] = { &bottom, &bottom, &top, &top };
+        for (int c = 0; c < 4; ++c)
+        {
+            float* corner = corners + c * 3 * _stride + i;
+            store4(corner, madd4(ux, *vertical[c], madd4(rx, *horizontal[c], wx)));
+            store4(corner + _stride, madd4(uy, *vertical[c], madd4(ry, *horizontal[c], wy)));
+            store4(corner + 2 * _stride, madd4(uz, *vertical[c], madd4(rz, *horizontal[c], wz)));
+        }
+    }
+}
+
+void BillBoardBatch::sortQuads()
+{
+    _order.resize(_visibleCount);
+    for (int i = 0; i < _visibleCount; ++i)
+        _order[i] = i;
+
+    const float* depth = &_components[COMPONENT_DEPTH * _stride];
+    const std::vector<Item>& items = _items;
+    const std::vector<int>& visibleItems = _visibleItems;
+    auto textureOf = [&items, &visibleItems](int i) { return items[visibleItems[i]].texture; };
+    bool sorted = _transparent;
+    switch (_sortMode)
+    {
+        case SortMode::NONE:
+            std::stable_sort(_order.begin(), _order.end(), [&textureOf](int a, int b) {
+                return textureOf(a) < textureOf(b);
+            });
+            break;
+        case SortMode::PER_TEXTURE:
+            std::sort(_order.begin(), _order.end(), [&textureOf, depth, sorted](int a, int b) {
+                if (textureOf(a) != textureOf(b))
+                    return textureOf(a) < textureOf(b);
+                return sorted && depth[a] > depth[b];
+            });
+            break;
+        case SortMode::GLOBAL:
+            std::sort(_order.begin(), _order.end(), [&textureOf, depth, sorted](int a, int b) {
+                if (sorted && depth[a] != depth[b])
+                    return depth[a] > depth[b];
+                return textureOf(a) < textureOf(b);
+            });
+            break;
+    }
+
+    // runs of quads of the same texture
+    _runs.clear();
+    for (int i = 0; i < _visibleCount; ++i)
+    {
+        int texture = textureOf(_order[i]);
+        if (_runs.empty() || _runs.back().texture != texture || _runs.back().count == MAX_QUADS_PER_COMMAND)
+        {
+            Run run = { texture, i, 0 };
+            _runs.push_back(run);
+        }
+        _runs.back().count++;
+    }
+}
+
+void BillBoardBatch::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
+{
+    _commandCount = 0;
+    auto camera = Camera::getVisitingCamera();
+    if (!camera || _items.empty())
+        return;
+
+    computeQuads(transform, camera);
+    if (_visibleCount == 0)
+        return;
+    sortQuads();
+
+    if (_indices.empty())
+    {
+        _indices.resize(MAX_QUADS_PER_COMMAND * 6);
+        for (int i = 0; i < MAX_QUADS_PER_COMMAND; ++i)
+        {
+            unsigned short base = (unsigned short)(i * 4);
+            unsigned short* quad = &_indices[i * 6];
+            quad[0] = base;
+            quad[1] = base + 1;
+            quad[2] = base + 2;
+            quad[3] = base + 3;
+            quad[4] = base + 2;
+            quad[5] = base + 1;
+        }
+    }
+
+    // the vertices of a command are relative to its farthest billboard, which is the translation of the
+    // command's transform, so the renderer sorts the commands by the depth of that billboard
+    _vertices.resize(_visibleCount * 4);
+    if (_commands.size() < _runs.size())
+        _commands.resize(_runs.size());
+
+    const float* corners = &_components[COMPONENT_CORNERS * _stride];
+    const float* depth = &_components[COMPONENT_DEPTH * _stride];
+    const float* world = &_components[COMPONENT_WORLD * _stride];
+    flags |= Node::FLAGS_RENDER_AS_3D;
+    for (const auto& run : _runs)
+    {
+        int origin = _order[run.start];
+        for (int i = run.start + 1; i < run.start + run.count; ++i)
+        {
+            if (depth[_order[i]] > depth[origin])
+                origin = _order[i];
+        }
+        Vec3 translation(world[origin], world[_stride + origin], world[2 * _stride + origin]);
+
+        for (int i = run.start; i < run.start + run.count; ++i)
+        {
+            int index = _order[i];
+            const Item& item = _items[_visibleItems[index]];
+            V3F_C4B_T2F* quad = &_vertices[i * 4];
+            for (int c = 0; c < 4; ++c)
+            {
+                const float* corner = corners + c * 3 * _stride + index;
+                quad[c].vertices.set(corner[0] - translation.x, corner[_stride] - translation.y, corner[2 * _stride] - translation.z);
+                quad[c].colors = item.color;
+            }
+            quad[0].texCoords = Tex2F(item.u0, item.v1);
+            quad[1].texCoords = Tex2F(item.u1, item.v1);
+            quad[2].texCoords = Tex2F(item.u0, item.v0);
+            quad[3].texCoords = Tex2F(item.u1, item.v0);
+        }
+
+        TrianglesCommand::Triangles triangles;
+        triangles.verts = &_vertices[run.start * 4];
+        triangles.vertCount = run.count * 4;
+        triangles.indices = &_indices[0];
+        triangles.indexCount = run.count * 6;
+
+        Mat4 mv;
+        mv.translate(translation);
+        auto& command = _commands[_commandCount++];
+        command.init(_globalZOrder, _textures.at(run.texture)->getName(), getGLProgramState(), _blendFunc, triangles, mv, flags);
+        command.setTransparent(_transparent);
+        command.set3D(true);
+        renderer->addCommand(&command);
+    }
+}
+
+NS_CC_END
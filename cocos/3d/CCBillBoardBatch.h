@@ -0,0 +1,178 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CCBILLBOARD_BATCH_H__
+#define __CCBILLBOARD_BATCH_H__
+
+#include <vector>
+
+#include "2d/CCNode.h"
+#include "3d/CCBillBoard.h"
+#include "renderer/CCTrianglesCommand.h"
+
+NS_CC_BEGIN
+
+class Texture2D;
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/**
+ * @brief Draws many billboards facing the camera, e.g. forests or nameplates.
+ *
+ * The billboards aren't nodes, they are items of the batch with a position in the space of the batch, a size,
+ * a texture rect and a color. Each frame their quads are generated in one pass, four billboards at a time
+ * with SSE or NEON where available, and drawn with one TrianglesCommand per texture.
+ * Transparent billboards are sorted back to front according to the sort mode.
+ */
+class CC_DLL BillBoardBatch : public Node
+{
+public:
+    /** How the quads of transparent billboards are sorted */
+    enum class SortMode
+    {
+        NONE, // one command per texture, unsorted, for alpha tested or additive billboards
+        PER_TEXTURE, // one command per texture, sorted back to front in each command; the commands are sorted by the renderer
+        GLOBAL, // sorted back to front across textures, one command per run of billboards of the same texture
+    };
+
+    /**
+     * Creates an empty batch.
+     * @param mode The orientation of the billboards, see BillBoard::Mode.
+     * @return An autoreleased BillBoardBatch object.
+     */
+    static BillBoardBatch* create(BillBoard::Mode mode = BillBoard::Mode::VIEW_POINT_ORIENTED);
+
+    /**
+     * Adds a billboard.
+     * @param texture The texture.
+     * @param rect The rect of the texture in pixels, Rect::ZERO for the whole texture.
+     * @param position The position of its anchor point in the space of the batch.
+     * @param size The size of the billboard in the space of the batch.
+     * @param color The color, premultiplied for premultiplied textures.
+     * @return The id of the billboard.
+     */
+    int addBillBoard(Texture2D* texture, const Rect& rect, const Vec3& position, const Size& size, const Color4B& color = Color4B::WHITE);
+
+    /** Removes a billboard. */
+    void removeBillBoard(int id);
+
+    /** Removes all the billboards and releases the textures. */
+    void removeAllBillBoards();
+
+    void setBillBoardPosition(int id, const Vec3& position);
+    const Vec3& getBillBoardPosition(int id) const;
+    void setBillBoardSize(int id, const Size& size);
+    void setBillBoardColor(int id, const Color4B& color);
+    void setBillBoardVisible(int id, bool visible);
+    /** The point the billboard turns around, normalized. Default is (0.5, 0.5). */
+    void setBillBoardAnchorPoint(int id, const Vec2& anchorPoint);
+
+    /** Number of billboards. */
+    ssize_t getBillBoardCount() const { return _items.size(); }
+
+    void setMode(BillBoard::Mode mode) { _mode = mode; }
+    BillBoard::Mode getMode() const { return _mode; }
+
+    /** Sets whether the billboards are drawn in the transparent queue, without writing the depth. Default is true. */
+    void setTransparent(bool transparent) { _transparent = transparent; }
+    bool isTransparent() const { return _transparent; }
+
+    /** Default is PER_TEXTURE. */
+    void setSortMode(SortMode mode) { _sortMode = mode; }
+    SortMode getSortMode() const { return _sortMode; }
+
+    /** Default is BlendFunc::ALPHA_PREMULTIPLIED. */
+    void setBlendFunc(const BlendFunc& blendFunc) { _blendFunc = blendFunc; }
+    const BlendFunc& getBlendFunc() const { return _blendFunc; }
+
+    /** Number of commands of the last draw. */
+    int getCommandCount() const { return _commandCount; }
+
+    // Overrides
+    virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
+
+CC_CONSTRUCTOR_ACCESS:
+    BillBoardBatch();
+    virtual ~BillBoardBatch();
+
+    bool init(BillBoard::Mode mode);
+
+protected:
+    struct Item
+    {
+        Vec3 position;
+        Size size;
+        Vec2 anchorPoint;
+        // u0, v0 is the top left corner
+        float u0, v0, u1, v1;
+        Color4B color;
+        int texture;
+        bool visible;
+        int id;
+    };
+
+    struct Run
+    {
+        int texture;
+        int start;
+        int count;
+    };
+
+    Item* getItem(int id);
+    void computeQuads(const Mat4& transform, const Camera* camera);
+    void sortQuads();
+
+    BillBoard::Mode _mode;
+    bool _transparent;
+    SortMode _sortMode;
+    BlendFunc _blendFunc;
+
+    std::vector<Item> _items;
+    std::vector<int> _itemIndices; // per id, -1 if free
+    std::vector<int> _freeIds;
+    Vector<Texture2D*> _textures;
+
+    // per frame, the components of the visible billboards are stored one after the other, _stride floats each
+    int _visibleCount;
+    int _stride;
+    std::vector<float> _components;
+    std::vector<int> _visibleItems;
+    std::vector<int> _order;
+    std::vector<Run> _runs;
+    std::vector<V3F_C4B_T2F> _vertices;
+    std::vector<unsigned short> _indices;
+    std::vector<TrianglesCommand> _commands;
+    int _commandCount;
+};
+
+// end of 3d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCBILLBOARD_BATCH_H__
@@ -27,6 +27,7 @@ THE SOFTWARE.
 
 #include "base/ccMacros.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCMappedFile.h"
 #include "renderer/CCGLProgram.h"
 #include "CCBundleReader.h"
 #include "base/CCData.h"
@@ -162,7 +163,7 @@ void Bundle3D::clear()
 {
     if (_isBinary)
     {
-        CC_SAFE_DELETE(_binaryBuffer);
+        CC_SAFE_RELEASE_NULL(_binaryBuffer);
         CC_SAFE_DELETE_ARRAY(_references);
     }
     else
@@ -397,6 +398,8 @@ bool  Bundle3D::loadMeshDatasBinary(MeshDatas& meshdatas)
         CCLOG("warning: Failed to read meshdata: attribCount '%s'.", _path.c_str());
         return false;
     }
+    // the aabbs of older versions are calculated from the copied vertices
+    bool zeroCopy = _meshDataZeroCopy && _version != "0.3" && _version != "0.4" && _version != "0.5";
     MeshData*   meshData = nullptr;
     for(unsigned int i = 0; i < meshSize ; i++ )
     {
@@ -434,11 +437,26 @@ bool  Bundle3D::loadMeshDatasBinary(MeshDatas& meshdatas)
             goto FAILED;
         }
 
-        meshData->vertex.resize(vertexSizeInFloat);
-        if (_binaryReader.read(&meshData->vertex[0], 4, vertexSizeInFloat) != vertexSizeInFloat)
+        if (zeroCopy)
         {
-            CCLOG("warning: Failed to read meshdata: vertex element '%s'.", _path.c_str());
-            goto FAILED;
+            meshData->source = _binaryBuffer;
+            _binaryBuffer->retain();
+            meshData->vertexSizeInFloat = vertexSizeInFloat;
+            meshData->sourceVertex = _binaryReader.readBlock((ssize_t)vertexSizeInFloat * 4);
+            if (meshData->sourceVertex == nullptr)
+            {
+                CCLOG("warning: Failed to read meshdata: vertex element '%s'.", _path.c_str());
+                goto FAILED;
+            }
+        }
+        else
+        {
+            meshData->vertex.resize(vertexSizeInFloat);
+            if (_binaryReader.read(&meshData->vertex[0], 4, vertexSizeInFloat) != vertexSizeInFloat)
+            {
+                CCLOG("warning: Failed to read meshdata: vertex element '%s'.", _path.c_str());
+                goto FAILED;
+            }
         }
 
         // Read index data
@@ -456,14 +474,28 @@ bool  Bundle3D::loadMeshDatasBinary(MeshDatas& meshdatas)
                 CCLOG("warning: Failed to read meshdata: nIndexCount '%s'.", _path.c_str());
                 goto FAILED;
             }
-            indexArray.resize(nIndexCount);
-            if (_binaryReader.read(&indexArray[0], 2, nIndexCount) != nIndexCount)
+            if (zeroCopy)
             {
-                CCLOG("warning: Failed to read meshdata: indices '%s'.", _path.c_str());
-                goto FAILED;
+                const char* indices = _binaryReader.readBlock((ssize_t)nIndexCount * 2);
+                if (indices == nullptr)
+                {
+                    CCLOG("warning: Failed to read meshdata: indices '%s'.", _path.c_str());
+                    goto FAILED;
+                }
+                meshData->sourceSubMeshIndices.push_back(std::make_pair(indices, nIndexCount));
+                meshData->numIndex = (int)meshData->sourceSubMeshIndices.size();
+            }
+            else
+            {
+                indexArray.resize(nIndexCount);
+                if (_binaryReader.read(&indexArray[0], 2, nIndexCount) != nIndexCount)
+                {
+                    CCLOG("warning: Failed to read meshdata: indices '%s'.", _path.c_str());
+                    goto FAILED;
+                }
+                meshData->subMeshIndices.push_back(indexArray);
+                meshData->numIndex = (int)meshData->subMeshIndices.size();
             }
-            meshData->subMeshIndices.push_back(indexArray);
-            meshData->numIndex = (int)meshData->subMeshIndices.size();
             //meshData->subMeshAABB.push_back(calculateAABB(meshData->vertex, meshData->getPerVertexSize(), indexArray));
             if (_version != "0.3" && _version != "0.4" && _version != "0.5")
             {
@@ -1066,19 +1098,18 @@ bool Bundle3D::loadBinary(const std::string& path)
 {
     clear();
     
-    // get file data
-    CC_SAFE_DELETE(_binaryBuffer);
-    _binaryBuffer = new (std::nothrow) Data();
-    *_binaryBuffer = FileUtils::getInstance()->getDataFromFile(path);
-    if (_binaryBuffer->isNull())
+    // map or read the file
+    CC_SAFE_RELEASE_NULL(_binaryBuffer);
+    _binaryBuffer = new (std::nothrow) MappedFile();
+    if (!_binaryBuffer->init(path))
     {
         clear();
         CCLOG("warning: Failed to read file: %s", path.c_str());
         return false;
     }
     
-    // Initialise bundle reader
-    _binaryReader.init( (char*)_binaryBuffer->getBytes(),  _binaryBuffer->getSize() );
+    // Initialise bundle reader, it only reads the buffer
+    _binaryReader.init((char*)_binaryBuffer->getBytes(), _binaryBuffer->getSize());
     
     // Read identifier info
     char identifier[] = { 'C', '3', 'B', '\0'};
@@ -2195,7 +2226,8 @@ _jsonBuffer(nullptr),
 _binaryBuffer(nullptr),
 _referenceCount(0),
 _references(nullptr),
-_isBinary(false)
+_isBinary(false),
+_meshDataZeroCopy(false)
 {
 
 }
@@ -38,6 +38,7 @@ NS_CC_BEGIN
 
 class Animation3D;
 class Data;
+class MappedFile;
 
 /**
  * @brief Defines a bundle file that contains a collection of assets. Mesh, Material, MeshSkin, Animation
@@ -66,6 +67,15 @@ public:
      */
     virtual bool load(const std::string& path);
     
+    /**
+     * Loads the vertices and indices of .c3b meshes without copying them, disabled by default.
+     * The mesh datas then reference the loaded file, which is mapped into memory where possible,
+     * and keep it alive. Read them with MeshData::getVertexData() and MeshData::getIndexData(),
+     * vertex and subMeshIndices stay empty.
+     */
+    void setMeshDataZeroCopy(bool zeroCopy) { _meshDataZeroCopy = zeroCopy; }
+    bool isMeshDataZeroCopy() const { return _meshDataZeroCopy; }
+    
     /**
      * load skin data from bundle
      * @param id The ID of the skin, load the first Skin in the bundle if it is empty
@@ -181,11 +191,12 @@ protected:
     rapidjson::Document _jsonReader;
 
     // for binary reading
-    Data* _binaryBuffer;
+    MappedFile* _binaryBuffer;
     BundleReader _binaryReader;
     unsigned int _referenceCount;
     Reference* _references;
     bool  _isBinary;
+    bool  _meshDataZeroCopy;
 };
 
 // end of 3d group
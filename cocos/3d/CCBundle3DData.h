@@ -152,6 +152,12 @@ struct MeshData
     int numIndex;
     std::vector<MeshVertexAttrib> attribs;
     int attribCount;
+    
+    // set when the vertices and indices are left in the loaded file instead of being copied into
+    // vertex and subMeshIndices (see Bundle3D::setMeshDataZeroCopy), the file is retained until resetData()
+    Ref* source;
+    const char* sourceVertex; // vertexSizeInFloat floats
+    std::vector<std::pair<const char*, unsigned int>> sourceSubMeshIndices; // indices and their count
 
 public:
     /**
@@ -167,6 +173,31 @@ public:
         }
         return vertexsize;
     }
+    
+    /** Get the vertices, they may not be 4 byte aligned if they are in the loaded file */
+    const void* getVertexData() const
+    {
+        if (source)
+            return sourceVertex;
+        return vertex.empty() ? nullptr : &vertex[0];
+    }
+    /** Get the number of floats in the vertices */
+    int getVertexSizeInFloat() const { return source ? vertexSizeInFloat : (int)vertex.size(); }
+    
+    /** Get the number of sub meshes */
+    size_t getSubMeshCount() const { return source ? sourceSubMeshIndices.size() : subMeshIndices.size(); }
+    /** Get the indices of a sub mesh, they may not be 2 byte aligned if they are in the loaded file */
+    const void* getIndexData(size_t subMesh) const
+    {
+        if (source)
+            return sourceSubMeshIndices[subMesh].first;
+        return subMeshIndices[subMesh].empty() ? nullptr : &subMeshIndices[subMesh][0];
+    }
+    /** Get the number of indices of a sub mesh */
+    unsigned int getIndexCount(size_t subMesh) const
+    {
+        return source ? sourceSubMeshIndices[subMesh].second : (unsigned int)subMeshIndices[subMesh].size();
+    }
 
     /**
      * Reset the data
@@ -180,12 +211,53 @@ public:
         vertexSizeInFloat = 0;
         numIndex = 0;
         attribCount = 0;
+        CC_SAFE_RELEASE_NULL(source);
+        sourceVertex = nullptr;
+        sourceSubMeshIndices.clear();
     }
     MeshData()
     : vertexSizeInFloat(0)
     , numIndex(0)
     , attribCount(0)
+    , source(nullptr)
+    , sourceVertex(nullptr)
+    {
+    }
+    // copies share the loaded file, each retains it
+    MeshData(const MeshData& other)
+    : vertex(other.vertex)
+    , vertexSizeInFloat(other.vertexSizeInFloat)
+    , subMeshIndices(other.subMeshIndices)
+    , subMeshIds(other.subMeshIds)
+    , subMeshAABB(other.subMeshAABB)
+    , numIndex(other.numIndex)
+    , attribs(other.attribs)
+    , attribCount(other.attribCount)
+    , source(other.source)
+    , sourceVertex(other.sourceVertex)
+    , sourceSubMeshIndices(other.sourceSubMeshIndices)
     {
+        CC_SAFE_RETAIN(source);
+    }
+    MeshData& operator=(const MeshData& other)
+    {
+        if (this != &other)
+        {
+            CC_SAFE_RETAIN(other.source);
+            CC_SAFE_RELEASE(source);
+            vertex = other.vertex;
+            vertexSizeInFloat = other.vertexSizeInFloat;
+            subMeshIndices = other.subMeshIndices;
+            subMeshIds = other.subMeshIds;
+            subMeshAABB = other.subMeshAABB;
+            numIndex = other.numIndex;
+            attribs = other.attribs;
+            attribCount = other.attribCount;
+            source = other.source;
+            sourceVertex = other.sourceVertex;
+            sourceSubMeshIndices = other.sourceSubMeshIndices;
+        }
+        return *this;
     }
     ~MeshData()
     {
@@ -159,6 +159,19 @@ bool BundleReader::rewind()
     return false;
 }
 
+const char* BundleReader::readBlock(ssize_t size)
+{
+    if (!_buffer || size < 0 || _length - _position < size)
+    {
+        CCLOG("warning: bundle reader out of range");
+        return nullptr;
+    }
+    
+    const char* block = _buffer + _position;
+    _position += size;
+    return block;
+}
+
 std::string BundleReader::readString()
 {
     unsigned int length;
@@ -29,6 +29,7 @@
 #include <vector>
 
 #include "base/CCRef.h"
+#include "base/CCData.h"
 #include "platform/CCPlatformMacros.h"
 #include "base/CCConsole.h"
 
@@ -112,6 +113,12 @@ public:
     template<typename T> bool read(T* ptr);
     template<typename T> bool readArray(unsigned int* length, std::vector<T>* values);
 
+    /**
+     * Returns a pointer to the next size bytes of the buffer and skips them, without copying them.
+     * Returns nullptr if the buffer is too short. The bytes may not be aligned.
+     */
+    const char* readBlock(ssize_t size);
+
     /**
      * first read length, then read string text
      */
@@ -25,33 +25,95 @@
 #include "3d/CCFrustum.h"
 #include "2d/CCCamera.h"
 
+#if defined (__SSE__)
+#define USE_SSE
+#include <xmmintrin.h>
+#elif defined (__arm64__) || defined (__aarch64__) || ((CC_TARGET_PLATFORM == CC_PLATFORM_IOS) && defined (__ARM_NEON__))
+#define USE_NEON
+#include <arm_neon.h>
+#endif
+
 NS_CC_BEGIN
 
 bool Frustum::initFrustum(const Camera* camera)
+{
+    return initFrustum(camera->getViewProjectionMatrix());
+}
+
+bool Frustum::initFrustum(const Mat4& viewProjection)
 {
     _initialized = true;
-    createPlane(camera);
+    createPlane(viewProjection);
     return true;
 }
 bool Frustum::isOutOfFrustum(const AABB& aabb) const
 {
-    if (_initialized)
-    {
-        Vec3 point;
+    return intersectAABB(aabb) == Intersection::OUTSIDE;
+}
 
-        int plane = _clipZ ? 6 : 4;
-        for (int i = 0; i < plane; i++)
+Frustum::Intersection Frustum::intersectAABB(const AABB& aabb, unsigned int* planeMask) const
+{
+    unsigned int mask = planeMask ? *planeMask : getAllPlanesMask();
+    if (!_initialized || mask == 0)
+        return Intersection::INSIDE;
+    
+    // the corner nearest to the inside of a plane is center - |normal| * extents, the farthest center + |normal| * extents
+    float centerX = (aabb._min.x + aabb._max.x) * 0.5f;
+    float centerY = (aabb._min.y + aabb._max.y) * 0.5f;
+    float centerZ = (aabb._min.z + aabb._max.z) * 0.5f;
+    float extentX = (aabb._max.x - aabb._min.x) * 0.5f;
+    float extentY = (aabb._max.y - aabb._min.y) * 0.5f;
+    float extentZ = (aabb._max.z - aabb._min.z) * 0.5f;
+    
+    unsigned int outside = 0;
+    unsigned int inside = 0;
+    for (int group = 0; group < 8; group += 4)
+    {
+        if (((mask >> group) & 0xf) == 0)
+            continue;
+        
+#if defined (USE_SSE)
+        const __m128 signMask = _mm_set1_ps(-0.f);
+        __m128 x = _mm_loadu_ps(_planeX + group);
+        __m128 y = _mm_loadu_ps(_planeY + group);
+        __m128 z = _mm_loadu_ps(_planeZ + group);
+        __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(centerX)), _mm_mul_ps(y, _mm_set1_ps(centerY))),
+                                 _mm_sub_ps(_mm_mul_ps(z, _mm_set1_ps(centerZ)), _mm_loadu_ps(_planeDist + group)));
+        __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, x), _mm_set1_ps(extentX)),
+                                              _mm_mul_ps(_mm_andnot_ps(signMask, y), _mm_set1_ps(extentY))),
+                                   _mm_mul_ps(_mm_andnot_ps(signMask, z), _mm_set1_ps(extentZ)));
+        outside |= (unsigned int)_mm_movemask_ps(_mm_cmpgt_ps(_mm_sub_ps(dist, radius), _mm_setzero_ps())) << group;
+        inside |= (unsigned int)_mm_movemask_ps(_mm_cmple_ps(_mm_add_ps(dist, radius), _mm_setzero_ps())) << group;
+#elif defined (USE_NEON)
+        float32x4_t x = vld1q_f32(_planeX + group);
+        float32x4_t y = vld1q_f32(_planeY + group);
+        float32x4_t z = vld1q_f32(_planeZ + group);
+        float32x4_t dist = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vnegq_f32(vld1q_f32(_planeDist + group)), x, centerX), y, centerY), z, centerZ);
+        float32x4_t radius = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(vabsq_f32(x), extentX), vabsq_f32(y), extentY), vabsq_f32(z), extentZ);
+        uint32x4_t out = vcgtq_f32(vsubq_f32(dist, radius), vdupq_n_f32(0.f));
+        uint32x4_t in = vcleq_f32(vaddq_f32(dist, radius), vdupq_n_f32(0.f));
+        outside |= ((vgetq_lane_u32(out, 0) & 1) | (vgetq_lane_u32(out, 1) & 2) | (vgetq_lane_u32(out, 2) & 4) | (vgetq_lane_u32(out, 3) & 8)) << group;
+        inside |= ((vgetq_lane_u32(in, 0) & 1) | (vgetq_lane_u32(in, 1) & 2) | (vgetq_lane_u32(in, 2) & 4) | (vgetq_lane_u32(in, 3) & 8)) << group;
+#else
+        for (int i = group; i < group + 4; i++)
         {
-            const Vec3& normal = _plane[i].getNormal();
-            point.x = normal.x < 0 ? aabb._max.x : aabb._min.x;
-            point.y = normal.y < 0 ? aabb._max.y : aabb._min.y;
-            point.z = normal.z < 0 ? aabb._max.z : aabb._min.z;
-            
-            if (_plane[i].getSide(point) == PointSide::FRONT_PLANE )
-                return true;
+            float dist = _planeX[i] * centerX + _planeY[i] * centerY + _planeZ[i] * centerZ - _planeDist[i];
+            float radius = fabsf(_planeX[i]) * extentX + fabsf(_planeY[i]) * extentY + fabsf(_planeZ[i]) * extentZ;
+            if (dist - radius > 0)
+                outside |= 1u << i;
+            if (dist + radius <= 0)
+                inside |= 1u << i;
         }
+#endif
     }
-    return false;
+    
+    if (outside & mask)
+        return Intersection::OUTSIDE;
+    
+    mask &= ~inside;
+    if (planeMask)
+        *planeMask = mask;
+    return mask == 0 ? Intersection::INSIDE : Intersection::INTERSECTING;
 }
 
 bool Frustum::isOutOfFrustum(const OBB& obb) const
@@ -79,9 +141,8 @@ bool Frustum::isOutOfFrustum(const OBB& obb) const
     return  false;
 }
 
-void Frustum::createPlane(const Camera* camera)
+void Frustum::createPlane(const Mat4& mat)
 {
-    const Mat4& mat = camera->getViewProjectionMatrix();
     //ref http://www.lighthouse3d.com/tutorials/view-frustum-culling/clip-space-approach-extracting-the-planes/
     //extract frustum plane
     _plane[0].initPlane(-Vec3(mat.m[3] + mat.m[0], mat.m[7] + mat.m[4], mat.m[11] + mat.m[8]), (mat.m[15] + mat.m[12]));//left
@@ -90,6 +151,15 @@ void Frustum::createPlane(const Camera* camera)
     _plane[3].initPlane(-Vec3(mat.m[3] - mat.m[1], mat.m[7] - mat.m[5], mat.m[11] - mat.m[9]), (mat.m[15] - mat.m[13]));//top
     _plane[4].initPlane(-Vec3(mat.m[3] + mat.m[2], mat.m[7] + mat.m[6], mat.m[11] + mat.m[10]), (mat.m[15] + mat.m[14]));//near
     _plane[5].initPlane(-Vec3(mat.m[3] - mat.m[2], mat.m[7] - mat.m[6], mat.m[11] - mat.m[10]), (mat.m[15] - mat.m[14]));//far
+    
+    for (int i = 0; i < 8; i++)
+    {
+        const Vec3& normal = i < 6 ? _plane[i].getNormal() : Vec3::ZERO;
+        _planeX[i] = normal.x;
+        _planeY[i] = normal.y;
+        _planeZ[i] = normal.z;
+        _planeDist[i] = i < 6 ? _plane[i].getDist() : 0.f;
+    }
 }
 
 NS_CC_END
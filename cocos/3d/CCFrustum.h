@@ -55,11 +55,37 @@ public:
      * init frustum from camera.
      */
     bool initFrustum(const Camera* camera);
+    
+    /**
+     * init frustum from a view projection matrix.
+     */
+    bool initFrustum(const Mat4& viewProjection);
 
     /**
      * is aabb out of frustum.
      */
     bool isOutOfFrustum(const AABB& aabb) const;
+    
+    /**
+     * result of intersectAABB
+     */
+    enum class Intersection
+    {
+        OUTSIDE,
+        INTERSECTING,
+        INSIDE
+    };
+    
+    /**
+     * Tests an aabb against the planes, four at a time with SSE or NEON where available.
+     * planeMask is used for hierarchical culling: its bits are the planes to test, initialize it to
+     * getAllPlanesMask(). The planes the aabb is fully inside of are removed from it, so the aabbs
+     * it contains only test the remaining planes, and none once the result is INSIDE.
+     */
+    Intersection intersectAABB(const AABB& aabb, unsigned int* planeMask = nullptr) const;
+    
+    /** the plane mask to start intersectAABB with */
+    unsigned int getAllPlanesMask() const { return _clipZ ? 0x3f : 0x0f; }
     /**
      * is obb out of frustum
      */
@@ -75,9 +101,14 @@ protected:
     /**
      * create clip plane
      */
-    void createPlane(const Camera* camera);
+    void createPlane(const Mat4& viewProjection);
 
     Plane _plane[6];             // clip plane, left, right, top, bottom, near, far
+    // the planes as structure of arrays for intersectAABB, padded to 8 with planes nothing is out of
+    float _planeX[8];
+    float _planeY[8];
+    float _planeZ[8];
+    float _planeDist[8];
     bool _clipZ;                // use near and far clip plane
     bool _initialized;
 };
@@ -35,6 +35,10 @@ MeshSkin::MeshSkin()
 : _rootBone(nullptr)
 , _skeleton(nullptr)
 , _matrixPalette(nullptr)
+, _matrixPaletteVersion(0)
+, _previousPalette(nullptr)
+, _interpolatedPalette(nullptr)
+, _interpolatedPaletteValue(1.f)
 {
     
 }
@@ -99,21 +103,79 @@ int MeshSkin::getBoneIndex(Bone3D* bone) const
 //compute matrix palette used by gpu skin
 Vec4* MeshSkin::getMatrixPalette()
 {
+    ssize_t paletteSize = _skinBones.size() * PALETTE_ROWS;
+    float interpolation = _skeleton ? _skeleton->getPoseInterpolation() : 1.f;
+    bool changed = true;
     if (_matrixPalette == nullptr)
     {
-        _matrixPalette = new (std::nothrow) Vec4[_skinBones.size() * PALETTE_ROWS];
+        _matrixPalette = new (std::nothrow) Vec4[paletteSize];
     }
-    int i = 0, paletteIndex = 0;
-    static Mat4 t;
-    for (auto it : _skinBones )
+    else if (_skeleton && _matrixPaletteVersion == _skeleton->getBoneMatrixVersion())
     {
-        Mat4::multiply(it->getWorldMat(), _invBindPoses[i++], &t);
-        _matrixPalette[paletteIndex++].set(t.m[0], t.m[4], t.m[8], t.m[12]);
-        _matrixPalette[paletteIndex++].set(t.m[1], t.m[5], t.m[9], t.m[13]);
-        _matrixPalette[paletteIndex++].set(t.m[2], t.m[6], t.m[10], t.m[14]);
+        changed = false;
     }
     
-    return _matrixPalette;
+    if (changed)
+    {
+        // the animation LOD interpolates from the previous pose to the last one
+        bool restart = false;
+        if (interpolation < 1.f || _previousPalette)
+        {
+            if (_previousPalette == nullptr)
+            {
+                _previousPalette = new (std::nothrow) Vec4[paletteSize];
+                restart = true;
+            }
+            else if (_skeleton->getPoseRestartVersion() > _matrixPaletteVersion)
+            {
+                restart = true;
+            }
+            else
+            {
+                memcpy(&_previousPalette[0].x, &_matrixPalette[0].x, paletteSize * 4 * sizeof(float));
+            }
+        }
+        
+        if (_skeleton)
+            _matrixPaletteVersion = _skeleton->getBoneMatrixVersion();
+        
+        int i = 0, paletteIndex = 0;
+        Mat4 t;
+        for (auto it : _skinBones )
+        {
+            Mat4::multiply(it->getWorldMat(), _invBindPoses[i++], &t);
+            _matrixPalette[paletteIndex++].set(t.m[0], t.m[4], t.m[8], t.m[12]);
+            _matrixPalette[paletteIndex++].set(t.m[1], t.m[5], t.m[9], t.m[13]);
+            _matrixPalette[paletteIndex++].set(t.m[2], t.m[6], t.m[10], t.m[14]);
+        }
+        
+        if (restart)
+            memcpy(&_previousPalette[0].x, &_matrixPalette[0].x, paletteSize * 4 * sizeof(float));
+    }
+    
+    if (interpolation >= 1.f || _previousPalette == nullptr)
+        return _matrixPalette;
+    
+    if (_interpolatedPalette == nullptr)
+    {
+        _interpolatedPalette = new (std::nothrow) Vec4[paletteSize];
+    }
+    else if (!changed && _interpolatedPaletteValue == interpolation)
+    {
+        return _interpolatedPalette;
+    }
+    _interpolatedPaletteValue = interpolation;
+    
+    // the rows of the palette are interpolated linearly, it is fine for the small steps between two evaluations
+    const float* from = &_previousPalette[0].x;
+    const float* to = &_matrixPalette[0].x;
+    float* dst = &_interpolatedPalette[0].x;
+    ssize_t count = paletteSize * 4;
+    for (ssize_t i = 0; i < count; i++)
+    {
+        dst[i] = from[i] + (to[i] - from[i]) * interpolation;
+    }
+    return _interpolatedPalette;
 }
 
 ssize_t MeshSkin::getMatrixPaletteSize() const
@@ -125,6 +187,8 @@ void MeshSkin::removeAllBones()
 {
     _skinBones.clear();
     CC_SAFE_DELETE_ARRAY(_matrixPalette);
+    CC_SAFE_DELETE_ARRAY(_previousPalette);
+    CC_SAFE_DELETE_ARRAY(_interpolatedPalette);
     CC_SAFE_RELEASE(_rootBone);
 }
 
@@ -67,7 +67,11 @@ public:
     /**get bone index*/
     int getBoneIndex(Bone3D* bone) const;
     
-    /**compute matrix palette used by gpu skin*/
+    /**compute matrix palette used by gpu skin
+     * it is only recomputed when the skeleton updated its bone matrices since the last call.
+     * When Skeleton3D::getPoseInterpolation() is smaller than 1, it returns the palette interpolated
+     * between the previous and the last pose.
+     */
     Vec4* getMatrixPalette();
     
     /**getSkinBoneCount() * 3*/
@@ -104,6 +108,12 @@ protected:
     // Each 4x3 row-wise matrix is represented as 3 Vec4's.
     // The number of Vec4's is (_skinBones.size() * 3).
     Vec4* _matrixPalette;
+    // Skeleton3D::getBoneMatrixVersion() when the palette was computed
+    unsigned int _matrixPaletteVersion;
+    // palette of the previous pose, allocated once the animation LOD interpolates poses
+    Vec4* _previousPalette;
+    Vec4* _interpolatedPalette;
+    float _interpolatedPaletteValue;
 };
 
 // end of 3d group
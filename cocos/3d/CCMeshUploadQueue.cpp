@@ -0,0 +1,224 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "3d/CCMeshUploadQueue.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "3d/CCMeshVertexIndexData.h"
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+
+NS_CC_BEGIN
+
+MeshUploadQueue* MeshUploadQueue::s_sharedQueue = nullptr;
+
+MeshUploadQueue* MeshUploadQueue::getInstance()
+{
+    if (s_sharedQueue == nullptr)
+    {
+        s_sharedQueue = new (std::nothrow) MeshUploadQueue();
+    }
+    return s_sharedQueue;
+}
+
+void MeshUploadQueue::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedQueue);
+}
+
+MeshUploadQueue::MeshUploadQueue()
+: _bytesPerFrame(1024 * 1024)
+, _pendingBytes(0)
+, _afterUpdateListener(nullptr)
+{
+    _afterUpdateListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [this](EventCustom* /*event*/){
+        if (!_batches.empty())
+            upload(_bytesPerFrame);
+    });
+}
+
+MeshUploadQueue::~MeshUploadQueue()
+{
+    Director::getInstance()->getEventDispatcher()->removeEventListener(_afterUpdateListener);
+    
+    // the callbacks release what the batches hold, they may queue more meshes, which are dropped too
+    while (!_batches.empty())
+    {
+        auto batch = _batches.front();
+        _batches.pop_front();
+        delete batch->meshdatas;
+        if (batch->callback)
+            batch->callback(false);
+        delete batch;
+    }
+}
+
+ssize_t MeshUploadQueue::getSize(const MeshData* meshdata)
+{
+    ssize_t size = (ssize_t)meshdata->getVertexSizeInFloat() * sizeof(float);
+    for (size_t i = 0; i < meshdata->getSubMeshCount(); ++i)
+    {
+        size += (ssize_t)meshdata->getIndexCount(i) * sizeof(unsigned short);
+    }
+    return size;
+}
+
+void MeshUploadQueue::enqueue(const Vector<MeshVertexData*>& vertexDatas, MeshDatas* meshdatas, const std::function<void(bool uploaded)>& callback)
+{
+    auto batch = new (std::nothrow) Batch();
+    batch->vertexDatas = vertexDatas;
+    batch->meshdatas = meshdatas;
+    batch->callback = callback;
+    batch->size = 0;
+    batch->mesh = 0;
+    batch->subMesh = -1;
+    batch->uploaded = 0;
+    for (auto meshdata : meshdatas->meshDatas)
+    {
+        if (meshdata && batch->meshes.size() < (size_t)vertexDatas.size())
+        {
+            batch->meshes.push_back(meshdata);
+            _pendingBytes += getSize(meshdata);
+        }
+    }
+    _batches.push_back(batch);
+}
+
+void MeshUploadQueue::enqueue(ssize_t size, const std::function<ssize_t(ssize_t budget)>& upload, const std::function<void(bool uploaded)>& callback)
+{
+    auto batch = new (std::nothrow) Batch();
+    batch->meshdatas = nullptr;
+    batch->callback = callback;
+    batch->upload = upload;
+    batch->size = size;
+    batch->mesh = 0;
+    batch->subMesh = -1;
+    batch->uploaded = 0;
+    _pendingBytes += size;
+    _batches.push_back(batch);
+}
+
+void MeshUploadQueue::uploadAll()
+{
+    upload(std::numeric_limits<ssize_t>::max());
+}
+
+void MeshUploadQueue::upload(ssize_t budget)
+{
+    for (;;)
+    {
+        // the callbacks may queue more meshes, the batch is removed first
+        while (!_batches.empty() && _batches.front()->isDone())
+        {
+            auto batch = _batches.front();
+            _batches.pop_front();
+            delete batch->meshdatas;
+            if (batch->callback)
+                batch->callback(true);
+            delete batch;
+        }
+        
+        if (_batches.empty() || budget <= 0)
+            break;
+        
+        auto batch = _batches.front();
+        if (batch->upload)
+        {
+            ssize_t size = batch->upload(budget);
+            budget -= std::max(size, (ssize_t)0);
+            // nothing left to upload, the rest of the size is skipped
+            if (size <= 0 || size > batch->size - batch->uploaded)
+                size = batch->size - batch->uploaded;
+            batch->uploaded += size;
+            _pendingBytes -= size;
+        }
+        else
+        {
+            budget -= uploadBlock(batch, budget);
+        }
+    }
+}
+
+ssize_t MeshUploadQueue::uploadBlock(Batch* batch, ssize_t budget)
+{
+    const MeshData* meshdata = batch->meshes[batch->mesh];
+    MeshVertexData* vertexData = batch->vertexDatas.at(batch->mesh);
+    
+    const char* source = nullptr;
+    ssize_t unit = 0;
+    ssize_t total = 0;
+    VertexBuffer* vertexBuffer = nullptr;
+    IndexBuffer* indexBuffer = nullptr;
+    if (batch->subMesh < 0)
+    {
+        vertexBuffer = vertexData->_vertexBuffer;
+        source = static_cast<const char*>(meshdata->getVertexData());
+        unit = vertexBuffer ? vertexBuffer->getSizePerVertex() : 0;
+        total = unit ? (ssize_t)meshdata->getVertexSizeInFloat() * sizeof(float) / unit * unit : 0;
+    }
+    else if (batch->subMesh < (int)vertexData->_indexs.size())
+    {
+        indexBuffer = vertexData->_indexs.at(batch->subMesh)->_indexBuffer;
+        source = static_cast<const char*>(meshdata->getIndexData(batch->subMesh));
+        unit = sizeof(unsigned short);
+        total = indexBuffer ? (ssize_t)meshdata->getIndexCount(batch->subMesh) * unit : 0;
+    }
+    
+    ssize_t size = 0;
+    if (source && total > batch->uploaded)
+    {
+        ssize_t count = std::max(budget / unit, (ssize_t)1);
+        count = std::min(count, (total - batch->uploaded) / unit);
+        size = count * unit;
+        if (vertexBuffer)
+            vertexBuffer->updateVertices(source + batch->uploaded, (int)count, (int)(batch->uploaded / unit));
+        else
+            indexBuffer->updateIndices(source + batch->uploaded, (int)count, (int)(batch->uploaded / unit));
+        batch->uploaded += size;
+        _pendingBytes -= size;
+    }
+    
+    if (source == nullptr || batch->uploaded >= total)
+    {
+        // skipped bytes of buffers which couldn't be created
+        if (batch->subMesh < 0)
+            _pendingBytes -= (ssize_t)meshdata->getVertexSizeInFloat() * sizeof(float) - batch->uploaded;
+        else if (batch->subMesh < (int)meshdata->getSubMeshCount())
+            _pendingBytes -= (ssize_t)meshdata->getIndexCount(batch->subMesh) * sizeof(unsigned short) - batch->uploaded;
+        
+        batch->uploaded = 0;
+        if (++batch->subMesh >= (int)meshdata->getSubMeshCount())
+        {
+            batch->subMesh = -1;
+            ++batch->mesh;
+        }
+    }
+    return size;
+}
+
+NS_CC_END
@@ -0,0 +1,126 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CCMESH_UPLOAD_QUEUE_H__
+#define __CCMESH_UPLOAD_QUEUE_H__
+
+#include <deque>
+#include <functional>
+
+#include "base/CCVector.h"
+#include "3d/CCBundle3DData.h"
+
+NS_CC_BEGIN
+
+class MeshVertexData;
+class EventListenerCustom;
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/** @class MeshUploadQueue
+ * @brief Uploads the vertices and indices of loaded meshes to their buffers over several frames.
+ *
+ * Once the scheduler update is done (Director::EVENT_AFTER_UPDATE), at most getBytesPerFrame() bytes
+ * are copied to the buffers, in the order the meshes were queued. Sprite3D::createAsync() and Terrain::createAsync()
+ * use it so that the frame in which a big model completes doesn't stall on the upload. Together with
+ * Bundle3D::setMeshDataZeroCopy() the data is copied from the mapped .c3b file to the buffers directly.
+ */
+class CC_DLL MeshUploadQueue
+{
+public:
+    /** Returns the shared instance of the queue. */
+    static MeshUploadQueue* getInstance();
+
+    /** Destroys the shared instance, the pending meshes are dropped and their callbacks are called with false. */
+    static void destroyInstance();
+
+    /** Queues the upload of mesh datas to vertex datas created with MeshVertexData::create(meshdata, false).
+     * The vertex datas are in the order of the non null mesh datas. The queue takes the ownership of
+     * meshdatas, it is deleted after the upload, then callback is called with true. If the queue is destroyed
+     * first, callback is called with false so that it can release what it holds.
+     */
+    void enqueue(const Vector<MeshVertexData*>& vertexDatas, MeshDatas* meshdatas, const std::function<void(bool uploaded)>& callback);
+    
+    /** Queues an upload done by the caller, e.g. the chunk buffers of Terrain::createAsync().
+     * upload is called with the bytes left in the budget of the frame and returns the bytes it uploaded,
+     * it must upload something on each call. Once size bytes are uploaded callback is called with true,
+     * with false if the queue is destroyed first.
+     */
+    void enqueue(ssize_t size, const std::function<ssize_t(ssize_t budget)>& upload, const std::function<void(bool uploaded)>& callback);
+
+    /** Uploads everything queued now. */
+    void uploadAll();
+
+    /** Sets how many bytes are uploaded per frame, at least one block of vertices or indices is. Default is 1MB. */
+    void setBytesPerFrame(ssize_t bytes) { _bytesPerFrame = bytes; }
+    ssize_t getBytesPerFrame() const { return _bytesPerFrame; }
+
+    /** Number of bytes waiting to be uploaded. */
+    ssize_t getPendingBytes() const { return _pendingBytes; }
+
+protected:
+    struct Batch
+    {
+        Vector<MeshVertexData*> vertexDatas;
+        std::vector<MeshData*> meshes; // the non null mesh datas
+        MeshDatas* meshdatas;
+        std::function<void(bool uploaded)> callback;
+        // uploads of the caller, instead of the meshes
+        std::function<ssize_t(ssize_t budget)> upload;
+        ssize_t size;
+        // progress, subMesh -1 is the vertices
+        size_t mesh;
+        int subMesh;
+        ssize_t uploaded;
+        
+        bool isDone() const { return upload ? uploaded >= size : mesh >= meshes.size(); }
+    };
+
+    MeshUploadQueue();
+    ~MeshUploadQueue();
+
+    void upload(ssize_t budget);
+    // uploads a block of the current buffer of a batch, returns the number of bytes
+    ssize_t uploadBlock(Batch* batch, ssize_t budget);
+    static ssize_t getSize(const MeshData* meshdata);
+
+    ssize_t _bytesPerFrame;
+    ssize_t _pendingBytes;
+    std::deque<Batch*> _batches;
+
+    EventListenerCustom* _afterUpdateListener;
+
+    static MeshUploadQueue* s_sharedQueue;
+};
+
+// end of 3d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCMESH_UPLOAD_QUEUE_H__
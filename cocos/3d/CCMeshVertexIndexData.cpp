@@ -80,10 +80,15 @@ MeshIndexData::~MeshIndexData()
 }
 
 MeshVertexData* MeshVertexData::create(const MeshData& meshdata)
+{
+    return create(meshdata, true);
+}
+
+MeshVertexData* MeshVertexData::create(const MeshData& meshdata, bool upload)
 {
     auto vertexdata = new (std::nothrow) MeshVertexData();
     int pervertexsize = meshdata.getPerVertexSize();
-    vertexdata->_vertexBuffer = VertexBuffer::create(pervertexsize, (int)(meshdata.vertex.size() / (pervertexsize / 4)));
+    vertexdata->_vertexBuffer = VertexBuffer::create(pervertexsize, (int)(meshdata.getVertexSizeInFloat() / (pervertexsize / 4)));
     vertexdata->_vertexData = VertexData::create();
     CC_SAFE_RETAIN(vertexdata->_vertexData);
     CC_SAFE_RETAIN(vertexdata->_vertexBuffer);
@@ -96,22 +101,36 @@ MeshVertexData* MeshVertexData::create(const MeshData& meshdata)
     
     vertexdata->_attribs = meshdata.attribs;
     
-    if(vertexdata->_vertexBuffer)
+    if(vertexdata->_vertexBuffer && upload)
     {
-        vertexdata->_vertexBuffer->updateVertices((void*)&meshdata.vertex[0], (int)meshdata.vertex.size() * 4 / vertexdata->_vertexBuffer->getSizePerVertex(), 0);
+        vertexdata->_vertexBuffer->updateVertices(meshdata.getVertexData(), meshdata.getVertexSizeInFloat() * 4 / vertexdata->_vertexBuffer->getSizePerVertex(), 0);
     }
     
-    bool needCalcAABB = (meshdata.subMeshAABB.size() != meshdata.subMeshIndices.size());
-    for (size_t i = 0; i < meshdata.subMeshIndices.size(); i++) {
-
-        auto& index = meshdata.subMeshIndices[i];
-        auto indexBuffer = IndexBuffer::create(IndexBuffer::IndexType::INDEX_TYPE_SHORT_16, (int)(index.size()));
-        indexBuffer->updateIndices(&index[0], (int)index.size(), 0);
+    size_t subMeshCount = meshdata.getSubMeshCount();
+    bool needCalcAABB = (meshdata.subMeshAABB.size() != subMeshCount);
+    for (size_t i = 0; i < subMeshCount; i++) {
+
+        int indexCount = (int)meshdata.getIndexCount(i);
+        auto indexBuffer = IndexBuffer::create(IndexBuffer::IndexType::INDEX_TYPE_SHORT_16, indexCount);
+        if (upload)
+            indexBuffer->updateIndices(meshdata.getIndexData(i), indexCount, 0);
         std::string id = (i < meshdata.subMeshIds.size() ? meshdata.subMeshIds[i] : "");
         MeshIndexData* indexdata = nullptr;
         if (needCalcAABB)
         {
-            auto aabb = Bundle3D::calculateAABB(meshdata.vertex, meshdata.getPerVertexSize(), index);
+            AABB aabb;
+            if (meshdata.source)
+            {
+                // referenced data isn't aligned, copy it
+                std::vector<float> vertex(meshdata.getVertexSizeInFloat());
+                std::vector<unsigned short> index(indexCount);
+                memcpy(&vertex[0], meshdata.getVertexData(), vertex.size() * sizeof(float));
+                if (indexCount)
+                    memcpy(&index[0], meshdata.getIndexData(i), indexCount * sizeof(unsigned short));
+                aabb = Bundle3D::calculateAABB(vertex, meshdata.getPerVertexSize(), index);
+            }
+            else
+                aabb = Bundle3D::calculateAABB(meshdata.vertex, meshdata.getPerVertexSize(), meshdata.subMeshIndices[i]);
             indexdata = MeshIndexData::create(id, vertexdata, indexBuffer, aabb);
         }
         else
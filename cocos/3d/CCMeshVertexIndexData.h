@@ -93,6 +93,7 @@ protected:
     
     friend class MeshVertexData;
     friend class Sprite3D;
+    friend class MeshUploadQueue;
 };
 
 /**
@@ -103,9 +104,14 @@ class MeshVertexData : public Ref
 {
     friend class Sprite3D;
     friend class Mesh;
+    friend class MeshUploadQueue;
 public:
     /**create*/
     static MeshVertexData* create(const MeshData& meshdata);
+    /**
+     * create, the buffers are left empty if upload is false, MeshUploadQueue fills them later
+     */
+    static MeshVertexData* create(const MeshData& meshdata, bool upload);
     
     /** get vertexbuffer */
     const VertexBuffer* getVertexBuffer() const { return _vertexBuffer; }
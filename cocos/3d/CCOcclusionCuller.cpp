@@ -0,0 +1,313 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "3d/CCOcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <cstring>
+
+#if defined (__SSE__)
+#define USE_SSE
+#include <xmmintrin.h>
+#elif defined (__arm64__) || defined (__aarch64__) || ((CC_TARGET_PLATFORM == CC_PLATFORM_IOS) && defined (__ARM_NEON__))
+#define USE_NEON
+#include <arm_neon.h>
+#endif
+
+NS_CC_BEGIN
+
+OcclusionCuller::OcclusionCuller()
+: _width(0)
+, _height(0)
+{
+    memset(&_stats, 0, sizeof(_stats));
+    setResolution(256, 128);
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+}
+
+void OcclusionCuller::setResolution(int width, int height)
+{
+    _width = (std::max(width, 4) + 3) & ~3;
+    _height = std::max(height, 1);
+    _depth.assign(_width * _height, 1.0f);
+}
+
+void OcclusionCuller::begin(const Mat4& viewProjection)
+{
+    _viewProjection = viewProjection;
+    std::fill(_depth.begin(), _depth.end(), 1.0f);
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+Vec3 OcclusionCuller::toScreen(const Vec4& clip) const
+{
+    float invW = 1.0f / clip.w;
+    return Vec3((clip.x * invW * 0.5f + 0.5f) * _width,
+                (clip.y * invW * 0.5f + 0.5f) * _height,
+                clip.z * invW * 0.5f + 0.5f);
+}
+
+void OcclusionCuller::addOccluder(const Vec3* positions, int vertexCount, const unsigned short* indices, int indexCount, const Mat4& transform)
+{
+    if (!positions || !indices || vertexCount <= 0)
+        return;
+    
+    _stats.occluders++;
+    
+    Mat4 mvp = _viewProjection * transform;
+    _clipVertices.resize(vertexCount);
+    for (int i = 0; i < vertexCount; i++)
+    {
+        mvp.transformVector(Vec4(positions[i].x, positions[i].y, positions[i].z, 1.0f), &_clipVertices[i]);
+    }
+    
+    for (int i = 0; i + 2 < indexCount; i += 3)
+    {
+        if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount)
+            continue;
+        
+        _stats.occluderTriangles++;
+        rasterizeClipped(_clipVertices[indices[i]], _clipVertices[indices[i + 1]], _clipVertices[indices[i + 2]]);
+    }
+}
+
+void OcclusionCuller::rasterizeClipped(const Vec4& v0, const Vec4& v1, const Vec4& v2)
+{
+    // clip against the near plane, z + w >= 0, the other planes are handled by the screen bounds
+    const Vec4* in[3] = { &v0, &v1, &v2 };
+    float dist[3] = { v0.z + v0.w, v1.z + v1.w, v2.z + v2.w };
+    if (dist[0] >= 0 && dist[1] >= 0 && dist[2] >= 0)
+    {
+        rasterizeTriangle(toScreen(v0), toScreen(v1), toScreen(v2));
+        return;
+    }
+    
+    Vec4 polygon[4];
+    int count = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        int next = (i + 1) % 3;
+        if (dist[i] >= 0)
+            polygon[count++] = *in[i];
+        if ((dist[i] >= 0) != (dist[next] >= 0))
+        {
+            float t = dist[i] / (dist[i] - dist[next]);
+            polygon[count++] = *in[i] + (*in[next] - *in[i]) * t;
+        }
+    }
+    
+    for (int i = 2; i < count; i++)
+    {
+        rasterizeTriangle(toScreen(polygon[0]), toScreen(polygon[i - 1]), toScreen(polygon[i]));
+    }
+}
+
+void OcclusionCuller::rasterizeTriangle(const Vec3& v0, const Vec3& v1, const Vec3& v2)
+{
+    // pixels whose center is inside the bounds
+    int minX = std::max(0, (int)std::ceil(std::min(v0.x, std::min(v1.x, v2.x)) - 0.5f));
+    int maxX = std::min(_width - 1, (int)std::floor(std::max(v0.x, std::max(v1.x, v2.x)) - 0.5f));
+    int minY = std::max(0, (int)std::ceil(std::min(v0.y, std::min(v1.y, v2.y)) - 0.5f));
+    int maxY = std::min(_height - 1, (int)std::floor(std::max(v0.y, std::max(v1.y, v2.y)) - 0.5f));
+    if (minX > maxX || minY > maxY)
+        return;
+    
+    // edge functions e = a * x + b * y + c, positive inside; ei is the weight of vi
+    float a0 = v1.y - v2.y, b0 = v2.x - v1.x, c0 = v1.x * v2.y - v1.y * v2.x;
+    float a1 = v2.y - v0.y, b1 = v0.x - v2.x, c1 = v2.x * v0.y - v2.y * v0.x;
+    float a2 = v0.y - v1.y, b2 = v1.x - v0.x, c2 = v0.x * v1.y - v0.y * v1.x;
+    float area = c0 + c1 + c2;
+    if (std::abs(area) < FLT_EPSILON)
+        return;
+    if (area < 0)
+    {
+        a0 = -a0; b0 = -b0; c0 = -c0;
+        a1 = -a1; b1 = -b1; c1 = -c1;
+        a2 = -a2; b2 = -b2; c2 = -c2;
+        area = -area;
+    }
+    
+    // z / w is linear in screen space
+    float invArea = 1.0f / area;
+    float za = (a0 * v0.z + a1 * v1.z + a2 * v2.z) * invArea;
+    float zb = (b0 * v0.z + b1 * v1.z + b2 * v2.z) * invArea;
+    float zc = (c0 * v0.z + c1 * v1.z + c2 * v2.z) * invArea;
+    
+    // the pixels get the farthest depth of the triangle's plane over them, not the depth at their center,
+    // so that a sloped occluder doesn't hide what is behind the center but in front of its farther part
+    zc += (std::abs(za) + std::abs(zb)) * 0.5f;
+    
+    _stats.rasterizedTriangles++;
+    
+    // four pixels at a time, the width is a multiple of 4 so the groups never cross a row
+    int startX = minX & ~3;
+    for (int y = minY; y <= maxY; y++)
+    {
+        float py = y + 0.5f;
+        float rowE0 = b0 * py + c0;
+        float rowE1 = b1 * py + c1;
+        float rowE2 = b2 * py + c2;
+        float rowZ = zb * py + zc;
+        float* row = &_depth[y * _width];
+        
+#if defined (USE_SSE)
+        const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+        for (int x = startX; x <= maxX; x += 4)
+        {
+            __m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+            __m128 e0 = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(a0)), _mm_set1_ps(rowE0));
+            __m128 e1 = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(a1)), _mm_set1_ps(rowE1));
+            __m128 e2 = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(a2)), _mm_set1_ps(rowE2));
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+            __m128 z = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(za)), _mm_set1_ps(rowZ));
+            __m128 depth = _mm_loadu_ps(row + x);
+            z = _mm_min_ps(z, depth);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, z), _mm_andnot_ps(inside, depth)));
+        }
+#elif defined (USE_NEON)
+        const float offsetValues[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+        const float32x4_t offsets = vld1q_f32(offsetValues);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        for (int x = startX; x <= maxX; x += 4)
+        {
+            float32x4_t px = vaddq_f32(vdupq_n_f32((float)x), offsets);
+            float32x4_t e0 = vmlaq_f32(vdupq_n_f32(rowE0), px, vdupq_n_f32(a0));
+            float32x4_t e1 = vmlaq_f32(vdupq_n_f32(rowE1), px, vdupq_n_f32(a1));
+            float32x4_t e2 = vmlaq_f32(vdupq_n_f32(rowE2), px, vdupq_n_f32(a2));
+            uint32x4_t inside = vandq_u32(vandq_u32(vcgeq_f32(e0, zero), vcgeq_f32(e1, zero)), vcgeq_f32(e2, zero));
+            float32x4_t z = vmlaq_f32(vdupq_n_f32(rowZ), px, vdupq_n_f32(za));
+            float32x4_t depth = vld1q_f32(row + x);
+            vst1q_f32(row + x, vbslq_f32(inside, vminq_f32(z, depth), depth));
+        }
+#else
+        for (int x = startX; x <= maxX; x++)
+        {
+            float px = x + 0.5f;
+            if (a0 * px + rowE0 >= 0 && a1 * px + rowE1 >= 0 && a2 * px + rowE2 >= 0)
+            {
+                float z = za * px + rowZ;
+                if (z < row[x])
+                    row[x] = z;
+            }
+        }
+#endif
+    }
+}
+
+bool OcclusionCuller::isVisible(const AABB& aabb)
+{
+    _stats.testedObjects++;
+    if (_stats.rasterizedTriangles == 0)
+        return true;
+    
+    Vec3 corners[8];
+    aabb.getCorners(corners);
+    
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    float minZ = FLT_MAX;
+    for (int i = 0; i < 8; i++)
+    {
+        Vec4 clip;
+        _viewProjection.transformVector(Vec4(corners[i].x, corners[i].y, corners[i].z, 1.0f), &clip);
+        // crosses the near plane, the camera may be inside it
+        if (clip.z + clip.w < 0 || clip.w <= FLT_EPSILON)
+            return true;
+        
+        Vec3 screen = toScreen(clip);
+        minX = std::min(minX, screen.x);
+        maxX = std::max(maxX, screen.x);
+        minY = std::min(minY, screen.y);
+        maxY = std::max(maxY, screen.y);
+        minZ = std::min(minZ, screen.z);
+    }
+    
+    // the pixels touched by the screen rectangle
+    int x0 = (int)std::floor(minX);
+    int x1 = (int)std::floor(maxX);
+    int y0 = (int)std::floor(minY);
+    int y1 = (int)std::floor(maxY);
+    if (x1 < 0 || x0 >= _width || y1 < 0 || y0 >= _height)
+        return true;
+    
+    // a pixel is written when the occluders cover its center, so the aabb may show in the part of
+    // a pixel they leave, the rectangle is grown by one pixel to reach the uncovered pixels beyond it
+    x0 = std::max(0, x0 - 1);
+    x1 = std::min(_width - 1, x1 + 1);
+    y0 = std::max(0, y0 - 1);
+    y1 = std::min(_height - 1, y1 + 1);
+    
+    int startX = x0 & ~3;
+    for (int y = y0; y <= y1; y++)
+    {
+        const float* row = &_depth[y * _width];
+        
+#if defined (USE_SSE)
+        const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        const __m128 first = _mm_set1_ps((float)x0);
+        const __m128 last = _mm_set1_ps((float)x1);
+        const __m128 nearest = _mm_set1_ps(minZ);
+        for (int x = startX; x <= x1; x += 4)
+        {
+            __m128 px = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+            __m128 inRect = _mm_and_ps(_mm_cmpge_ps(px, first), _mm_cmple_ps(px, last));
+            __m128 visible = _mm_and_ps(inRect, _mm_cmpge_ps(_mm_loadu_ps(row + x), nearest));
+            if (_mm_movemask_ps(visible))
+                return true;
+        }
+#elif defined (USE_NEON)
+        const float laneValues[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+        const float32x4_t lanes = vld1q_f32(laneValues);
+        const float32x4_t first = vdupq_n_f32((float)x0);
+        const float32x4_t last = vdupq_n_f32((float)x1);
+        const float32x4_t nearest = vdupq_n_f32(minZ);
+        for (int x = startX; x <= x1; x += 4)
+        {
+            float32x4_t px = vaddq_f32(vdupq_n_f32((float)x), lanes);
+            uint32x4_t inRect = vandq_u32(vcgeq_f32(px, first), vcleq_f32(px, last));
+            uint32x4_t visible = vandq_u32(inRect, vcgeq_f32(vld1q_f32(row + x), nearest));
+            uint32x2_t halves = vorr_u32(vget_low_u32(visible), vget_high_u32(visible));
+            if (vget_lane_u32(vpmax_u32(halves, halves), 0))
+                return true;
+        }
+#else
+        for (int x = x0; x <= x1; x++)
+        {
+            if (row[x] >= minZ)
+                return true;
+        }
+#endif
+    }
+    
+    _stats.culledObjects++;
+    return false;
+}
+
+NS_CC_END
@@ -0,0 +1,112 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CC_OCCLUSION_CULLER_H__
+#define __CC_OCCLUSION_CULLER_H__
+
+#include <vector>
+
+#include "3d/CCAABB.h"
+#include "math/CCMath.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/**
+ * @brief A software occlusion culler, it runs on the CPU only.
+ *
+ * The occluders are rasterized into a low resolution depth buffer, four pixels at a time with SSE or NEON
+ * where available, each pixel with the farthest depth of the triangle over it. Then the screen rectangles
+ * of aabbs, grown by a pixel for the pixels the occluders only partly cover, are tested against it.
+ * An aabb is occluded if every pixel of its rectangle is nearer than its nearest corner.
+ * The occluders must be inside the objects they stand for, so they never hide what those don't,
+ * e.g. simplified meshes made for it.
+ * Cameras use it when Camera::setOcclusionCullingEnabled() is set, with the occluders of Sprite3D::setOccluderMesh().
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL OcclusionCuller
+{
+public:
+    /** counters since the last begin() */
+    struct Stats
+    {
+        int occluders;
+        int occluderTriangles;
+        int rasterizedTriangles; // after near plane clipping and size rejection
+        int testedObjects;
+        int culledObjects;
+    };
+    
+    OcclusionCuller();
+    ~OcclusionCuller();
+    
+    /** Sets the size of the depth buffer, the width is rounded up to a multiple of 4. Default is 256x128. */
+    void setResolution(int width, int height);
+    int getWidth() const { return _width; }
+    int getHeight() const { return _height; }
+    
+    /** Clears the depth buffer and the stats, and sets the view projection matrix of the frame. */
+    void begin(const Mat4& viewProjection);
+    
+    /** Rasterizes an occluder mesh.
+     * @param positions The vertices.
+     * @param indices The triangles.
+     * @param transform The world transform of the mesh.
+     */
+    void addOccluder(const Vec3* positions, int vertexCount, const unsigned short* indices, int indexCount, const Mat4& transform);
+    
+    /** Returns false if the world space aabb is hidden by the occluders. */
+    bool isVisible(const AABB& aabb);
+    
+    /** The depth buffer, row by row from the bottom, in [0, 1] with 1 for the far plane. */
+    const float* getDepthBuffer() const { return _depth.empty() ? nullptr : &_depth[0]; }
+    
+    const Stats& getStats() const { return _stats; }
+    
+protected:
+    // x and y in pixels, z is the depth
+    void rasterizeTriangle(const Vec3& v0, const Vec3& v1, const Vec3& v2);
+    void rasterizeClipped(const Vec4& v0, const Vec4& v1, const Vec4& v2);
+    Vec3 toScreen(const Vec4& clip) const;
+    
+    int _width;
+    int _height;
+    std::vector<float> _depth;
+    Mat4 _viewProjection;
+    Stats _stats;
+    std::vector<Vec4> _clipVertices;
+};
+
+// end of 3d group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_OCCLUSION_CULLER_H__
@@ -0,0 +1,303 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "3d/CCPagedTerrain.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "2d/CCScene.h"
+#include "2d/CCCamera.h"
+#include "platform/CCFileUtils.h"
+
+NS_CC_BEGIN
+
+PagedTerrain* PagedTerrain::create(const Terrain::TerrainData& tileData, const std::string& heightMapPattern, const std::string& alphaMapPattern,
+                                   int tilesX, int tilesY, float tileSize, Terrain::CrackFixedType fixedType)
+{
+    auto terrain = new (std::nothrow) PagedTerrain();
+    if (terrain && terrain->init(tileData, heightMapPattern, alphaMapPattern, tilesX, tilesY, tileSize, fixedType))
+    {
+        terrain->autorelease();
+        return terrain;
+    }
+    CC_SAFE_DELETE(terrain);
+    return nullptr;
+}
+
+PagedTerrain::PagedTerrain()
+: _tilesX(0)
+, _tilesY(0)
+, _tileSize(0)
+, _crackFixedType(Terrain::CrackFixedType::SKIRT)
+, _loadDistance(0)
+, _unloadDistance(0)
+, _maxLoadingTiles(2)
+, _loadingTiles(0)
+, _focus(nullptr)
+{
+}
+
+PagedTerrain::~PagedTerrain()
+{
+    CC_SAFE_RELEASE(_focus);
+}
+
+bool PagedTerrain::init(const Terrain::TerrainData& tileData, const std::string& heightMapPattern, const std::string& alphaMapPattern,
+                        int tilesX, int tilesY, float tileSize, Terrain::CrackFixedType fixedType)
+{
+    if (!Node::init() || tilesX <= 0 || tilesY <= 0 || tileSize <= 0)
+        return false;
+    
+    _tileData = tileData;
+    if (tileData._alphaMapSrc)
+    {
+        _alphaMapPath = tileData._alphaMapSrc;
+        _tileData._alphaMapSrc = const_cast<char*>(_alphaMapPath.c_str());
+    }
+    _heightMapPattern = heightMapPattern;
+    _alphaMapPattern = alphaMapPattern;
+    _tilesX = tilesX;
+    _tilesY = tilesY;
+    _tileSize = tileSize;
+    _crackFixedType = fixedType;
+    _loadDistance = tileSize * 1.5f;
+    _unloadDistance = tileSize * 2.0f;
+    scheduleUpdate();
+    return true;
+}
+
+void PagedTerrain::setFocus(Node* focus)
+{
+    CC_SAFE_RETAIN(focus);
+    CC_SAFE_RELEASE(_focus);
+    _focus = focus;
+}
+
+void PagedTerrain::update(float delta)
+{
+    Node* focus = _focus;
+    if (!focus)
+    {
+        auto scene = getScene();
+        focus = scene ? scene->getDefaultCamera() : nullptr;
+        if (!focus)
+            return;
+    }
+    
+    Vec3 center;
+    focus->getNodeToWorldTransform().getTranslation(&center);
+    getWorldToNodeTransform().transformPoint(&center);
+    updateTiles(center);
+}
+
+float PagedTerrain::getTileDistance(int x, int y, const Vec2& center) const
+{
+    // distance to the rectangle of the tile on XZ
+    float dx = std::max(std::max(x * _tileSize - center.x, center.x - (x + 1) * _tileSize), 0.0f);
+    float dz = std::max(std::max(y * _tileSize - center.y, center.y - (y + 1) * _tileSize), 0.0f);
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+void PagedTerrain::updateTiles(const Vec3& center)
+{
+    Vec2 center2D(center.x, center.z);
+    
+    // unload, the loading tiles are dropped when they arrive
+    for (auto iter = _tiles.begin(); iter != _tiles.end();)
+    {
+        const auto& tile = iter->second;
+        if (!tile.missing && getTileDistance(tile.x, tile.y, center2D) > _unloadDistance)
+        {
+            if (tile.terrain)
+                removeChild(tile.terrain);
+            iter = _tiles.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+    
+    if (_loadingTiles >= _maxLoadingTiles)
+        return;
+    
+    // load, the nearest tiles first
+    int x0 = std::max(0, (int)std::floor((center2D.x - _loadDistance) / _tileSize));
+    int x1 = std::min(_tilesX - 1, (int)std::floor((center2D.x + _loadDistance) / _tileSize));
+    int y0 = std::max(0, (int)std::floor((center2D.y - _loadDistance) / _tileSize));
+    int y1 = std::min(_tilesY - 1, (int)std::floor((center2D.y + _loadDistance) / _tileSize));
+    std::vector<std::pair<float, long long>> candidates;
+    for (int y = y0; y <= y1; y++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            float distance = getTileDistance(x, y, center2D);
+            if (distance <= _loadDistance && _tiles.find(getTileKey(x, y)) == _tiles.end())
+                candidates.push_back(std::make_pair(distance, getTileKey(x, y)));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    
+    for (const auto& candidate : candidates)
+    {
+        if (_loadingTiles >= _maxLoadingTiles)
+            break;
+        requestTile((int)(candidate.second >> 32), (int)(unsigned int)(candidate.second & 0xffffffff));
+    }
+}
+
+void PagedTerrain::requestTile(int x, int y)
+{
+    Tile tile;
+    tile.x = x;
+    tile.y = y;
+    tile.terrain = nullptr;
+    tile.loading = false;
+    tile.missing = false;
+    
+    char path[512];
+    snprintf(path, sizeof(path), _heightMapPattern.c_str(), x, y);
+    if (!FileUtils::getInstance()->isFileExist(path))
+    {
+        tile.missing = true;
+        _tiles[getTileKey(x, y)] = tile;
+        return;
+    }
+    
+    // createAsync copies the data and the alpha map path
+    Terrain::TerrainData data = _tileData;
+    data._heightMapSrc = path;
+    std::string alphaMap;
+    if (!_alphaMapPattern.empty())
+    {
+        snprintf(path, sizeof(path), _alphaMapPattern.c_str(), x, y);
+        alphaMap = path;
+        data._alphaMapSrc = const_cast<char*>(alphaMap.c_str());
+    }
+    
+    tile.loading = true;
+    _tiles[getTileKey(x, y)] = tile;
+    _loadingTiles++;
+    
+    // kept alive until the tile arrives
+    retain();
+    Terrain::createAsync(data, _crackFixedType, [this, x, y](Terrain* terrain, void* /*param*/)
+    {
+        onTileLoaded(x, y, terrain);
+        release();
+    }, nullptr);
+}
+
+void PagedTerrain::onTileLoaded(int x, int y, Terrain* terrain)
+{
+    _loadingTiles--;
+    auto iter = _tiles.find(getTileKey(x, y));
+    if (iter == _tiles.end() || !iter->second.loading)
+        return; // unloaded meanwhile, the terrain is autoreleased
+    
+    auto& tile = iter->second;
+    tile.loading = false;
+    if (!terrain)
+    {
+        tile.missing = true;
+        return;
+    }
+    
+    terrain->setPosition3D(Vec3((x + 0.5f) * _tileSize, 0.0f, (y + 0.5f) * _tileSize));
+    terrain->setCameraMask(getCameraMask());
+    addChild(terrain);
+    tile.terrain = terrain;
+}
+
+Terrain* PagedTerrain::getTile(int x, int y) const
+{
+    auto iter = _tiles.find(getTileKey(x, y));
+    return iter != _tiles.end() ? iter->second.terrain : nullptr;
+}
+
+Terrain* PagedTerrain::getTileAt(float x, float z) const
+{
+    Vec3 position(x, 0.0f, z);
+    getWorldToNodeTransform().transformPoint(&position);
+    return getTile((int)std::floor(position.x / _tileSize), (int)std::floor(position.z / _tileSize));
+}
+
+int PagedTerrain::getResidentTileCount() const
+{
+    int count = 0;
+    for (const auto& pair : _tiles)
+    {
+        if (pair.second.terrain)
+            count++;
+    }
+    return count;
+}
+
+float PagedTerrain::getHeight(float x, float z, Vec3* normal) const
+{
+    auto terrain = getTileAt(x, z);
+    if (terrain)
+        return terrain->getHeight(x, z, normal);
+    
+    if (normal)
+        normal->setZero();
+    return 0;
+}
+
+bool PagedTerrain::isResident(float x, float z) const
+{
+    return getTileAt(x, z) != nullptr;
+}
+
+bool PagedTerrain::getIntersectionPoint(const Ray& ray, Vec3& intersectionPoint) const
+{
+    bool hasIntersect = false;
+    float intersectionDist = FLT_MAX;
+    for (const auto& pair : _tiles)
+    {
+        auto terrain = pair.second.terrain;
+        if (!terrain || !ray.intersects(terrain->getAABB()))
+            continue;
+        
+        // in the space of the tile
+        Vec3 point;
+        if (terrain->getIntersectionPoint(ray, point))
+        {
+            terrain->getNodeToWorldTransform().transformPoint(&point);
+            float dist = ray._origin.distance(point);
+            if (dist < intersectionDist)
+            {
+                hasIntersect = true;
+                intersectionDist = dist;
+                intersectionPoint = point;
+            }
+        }
+    }
+    return hasIntersect;
+}
+
+NS_CC_END
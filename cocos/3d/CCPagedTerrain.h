@@ -0,0 +1,162 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CC_PAGED_TERRAIN_H__
+#define __CC_PAGED_TERRAIN_H__
+
+#include <string>
+#include <unordered_map>
+
+#include "3d/CCTerrain.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/**
+ * @brief A terrain split into tiles streamed around a focus, for maps which don't fit in memory.
+ *
+ * Each tile is a Terrain with its own height map and alpha map on disk, named by a printf pattern
+ * taking the x and y of the tile, e.g. "terrain/height_%d_%d.png". The detail maps and the other
+ * parameters are the same for all the tiles. The tiles whose distance to the focus is under the load
+ * distance are created with Terrain::createAsync(), which loads them on a background thread, and the
+ * tiles further than the unload distance are removed, freeing their memory.
+ * Tile (x, y) covers [x * tileSize, (x + 1) * tileSize] on X and [y * tileSize, (y + 1) * tileSize] on Z,
+ * so tileSize should be (heightMapWidth - 1) * mapScale with POT + 1 height maps sharing their border.
+ * Tiles missing on disk are holes.
+ *
+ * getHeight() and getIntersectionPoint() only see the resident tiles.
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL PagedTerrain : public Node
+{
+public:
+    /**
+     * Creates a paged terrain.
+     * @param tileData The parameters of the tiles, its height map and alpha map are replaced by the patterns.
+     * @param heightMapPattern The pattern of the height map files.
+     * @param alphaMapPattern The pattern of the alpha map files, empty to use the alpha map of tileData.
+     * @param tilesX The number of tiles on X.
+     * @param tilesY The number of tiles on Z.
+     * @param tileSize The size of a tile.
+     * @param fixedType The crack fix type, skirts also hide the cracks between tiles.
+     */
+    static PagedTerrain* create(const Terrain::TerrainData& tileData, const std::string& heightMapPattern, const std::string& alphaMapPattern,
+                                int tilesX, int tilesY, float tileSize, Terrain::CrackFixedType fixedType = Terrain::CrackFixedType::SKIRT);
+    
+    /** The tiles nearer than this are loaded. Default is 1.5 tile. */
+    void setLoadDistance(float distance) { _loadDistance = distance; }
+    float getLoadDistance() const { return _loadDistance; }
+    
+    /** The tiles further than this are unloaded, it should be greater than the load distance. Default is 2 tiles. */
+    void setUnloadDistance(float distance) { _unloadDistance = distance; }
+    float getUnloadDistance() const { return _unloadDistance; }
+    
+    /** The maximum number of tiles loading at the same time. Default is 2. */
+    void setMaxLoadingTiles(int count) { _maxLoadingTiles = count; }
+    int getMaxLoadingTiles() const { return _maxLoadingTiles; }
+    
+    /** Sets the node the tiles are streamed around, retained. nullptr uses the default camera of the scene. */
+    void setFocus(Node* focus);
+    Node* getFocus() const { return _focus; }
+    
+    /**
+     * Get the height of the terrain at a world space position (X, Z), see Terrain::getHeight().
+     * @return The height, 0 if the tile isn't resident.
+     */
+    float getHeight(float x, float z, Vec3* normal = nullptr) const;
+    
+    /** Returns true if the tile under a world space position (X, Z) is loaded. */
+    bool isResident(float x, float z) const;
+    
+    /**
+     * Ray-Terrain intersection with the resident tiles.
+     * @param ray The ray in world space.
+     * @param intersectionPoint The nearest hit point in world space.
+     * @return true if hit, false otherwise.
+     */
+    bool getIntersectionPoint(const Ray& ray, Vec3& intersectionPoint) const;
+    
+    /** Get the terrain of a tile, nullptr if it isn't loaded. */
+    Terrain* getTile(int x, int y) const;
+    
+    int getResidentTileCount() const;
+    int getLoadingTileCount() const { return _loadingTiles; }
+    
+    /** Loads and unloads the tiles around a position in the space of the node, update() calls it with the focus. */
+    void updateTiles(const Vec3& center);
+    
+    // Overrides
+    virtual void update(float delta) override;
+    
+CC_CONSTRUCTOR_ACCESS:
+    PagedTerrain();
+    virtual ~PagedTerrain();
+    
+    bool init(const Terrain::TerrainData& tileData, const std::string& heightMapPattern, const std::string& alphaMapPattern,
+              int tilesX, int tilesY, float tileSize, Terrain::CrackFixedType fixedType);
+    
+protected:
+    struct Tile
+    {
+        int x;
+        int y;
+        Terrain* terrain; // weak ref, it is a child
+        bool loading;
+        bool missing;
+    };
+    
+    static long long getTileKey(int x, int y) { return ((long long)x << 32) | (unsigned int)y; }
+    float getTileDistance(int x, int y, const Vec2& center) const;
+    Terrain* getTileAt(float x, float z) const;
+    void requestTile(int x, int y);
+    void onTileLoaded(int x, int y, Terrain* terrain);
+    
+    Terrain::TerrainData _tileData;
+    std::string _alphaMapPath; // owns the alpha map of _tileData
+    std::string _heightMapPattern;
+    std::string _alphaMapPattern;
+    int _tilesX;
+    int _tilesY;
+    float _tileSize;
+    Terrain::CrackFixedType _crackFixedType;
+    float _loadDistance;
+    float _unloadDistance;
+    int _maxLoadingTiles;
+    int _loadingTiles;
+    Node* _focus;
+    std::unordered_map<long long, Tile> _tiles;
+};
+
+// end of 3d group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_PAGED_TERRAIN_H__
@@ -23,6 +23,9 @@
  ****************************************************************************/
 
 #include "3d/CCSkeleton3D.h"
+#include "base/CCDirector.h"
+
+#include <atomic>
 
 
 NS_CC_BEGIN
@@ -141,7 +144,7 @@ Bone3D* Bone3D::create(const std::string& id)
 void Bone3D::updateJointMatrix(Vec4* matrixPalette)
 {
     {
-        static Mat4 t;
+        Mat4 t;
         Mat4::multiply(_world, getInverseBindPose(), &t);
 
         matrixPalette[0].set(t.m[0], t.m[4], t.m[8], t.m[12]);
@@ -245,7 +248,39 @@ void Bone3D::updateLocalMat()
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// updateBones() may run on the Skeleton3DManager threads
+static std::atomic<unsigned int> s_evaluatedSkeletons(0);
+static std::atomic<unsigned int> s_evaluatedBones(0);
+static unsigned int s_skippedSkeletons = 0;
+static unsigned int s_suspendedSkeletons = 0;
+
+Skeleton3D::FrameStats Skeleton3D::s_lastFrameStats = { 0, 0, 0, 0 };
+
+void Skeleton3D::addSkippedSkeleton(bool suspended)
+{
+    if (suspended)
+        ++s_suspendedSkeletons;
+    else
+        ++s_skippedSkeletons;
+}
+
+void Skeleton3D::resetFrameStats()
+{
+    s_lastFrameStats.evaluatedSkeletons = s_evaluatedSkeletons.exchange(0);
+    s_lastFrameStats.evaluatedBones = s_evaluatedBones.exchange(0);
+    s_lastFrameStats.skippedSkeletons = s_skippedSkeletons;
+    s_lastFrameStats.suspendedSkeletons = s_suspendedSkeletons;
+    s_skippedSkeletons = 0;
+    s_suspendedSkeletons = 0;
+}
+
 Skeleton3D::Skeleton3D()
+: _sortedBonesDirty(true)
+, _boneMatrixVersion(0)
+, _batchUpdatedFrame(0)
+, _batchUpdated(false)
+, _poseInterpolation(1.f)
+, _poseRestartVersion(0)
 {
     
 }
@@ -263,6 +298,7 @@ Skeleton3D* Skeleton3D::create(const std::vector<NodeData*>& skeletondata)
         bone->resetPose();
         skeleton->_rootBones.pushBack(bone);
     }
+    skeleton->_sortedBonesDirty = true;
     skeleton->autorelease();
     return skeleton;
 }
@@ -315,21 +351,84 @@ int Skeleton3D::getBoneIndex(Bone3D* bone) const
 //refresh bone world matrix
 void Skeleton3D::updateBoneMatrix()
 {
+    // already updated in this frame, by the Skeleton3DManager after the scheduler update or by the draw for another camera,
+    // so the version doesn't change and the skins keep their palettes
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    if (_batchUpdated && _batchUpdatedFrame == frame)
+        return;
+    
+    updateBones();
+    setBatchUpdatedFrame(frame);
+}
+
+void Skeleton3D::updateBones()
+{
+    if (_sortedBonesDirty)
+        sortBones();
+    
+    size_t count = _sortedBones.size();
+    for (size_t i = 0; i < count; i++) {
+        auto bone = _sortedBones[i];
+        bone->updateLocalMat();
+        int parent = _parentSlots[i];
+        if (parent >= 0)
+            Mat4::multiply(_sortedBones[parent]->_world, bone->_local, &bone->_world);
+        else
+            bone->_world = bone->_local;
+        bone->_worldDirty = false;
+    }
+    ++_boneMatrixVersion;
+    
+    ++s_evaluatedSkeletons;
+    s_evaluatedBones += (unsigned int)count;
+}
+
+int Skeleton3D::getBoneSlot(Bone3D* bone)
+{
+    if (_sortedBonesDirty)
+        sortBones();
+    
+    auto iter = _boneSlots.find(bone);
+    return iter != _boneSlots.end() ? iter->second : -1;
+}
+
+void Skeleton3D::sortBones()
+{
+    _sortedBones.clear();
+    _parentSlots.clear();
+    
+    // breadth first, so the bones of one level are next to each other
     for (const auto& it : _rootBones) {
-        it->setWorldMatDirty(true);
-        it->updateWorldMat();
+        _sortedBones.push_back(it);
+        _parentSlots.push_back(-1);
+    }
+    for (size_t i = 0; i < _sortedBones.size(); i++) {
+        for (const auto& child : _sortedBones[i]->_children) {
+            _sortedBones.push_back(child);
+            _parentSlots.push_back((int)i);
+        }
+    }
+    
+    _boneSlots.clear();
+    for (size_t i = 0; i < _sortedBones.size(); i++) {
+        _boneSlots[_sortedBones[i]] = (int)i;
     }
+    _sortedBonesDirty = false;
 }
 
 void Skeleton3D::removeAllBones()
 {
     _bones.clear();
     _rootBones.clear();
+    _sortedBones.clear();
+    _parentSlots.clear();
+    _sortedBonesDirty = true;
 }
 
 void Skeleton3D::addBone(Bone3D* bone)
 {
     _bones.pushBack(bone);
+    _sortedBonesDirty = true;
 }
 
 Bone3D* Skeleton3D::createBone3D(const NodeData& nodedata)
@@ -28,6 +28,7 @@
 #include "3d/CCBundle3DData.h"
 #include "base/CCRef.h"
 #include "base/CCVector.h"
+#include <unordered_map>
 
 
 NS_CC_BEGIN
@@ -208,9 +209,61 @@ public:
     /**get bone index*/
     int getBoneIndex(Bone3D* bone) const;
     
-    /**refresh bone world matrix*/
+    /**refresh bone world matrix
+     * the bones are updated in one pass over an array sorted parents first, built from the root bones.
+     * It runs at most once per frame, it is skipped once the Skeleton3DManager or a previous call updated the skeleton,
+     * so the skins drawn for several cameras build their palette once. Call updateBones() to refresh it again.
+     */
     void updateBoneMatrix();
     
+    /**
+     * refresh bone world matrix now, used by the Skeleton3DManager.
+     * It only touches the bones of this skeleton, so different skeletons can be updated on different threads.
+     */
+    void updateBones();
+    
+    /** incremented each time the bone world matrices are refreshed, MeshSkin rebuilds its palette only when it changed */
+    unsigned int getBoneMatrixVersion() const { return _boneMatrixVersion; }
+    
+    /** marks the skeleton as updated in this frame, updateBoneMatrix() does nothing until the next frame */
+    void setBatchUpdatedFrame(unsigned int frame) { _batchUpdatedFrame = frame; _batchUpdated = true; }
+    
+    /** get the slot of a bone in the parents first order used by updateBones(), -1 if it isn't in the skeleton */
+    int getBoneSlot(Bone3D* bone);
+    
+    /** must be called after bones are added to or removed from the hierarchy with Bone3D::addChildBone() and the like */
+    void setBoneHierarchyDirty() { _sortedBonesDirty = true; }
+    
+    /**
+     * sets how far the skins are between the previous and the last evaluated pose, used by the animation LOD.
+     * 1 uses the last pose. MeshSkin interpolates the matrix palettes when it is smaller.
+     */
+    void setPoseInterpolation(float interpolation) { _poseInterpolation = interpolation; }
+    float getPoseInterpolation() const { return _poseInterpolation; }
+    
+    /** the next evaluated pose starts a new interpolation, e.g. when the animation resumes after being suspended */
+    void restartPoseInterpolation() { _poseRestartVersion = _boneMatrixVersion + 1; }
+    /** bone matrix version of the last pose that restarted the interpolation */
+    unsigned int getPoseRestartVersion() const { return _poseRestartVersion; }
+    
+    /** animation statistics of a frame */
+    struct FrameStats
+    {
+        unsigned int evaluatedSkeletons; // calls to updateBones()
+        unsigned int evaluatedBones;
+        unsigned int skippedSkeletons; // skipped by the animation LOD
+        unsigned int suspendedSkeletons; // outside every camera frustum
+    };
+    
+    /** returns the statistics of the last frame */
+    static const FrameStats& getFrameStats() { return s_lastFrameStats; }
+    
+    /** counts a skeleton the animation LOD didn't evaluate this frame */
+    static void addSkippedSkeleton(bool suspended);
+    
+    /** ends the statistics of a frame, called by the Director before the scheduler update */
+    static void resetFrameStats();
+    
 CC_CONSTRUCTOR_ACCESS:
     
     Skeleton3D();
@@ -228,9 +281,24 @@ CC_CONSTRUCTOR_ACCESS:
     
 protected:
     
+    /** sorts the bones reachable from the root bones, parents first */
+    void sortBones();
+    
     Vector<Bone3D*> _bones; // bones
 
     Vector<Bone3D*> _rootBones;
+    
+    std::vector<Bone3D*> _sortedBones; // parents before their children, weak ref
+    std::vector<int> _parentSlots; // slot of the parent in _sortedBones, -1 for root bones
+    std::unordered_map<Bone3D*, int> _boneSlots; // slot of each bone in _sortedBones
+    bool _sortedBonesDirty;
+    unsigned int _boneMatrixVersion;
+    unsigned int _batchUpdatedFrame;
+    bool _batchUpdated;
+    float _poseInterpolation;
+    unsigned int _poseRestartVersion;
+    
+    static FrameStats s_lastFrameStats;
 };
 
 // end of 3d group
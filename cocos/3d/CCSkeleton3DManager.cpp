@@ -0,0 +1,182 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "3d/CCSkeleton3DManager.h"
+#include "3d/CCAnimate3D.h"
+#include "3d/CCSprite3D.h"
+#include "3d/CCMesh.h"
+#include "3d/CCMeshSkin.h"
+#include "3d/CCSkeleton3D.h"
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCJobPool.h"
+
+NS_CC_BEGIN
+
+Skeleton3DManager* Skeleton3DManager::s_sharedManager = nullptr;
+
+Skeleton3DManager* Skeleton3DManager::getInstance()
+{
+    if (s_sharedManager == nullptr)
+    {
+        s_sharedManager = new (std::nothrow) Skeleton3DManager();
+    }
+    return s_sharedManager;
+}
+
+void Skeleton3DManager::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedManager);
+}
+
+Skeleton3DManager::Skeleton3DManager()
+: _enabled(false)
+, _evaluatedSkeletonCount(0)
+, _jobCount(0)
+, _afterUpdateListener(nullptr)
+{
+}
+
+Skeleton3DManager::~Skeleton3DManager()
+{
+    setEnabled(false);
+}
+
+void Skeleton3DManager::setEnabled(bool enabled)
+{
+    if (_enabled == enabled)
+    {
+        return;
+    }
+
+    if (enabled)
+    {
+        _afterUpdateListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [this](EventCustom* /*event*/){
+            evaluateSkeletons();
+        });
+        _enabled = true;
+    }
+    else
+    {
+        evaluateSkeletons();
+        _enabled = false;
+        if (_afterUpdateListener)
+        {
+            Director::getInstance()->getEventDispatcher()->removeEventListener(_afterUpdateListener);
+            _afterUpdateListener = nullptr;
+        }
+    }
+}
+
+void Skeleton3DManager::scheduleAnimation(Sprite3D* sprite, Animate3D* animate, float t, float weight)
+{
+    // the animates of a sprite blend into the same bones, so they are evaluated by the same job
+    auto iter = _jobIndices.find(sprite);
+    int index = 0;
+    if (iter == _jobIndices.end())
+    {
+        index = _jobCount++;
+        if (index == static_cast<int>(_jobs.size()))
+        {
+            _jobs.push_back(Job());
+        }
+        // released once the skeletons are evaluated
+        sprite->retain();
+        _jobs[index].sprite = sprite;
+        _jobIndices[sprite] = index;
+    }
+    else
+    {
+        index = iter->second;
+    }
+
+    animate->retain();
+    Animation animation;
+    animation.animate = animate;
+    animation.t = t;
+    animation.weight = weight;
+    _jobs[index].animations.push_back(animation);
+}
+
+void Skeleton3DManager::evaluateSkeletons()
+{
+    _evaluatedSkeletonCount = _jobCount;
+    if (_jobCount == 0)
+    {
+        return;
+    }
+
+    JobPool::getInstance()->parallelFor(_jobCount, [this](int index) {
+        evaluateSprite(_jobs[index]);
+    });
+
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    for (int i = 0; i < _jobCount; ++i)
+    {
+        auto& job = _jobs[i];
+        auto skeleton = job.sprite->getSkeleton();
+        if (skeleton)
+        {
+            skeleton->setBatchUpdatedFrame(frame);
+        }
+        for (auto& animation : job.animations)
+        {
+            animation.animate->release();
+        }
+        job.animations.clear();
+        job.sprite->release();
+        job.sprite = nullptr;
+    }
+    _jobCount = 0;
+    _jobIndices.clear();
+}
+
+void Skeleton3DManager::evaluateSprite(Job& job)
+{
+    auto skeleton = job.sprite->getSkeleton();
+    if (skeleton == nullptr)
+    {
+        return;
+    }
+
+    for (const auto& animation : job.animations)
+    {
+        animation.animate->evaluateBoneCurves(animation.t, animation.weight);
+    }
+    skeleton->updateBones();
+
+    ssize_t meshCount = job.sprite->getMeshCount();
+    for (ssize_t i = 0; i < meshCount; ++i)
+    {
+        auto skin = job.sprite->getMeshByIndex(static_cast<int>(i))->getSkin();
+        if (skin)
+        {
+            skin->getMatrixPalette();
+        }
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,113 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CCSKELETON3D_MANAGER_H__
+#define __CCSKELETON3D_MANAGER_H__
+
+#include <vector>
+#include <unordered_map>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+class Sprite3D;
+class Animate3D;
+class EventListenerCustom;
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/** @class Skeleton3DManager
+ * @brief Evaluates the animations and skeletons of the animated Sprite3Ds of a frame in parallel, as jobs of the shared JobPool.
+ *
+ * When it is enabled, Animate3D::update() queues its bone curves instead of evaluating them, the node curves
+ * and the key frame events stay in the main thread. Once the scheduler update is done (Director::EVENT_AFTER_UPDATE),
+ * the sprites are evaluated by the JobPool worker threads and the main thread, one sprite per job: the bone curves of
+ * its Animate3Ds, Skeleton3D::updateBones() and the matrix palettes of its skins. The manager waits for them
+ * before the scene is visited, Sprite3D::draw() then reuses the bone matrices and palettes.
+ * It is disabled by default.
+ */
+class CC_DLL Skeleton3DManager
+{
+public:
+    /** Returns the shared instance of the manager. */
+    static Skeleton3DManager* getInstance();
+
+    /** Destroys the shared instance. */
+    static void destroyInstance();
+
+    /** Enables or disables the parallel evaluation. Queued animations are evaluated before it is disabled. */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return _enabled; }
+
+    /** Queues the bone curves of an animate for this frame, it is called by Animate3D::update(). */
+    void scheduleAnimation(Sprite3D* sprite, Animate3D* animate, float t, float weight);
+
+    /** Evaluates the queued sprites and waits for them. It is called after the scheduler update. */
+    void evaluateSkeletons();
+
+    /** Number of skeletons evaluated by the last evaluateSkeletons(). */
+    int getEvaluatedSkeletonCount() const { return _evaluatedSkeletonCount; }
+
+protected:
+    struct Animation
+    {
+        Animate3D* animate;
+        float t;
+        float weight;
+    };
+
+    struct Job
+    {
+        Sprite3D* sprite;
+        std::vector<Animation> animations;
+    };
+
+    Skeleton3DManager();
+    ~Skeleton3DManager();
+
+    void evaluateSprite(Job& job);
+
+    bool _enabled;
+    int _evaluatedSkeletonCount;
+    // the jobs are reused between frames to keep their animation vectors
+    std::vector<Job> _jobs;
+    int _jobCount;
+    std::unordered_map<Sprite3D*, int> _jobIndices;
+
+    EventListenerCustom* _afterUpdateListener;
+
+    static Skeleton3DManager* s_sharedManager;
+};
+
+// end of 3d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCSKELETON3D_MANAGER_H__
@@ -29,6 +29,8 @@
 #include "3d/CCSprite3DMaterial.h"
 #include "3d/CCAttachNode.h"
 #include "3d/CCMesh.h"
+#include "3d/CCMeshUploadQueue.h"
+#include "3d/CCOcclusionCuller.h"
 
 #include "base/CCDirector.h"
 #include "base/CCAsyncTaskPool.h"
@@ -123,7 +125,6 @@ void Sprite3D::createAsync(const std::string& modelPath, const std::string& text
 void Sprite3D::afterAsyncLoad(void* param)
 {
     Sprite3D::AsyncLoadParam* asyncParam = (Sprite3D::AsyncLoadParam*)param;
-    autorelease();
     if (asyncParam)
     {
         if (asyncParam->result)
@@ -133,34 +134,27 @@ void Sprite3D::afterAsyncLoad(void* param)
             CC_SAFE_RELEASE_NULL(_skeleton);
             removeAllAttachNode();
             
-            //create in the main thread
-            auto& meshdatas = asyncParam->meshdatas;
-            auto& materialdatas = asyncParam->materialdatas;
-            auto&   nodeDatas = asyncParam->nodeDatas;
-            if (initFrom(*nodeDatas, *meshdatas, *materialdatas))
+            //create in the main thread, the buffers are filled by MeshUploadQueue over the next frames
+            auto meshdatas = asyncParam->meshdatas;
+            asyncParam->meshdatas = nullptr;
+            if (initFrom(*asyncParam->nodeDatas, *meshdatas, *asyncParam->materialdatas, false))
             {
-                auto spritedata = Sprite3DCache::getInstance()->getSpriteData(asyncParam->modlePath);
-                if (spritedata == nullptr)
-                {
-                    //add to cache
-                    auto data = new (std::nothrow) Sprite3DCache::Sprite3DData();
-                    data->materialdatas = materialdatas;
-                    data->nodedatas = nodeDatas;
-                    data->meshVertexDatas = _meshVertexDatas;
-                    for (const auto mesh : _meshes) {
-                        data->glProgramStates.pushBack(mesh->getGLProgramState());
+                MeshUploadQueue::getInstance()->enqueue(_meshVertexDatas, meshdatas, [this](bool uploaded){
+                    if (uploaded)
+                    {
+                        afterAsyncUpload();
+                        return;
                     }
-                    
-                    Sprite3DCache::getInstance()->addSprite3DData(asyncParam->modlePath, data);
-                    
-                    CC_SAFE_DELETE(meshdatas);
-                    materialdatas = nullptr;
-                    nodeDatas = nullptr;
-                }
+                    // the queue was destroyed, the sprite never reaches the callback
+                    CC_SAFE_DELETE(_asyncLoadParam.materialdatas);
+                    CC_SAFE_DELETE(_asyncLoadParam.nodeDatas);
+                    release();
+                });
+                return;
             }
             CC_SAFE_DELETE(meshdatas);
-            CC_SAFE_DELETE(materialdatas);
-            CC_SAFE_DELETE(nodeDatas);
+            CC_SAFE_DELETE(asyncParam->materialdatas);
+            CC_SAFE_DELETE(asyncParam->nodeDatas);
             
             if (asyncParam->texPath != "")
             {
@@ -171,10 +165,47 @@ void Sprite3D::afterAsyncLoad(void* param)
         {
             CCLOG("file load failed: %s ", asyncParam->modlePath.c_str());
         }
+    }
+    autorelease();
+    if (asyncParam)
+    {
         asyncParam->afterLoadCallback(this, asyncParam->callbackParam);
     }
 }
 
+void Sprite3D::afterAsyncUpload()
+{
+    autorelease();
+    
+    auto& materialdatas = _asyncLoadParam.materialdatas;
+    auto& nodeDatas = _asyncLoadParam.nodeDatas;
+    auto spritedata = Sprite3DCache::getInstance()->getSpriteData(_asyncLoadParam.modlePath);
+    if (spritedata == nullptr)
+    {
+        //add to cache, before the callback: Sprite3DCache::prefetch reads the result from the cache
+        auto data = new (std::nothrow) Sprite3DCache::Sprite3DData();
+        data->materialdatas = materialdatas;
+        data->nodedatas = nodeDatas;
+        data->meshVertexDatas = _meshVertexDatas;
+        for (const auto mesh : _meshes) {
+            data->glProgramStates.pushBack(mesh->getGLProgramState());
+        }
+        
+        Sprite3DCache::getInstance()->addSprite3DData(_asyncLoadParam.modlePath, data);
+        
+        materialdatas = nullptr;
+        nodeDatas = nullptr;
+    }
+    CC_SAFE_DELETE(materialdatas);
+    CC_SAFE_DELETE(nodeDatas);
+    
+    if (_asyncLoadParam.texPath != "")
+    {
+        setTexture(_asyncLoadParam.texPath);
+    }
+    _asyncLoadParam.afterLoadCallback(this, _asyncLoadParam.callbackParam);
+}
+
 AABB Sprite3D::getAABBRecursivelyImp(Node *node)
 {
     AABB aabb;
@@ -240,6 +271,8 @@ bool Sprite3D::loadFromFile(const std::string& path, NodeDatas* nodedatas, MeshD
     {
         //load from .c3b or .c3t
         auto bundle = Bundle3D::createBundle();
+        // the meshes reference the loaded file, their vertices are copied only once, to the buffers
+        bundle->setMeshDataZeroCopy(true);
         if (!bundle->load(fullPath))
         {
             Bundle3D::destroyBundle(bundle);
@@ -264,6 +297,20 @@ Sprite3D::Sprite3D()
 , _forceDepthWrite(false)
 , _usingAutogeneratedGLProgram(true)
 {
+    _animationLOD.enabled = false;
+    _animationLOD.byScreenSize = false;
+    _animationLOD.interpolate = true;
+    _animationLOD.thresholds.push_back(500.f);
+    _animationLOD.thresholds.push_back(1000.f);
+    _animationLOD.thresholds.push_back(2000.f);
+    _animationLOD.metric = 0.f;
+    _animationLOD.visibleFrame = 0;
+    _animationLOD.drawn = false;
+    _animationLOD.decisionFrame = 0;
+    _animationLOD.evaluated = true;
+    _animationLOD.suspended = false;
+    // spreads the evaluations of sprites with the same interval over different frames
+    _animationLOD.counter = (int)(((uintptr_t)this >> 4) & 0xff);
 }
 
 Sprite3D::~Sprite3D()
@@ -323,6 +370,11 @@ bool Sprite3D::initWithFile(const std::string& path)
 }
 
 bool Sprite3D::initFrom(const NodeDatas& nodeDatas, const MeshDatas& meshdatas, const MaterialDatas& materialdatas)
+{
+    return initFrom(nodeDatas, meshdatas, materialdatas, true);
+}
+
+bool Sprite3D::initFrom(const NodeDatas& nodeDatas, const MeshDatas& meshdatas, const MaterialDatas& materialdatas, bool uploadMeshData)
 {
     for(const auto& it : meshdatas.meshDatas)
     {
@@ -330,7 +382,7 @@ bool Sprite3D::initFrom(const NodeDatas& nodeDatas, const MeshDatas& meshdatas,
         {
 //            Mesh* mesh = Mesh::create(*it);
 //            _meshes.pushBack(mesh);
-            auto meshvertex = MeshVertexData::create(*it);
+            auto meshvertex = MeshVertexData::create(*it, uploadMeshData);
             _meshVertexDatas.pushBack(meshvertex);
         }
     }
@@ -670,6 +722,13 @@ void Sprite3D::visit(cocos2d::Renderer *renderer, const cocos2d::Mat4 &parentTra
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
     flags |= FLAGS_RENDER_AS_3D;
     
+    auto scene = _spatialIndexEntry.scene;
+    if (scene && scene->isSpatialIndexEnabled()
+        && ((flags & FLAGS_DIRTY_MASK) || _aabbDirty || !scene->isInSpatialIndex(_spatialIndexEntry)))
+    {
+        scene->updateSpatialIndex(this, _spatialIndexEntry, getAABB());
+    }
+    
     //
     Director* director = Director::getInstance();
     director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
@@ -707,15 +766,166 @@ void Sprite3D::visit(cocos2d::Renderer *renderer, const cocos2d::Mat4 &parentTra
     director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 }
 
+void Sprite3D::onEnter()
+{
+    _spatialIndexEntry.scene = getScene();
+    if (_spatialIndexEntry.scene && isOccluder())
+        _spatialIndexEntry.scene->_occluders.push_back(this);
+    Node::onEnter();
+}
+
+void Sprite3D::onExit()
+{
+    if (_spatialIndexEntry.scene)
+    {
+        _spatialIndexEntry.scene->removeFromSpatialIndex(_spatialIndexEntry);
+        auto& occluders = _spatialIndexEntry.scene->_occluders;
+        auto iter = std::find(occluders.begin(), occluders.end(), this);
+        if (iter != occluders.end())
+            occluders.erase(iter);
+        _spatialIndexEntry.scene = nullptr;
+    }
+    Node::onExit();
+}
+
+void Sprite3D::setOccluderMesh(const std::vector<Vec3>& positions, const std::vector<unsigned short>& indices)
+{
+    bool wasOccluder = isOccluder();
+    if (positions.empty() || indices.size() < 3)
+    {
+        _occluderPositions.clear();
+        _occluderIndices.clear();
+    }
+    else
+    {
+        _occluderPositions = positions;
+        _occluderIndices = indices;
+    }
+    
+    auto scene = _spatialIndexEntry.scene;
+    if (scene && wasOccluder != isOccluder())
+    {
+        auto& occluders = scene->_occluders;
+        if (isOccluder())
+            occluders.push_back(this);
+        else
+            occluders.erase(std::find(occluders.begin(), occluders.end(), this));
+    }
+}
+
+void Sprite3D::setAnimationLODEnabled(bool enabled)
+{
+    _animationLOD.enabled = enabled;
+    _animationLOD.drawn = false;
+    _animationLOD.decisionFrame = 0;
+    if (_skeleton)
+        _skeleton->setPoseInterpolation(1.f);
+}
+
+void Sprite3D::setAnimationLODThresholds(const std::vector<float>& thresholds, bool byScreenSize)
+{
+    _animationLOD.thresholds = thresholds;
+    _animationLOD.byScreenSize = byScreenSize;
+}
+
+bool Sprite3D::isAnimationEvaluated()
+{
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    if (!_animationLOD.enabled || _animationLOD.decisionFrame == frame)
+        return !_animationLOD.enabled || _animationLOD.evaluated;
+    _animationLOD.decisionFrame = frame;
+    
+    // not drawn by any camera in the previous frame, sprites never drawn are evaluated once for their first pose
+    if (_animationLOD.drawn && _animationLOD.visibleFrame + 1 < frame)
+    {
+        if (!_animationLOD.suspended && _skeleton)
+            _skeleton->restartPoseInterpolation();
+        _animationLOD.suspended = true;
+        _animationLOD.evaluated = false;
+        Skeleton3D::addSkippedSkeleton(true);
+        return false;
+    }
+    
+    int level = 0;
+    for (auto threshold : _animationLOD.thresholds)
+    {
+        if (_animationLOD.byScreenSize ? _animationLOD.metric >= threshold : _animationLOD.metric < threshold)
+            break;
+        level++;
+    }
+    int interval = 1 << std::min(level, 4);
+    
+    ++_animationLOD.counter;
+    _animationLOD.evaluated = _animationLOD.suspended || _animationLOD.counter >= interval;
+    _animationLOD.suspended = false;
+    if (_animationLOD.evaluated)
+        _animationLOD.counter = 0;
+    else
+        Skeleton3D::addSkippedSkeleton(false);
+    
+    if (_skeleton)
+    {
+        if (_animationLOD.interpolate && interval > 1)
+            _skeleton->setPoseInterpolation((float)_animationLOD.counter / interval);
+        else
+            _skeleton->setPoseInterpolation(1.f);
+    }
+    return _animationLOD.evaluated;
+}
+
 void Sprite3D::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
 #if CC_USE_CULLING
-    // camera clipping
-    if(Camera::getVisitingCamera() && !Camera::getVisitingCamera()->isVisibleInFrustum(&this->getAABB()))
-        return;
+    // camera clipping, with the result of the spatial index if there is one
+    auto visitingCamera = Camera::getVisitingCamera();
+    if (visitingCamera)
+    {
+        bool visible;
+        auto scene = _spatialIndexEntry.scene;
+        if (!(scene && scene->getSpatialIndexVisibility(_spatialIndexEntry, visitingCamera, &visible)))
+            visible = visitingCamera->isVisibleInFrustum(&this->getAABB());
+        if (!visible)
+            return;
+        
+        // occluders are inside their own bounds, so only the others are tested
+        auto culler = visitingCamera->getOcclusionCuller();
+        if (culler && !isOccluder() && !culler->isVisible(getAABB()))
+            return;
+    }
 #endif
     
-    if (_skeleton)
+    if (_animationLOD.enabled && _skeleton)
+    {
+        // measured for the decision of the next frame, the nearest camera wins
+        auto camera = Camera::getVisitingCamera();
+        float metric = 0.f;
+        if (camera)
+        {
+            if (_animationLOD.byScreenSize)
+            {
+                const AABB& aabb = getAABB();
+                float depth = std::max(camera->getDepthInView(transform), 0.001f);
+                metric = aabb._max.distance(aabb._min) * 0.5f / depth;
+            }
+            else
+            {
+                Vec3 cameraPosition;
+                camera->getNodeToWorldTransform().getTranslation(&cameraPosition);
+                metric = cameraPosition.distance(Vec3(transform.m[12], transform.m[13], transform.m[14]));
+            }
+        }
+        unsigned int frame = Director::getInstance()->getTotalFrames();
+        if (_animationLOD.visibleFrame != frame || !_animationLOD.drawn)
+            _animationLOD.metric = metric;
+        else if (_animationLOD.byScreenSize)
+            _animationLOD.metric = std::max(_animationLOD.metric, metric);
+        else
+            _animationLOD.metric = std::min(_animationLOD.metric, metric);
+        _animationLOD.visibleFrame = frame;
+        _animationLOD.drawn = true;
+    }
+    
+    if (_skeleton && isAnimationEvaluated())
         _skeleton->updateBoneMatrix();
     
     Color4F color(getDisplayedColor());
@@ -909,7 +1119,10 @@ Sprite3DCache::Sprite3DData* Sprite3DCache::getSpriteData(const std::string& key
 {
     auto it = _spriteDatas.find(key);
     if (it != _spriteDatas.end())
+    {
+        it->second->lastUsed = ++_useCounter;
         return it->second;
+    }
     return nullptr;
 }
 
@@ -918,7 +1131,14 @@ bool Sprite3DCache::addSprite3DData(const std::string& key, Sprite3DCache::Sprit
     auto it = _spriteDatas.find(key);
     if (it == _spriteDatas.end())
     {
+        calculateBytes(spritedata);
+        spritedata->lastUsed = ++_useCounter;
         _spriteDatas[key] = spritedata;
+        _gpuBytes += spritedata->gpuBytes;
+        _cpuBytes += spritedata->cpuBytes;
+        
+        if (_memoryBudget > 0 && _gpuBytes + _cpuBytes > _memoryBudget)
+            removeUnusedSprite3DData(_memoryBudget);
         return true;
     }
     return false;
@@ -929,9 +1149,11 @@ void Sprite3DCache::removeSprite3DData(const std::string& key)
     auto it = _spriteDatas.find(key);
     if (it != _spriteDatas.end())
     {
+        _gpuBytes -= it->second->gpuBytes;
+        _cpuBytes -= it->second->cpuBytes;
         delete it->second;
+        _spriteDatas.erase(it);
     }
-    _spriteDatas.erase(it);
 }
 
 void Sprite3DCache::removeAllSprite3DData()
@@ -940,9 +1162,189 @@ void Sprite3DCache::removeAllSprite3DData()
         delete it.second;
     }
     _spriteDatas.clear();
+    _gpuBytes = 0;
+    _cpuBytes = 0;
+}
+
+void Sprite3DCache::removeUnusedSprite3DData(size_t bytesToKeep)
+{
+    if (_gpuBytes + _cpuBytes <= bytesToKeep && bytesToKeep > 0)
+        return;
+    
+    std::vector<std::pair<unsigned int, std::string>> unused;
+    for (const auto& it : _spriteDatas)
+    {
+        if (!isUsed(it.second))
+            unused.push_back(std::make_pair(it.second->lastUsed, it.first));
+    }
+    std::sort(unused.begin(), unused.end());
+    
+    for (const auto& it : unused)
+    {
+        if (bytesToKeep > 0 && _gpuBytes + _cpuBytes <= bytesToKeep)
+            break;
+        CCLOG("Sprite3DCache: removing unused %s", it.second.c_str());
+        removeSprite3DData(it.second);
+    }
+}
+
+void Sprite3DCache::setMemoryBudget(size_t bytes)
+{
+    _memoryBudget = bytes;
+    if (_memoryBudget > 0 && _gpuBytes + _cpuBytes > _memoryBudget)
+        removeUnusedSprite3DData(_memoryBudget);
+}
+
+void Sprite3DCache::prefetch(const std::string& modelPath, const std::function<void(bool)>& callback)
+{
+    if (getSpriteData(modelPath))
+    {
+        if (callback)
+            callback(true);
+        return;
+    }
+    
+    auto it = _prefetching.find(modelPath);
+    if (it != _prefetching.end())
+    {
+        if (callback)
+            it->second.push_back(callback);
+        return;
+    }
+    auto& callbacks = _prefetching[modelPath];
+    if (callback)
+        callbacks.push_back(callback);
+    
+    // the sprite adds the data to the cache once its meshes are uploaded, it is never added to a scene
+    // and released after the callback
+    Sprite3D::createAsync(modelPath, [modelPath](Sprite3D* sprite, void* param)
+    {
+        // the cache may have been destroyed and created again meanwhile
+        auto cache = Sprite3DCache::getInstance();
+        bool loaded = cache->_spriteDatas.find(modelPath) != cache->_spriteDatas.end();
+        if (!loaded)
+            CCLOG("Sprite3DCache: failed to prefetch %s", modelPath.c_str());
+        
+        auto it = cache->_prefetching.find(modelPath);
+        if (it == cache->_prefetching.end())
+            return;
+        auto callbacks = it->second;
+        cache->_prefetching.erase(it);
+        for (const auto& callback : callbacks)
+            callback(loaded);
+    }, nullptr);
+}
+
+std::string Sprite3DCache::getCachedSprite3DDataInfo() const
+{
+    std::string buffer;
+    char buftmp[4096];
+    
+    for (const auto& it : _spriteDatas)
+    {
+        auto spritedata = it.second;
+        snprintf(buftmp, sizeof(buftmp) - 1, "\"%s\" meshes=%ld used=%s lastUsed=%u => GPU %lu KB, CPU %lu KB\n",
+                 it.first.c_str(),
+                 (long)spritedata->meshVertexDatas.size(),
+                 isUsed(spritedata) ? "yes" : "no",
+                 spritedata->lastUsed,
+                 (unsigned long)spritedata->gpuBytes / 1024,
+                 (unsigned long)spritedata->cpuBytes / 1024);
+        buffer += buftmp;
+    }
+    
+    snprintf(buftmp, sizeof(buftmp) - 1, "Sprite3DCache dumpDebugInfo: %ld models, GPU %lu KB, CPU %lu KB, budget %lu KB\n",
+             (long)_spriteDatas.size(),
+             (unsigned long)_gpuBytes / 1024,
+             (unsigned long)_cpuBytes / 1024,
+             (unsigned long)_memoryBudget / 1024);
+    buffer += buftmp;
+    
+    return buffer;
+}
+
+bool Sprite3DCache::isUsed(const Sprite3DData* spritedata)
+{
+    // the cache holds one reference, sprites and meshes hold the others
+    for (const auto& vertexData : spritedata->meshVertexDatas)
+    {
+        if (vertexData->getReferenceCount() > 1)
+            return true;
+        for (ssize_t i = 0; i < vertexData->getMeshIndexDataCount(); ++i)
+        {
+            if (vertexData->getMeshIndexDataByIndex((int)i)->getReferenceCount() > 1)
+                return true;
+        }
+    }
+    return false;
+}
+
+static size_t getNodeDataBytes(const NodeData* nodedata)
+{
+    size_t bytes = sizeof(NodeData) + nodedata->id.capacity();
+    for (const auto& model : nodedata->modelNodeDatas)
+    {
+        bytes += sizeof(ModelData) + model->subMeshId.capacity() + model->matrialId.capacity();
+        bytes += model->invBindPose.capacity() * sizeof(Mat4);
+        for (const auto& bone : model->bones)
+            bytes += sizeof(std::string) + bone.capacity();
+    }
+    for (const auto& child : nodedata->children)
+        bytes += getNodeDataBytes(child);
+    return bytes;
+}
+
+void Sprite3DCache::calculateBytes(Sprite3DData* spritedata)
+{
+    size_t gpuBytes = 0;
+    for (const auto& vertexData : spritedata->meshVertexDatas)
+    {
+        if (vertexData->getVertexBuffer())
+            gpuBytes += vertexData->getVertexBuffer()->getSize();
+        for (ssize_t i = 0; i < vertexData->getMeshIndexDataCount(); ++i)
+        {
+            auto indexBuffer = vertexData->getMeshIndexDataByIndex((int)i)->getIndexBuffer();
+            if (indexBuffer)
+                gpuBytes += indexBuffer->getSize();
+        }
+    }
+    
+    size_t cpuBytes = sizeof(Sprite3DData);
+    // the shadow copies are kept to restore the buffers after the context is lost
+    if (VertexBuffer::isShadowCopyEnabled())
+        cpuBytes += gpuBytes;
+    if (spritedata->nodedatas)
+    {
+        for (const auto& it : spritedata->nodedatas->nodes)
+        {
+            if (it)
+                cpuBytes += getNodeDataBytes(it);
+        }
+        for (const auto& it : spritedata->nodedatas->skeleton)
+        {
+            if (it)
+                cpuBytes += getNodeDataBytes(it);
+        }
+    }
+    if (spritedata->materialdatas)
+    {
+        for (const auto& material : spritedata->materialdatas->materials)
+        {
+            cpuBytes += sizeof(NMaterialData) + material.id.capacity();
+            for (const auto& texture : material.textures)
+                cpuBytes += sizeof(NTextureData) + texture.id.capacity() + texture.filename.capacity();
+        }
+    }
+    
+    spritedata->gpuBytes = gpuBytes;
+    spritedata->cpuBytes = cpuBytes;
 }
 
 Sprite3DCache::Sprite3DCache()
+: _memoryBudget(0)
+, _gpuBytes(0)
+, _cpuBytes(0)
+, _useCounter(0)
 {
     
 }
@@ -31,6 +31,7 @@
 #include "base/ccTypes.h"
 #include "base/CCProtocols.h"
 #include "2d/CCNode.h"
+#include "2d/CCScene.h"
 #include "renderer/CCMeshCommand.h"
 #include "renderer/CCGLProgramState.h"
 #include "3d/CCSkeleton3D.h" // need to include for lua-binding
@@ -72,6 +73,7 @@ public:
      * If the 3d model was previously loaded, it will create a new 3d sprite and the callback will be called at once.
      * Otherwise it will load the model file in a new thread, and when the 3d sprite is loaded, the callback will be called with the created Sprite3D and a userdefined parameter.
      * The callback will be called from the main thread, so it is safe to create any cocos2d object from the callback.
+     * The vertices and indices are uploaded by MeshUploadQueue over the frames following the load, the callback is called once they are.
      * @param modelPath model to be loaded
      * @param callback callback after loading
      * @param callbackparam user defined parameter for the callback
@@ -108,6 +110,37 @@ public:
     
     Skeleton3D* getSkeleton() const { return _skeleton; }
     
+    /**
+     * Enables the animation LOD, disabled by default.
+     * The skeleton is evaluated less often the farther or smaller the sprite is, see setAnimationLODThresholds(),
+     * and not at all while the sprite is outside every camera frustum. The visibility and the distance are
+     * those of the previous frame, so a sprite entering the view shows its old pose for one frame.
+     */
+    void setAnimationLODEnabled(bool enabled);
+    bool isAnimationLODEnabled() const { return _animationLOD.enabled; }
+    
+    /**
+     * Sets the thresholds of the animation LOD levels, level n evaluates the skeleton every 2^n frames.
+     * By distance, level n starts at thresholds[n-1] from the nearest camera, sorted ascending. Default is 500, 1000, 2000.
+     * By screen size, the size is the radius of the AABB divided by the depth in the camera, level n starts
+     * below thresholds[n-1], sorted descending.
+     */
+    void setAnimationLODThresholds(const std::vector<float>& thresholds, bool byScreenSize = false);
+    const std::vector<float>& getAnimationLODThresholds() const { return _animationLOD.thresholds; }
+    
+    /**
+     * Interpolates the skin palettes between the last two evaluated poses on the frames the LOD skips,
+     * instead of holding the last pose. The animation is then one evaluation interval late. Default is true.
+     */
+    void setAnimationLODInterpolation(bool interpolate) { _animationLOD.interpolate = interpolate; }
+    bool isAnimationLODInterpolation() const { return _animationLOD.interpolate; }
+    
+    /**
+     * Returns whether the skeleton is evaluated this frame. It is decided once per frame,
+     * Animate3D skips its bone curves and draw() skips the bone matrices when it returns false.
+     */
+    bool isAnimationEvaluated();
+    
     /**get AttachNode by bone name, return nullptr if not exist*/
     AttachNode* getAttachNode(const std::string& boneName);
     
@@ -143,6 +176,18 @@ public:
      */
     AABB getAABBRecursively();
     
+    /**
+     * Makes the sprite an occluder for the cameras with occlusion culling, see Camera::setOcclusionCullingEnabled().
+     * The mesh must be inside the sprite so it never hides what the sprite doesn't, usually a simplified version of it,
+     * e.g. a few boxes for a building. An empty mesh makes the sprite a regular one again.
+     * @param positions The vertices, in the space of the sprite.
+     * @param indices The triangles.
+     */
+    void setOccluderMesh(const std::vector<Vec3>& positions, const std::vector<unsigned short>& indices);
+    const std::vector<Vec3>& getOccluderPositions() const { return _occluderPositions; }
+    const std::vector<unsigned short>& getOccluderIndices() const { return _occluderIndices; }
+    bool isOccluder() const { return !_occluderIndices.empty(); }
+    
     /**
      * Executes an action, and returns the action that is executed. For Sprite3D special logic are needed to take care of Fading.
      *
@@ -210,6 +255,8 @@ CC_CONSTRUCTOR_ACCESS:
     bool initWithFile(const std::string &path);
     
     bool initFrom(const NodeDatas& nodedatas, const MeshDatas& meshdatas, const MaterialDatas& materialdatas);
+    /** the buffers of the meshes are left empty if uploadMeshData is false, see MeshUploadQueue */
+    bool initFrom(const NodeDatas& nodedatas, const MeshDatas& meshdatas, const MaterialDatas& materialdatas, bool uploadMeshData);
     
     /**load sprite3d from cache, return true if succeed, false otherwise*/
     bool loadFromCache(const std::string& path);
@@ -237,7 +284,11 @@ CC_CONSTRUCTOR_ACCESS:
     
     void onAABBDirty() { _aabbDirty = true; }
     
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    
     void afterAsyncLoad(void* param);
+    void afterAsyncUpload();
 
     static AABB getAABBRecursivelyImp(Node *node);
     
@@ -261,6 +312,27 @@ protected:
     bool                         _forceDepthWrite; // Always write to depth buffer
     bool                         _usingAutogeneratedGLProgram;
     
+    struct AnimationLOD
+    {
+        bool enabled;
+        bool byScreenSize;
+        bool interpolate;
+        std::vector<float> thresholds;
+        // distance or screen size measured by the cameras which drew the sprite in visibleFrame
+        float metric;
+        unsigned int visibleFrame;
+        bool drawn;
+        // decision made for decisionFrame
+        unsigned int decisionFrame;
+        bool evaluated;
+        bool suspended;
+        int counter;
+    };
+    AnimationLOD               _animationLOD;
+    SpatialIndexEntry          _spatialIndexEntry;
+    std::vector<Vec3>          _occluderPositions;
+    std::vector<unsigned short> _occluderIndices;
+    
     struct AsyncLoadParam
     {
         std::function<void(Sprite3D*, void*)> afterLoadCallback; // callback after load
@@ -289,6 +361,18 @@ public:
         Vector<GLProgramState*>   glProgramStates;
         NodeDatas*      nodedatas;
         MaterialDatas*  materialdatas;
+        // set by the cache
+        size_t          gpuBytes; // vertex and index buffers
+        size_t          cpuBytes; // node and material datas, shadow copies of the buffers
+        unsigned int    lastUsed;
+        Sprite3DData()
+        : nodedatas(nullptr)
+        , materialdatas(nullptr)
+        , gpuBytes(0)
+        , cpuBytes(0)
+        , lastUsed(0)
+        {
+        }
         ~Sprite3DData()
         {
             if (nodedatas)
@@ -324,15 +408,61 @@ public:
     /**remove all the SpriteData from Sprite3D*/
     void removeAllSprite3DData();
     
+    /**
+     * remove the SpriteData no sprite uses, least recently used first, until the cache uses at most bytesToKeep bytes
+     *
+     * @param bytesToKeep The GPU and CPU bytes the cache may keep, 0 removes all the unused SpriteData.
+     */
+    void removeUnusedSprite3DData(size_t bytesToKeep = 0);
+    
+    /**
+     * set the GPU and CPU bytes the cache should use at most, 0 is unlimited, the default.
+     * When it is exceeded, the least recently used SpriteData no sprite uses are removed. The SpriteData
+     * used by sprites are never removed, so the cache can stay above the budget.
+     */
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const { return _memoryBudget; }
+    
+    /**bytes of the vertex and index buffers of all the SpriteData*/
+    size_t getGPUBytes() const { return _gpuBytes; }
+    /**bytes of the node and material datas and buffer shadow copies of all the SpriteData*/
+    size_t getCPUBytes() const { return _cpuBytes; }
+    
+    /**
+     * load a .c3b, .c3t or .obj file into the cache in the background, so that Sprite3D::create with it doesn't load it.
+     * The meshes are uploaded over several frames as in Sprite3D::createAsync.
+     *
+     * @param modelPath The model file.
+     * @param callback Called on the main thread once the file is cached, with false if it failed to load.
+     */
+    void prefetch(const std::string& modelPath, const std::function<void(bool)>& callback = nullptr);
+    
+    /**whether the file is being prefetched*/
+    bool isPrefetching(const std::string& modelPath) const { return _prefetching.find(modelPath) != _prefetching.end(); }
+    
+    /**
+     * returns a string with the size and use of each SpriteData, for debugging
+     *
+     * @lua NA
+     */
+    std::string getCachedSprite3DDataInfo() const;
+    
     CC_CONSTRUCTOR_ACCESS:
     Sprite3DCache();
     ~Sprite3DCache();
     
 protected:
     
+    static bool isUsed(const Sprite3DData* spritedata);
+    static void calculateBytes(Sprite3DData* spritedata);
     
     static Sprite3DCache*                        _cacheInstance;
     std::unordered_map<std::string, Sprite3DData*> _spriteDatas; //cached sprite datas
+    std::unordered_map<std::string, std::vector<std::function<void(bool)>>> _prefetching; //callbacks of the files being prefetched
+    size_t                                       _memoryBudget;
+    size_t                                       _gpuBytes;
+    size_t                                       _cpuBytes;
+    mutable unsigned int                         _useCounter;
 };
 
 // end of 3d group
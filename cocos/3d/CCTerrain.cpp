@@ -29,6 +29,8 @@ USING_NS_CC;
 #include <CCImage.h>
 #include <float.h>
 #include <set>
+#include <algorithm>
+#include <limits>
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCGLProgramCache.h"
 #include "renderer/CCGLProgramState.h"
@@ -38,6 +40,9 @@ USING_NS_CC;
 #include "renderer/CCRenderState.h"
 #include "base/CCDirector.h"
 #include "base/CCEventType.h"
+#include "base/CCAsyncTaskPool.h"
+#include "base/CCJobPool.h"
+#include "3d/CCMeshUploadQueue.h"
 #include "2d/CCCamera.h"
 
 NS_CC_BEGIN
@@ -62,10 +67,88 @@ Terrain * Terrain::create(TerrainData &parameter, CrackFixedType fixedType)
     CC_SAFE_DELETE(terrain);
     return terrain;
 }
+void Terrain::createAsync(const TerrainData &parameter, CrackFixedType fixedType, const std::function<void(Terrain*, void*)>& callback, void* callbackparam)
+{
+    Terrain * terrain = new (std::nothrow)Terrain();
+    terrain->setSkirtHeightRatio(parameter._skirtHeightRatio);
+    terrain->setTerrainData(parameter);
+    terrain->_crackFixedType = fixedType;
+    terrain->_isCameraViewChanged = true;
+    terrain->_chunkSize = parameter._chunkSize;
+    terrain->_asyncLoadParam.afterLoadCallback = callback;
+    terrain->_asyncLoadParam.callbackParam = callbackparam;
+    terrain->_asyncLoadParam.result = false;
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, CC_CALLBACK_1(Terrain::afterAsyncLoad, terrain), (void*)(&terrain->_asyncLoadParam), [terrain]()
+    {
+        terrain->_asyncLoadParam.result = terrain->loadHeightMap(terrain->_terrainData._heightMapSrc.c_str());
+        if (terrain->_asyncLoadParam.result)
+        {
+            //decode the textures here too, only their upload is left to the main thread
+            terrain->preloadTextureImages();
+        }
+    });
+}
+
+void Terrain::afterAsyncLoad(void* param)
+{
+    AsyncLoadParam* asyncParam = (AsyncLoadParam*)param;
+    auto callback = asyncParam->afterLoadCallback;
+    auto callbackParam = asyncParam->callbackParam;
+    if (asyncParam->result)
+    {
+        //the textures and the buffers are created in the main thread, the chunk buffers over the next frames
+        initQuadTree();
+        _finishedChunks = 0;
+        ssize_t size = 0;
+        int chunk_amount_y = _imageHeight/_chunkSize.height;
+        int chunk_amount_x = _imageWidth/_chunkSize.width;
+        for(int m =0;m<chunk_amount_y;m++)
+        {
+            for(int n =0; n<chunk_amount_x;n++)
+            {
+                size += sizeof(TerrainVertexData)*_chunkesArray[m][n]->_originalVertices.size();
+            }
+        }
+        MeshUploadQueue::getInstance()->enqueue(size, [this](ssize_t budget){
+            return finishChunks(budget);
+        }, [this, callback, callbackParam](bool uploaded){
+            if (!uploaded)
+            {
+                //the queue was destroyed, the terrain never reaches the callback
+                release();
+                return;
+            }
+            initTextures();
+            initProperties();
+            autorelease();
+            if (callback)
+                callback(this, callbackParam);
+        });
+    }
+    else
+    {
+        CCLOG("failed to load terrain height map: %s", _terrainData._heightMapSrc.c_str());
+        release();
+        if (callback)
+            callback(nullptr, callbackParam);
+    }
+}
+
+void Terrain::setTerrainData(const TerrainData &parameter)
+{
+    _terrainData = parameter;
+    //the alpha map path is kept for reload(), the one of parameter may not live as long
+    if(parameter._alphaMapSrc)
+    {
+        _alphaMapPath = parameter._alphaMapSrc;
+        _terrainData._alphaMapSrc = const_cast<char *>(_alphaMapPath.c_str());
+    }
+}
+
 bool Terrain::initWithTerrainData(TerrainData &parameter, CrackFixedType fixedType)
 {
     this->setSkirtHeightRatio(parameter._skirtHeightRatio);
-    this->_terrainData = parameter;
+    this->setTerrainData(parameter);
     this->_crackFixedType = fixedType;
     this->_isCameraViewChanged = true;
     //chunksize
@@ -224,9 +307,21 @@ void Terrain::onDraw(const Mat4 &transform, uint32_t flags)
 }
 
 bool Terrain::initHeightMap(const char * heightMap)
+{
+    if (!loadHeightMap(heightMap))
+        return false;
+    finishHeightMap();
+    return true;
+}
+
+bool Terrain::loadHeightMap(const char * heightMap)
 {
     _heightMapImage = new Image();
-    _heightMapImage->initWithImageFile(heightMap);
+    if (!_heightMapImage->initWithImageFile(heightMap))
+    {
+        CCLOG("warning: failed to load the height map %s", heightMap);
+        return false;
+    }
     _data = _heightMapImage->getData();
     _imageWidth =_heightMapImage->getWidth();
     _imageHeight =_heightMapImage->getHeight();
@@ -262,8 +357,6 @@ bool Terrain::initHeightMap(const char * heightMap)
                 if(m+1<chunk_amount_y) _chunkesArray[m][n]->_front = _chunkesArray[m+1][n];
             }
         }
-        _quadRoot = new QuadTree(0,0,_imageWidth,_imageHeight,this);
-        setLODDistance(_chunkSize.width,2*_chunkSize.width,3*_chunkSize.width);
         return true;
     }else
     {
@@ -272,12 +365,56 @@ bool Terrain::initHeightMap(const char * heightMap)
     }
 }
 
+void Terrain::finishHeightMap()
+{
+    _finishedChunks = 0;
+    finishChunks(std::numeric_limits<ssize_t>::max());
+    initQuadTree();
+}
+
+ssize_t Terrain::finishChunks(ssize_t budget)
+{
+    int chunk_amount_y = _imageHeight/_chunkSize.height;
+    int chunk_amount_x = _imageWidth/_chunkSize.width;
+    ssize_t size = 0;
+    while(_finishedChunks < chunk_amount_x * chunk_amount_y && (size == 0 || size < budget))
+    {
+        auto chunk = _chunkesArray[_finishedChunks / chunk_amount_x][_finishedChunks % chunk_amount_x];
+        chunk->finish();
+        size += sizeof(TerrainVertexData)*chunk->_originalVertices.size();
+        _finishedChunks++;
+    }
+    return size;
+}
+
+void Terrain::initQuadTree()
+{
+    deleteIndicesLOD();
+    createIndicesLOD();
+
+    _quadRoot = new QuadTree(0,0,_imageWidth,_imageHeight,this);
+    setLODDistance(_chunkSize.width,2*_chunkSize.width,3*_chunkSize.width);
+    _isCameraViewChanged = true;
+}
+
 Terrain::Terrain()
 : _alphaMap(nullptr)
 , _stateBlock(nullptr)
 , _lightMap(nullptr)
 , _lightDir(-1.f, -1.f, 0.f)
-{
+, _quadRoot(nullptr)
+, _heightMapImage(nullptr)
+, _finishedChunks(0)
+{
+    memset(_chunkesArray, 0, sizeof(_chunkesArray));
+    memset(_detailMapTextures, 0, sizeof(_detailMapTextures));
+    memset(_chunkLodIndices, 0, sizeof(_chunkLodIndices));
+    memset(_chunkLodIndicesSkirt, 0, sizeof(_chunkLodIndicesSkirt));
+    _asyncLoadParam.callbackParam = nullptr;
+    _asyncLoadParam.result = false;
+    _asyncLoadParam.alphaMapImage = nullptr;
+    memset(_asyncLoadParam.detailMapImages, 0, sizeof(_asyncLoadParam.detailMapImages));
+
     _stateBlock = RenderState::StateBlock::create();
     CC_SAFE_RETAIN(_stateBlock);
 
@@ -298,22 +435,50 @@ void Terrain::setChunksLOD(Vec3 cameraPos)
 {
     int chunk_amount_y = _imageHeight/_chunkSize.height;
     int chunk_amount_x = _imageWidth/_chunkSize.width;
-    for(int m=0;m<chunk_amount_y;m++)
-        for(int n =0;n<chunk_amount_x;n++)
+    //one row of chunks per job, terrains of less than 64 chunks aren't worth waking the threads
+    //the indices depend on the LOD of the neighbors, so they are selected once every LOD is known
+    for(int pass = 0; pass < 2; pass++)
+    {
+        if(chunk_amount_x * chunk_amount_y >= 64)
+        {
+            JobPool::getInstance()->parallelFor(chunk_amount_y, [this, pass, &cameraPos](int m){
+                updateLODRow(pass, m, cameraPos);
+            });
+        }else
+        {
+            for(int m = 0; m < chunk_amount_y; m++)
+            {
+                updateLODRow(pass, m, cameraPos);
+            }
+        }
+    }
+}
+
+void Terrain::updateLODRow(int pass, int row, const Vec3& cameraPos)
+{
+    int chunk_amount_x = _imageWidth/_chunkSize.width;
+    for(int n =0;n<chunk_amount_x;n++)
+    {
+        auto chunk = _chunkesArray[row][n];
+        if(pass == 0)
         {
-            AABB aabb = _chunkesArray[m][n]->_parent->_worldSpaceAABB;
+            AABB aabb = chunk->_parent->_worldSpaceAABB;
             auto center = aabb.getCenter();
             float dist = Vec2(center.x, center.z).distance(Vec2(cameraPos.x, cameraPos.z));
-            _chunkesArray[m][n]->_currentLod = 3;
+            chunk->_currentLod = 3;
             for(int i =0;i<3;i++)
             {
                 if(dist<=_lodDistance[i])
                 {
-                    _chunkesArray[m][n]->_currentLod = i;
+                    chunk->_currentLod = i;
                     break;
                 }
             }
+        }else
+        {
+            chunk->updateLOD();
         }
+    }
 }
 
 float Terrain::getHeight(float x, float z, Vec3 * normal) const
@@ -321,7 +486,8 @@ float Terrain::getHeight(float x, float z, Vec3 * normal) const
     Vec2 pos(x,z);
 
     //top-left
-    Vec2 tl(-1*_terrainData._mapScale*_imageWidth/2,-1*_terrainData._mapScale*_imageHeight/2);
+    //the vertices start at the integer half size, see loadVertices
+    Vec2 tl(-1*_terrainData._mapScale*(_imageWidth/2),-1*_terrainData._mapScale*(_imageHeight/2));
     auto result  = getNodeToWorldTransform()*Vec4(tl.x,0.0f,tl.y,1.0f);
     tl.set(result.x, result.z);
 
@@ -337,13 +503,14 @@ float Terrain::getHeight(float x, float z, Vec3 * normal) const
 
     float image_x = width_ratio * _imageWidth;
     float image_y = height_ratio * _imageHeight;
-    float u =image_x - (int)image_x;
-    float v =image_y - (int)image_y;
-    float i = (int)image_x;
-    float j = (int)image_y;
+    //the last row and column belong to the terrain too, they are interpolated from the cell before them
+    float i = std::min((int)image_x, _imageWidth - 2);
+    float j = std::min((int)image_y, _imageHeight - 2);
+    float u =image_x - i;
+    float v =image_y - j;
 
 
-    if(image_x>=_imageWidth-1 || image_y >=_imageHeight-1 || image_x<0 || image_y<0)
+    if(image_x>_imageWidth-1 || image_y >_imageHeight-1 || image_x<0 || image_y<0)
     {
         if (normal)
         {
@@ -476,6 +643,11 @@ void Terrain::setIsEnableFrustumCull(bool bool_value)
 
 Terrain::~Terrain()
 {
+    CC_SAFE_DELETE(_asyncLoadParam.alphaMapImage);
+    for(int i=0;i<4;i++)
+    {
+        CC_SAFE_DELETE(_asyncLoadParam.detailMapImages[i]);
+    }
     CC_SAFE_RELEASE(_stateBlock);
     CC_SAFE_RELEASE(_alphaMap);
     CC_SAFE_RELEASE(_lightMap);
@@ -499,15 +671,7 @@ Terrain::~Terrain()
         }
     }
 
-    for(size_t i =0;i<_chunkLodIndicesSet.size();i++)
-    {
-        glDeleteBuffers(1,&(_chunkLodIndicesSet[i]._chunkIndices._indices));
-    }
-
-    for(size_t i =0;i<_chunkLodIndicesSkirtSet.size();i++)
-    {
-        glDeleteBuffers(1,&(_chunkLodIndicesSkirtSet[i]._chunkIndices._indices));
-    }
+    deleteIndicesLOD();
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
     Director::getInstance()->getEventDispatcher()->removeEventListener(_backToForegroundListener);
@@ -548,8 +712,9 @@ bool Terrain::getIntersectionPoint(const Ray & ray_, Vec3 & intersectionPoint) c
     getWorldToNodeTransform().transformPoint(&(ray._origin));
 
     std::set<Chunk *> closeList;
-    Vec2 start = Vec2(ray._origin.x,ray._origin.z);
+    Vec2 start = Vec2(ray_._origin.x,ray_._origin.z);
     Vec2 dir = Vec2(ray._direction.x,ray._direction.z);
+    //convertToTerrainSpace takes world space positions
     start = convertToTerrainSpace(start);
     start.x /=(_terrainData._chunkSize.width+1);
     start.y /=(_terrainData._chunkSize.height+1);
@@ -587,6 +752,11 @@ bool Terrain::getIntersectionPoint(const Ray & ray_, Vec3 & intersectionPoint) c
                 }
             }
         }
+        //a vertical ray only crosses the chunks under its origin
+        if (delta.isZero())
+        {
+            break;
+        }
         if ((delta.x > 0 && start.x > width) || (delta.x <0 && start.x <0))
         {
             break;
@@ -611,7 +781,8 @@ cocos2d::Vec2 Terrain::convertToTerrainSpace(Vec2 worldSpaceXZ) const
     Vec2 pos(worldSpaceXZ.x,worldSpaceXZ.y);
 
     //top-left
-    Vec2 tl(-1*_terrainData._mapScale*_imageWidth/2,-1*_terrainData._mapScale*_imageHeight/2);
+    //the vertices start at the integer half size, see loadVertices
+    Vec2 tl(-1*_terrainData._mapScale*(_imageWidth/2),-1*_terrainData._mapScale*(_imageHeight/2));
     auto result  = getNodeToWorldTransform()*Vec4(tl.x,0.0f,tl.y,1.0f);
     tl.set(result.x, result.z);
 
@@ -646,6 +817,7 @@ void Terrain::resetHeightMap(const char * heightMap)
         }
     }
     delete _quadRoot;
+    _quadRoot = nullptr;
     initHeightMap(heightMap);
 }
 
@@ -715,80 +887,299 @@ void Terrain::setDetailMap(unsigned int index, DetailMap detailMap)
     delete textImage;
 }
 
-Terrain::ChunkIndices Terrain::lookForIndicesLOD(int neighborLod[4], int selfLod, bool * result)
+void Terrain::generateIndicesLOD(int selfLod, int neighborMask, std::vector<GLushort>& indices) const
 {
-    (* result) =false;
-    ChunkIndices tmp;
-    tmp._indices = 0;
-    tmp._size = 0;
-    if(_chunkLodIndicesSet.empty())
-    {
-        (* result) =false;
-        return tmp;
-    }else
+    int gridY = _chunkSize.height;
+    int gridX = _chunkSize.width;
+
+    int step = 1<<selfLod;
+    if(neighborMask)
+        //need update indices.
     {
-        int test[5];
-        memcpy(test,neighborLod,sizeof(int [4]));
-        test[4] = selfLod;
-        for(size_t i =0;i<_chunkLodIndicesSet.size();i++)
+        //t-junction inner 
+        indices.clear();
+        for(int i =step;i<gridY-step;i+=step)
+        {
+            for(int j = step;j<gridX-step;j+=step)
+            {  
+                int nLocIndex = i * (gridX+1) + j;
+                indices.push_back (nLocIndex);
+                indices.push_back (nLocIndex + step * (gridX+1));
+                indices.push_back (nLocIndex + step);
+
+                indices.push_back (nLocIndex + step);
+                indices.push_back (nLocIndex + step * (gridX+1));
+                indices.push_back (nLocIndex + step * (gridX+1) + step);
+            }
+        }
+        //fix T-crack
+        int next_step = 1<<(selfLod+1);
+        if(neighborMask & NEIGHBOR_LEFT)//left
         {
-            if(memcmp(test,_chunkLodIndicesSet[i]._relativeLod,sizeof(test))==0)
+            for(int i =0;i<gridY;i+=next_step)
             {
-                (*result) = true;
-                return _chunkLodIndicesSet[i]._chunkIndices;
+                indices.push_back(i*(gridX+1)+step);
+                indices.push_back(i*(gridX+1));
+                indices.push_back((i+next_step)*(gridX+1));
+
+                indices.push_back(i*(gridX+1)+step);
+                indices.push_back((i+next_step)*(gridX+1));
+                indices.push_back((i+step)*(gridX+1)+step);
+
+                indices.push_back((i+step)*(gridX+1)+step);
+                indices.push_back((i+next_step)*(gridX+1));
+                indices.push_back((i+next_step)*(gridX+1)+step);
+            }
+        }else{
+            int start=0;
+            int end =gridY;
+            if(neighborMask & NEIGHBOR_FRONT) end -=step;
+            if(neighborMask & NEIGHBOR_BACK) start +=step;
+            for(int i =start;i<end;i+=step)
+            {
+                indices.push_back(i*(gridX+1)+step);
+                indices.push_back(i*(gridX+1));
+                indices.push_back((i+step)*(gridX+1));
+
+                indices.push_back(i*(gridX+1)+step);
+                indices.push_back((i+step)*(gridX+1));
+                indices.push_back((i+step)*(gridX+1)+step);
+            }
+        }
+
+        if(neighborMask & NEIGHBOR_RIGHT)//LEFT
+        {
+            for(int i =0;i<gridY;i+=next_step)
+            {
+                indices.push_back(i*(gridX+1)+gridX);
+                indices.push_back(i*(gridX+1)+gridX-step);
+                indices.push_back((i+step)*(gridX+1)+gridX-step);
+
+                indices.push_back(i*(gridX+1)+gridX);
+                indices.push_back((i+step)*(gridX+1)+gridX-step);
+                indices.push_back((i+next_step)*(gridX+1)+gridX-step);
+
+                indices.push_back(i*(gridX+1)+gridX);
+                indices.push_back((i+next_step)*(gridX+1)+gridX-step);
+                indices.push_back((i+next_step)*(gridX+1)+gridX);
+            }
+        }else{
+            int start=0;
+            int end =gridY;
+            if(neighborMask & NEIGHBOR_FRONT) end -=step;
+            if(neighborMask & NEIGHBOR_BACK) start +=step;
+            for(int i =start;i<end;i+=step)
+            {
+                indices.push_back(i*(gridX+1)+gridX);
+                indices.push_back(i*(gridX+1)+gridX-step);
+                indices.push_back((i+step)*(gridX+1)+gridX-step);
+
+                indices.push_back(i*(gridX+1)+gridX);
+                indices.push_back((i+step)*(gridX+1)+gridX-step);
+                indices.push_back((i+step)*(gridX+1)+gridX);
+            }
+        }
+        if(neighborMask & NEIGHBOR_FRONT)//front
+        {
+            for(int i =0;i<gridX;i+=next_step)
+            {
+                indices.push_back((gridY-step)*(gridX+1)+i);
+                indices.push_back(gridY*(gridX+1)+i);
+                indices.push_back((gridY-step)*(gridX+1)+i+step);
+
+                indices.push_back((gridY-step)*(gridX+1)+i+step);
+                indices.push_back(gridY*(gridX+1)+i);
+                indices.push_back(gridY*(gridX+1)+i+next_step);
+
+                indices.push_back((gridY-step)*(gridX+1)+i+step);
+                indices.push_back(gridY*(gridX+1)+i+next_step);
+                indices.push_back((gridY-step)*(gridX+1)+i+next_step);
+            }
+        }else
+        {
+            for(int i =step;i<gridX-step;i+=step)
+            {
+                indices.push_back((gridY-step)*(gridX+1)+i);
+                indices.push_back(gridY*(gridX+1)+i);
+                indices.push_back((gridY-step)*(gridX+1)+i+step);
+
+                indices.push_back((gridY-step)*(gridX+1)+i+step);
+                indices.push_back(gridY*(gridX+1)+i);
+                indices.push_back(gridY*(gridX+1)+i+step);
+            }
+        }
+        if(neighborMask & NEIGHBOR_BACK)//back
+        {
+            for(int i =0;i<gridX;i+=next_step)
+            {
+                indices.push_back(i);
+                indices.push_back(step*(gridX+1) +i);
+                indices.push_back(step*(gridX+1) +i+step);
+
+                indices.push_back(i);
+                indices.push_back(step*(gridX+1) +i+step);
+                indices.push_back(i+next_step);
+
+                indices.push_back(i+next_step);
+                indices.push_back(step*(gridX+1) +i+step);
+                indices.push_back(step*(gridX+1) +i+next_step);
+            }
+        }else{
+            for(int i =step;i<gridX-step;i+=step)
+            {
+                indices.push_back(i);
+                indices.push_back(step*(gridX+1)+i);
+                indices.push_back(step*(gridX+1)+i+step);
+
+                indices.push_back(i);
+                indices.push_back(step*(gridX+1)+i+step);
+                indices.push_back(i+step);
+            }
+        }
+    }else{
+        //No lod difference, use simple method
+        indices.clear();
+        for(int i =0;i<gridY;i+=step)
+        {
+            for(int j = 0;j<gridX;j+=step)
+            { 
+
+                int nLocIndex = i * (gridX+1) + j; 
+                indices.push_back (nLocIndex);
+                indices.push_back (nLocIndex + step * (gridX+1));
+                indices.push_back (nLocIndex + step);
+
+                indices.push_back (nLocIndex + step);
+                indices.push_back (nLocIndex + step * (gridX+1));
+                indices.push_back (nLocIndex + step * (gridX+1) + step);
             }
         }
     }
-    (* result) =false;
-    return tmp;
 }
 
-Terrain::ChunkIndices Terrain::insertIndicesLOD(int neighborLod[4], int selfLod, GLushort * indices,int size)
+
+void Terrain::generateIndicesLODSkirt(int selfLod, std::vector<GLushort>& indices) const
 {
-    ChunkLODIndices lodIndices;
-    memcpy(lodIndices._relativeLod,neighborLod,sizeof(int [4]));
-    lodIndices._relativeLod[4] = selfLod;
-    lodIndices._chunkIndices._size = size;
-    glGenBuffers(1,&(lodIndices._chunkIndices._indices));
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lodIndices._chunkIndices._indices);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER,sizeof(GLushort)*size,indices,GL_STATIC_DRAW);
-    this->_chunkLodIndicesSet.push_back(lodIndices);
-    return lodIndices._chunkIndices;
+    int gridY = _chunkSize.height;
+    int gridX = _chunkSize.width;
+    int step = 1<<selfLod;
+    indices.clear();
+    int k =0;
+    for(int i =0;i<gridY;i+=step,k+=step)
+    {
+        for(int j = 0;j<gridX;j+=step)
+        {  
+            int nLocIndex = i * (gridX+1) + j;
+            indices.push_back (nLocIndex);
+            indices.push_back (nLocIndex + step * (gridX+1));
+            indices.push_back (nLocIndex + step);
+
+            indices.push_back (nLocIndex + step);
+            indices.push_back (nLocIndex + step * (gridX+1));
+            indices.push_back (nLocIndex + step * (gridX+1) + step);
+        }
+    }
+    //add skirt
+    //#1
+    for(int i =0;i<gridY;i+=step)
+    {
+        int nLocIndex = i * (gridX+1) + gridX;
+        indices.push_back (nLocIndex);
+        indices.push_back (nLocIndex + step * (gridX+1));
+        indices.push_back ((gridY+1) *(gridX+1)+i);
+
+        indices.push_back ((gridY+1) *(gridX+1)+i);
+        indices.push_back (nLocIndex + step * (gridX+1));
+        indices.push_back ((gridY+1) *(gridX+1)+i+step);
+    }
+
+    //#2
+    for(int j =0;j<gridX;j+=step)
+    {
+        int nLocIndex = (gridY)* (gridX+1) + j;
+        indices.push_back (nLocIndex);
+        indices.push_back (_skirtVerticesOffset[1] +j);
+        indices.push_back (nLocIndex + step);
+
+        indices.push_back (nLocIndex + step);
+        indices.push_back (_skirtVerticesOffset[1] +j);
+        indices.push_back (_skirtVerticesOffset[1] +j + step);
+    }
+
+    //#3
+    for(int i =0;i<gridY;i+=step)
+    {
+        int nLocIndex = i * (gridX+1);
+        indices.push_back (nLocIndex);
+        indices.push_back (_skirtVerticesOffset[2]+i);
+        indices.push_back ((i+step)*(gridX+1));
+
+        indices.push_back ((i+step)*(gridX+1));
+        indices.push_back (_skirtVerticesOffset[2]+i);
+        indices.push_back (_skirtVerticesOffset[2]+i +step);
+    }
+
+    //#4
+    for(int j =0;j<gridX;j+=step)
+    {
+        int nLocIndex = j;
+        indices.push_back (nLocIndex + step);
+        indices.push_back (_skirtVerticesOffset[3]+j); 
+        indices.push_back (nLocIndex);
+
+
+        indices.push_back (_skirtVerticesOffset[3] + j + step);
+        indices.push_back (_skirtVerticesOffset[3] +j);
+        indices.push_back (nLocIndex + step);
+    }
 }
 
-Terrain::ChunkIndices Terrain::lookForIndicesLODSkrit(int selfLod, bool * result)
+
+void Terrain::createIndicesLOD()
 {
-    ChunkIndices badResult;
-    badResult._indices = 0;
-    badResult._size = 0;
-    if(this->_chunkLodIndicesSkirtSet.empty())
+    auto upload = [](const std::vector<GLushort>& indices, ChunkIndices& chunkIndices)
     {
-    (*result) = false;
-    return badResult;
-    }
+        chunkIndices._size = (unsigned short)indices.size();
+        glGenBuffers(1,&(chunkIndices._indices));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunkIndices._indices);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER,sizeof(GLushort)*indices.size(),indices.empty() ? nullptr : &indices[0],GL_STATIC_DRAW);
+    };
 
-    for(size_t i =0;i<_chunkLodIndicesSkirtSet.size();i++)
+    std::vector<GLushort> indices;
+    for(int lod =0;lod<4;lod++)
     {
-        if(_chunkLodIndicesSkirtSet[i]._selfLod == selfLod)
+        if(_crackFixedType == CrackFixedType::SKIRT)
         {
-            (*result) = true;
-            return _chunkLodIndicesSkirtSet[i]._chunkIndices;
+            generateIndicesLODSkirt(lod, indices);
+            upload(indices, _chunkLodIndicesSkirt[lod]);
+        }else
+        {
+            //no neighbor has a higher LOD than the last one
+            int maskCount = lod < 3 ? NEIGHBOR_MASK_COUNT : 1;
+            for(int mask =0;mask<maskCount;mask++)
+            {
+                generateIndicesLOD(lod, mask, indices);
+                upload(indices, _chunkLodIndices[lod][mask]);
+            }
         }
     }
-    (*result) = false;
-    return badResult;
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
-Terrain::ChunkIndices Terrain::insertIndicesLODSkirt(int selfLod, GLushort * indices, int size)
+void Terrain::deleteIndicesLOD()
 {
-    ChunkLODIndicesSkirt skirtIndices;
-    skirtIndices._selfLod = selfLod;
-    skirtIndices._chunkIndices._size = size;
-    glGenBuffers(1,&(skirtIndices._chunkIndices._indices));
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, skirtIndices._chunkIndices._indices);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER,sizeof(GLushort)*size,indices,GL_STATIC_DRAW);
-    this->_chunkLodIndicesSkirtSet.push_back(skirtIndices);
-    return skirtIndices._chunkIndices;
+    for(int lod =0;lod<4;lod++)
+    {
+        for(int mask =0;mask<NEIGHBOR_MASK_COUNT;mask++)
+        {
+            if(_chunkLodIndices[lod][mask]._indices)
+                glDeleteBuffers(1,&(_chunkLodIndices[lod][mask]._indices));
+        }
+        if(_chunkLodIndicesSkirt[lod]._indices)
+            glDeleteBuffers(1,&(_chunkLodIndicesSkirt[lod]._indices));
+    }
+    memset(_chunkLodIndices, 0, sizeof(_chunkLodIndices));
+    memset(_chunkLodIndicesSkirt, 0, sizeof(_chunkLodIndicesSkirt));
 }
 
 void Terrain::setSkirtHeightRatio(float ratio)
@@ -847,6 +1238,40 @@ void Terrain::cacheUniformAttribLocation()
     _lightDirLocation = glGetUniformLocation(glProgram->getProgram(),"u_lightDir");
 }
 
+// returns the image decoded by createAsync if there is one, otherwise loads it
+static Image* takeTextureImage(Image*& preloaded, const std::string& path)
+{
+    Image* image = preloaded;
+    preloaded = nullptr;
+    if(!image)
+    {
+        image = new (std::nothrow)Image();
+        image->initWithImageFile(path);
+    }
+    return image;
+}
+
+void Terrain::preloadTextureImages()
+{
+    auto load = [](const std::string& path)
+    {
+        auto image = new (std::nothrow)Image();
+        image->initWithImageFile(path);
+        return image;
+    };
+    if(!_terrainData._alphaMapSrc)
+    {
+        _asyncLoadParam.detailMapImages[0] = load(_terrainData._detailMaps[0]._detailMapSrc);
+    }else
+    {
+        _asyncLoadParam.alphaMapImage = load(_terrainData._alphaMapSrc);
+        for(int i =0;i<_terrainData._detailMapAmount;i++)
+        {
+            _asyncLoadParam.detailMapImages[i] = load(_terrainData._detailMaps[i]._detailMapSrc);
+        }
+    }
+}
+
 bool Terrain::initTextures()
 {
     for (int i = 0; i < 4; i++)
@@ -859,8 +1284,7 @@ bool Terrain::initTextures()
     texParam.wrapT = GL_REPEAT;
     if(!_terrainData._alphaMapSrc)
     {
-        auto textImage = new (std::nothrow)Image();
-        textImage->initWithImageFile(_terrainData._detailMaps[0]._detailMapSrc);
+        auto textImage = takeTextureImage(_asyncLoadParam.detailMapImages[0], _terrainData._detailMaps[0]._detailMapSrc);
         auto texture = new (std::nothrow)Texture2D();
         texture->initWithImage(textImage);
         texture->generateMipmap();
@@ -872,8 +1296,7 @@ bool Terrain::initTextures()
     }else
     {
         //alpha map
-        auto image = new (std::nothrow)Image(); 
-        image->initWithImageFile(_terrainData._alphaMapSrc);
+        auto image = takeTextureImage(_asyncLoadParam.alphaMapImage, _terrainData._alphaMapSrc);
         _alphaMap = new (std::nothrow)Texture2D();
         _alphaMap->initWithImage(image);
         texParam.wrapS = GL_CLAMP_TO_EDGE;
@@ -885,8 +1308,7 @@ bool Terrain::initTextures()
 
         for(int i =0;i<_terrainData._detailMapAmount;i++)
         {
-            auto textImage = new (std::nothrow)Image();
-            textImage->initWithImageFile(_terrainData._detailMaps[i]._detailMapSrc);
+            auto textImage = takeTextureImage(_asyncLoadParam.detailMapImages[i], _terrainData._detailMaps[i]._detailMapSrc);
             auto texture = new (std::nothrow)Texture2D();
             texture->initWithImage(textImage);
             delete textImage;
@@ -918,8 +1340,11 @@ void Terrain::reload()
     }
 
     initTextures();
-    _chunkLodIndicesSet.clear();
-    _chunkLodIndicesSkirtSet.clear();
+    //the buffers were lost with the context
+    memset(_chunkLodIndices, 0, sizeof(_chunkLodIndices));
+    memset(_chunkLodIndicesSkirt, 0, sizeof(_chunkLodIndicesSkirt));
+    createIndicesLOD();
+    _isCameraViewChanged = true;
 }
 
 void Terrain::Chunk::finish()
@@ -934,37 +1359,18 @@ void Terrain::Chunk::finish()
 
     glBindBuffer(GL_ARRAY_BUFFER,0);
 
-    calculateSlope();
-
-    for(int i =0;i<4;i++)
-    {
-        int step = 1<<_currentLod;
-        //reserve the indices size, the first part is the core part of the chunk, the second part & thid part is for fix crack 
-        int indicesAmount =(_terrain->_chunkSize.width/step+1)*(_terrain->_chunkSize.height/step+1)*6+(_terrain->_chunkSize.height/step)*6
-            +(_terrain->_chunkSize.width/step)*6;
-        _lod[i]._indices.reserve(indicesAmount);
-    }
     _oldLod = -1;
+    _verticesDirty = false;
 }
 
 void Terrain::Chunk::bindAndDraw()
 {
     glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-    if(_terrain->_isCameraViewChanged || _oldLod <0)
+    //the LOD is selected by Terrain::setChunksLOD, only the upload is left
+    if(_verticesDirty)
     {
-        switch (_terrain->_crackFixedType)
-        {
-        case CrackFixedType::SKIRT:
-
-            updateIndicesLODSkirt();
-            break;
-        case CrackFixedType::INCREASE_LOWER:
-            updateVerticesForLOD();
-            updateIndicesLOD();
-            break;
-        default:
-            break;
-        }
+        glBufferData(GL_ARRAY_BUFFER, sizeof(TerrainVertexData)*_currentVertices.size(), &_currentVertices[0], GL_STREAM_DRAW);
+        _verticesDirty = false;
     }
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,_chunkIndices._indices);
     unsigned long offset = 0;
@@ -1069,7 +1475,24 @@ void Terrain::Chunk::generate(int imgWidth, int imageHei, int m, int n, const un
     }
 
     calculateAABB();
-    finish();
+    calculateSlope();
+}
+
+void Terrain::Chunk::updateLOD()
+{
+    switch (_terrain->_crackFixedType)
+    {
+    case CrackFixedType::SKIRT:
+        updateIndicesLODSkirt();
+        break;
+    case CrackFixedType::INCREASE_LOWER:
+        updateVerticesForLOD();
+        updateIndicesLOD();
+        break;
+    default:
+        break;
+    }
+    _oldLod = _currentLod;
 }
 
 Terrain::Chunk::Chunk()
@@ -1080,214 +1503,20 @@ Terrain::Chunk::Chunk()
     _back = nullptr;
     _front = nullptr;
     _oldLod = -1;
-    for(int i =0;i<4;i++)
-    {
-        _neighborOldLOD[i] = -1;
-    }
+    _verticesDirty = false;
+    _vbo = 0;
+    _chunkIndices._indices = 0;
+    _chunkIndices._size = 0;
 }
 
 void Terrain::Chunk::updateIndicesLOD()
 {
-    int currentNeighborLOD[4];
-    if(_left)
-    {
-        currentNeighborLOD[0] = _left->_currentLod;
-    }else{currentNeighborLOD[0] = -1;}
-    if(_right)
-    {
-        currentNeighborLOD[1] = _right->_currentLod;
-    }else{currentNeighborLOD[1] = -1;}
-    if(_back)
-    {
-        currentNeighborLOD[2] = _back->_currentLod;
-    }else{currentNeighborLOD[2] = -1;}
-    if(_front)
-    {
-        currentNeighborLOD[3] = _front->_currentLod;
-    }else{currentNeighborLOD[3] = -1;}
-
-    if(_oldLod == _currentLod &&(memcmp(currentNeighborLOD,_neighborOldLOD,sizeof(currentNeighborLOD))==0) )
-    {
-        return;// no need to update
-    }
-    bool isOk;
-    _chunkIndices = _terrain->lookForIndicesLOD(currentNeighborLOD,_currentLod,&isOk);
-    if(isOk)
-    {
-        return;
-    }
-    memcpy(_neighborOldLOD,currentNeighborLOD,sizeof(currentNeighborLOD)); 
-    _oldLod = _currentLod;
-    int gridY = _size.height;
-    int gridX = _size.width;
-
-    int step = 1<<_currentLod;
-    if((_left&&_left->_currentLod > _currentLod) ||(_right&&_right->_currentLod > _currentLod)
-        ||(_back&&_back->_currentLod > _currentLod) || (_front && _front->_currentLod > _currentLod))
-        //need update indices.
-    {
-        //t-junction inner 
-        _lod[_currentLod]._indices.clear();
-        for(int i =step;i<gridY-step;i+=step)
-        {
-            for(int j = step;j<gridX-step;j+=step)
-            {  
-                int nLocIndex = i * (gridX+1) + j;
-                _lod[_currentLod]._indices.push_back (nLocIndex);
-                _lod[_currentLod]._indices.push_back (nLocIndex + step * (gridX+1));
-                _lod[_currentLod]._indices.push_back (nLocIndex + step);
-
-                _lod[_currentLod]._indices.push_back (nLocIndex + step);
-                _lod[_currentLod]._indices.push_back (nLocIndex + step * (gridX+1));
-                _lod[_currentLod]._indices.push_back (nLocIndex + step * (gridX+1) + step);
-            }
-        }
-        //fix T-crack
-        int next_step = 1<<(_currentLod+1);
-        if(_left&&_left->_currentLod > _currentLod)//left
-        {
-            for(int i =0;i<gridY;i+=next_step)
-            {
-                _lod[_currentLod]._indices.push_back(i*(gridX+1)+step);
-                _lod[_currentLod]._indices.push_back(i*(gridX+1));
-                _lod[_currentLod]._indices.push_back((i+next_step)*(gridX+1));
-
-                _lod[_currentLod]._indices.push_back(i*(gridX+1)+step);
-                _lod[_currentLod]._indices.push_back((i+next_step)*(gridX+1));
-                _lod[_currentLod]._indices.push_back((i+step)*(gridX+1)+step);
-
-                _lod[_currentLod]._indices.push_back((i+step)*(gridX+1)+step);
-                _lod[_currentLod]._indices.push_back((i+next_step)*(gridX+1));
-                _lod[_currentLod]._indices.push_back((i+next_step)*(gridX+1)+step);
-            }
-        }else{
-            int start=0;
-            int end =gridY;
-            if(_front&&_front->_currentLod > _currentLod) end -=step;
-            if(_back&&_back->_currentLod > _currentLod) start +=step;
-            for(int i =start;i<end;i+=step)
-            {
-                _lod[_currentLod]._indices.push_back(i*(gridX+1)+step);
-                _lod[_currentLod]._indices.push_back(i*(gridX+1));
-                _lod[_currentLod]._indices.push_back((i+step)*(gridX+1));
-
-                _lod[_currentLod]._indices.push_back(i*(gridX+1)+step);
-                _lod[_currentLod]._indices.push_back((i+step)*(gridX+1));
-                _lod[_currentLod]._indices.push_back((i+step)*(gridX+1)+step);
-            }
-        }
-
-        if(_right&&_right->_currentLod > _currentLod)//LEFT
-        {
-            for(int i =0;i<gridY;i+=next_step)
-            {
-                _lod[_currentLod]._indices.push_back(i*(gridX+1)+gridX);
-                _lod[_currentLod]._indices.push_back(i*(gridX+1)+gridX-step);
-                _lod[_currentLod]._indices.push_back((i+step)*(gridX+1)+gridX-step);
-
-                _lod[_currentLod]._indices.push_back(i*(gridX+1)+gridX);
-                _lod[_currentLod]._indices.push_back((i+step)*(gridX+1)+gridX-step);
-                _lod[_currentLod]._indices.push_back((i+next_step)*(gridX+1)+gridX-step);
-
-                _lod[_currentLod]._indices.push_back(i*(gridX+1)+gridX);
-                _lod[_currentLod]._indices.push_back((i+next_step)*(gridX+1)+gridX-step);
-                _lod[_currentLod]._indices.push_back((i+next_step)*(gridX+1)+gridX);
-            }
-        }else{
-            int start=0;
-            int end =gridY;
-            if(_front&&_front->_currentLod > _currentLod) end -=step;
-            if(_back&&_back->_currentLod > _currentLod) start +=step;
-            for(int i =start;i<end;i+=step)
-            {
-                _lod[_currentLod]._indices.push_back(i*(gridX+1)+gridX);
-                _lod[_currentLod]._indices.push_back(i*(gridX+1)+gridX-step);
-                _lod[_currentLod]._indices.push_back((i+step)*(gridX+1)+gridX-step);
-
-                _lod[_currentLod]._indices.push_back(i*(gridX+1)+gridX);
-                _lod[_currentLod]._indices.push_back((i+step)*(gridX+1)+gridX-step);
-                _lod[_currentLod]._indices.push_back((i+step)*(gridX+1)+gridX);
-            }
-        }
-        if(_front&&_front->_currentLod > _currentLod)//front
-        {
-            for(int i =0;i<gridX;i+=next_step)
-            {
-                _lod[_currentLod]._indices.push_back((gridY-step)*(gridX+1)+i);
-                _lod[_currentLod]._indices.push_back(gridY*(gridX+1)+i);
-                _lod[_currentLod]._indices.push_back((gridY-step)*(gridX+1)+i+step);
-
-                _lod[_currentLod]._indices.push_back((gridY-step)*(gridX+1)+i+step);
-                _lod[_currentLod]._indices.push_back(gridY*(gridX+1)+i);
-                _lod[_currentLod]._indices.push_back(gridY*(gridX+1)+i+next_step);
-
-                _lod[_currentLod]._indices.push_back((gridY-step)*(gridX+1)+i+step);
-                _lod[_currentLod]._indices.push_back(gridY*(gridX+1)+i+next_step);
-                _lod[_currentLod]._indices.push_back((gridY-step)*(gridX+1)+i+next_step);
-            }
-        }else
-        {
-            for(int i =step;i<gridX-step;i+=step)
-            {
-                _lod[_currentLod]._indices.push_back((gridY-step)*(gridX+1)+i);
-                _lod[_currentLod]._indices.push_back(gridY*(gridX+1)+i);
-                _lod[_currentLod]._indices.push_back((gridY-step)*(gridX+1)+i+step);
-
-                _lod[_currentLod]._indices.push_back((gridY-step)*(gridX+1)+i+step);
-                _lod[_currentLod]._indices.push_back(gridY*(gridX+1)+i);
-                _lod[_currentLod]._indices.push_back(gridY*(gridX+1)+i+step);
-            }
-        }
-        if(_back&&_back->_currentLod > _currentLod)//back
-        {
-            for(int i =0;i<gridX;i+=next_step)
-            {
-                _lod[_currentLod]._indices.push_back(i);
-                _lod[_currentLod]._indices.push_back(step*(gridX+1) +i);
-                _lod[_currentLod]._indices.push_back(step*(gridX+1) +i+step);
-
-                _lod[_currentLod]._indices.push_back(i);
-                _lod[_currentLod]._indices.push_back(step*(gridX+1) +i+step);
-                _lod[_currentLod]._indices.push_back(i+next_step);
-
-                _lod[_currentLod]._indices.push_back(i+next_step);
-                _lod[_currentLod]._indices.push_back(step*(gridX+1) +i+step);
-                _lod[_currentLod]._indices.push_back(step*(gridX+1) +i+next_step);
-            }
-        }else{
-            for(int i =step;i<gridX-step;i+=step)
-            {
-                _lod[_currentLod]._indices.push_back(i);
-                _lod[_currentLod]._indices.push_back(step*(gridX+1)+i);
-                _lod[_currentLod]._indices.push_back(step*(gridX+1)+i+step);
-
-                _lod[_currentLod]._indices.push_back(i);
-                _lod[_currentLod]._indices.push_back(step*(gridX+1)+i+step);
-                _lod[_currentLod]._indices.push_back(i+step);
-            }
-        }
-
-        _chunkIndices = _terrain->insertIndicesLOD(currentNeighborLOD,_currentLod,&_lod[_currentLod]._indices[0],(int)_lod[_currentLod]._indices.size());
-    }else{
-        //No lod difference, use simple method
-        _lod[_currentLod]._indices.clear();
-        for(int i =0;i<gridY;i+=step)
-        {
-            for(int j = 0;j<gridX;j+=step)
-            { 
-
-                int nLocIndex = i * (gridX+1) + j; 
-                _lod[_currentLod]._indices.push_back (nLocIndex);
-                _lod[_currentLod]._indices.push_back (nLocIndex + step * (gridX+1));
-                _lod[_currentLod]._indices.push_back (nLocIndex + step);
-
-                _lod[_currentLod]._indices.push_back (nLocIndex + step);
-                _lod[_currentLod]._indices.push_back (nLocIndex + step * (gridX+1));
-                _lod[_currentLod]._indices.push_back (nLocIndex + step * (gridX+1) + step);
-            }
-        }
-        _chunkIndices = _terrain->insertIndicesLOD(currentNeighborLOD,_currentLod,&_lod[_currentLod]._indices[0],(int)_lod[_currentLod]._indices.size());
-    }
+    int neighborMask = 0;
+    if(_left && _left->_currentLod > _currentLod) neighborMask |= NEIGHBOR_LEFT;
+    if(_right && _right->_currentLod > _currentLod) neighborMask |= NEIGHBOR_RIGHT;
+    if(_back && _back->_currentLod > _currentLod) neighborMask |= NEIGHBOR_BACK;
+    if(_front && _front->_currentLod > _currentLod) neighborMask |= NEIGHBOR_FRONT;
+    _chunkIndices = _terrain->_chunkLodIndices[_currentLod][neighborMask];
 }
 
 void Terrain::Chunk::calculateAABB()
@@ -1379,8 +1608,7 @@ void Terrain::Chunk::updateVerticesForLOD()
             }
     }
 
-    glBufferData(GL_ARRAY_BUFFER, sizeof(TerrainVertexData)*_currentVertices.size(), &_currentVertices[0], GL_STREAM_DRAW);
-
+    _verticesDirty = true;
 }
 
 Terrain::Chunk::~Chunk()
@@ -1390,85 +1618,7 @@ Terrain::Chunk::~Chunk()
 
 void Terrain::Chunk::updateIndicesLODSkirt()
 {
-    if(_oldLod == _currentLod) return;
-    _oldLod = _currentLod;
-    bool isOk;
-    _chunkIndices =  _terrain->lookForIndicesLODSkrit(_currentLod,&isOk);
-    if(isOk) return;
-
-    int gridY = _size.height;
-    int gridX = _size.width;
-    int step = 1<<_currentLod;
-    int k =0;
-    for(int i =0;i<gridY;i+=step,k+=step)
-    {
-        for(int j = 0;j<gridX;j+=step)
-        {  
-            int nLocIndex = i * (gridX+1) + j;
-            _lod[_currentLod]._indices.push_back (nLocIndex);
-            _lod[_currentLod]._indices.push_back (nLocIndex + step * (gridX+1));
-            _lod[_currentLod]._indices.push_back (nLocIndex + step);
-
-            _lod[_currentLod]._indices.push_back (nLocIndex + step);
-            _lod[_currentLod]._indices.push_back (nLocIndex + step * (gridX+1));
-            _lod[_currentLod]._indices.push_back (nLocIndex + step * (gridX+1) + step);
-        }
-    }
-    //add skirt
-    //#1
-    for(int i =0;i<gridY;i+=step)
-    {
-        int nLocIndex = i * (gridX+1) + gridX;
-        _lod[_currentLod]._indices.push_back (nLocIndex);
-        _lod[_currentLod]._indices.push_back (nLocIndex + step * (gridX+1));
-        _lod[_currentLod]._indices.push_back ((gridY+1) *(gridX+1)+i);
-
-        _lod[_currentLod]._indices.push_back ((gridY+1) *(gridX+1)+i);
-        _lod[_currentLod]._indices.push_back (nLocIndex + step * (gridX+1));
-        _lod[_currentLod]._indices.push_back ((gridY+1) *(gridX+1)+i+step);
-    }
-
-    //#2
-    for(int j =0;j<gridX;j+=step)
-    {
-        int nLocIndex = (gridY)* (gridX+1) + j;
-        _lod[_currentLod]._indices.push_back (nLocIndex);
-        _lod[_currentLod]._indices.push_back (_terrain->_skirtVerticesOffset[1] +j);
-        _lod[_currentLod]._indices.push_back (nLocIndex + step);
-
-        _lod[_currentLod]._indices.push_back (nLocIndex + step);
-        _lod[_currentLod]._indices.push_back (_terrain->_skirtVerticesOffset[1] +j);
-        _lod[_currentLod]._indices.push_back (_terrain->_skirtVerticesOffset[1] +j + step);
-    }
-
-    //#3
-    for(int i =0;i<gridY;i+=step)
-    {
-        int nLocIndex = i * (gridX+1);
-        _lod[_currentLod]._indices.push_back (nLocIndex);
-        _lod[_currentLod]._indices.push_back (_terrain->_skirtVerticesOffset[2]+i);
-        _lod[_currentLod]._indices.push_back ((i+step)*(gridX+1));
-
-        _lod[_currentLod]._indices.push_back ((i+step)*(gridX+1));
-        _lod[_currentLod]._indices.push_back (_terrain->_skirtVerticesOffset[2]+i);
-        _lod[_currentLod]._indices.push_back (_terrain->_skirtVerticesOffset[2]+i +step);
-    }
-
-    //#4
-    for(int j =0;j<gridX;j+=step)
-    {
-        int nLocIndex = j;
-        _lod[_currentLod]._indices.push_back (nLocIndex + step);
-        _lod[_currentLod]._indices.push_back (_terrain->_skirtVerticesOffset[3]+j); 
-        _lod[_currentLod]._indices.push_back (nLocIndex);
-
-
-        _lod[_currentLod]._indices.push_back (_terrain->_skirtVerticesOffset[3] + j + step);
-        _lod[_currentLod]._indices.push_back (_terrain->_skirtVerticesOffset[3] +j);
-        _lod[_currentLod]._indices.push_back (nLocIndex + step);
-    }
-
-    _chunkIndices = _terrain->insertIndicesLODSkirt(_currentLod,&_lod[_currentLod]._indices[0], (int)_lod[_currentLod]._indices.size());
+    _chunkIndices = _terrain->_chunkLodIndicesSkirt[_currentLod];
 }
 
 Terrain::QuadTree::QuadTree(int x, int y, int w, int h, Terrain * terrain)
@@ -25,6 +25,7 @@ THE SOFTWARE.
 #define CC_TERRAIN_H
 
 #include <vector>
+#include <functional>
 
 #include "2d/CCNode.h"
 #include "2d/CCCamera.h"
@@ -80,6 +81,8 @@ NS_CC_BEGIN
     * Finally, when LOD is enabled, cracks can begin to appear between terrain Chunks of
     * different LOD levels. An acceptable solution might be to simply reduce the lower LOD(high detail,smooth) chunks border,
     * And let the higher LOD(rough) chunks to seamlessly connect it.
+    * The index buffers of every LOD and combination of rougher neighbors are generated once and shared by the chunks,
+    * and the LOD of the chunks is selected on the JobPool threads when the camera moves.
     * 
     * We can use ray-terrain intersection to pick a point of the terrain;
     * Also we can get an arbitrary point of the terrain's height and normal vector for convenience .
@@ -162,17 +165,14 @@ private:
         unsigned short _size;
     };
 
-    struct ChunkLODIndices
+    /**the bits of the neighbors with a higher LOD in the index permutations*/
+    enum
     {
-        int _relativeLod[5];
-        ChunkIndices _chunkIndices;
-    };
-
-
-    struct ChunkLODIndicesSkirt
-    {
-        int _selfLod;
-        ChunkIndices _chunkIndices;
+        NEIGHBOR_LEFT = 1,
+        NEIGHBOR_RIGHT = 2,
+        NEIGHBOR_BACK = 4,
+        NEIGHBOR_FRONT = 8,
+        NEIGHBOR_MASK_COUNT = 16,
     };
     /*
     *terrain vertices internal data format
@@ -204,14 +204,9 @@ private:
         ~Chunk();
         /*vertices*/
         std::vector<TerrainVertexData> _originalVertices;
-        /*LOD indices*/
-        struct LOD{
-            std::vector<GLushort> _indices;
-        };
         GLuint _vbo;
+        /**shared indices of the current LOD, owned by the terrain*/
         ChunkIndices _chunkIndices; 
-        /**we now support four levels of detail*/
-        LOD _lod[4];
         /**AABB in local space*/
         AABB _aabb;
         /**setup Chunk data*/
@@ -222,6 +217,8 @@ private:
         void bindAndDraw();
         /**finish opengl setup*/
         void finish();
+        /**select the vertices and indices of the current LOD, it doesn't use OpenGL so it runs on worker threads*/
+        void updateLOD();
         /*use linear-sample vertices for LOD mesh*/
         void updateVerticesForLOD();
         /*updateIndices */
@@ -239,7 +236,8 @@ private:
 
         int _oldLod;
 
-        int _neighborOldLOD[4];
+        /**_currentVertices changed and must be uploaded*/
+        bool _verticesDirty;
         /*the left,right,front,back neighbors*/
         Chunk * _left;
         Chunk * _right;
@@ -321,6 +319,16 @@ public:
     bool initTextures();
     /**create entry*/
     static Terrain * create(TerrainData &parameter, CrackFixedType fixedType = CrackFixedType::INCREASE_LOWER);
+    /**
+     * create a terrain asynchronously, the height map, the vertices, the normals and the chunks are
+     * generated by a thread of AsyncTaskPool, then the textures and the buffers are created in the main thread,
+     * the vertex buffers of the chunks over several frames by MeshUploadQueue.
+     * @param parameter The terrain data, copied.
+     * @param fixedType The crack fix type.
+     * @param callback Called in the main thread with the terrain, autoreleased, or nullptr if it failed.
+     * @param callbackparam The parameter of the callback.
+     */
+    static void createAsync(const TerrainData &parameter, CrackFixedType fixedType, const std::function<void(Terrain*, void*)>& callback, void* callbackparam);
     /**get specified position's height mapping to the terrain,use bi-linear interpolation method
      * @param x the X position
      * @param y the Z position
@@ -444,6 +452,29 @@ protected:
      **/
     void setChunksLOD(Vec3 cameraPos);
 
+    /**
+     * load the height map and generate the vertices, the normals and the chunks, it doesn't use OpenGL.
+     **/
+    bool loadHeightMap(const char* heightMap);
+
+    /**
+     * create the buffers of the chunks and the quad tree once the height map is loaded.
+     **/
+    void finishHeightMap();
+
+    /**create the shared index buffers and the quad tree of the loaded chunks*/
+    void initQuadTree();
+
+    /**create the vertex buffers of the next chunks, at least one, up to budget bytes. returns the bytes uploaded*/
+    ssize_t finishChunks(ssize_t budget);
+
+    void afterAsyncLoad(void* param);
+
+    /**decode the images of the alpha map and the detail maps for initTextures()*/
+    void preloadTextureImages();
+
+    void setTerrainData(const TerrainData &parameter);
+
     /**
      * load Vertices from height filed for the whole terrain.
      **/
@@ -463,22 +494,41 @@ protected:
     void cacheUniformAttribLocation();
 
     //IBO generate & cache
-    ChunkIndices lookForIndicesLODSkrit(int selfLod, bool * result);
+    void generateIndicesLOD(int selfLod, int neighborMask, std::vector<GLushort>& indices) const;
 
-    ChunkIndices lookForIndicesLOD(int neighborLod[4], int selfLod, bool * result);
+    void generateIndicesLODSkirt(int selfLod, std::vector<GLushort>& indices) const;
 
-    ChunkIndices insertIndicesLOD(int neighborLod[4], int selfLod, GLushort * indices, int size);
+    /**create the shared index buffers of all the LOD permutations*/
+    void createIndicesLOD();
 
-    ChunkIndices insertIndicesLODSkirt(int selfLod, GLushort * indices, int size);
+    void deleteIndicesLOD();
+
+    /**
+     * pass 0 selects the LOD of a row of chunks from the distance to the camera, pass 1 updates their vertices and indices.
+     **/
+    void updateLODRow(int pass, int row, const Vec3& cameraPos);
     
     Chunk * getChunkByIndex(int x,int y) const;
 
 protected:
-    std::vector <ChunkLODIndices> _chunkLodIndicesSet;
-    std::vector<ChunkLODIndicesSkirt> _chunkLodIndicesSkirtSet;
+    struct AsyncLoadParam
+    {
+        std::function<void(Terrain*, void*)> afterLoadCallback;
+        void* callbackParam;
+        bool result;
+        // decoded by the loading thread, taken by initTextures()
+        Image* alphaMapImage;
+        Image* detailMapImages[4];
+    };
+
+    // per LOD and mask of the neighbors with a higher LOD, for INCREASE_LOWER
+    ChunkIndices _chunkLodIndices[4][NEIGHBOR_MASK_COUNT];
+    // per LOD, for SKIRT
+    ChunkIndices _chunkLodIndicesSkirt[4];
     Mat4 _CameraMatrix;
     bool _isCameraViewChanged;
     TerrainData _terrainData;
+    std::string _alphaMapPath; // owns _terrainData._alphaMapSrc
     bool _isDrawWire;
     unsigned char * _data;
     float _lodDistance[3];
@@ -515,6 +565,9 @@ protected:
     GLint _detailMapSizeLocation[4];
     GLint _lightDirLocation;
     RenderState::StateBlock* _stateBlock;
+    AsyncLoadParam _asyncLoadParam;
+    // chunks whose vertex buffer is created, in row order
+    int _finishedChunks;
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
     EventListenerCustom* _backToForegroundListener;
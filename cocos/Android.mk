@@ -70,6 +70,7 @@ cocos2d.cpp \
 2d/CCParticleExamples.cpp \
 2d/CCParticleSystem.cpp \
 2d/CCParticleSystemQuad.cpp \
+2d/CCParticleSystemManager.cpp \
 2d/CCProgressTimer.cpp \
 2d/CCProtectedNode.cpp \
 2d/CCRenderTexture.cpp \
@@ -94,6 +95,7 @@ cocos2d.cpp \
 platform/CCFileUtils.cpp \
 platform/CCGLView.cpp \
 platform/CCImage.cpp \
+platform/CCMappedFile.cpp \
 platform/CCSAXParser.cpp \
 platform/CCThread.cpp \
 $(MATHNEONFILE) \
@@ -114,6 +116,7 @@ base/CCConsole.cpp \
 base/CCController-android.cpp \
 base/CCController.cpp \
 base/CCData.cpp \
+base/CCJobPool.cpp \
 base/CCDataVisitor.cpp \
 base/CCDirector.cpp \
 base/CCEvent.cpp \
@@ -181,6 +184,7 @@ renderer/CCTechnique.cpp \
 renderer/CCTexture2D.cpp \
 renderer/CCTextureAtlas.cpp \
 renderer/CCTextureCache.cpp \
+renderer/CCDynamicAtlas.cpp \
 renderer/CCTextureCube.cpp \
 renderer/CCTrianglesCommand.cpp \
 renderer/CCVertexAttribBinding.cpp \
@@ -184,6 +184,14 @@ static void printFileUtils(int fd)
     for( const auto &item : cache) {
         mydprintf(fd, "%s -> %s\n", item.first.c_str(), item.second.c_str());
     }
+
+    mydprintf(fd, "\nPath Index:\n");
+    mydprintf(fd, "%ld files\n", (long)fu->getPathIndexCount());
+
+    auto& stats = fu->getPathLookupStats();
+    mydprintf(fd, "\nPath Lookups:\n");
+    mydprintf(fd, "cache hits: %u, cache misses: %u, index lookups: %u, file system lookups: %u\n",
+              stats.cacheHits.load(), stats.cacheMisses.load(), stats.indexLookups.load(), stats.fileSystemLookups.load());
     sendPrompt(fd);
 }
 
@@ -334,7 +342,7 @@ Console::Console()
             }
         } },
         { "exit", "Close connection to the console", std::bind(&Console::commandExit, this, std::placeholders::_1, std::placeholders::_2) },
-        { "fileutils", "Flush or print the FileUtils info. Args: [flush | ] ", std::bind(&Console::commandFileUtils, this, std::placeholders::_1, std::placeholders::_2) },
+        { "fileutils", "Flush, reset the lookup counters of, or print the FileUtils info. Args: [flush | reset | ] ", std::bind(&Console::commandFileUtils, this, std::placeholders::_1, std::placeholders::_2) },
         { "fps", "Turn on / off the FPS. Args: [on | off] ", [](int fd, const std::string& args) {
             if( args.compare("on")==0 || args.compare("off")==0) {
                 bool state = (args.compare("on") == 0);
@@ -533,13 +541,17 @@ void Console::commandFileUtils(int fd, const std::string &args)
     {
         FileUtils::getInstance()->purgeCachedEntries();
     }
+    else if( args.compare("reset") == 0 )
+    {
+        FileUtils::getInstance()->resetPathLookupStats();
+    }
     else if( args.length()==0)
     {
         sched->performFunctionInCocosThread( std::bind(&printFileUtils, fd) );
     }
     else
     {
-        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'flush' or nothing", args.c_str());
+        mydprintf(fd, "Unsupported argument: '%s'. Supported arguments: 'flush', 'reset' or nothing", args.c_str());
     }
 }
 
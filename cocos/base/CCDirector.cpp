@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "2d/CCDrawingPrimitives.h"
 #include "2d/CCSpriteFrameCache.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCImage.h"
 
 #include "2d/CCActionManager.h"
 #include "2d/CCFontFNT.h"
@@ -42,6 +43,11 @@ THE SOFTWARE.
 #include "2d/CCTransition.h"
 #include "2d/CCFontFreeType.h"
 #include "2d/CCLabelAtlas.h"
+#include "2d/CCParticleSystemManager.h"
+#include "2d/CCAutoPolygon.h"
+#include "3d/CCSkeleton3DManager.h"
+#include "3d/CCMeshUploadQueue.h"
+#include "3d/CCSkeleton3D.h"
 #include "renderer/CCGLProgramCache.h"
 #include "renderer/CCGLProgramStateCache.h"
 #include "renderer/CCTextureCache.h"
@@ -60,6 +66,7 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobPool.h"
 #include "platform/CCApplication.h"
 //#include "platform/CCGLViewImpl.h"
 
@@ -263,6 +270,9 @@ void Director::drawScene()
         _openGLView->pollEvents();
     }
 
+    // the animation statistics of the previous frame are complete
+    Skeleton3D::resetFrameStats();
+
     //tick before glClear: issue #533
     if (! _paused)
     {
@@ -658,6 +668,8 @@ void Director::purgeCachedData(void)
         log("%s\n", _textureCache->getCachedTextureInfo().c_str());
     }
     FileUtils::getInstance()->purgeCachedEntries();
+    Image::purgeDecodeBufferPool();
+    AutoPolygon::removeCachedPolygons();
 }
 
 float Director::getZEye(void) const
@@ -929,6 +941,12 @@ void Director::reset()
     // cleanup scheduler
     getScheduler()->unscheduleAll();
     
+    // the managers remove their own listeners, so they go before the other listeners
+    ParticleSystemManager::destroyInstance();
+    Skeleton3DManager::destroyInstance();
+    MeshUploadQueue::destroyInstance();
+    JobPool::destroyInstance();
+
     // Remove all events
     if (_eventDispatcher)
     {
@@ -0,0 +1,179 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "base/CCJobPool.h"
+
+#include <algorithm>
+
+NS_CC_BEGIN
+
+JobPool* JobPool::s_sharedPool = nullptr;
+
+JobPool* JobPool::getInstance()
+{
+    if (s_sharedPool == nullptr)
+    {
+        s_sharedPool = new (std::nothrow) JobPool();
+    }
+    return s_sharedPool;
+}
+
+void JobPool::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedPool);
+}
+
+JobPool::JobPool()
+: _threadCount(0)
+, _job(nullptr)
+, _jobCount(0)
+, _nextJob(0)
+, _batch(0)
+, _running(false)
+, _activeWorkers(0)
+, _quit(false)
+{
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    _threadCount = cores > 1 ? cores - 1 : 0;
+}
+
+JobPool::~JobPool()
+{
+    stopThreads();
+}
+
+void JobPool::setThreadCount(int threadCount)
+{
+    threadCount = std::max(threadCount, 0);
+    std::lock_guard<std::mutex> batchLock(_batchMutex);
+    if (_threadCount == threadCount)
+    {
+        return;
+    }
+
+    // restarted by the next batch
+    stopThreads();
+    _threadCount = threadCount;
+}
+
+void JobPool::startThreads()
+{
+    _quit = false;
+    for (int i = 0; i < _threadCount; ++i)
+    {
+        _threads.push_back(new (std::nothrow) std::thread(&JobPool::workerThread, this));
+    }
+}
+
+void JobPool::stopThreads()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+    }
+    _workCondition.notify_all();
+
+    for (auto thread : _threads)
+    {
+        thread->join();
+        delete thread;
+    }
+    _threads.clear();
+}
+
+void JobPool::parallelFor(int count, const std::function<void(int)>& job)
+{
+    // a batch from a job, or from another thread while one runs, would wait for the threads it runs on
+    std::unique_lock<std::mutex> batchLock(_batchMutex, std::try_to_lock);
+    if (count <= 1 || _threadCount == 0 || !batchLock.owns_lock())
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            job(i);
+        }
+        return;
+    }
+
+    if (_threads.empty())
+    {
+        startThreads();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _job = &job;
+        _jobCount = count;
+        _nextJob = 0;
+        _running = true;
+        ++_batch;
+    }
+    _workCondition.notify_all();
+
+    runJobs();
+
+    // the jobs are all taken, wait for the workers still running one
+    std::unique_lock<std::mutex> lock(_mutex);
+    _doneCondition.wait(lock, [this]{ return _activeWorkers == 0; });
+    _running = false;
+    _job = nullptr;
+}
+
+void JobPool::runJobs()
+{
+    const auto& job = *_job;
+    int jobCount = _jobCount;
+    for (int index = _nextJob++; index < jobCount; index = _nextJob++)
+    {
+        job(index);
+    }
+}
+
+void JobPool::workerThread()
+{
+    unsigned int batch = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _workCondition.wait(lock, [this, batch]{ return _quit || (_running && _batch != batch); });
+            if (_quit)
+            {
+                return;
+            }
+            batch = _batch;
+            ++_activeWorkers;
+        }
+
+        runJobs();
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            --_activeWorkers;
+        }
+        _doneCondition.notify_one();
+    }
+}
+
+NS_CC_END
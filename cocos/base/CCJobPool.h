@@ -0,0 +1,112 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CCJOB_POOL_H__
+#define __CCJOB_POOL_H__
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+NS_CC_BEGIN
+
+/**
+ * @class JobPool
+ * @brief Worker threads shared by the engine systems that split the work of a frame into jobs.
+ *
+ * parallelFor() runs a batch of jobs on the worker threads and the calling thread, and returns once they
+ * are all done, so a batch never outlives the frame it was submitted in. ParticleSystemManager, Skeleton3DManager
+ * and Terrain submit their batches to it, one after the other, instead of each starting its own threads.
+ * Unlike AsyncTaskPool, it is meant for short jobs the main thread waits for.
+ * @js NA
+ */
+class CC_DLL JobPool
+{
+public:
+    /** Returns the shared instance of the job pool. The worker threads are started by the first batch. */
+    static JobPool* getInstance();
+
+    /** Stops the worker threads and destroys the shared instance. */
+    static void destroyInstance();
+
+    /** Sets how many worker threads run the jobs, along with the calling thread.
+     * 0 runs the jobs on the calling thread only. Default is the number of cores minus one.
+     */
+    void setThreadCount(int threadCount);
+    int getThreadCount() const { return _threadCount; }
+
+    /**
+     * Runs job(0) ... job(count - 1) on the worker threads and the calling thread, and waits for them.
+     * A batch submitted while another one runs, from a job or from another thread, runs on the calling thread.
+     *
+     * @param count The number of jobs.
+     * @param job Called once for each index, from any of the threads, so the jobs must not share mutable state.
+     */
+    void parallelFor(int count, const std::function<void(int)>& job);
+
+protected:
+    JobPool();
+    ~JobPool();
+
+    void startThreads();
+    void stopThreads();
+    void workerThread();
+    void runJobs();
+
+    int _threadCount;
+    std::vector<std::thread*> _threads;
+    // held while a batch runs
+    std::mutex _batchMutex;
+
+    const std::function<void(int)>* _job;
+    int _jobCount;
+    std::atomic<int> _nextJob;
+
+    std::mutex _mutex;
+    std::condition_variable _workCondition;
+    std::condition_variable _doneCondition;
+    // batch being run, workers join a batch only while it is running
+    unsigned int _batch;
+    bool _running;
+    int _activeWorkers;
+    bool _quit;
+
+    static JobPool* s_sharedPool;
+};
+
+NS_CC_END
+// end of base group
+/** @} */
+
+#endif // __CCJOB_POOL_H__
@@ -57,6 +57,14 @@ public:
         auto &mt = RandomHelper::getEngine();
         return dist(mt);
     }
+
+    /**
+     * Seeds the engine used by cocos2d::random(), so the numbers it returns are reproducible.
+     * Particle systems seed their own engine from it when they are created.
+     */
+    static inline void seed(std::mt19937::result_type value) {
+        getEngine().seed(value);
+    }
 private:
     static std::mt19937 &getEngine();
 };
@@ -39,6 +39,7 @@ THE SOFTWARE.
 
 // base
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobPool.h"
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCConsole.h"
@@ -128,6 +129,7 @@ THE SOFTWARE.
 #include "2d/CCParticleExamples.h"
 #include "2d/CCParticleSystem.h"
 #include "2d/CCParticleSystemQuad.h"
+#include "2d/CCParticleSystemManager.h"
 #include "2d/CCProgressTimer.h"
 #include "2d/CCProtectedNode.h"
 #include "2d/CCRenderTexture.h"
@@ -165,6 +167,7 @@ THE SOFTWARE.
 #include "renderer/CCTexture2D.h"
 #include "renderer/CCTextureCube.h"
 #include "renderer/CCTextureCache.h"
+#include "renderer/CCDynamicAtlas.h"
 #include "renderer/CCTrianglesCommand.h"
 #include "renderer/CCVertexAttribBinding.h"
 #include "renderer/CCVertexIndexBuffer.h"
@@ -283,18 +286,24 @@ THE SOFTWARE.
 
 //3d
 #include "3d/CCAABB.h"
+#include "3d/CCAABBTree.h"
 #include "3d/CCAnimate3D.h"
 #include "3d/CCAnimation3D.h"
 #include "3d/CCAttachNode.h"
 #include "3d/CCBillBoard.h"
+#include "3d/CCBillBoardBatch.h"
 #include "3d/CCFrustum.h"
 #include "3d/CCMesh.h"
 #include "3d/CCMeshSkin.h"
+#include "3d/CCMeshUploadQueue.h"
 #include "3d/CCMeshVertexIndexData.h"
 #include "3d/CCOBB.h"
+#include "3d/CCOcclusionCuller.h"
+#include "3d/CCPagedTerrain.h"
 #include "3d/CCPlane.h"
 #include "3d/CCRay.h"
 #include "3d/CCSkeleton3D.h"
+#include "3d/CCSkeleton3DManager.h"
 #include "3d/CCSkybox.h"
 #include "3d/CCSprite3D.h"
 #include "3d/CCSprite3DMaterial.h"
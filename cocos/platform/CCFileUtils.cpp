@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include "CCFileUtils.h"
 
 #include <stack>
+#include <algorithm>
 
 #include "base/CCData.h"
 #include "base/ccMacros.h"
@@ -556,6 +557,7 @@ void FileUtils::setDelegate(FileUtils *delegate)
 FileUtils::FileUtils()
     : _writablePath("")
 {
+    resetPathLookupStats();
 }
 
 FileUtils::~FileUtils()
@@ -607,6 +609,85 @@ void FileUtils::purgeCachedEntries()
     _fullPathCache.clear();
 }
 
+std::string FileUtils::addPathIndexRoot(const std::string& rootPath)
+{
+    std::string root = isAbsolutePath(rootPath) ? rootPath : _defaultResRootPath + rootPath;
+    if (!root.empty() && root[root.length()-1] != '/')
+    {
+        root += '/';
+    }
+
+    if (std::find(_pathIndexRoots.begin(), _pathIndexRoots.end(), root) == _pathIndexRoots.end())
+    {
+        _pathIndexRoots.push_back(root);
+    }
+    // files which were missing may be indexed now
+    _fullPathCache.clear();
+    return root;
+}
+
+bool FileUtils::addPathIndexFromManifest(const std::string& manifestFile, const std::string& rootPath)
+{
+    std::string content = getStringFromFile(manifestFile);
+    if (content.empty())
+    {
+        CCLOG("cocos2d: FileUtils: can't load path index manifest %s", manifestFile.c_str());
+        return false;
+    }
+
+    const std::string root = addPathIndexRoot(rootPath);
+
+    size_t start = 0;
+    while (start < content.length())
+    {
+        size_t end = content.find('\n', start);
+        if (end == std::string::npos)
+        {
+            end = content.length();
+        }
+
+        size_t last = end;
+        while (last > start && (content[last-1] == '\r' || content[last-1] == ' '))
+        {
+            --last;
+        }
+        if (last > start && content[start] != '#')
+        {
+            _pathIndex.insert(root + content.substr(start, last - start));
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+void FileUtils::removeAllPathIndexes()
+{
+    _pathIndex.clear();
+    _pathIndexRoots.clear();
+    _fullPathCache.clear();
+}
+
+void FileUtils::resetPathLookupStats()
+{
+    _pathLookupStats.cacheHits = 0;
+    _pathLookupStats.cacheMisses = 0;
+    _pathLookupStats.indexLookups = 0;
+    _pathLookupStats.fileSystemLookups = 0;
+}
+
+bool FileUtils::findInPathIndex(const std::string& fullpath, bool* exists) const
+{
+    for (const auto& root : _pathIndexRoots)
+    {
+        if (fullpath.compare(0, root.length(), root) == 0)
+        {
+            *exists = _pathIndex.find(fullpath) != _pathIndex.end();
+            return true;
+        }
+    }
+    return false;
+}
+
 static Data getData(const std::string& filename, bool forString)
 {
     if (filename.empty())
@@ -791,6 +872,24 @@ std::string FileUtils::getPathForFilename(const std::string& filename, const std
     path += file_path;
     path += resolutionDirectory;
 
+    if (!_pathIndexRoots.empty())
+    {
+        std::string fullpath = path;
+        if (!fullpath.empty() && fullpath[fullpath.length()-1] != '/')
+        {
+            fullpath += '/';
+        }
+        fullpath += file;
+
+        bool exists = false;
+        if (findInPathIndex(fullpath, &exists))
+        {
+            ++_pathLookupStats.indexLookups;
+            return exists ? fullpath : "";
+        }
+    }
+
+    ++_pathLookupStats.fileSystemLookups;
     path = getFullPathForDirectoryAndFilename(path, file);
 
     //CCLOG("getPathForFilename, fullPath = %s", path.c_str());
@@ -813,8 +912,10 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
     auto cacheIter = _fullPathCache.find(filename);
     if(cacheIter != _fullPathCache.end())
     {
+        ++_pathLookupStats.cacheHits;
         return cacheIter->second;
     }
+    ++_pathLookupStats.cacheMisses;
 
     // Get the new file name.
     const std::string newFilename( getNewFilename(filename) );
@@ -1072,6 +1173,12 @@ bool FileUtils::createDirectory(const std::string& path)
     return false;
 }
 
+bool FileUtils::addPathIndexFromDirectory(const std::string& rootPath)
+{
+    CCLOG("cocos2d: FileUtils: addPathIndexFromDirectory isn't supported on this platform, use addPathIndexFromManifest");
+    return false;
+}
+
 bool FileUtils::removeDirectory(const std::string& path)
 {
     CCASSERT(false, "FileUtils not support removeDirectory");
@@ -1118,6 +1225,63 @@ bool FileUtils::isDirectoryExistInternal(const std::string& dirPath) const
     return false;
 }
 
+static bool indexDirectory(const std::string& root, const std::string& relative, std::unordered_set<std::string>& index)
+{
+    DIR* dir = opendir((root + relative).c_str());
+    if (!dir)
+    {
+        return false;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+        {
+            continue;
+        }
+
+        std::string path = relative + entry->d_name;
+        struct stat st;
+        if (stat((root + path).c_str(), &st) != 0)
+        {
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode))
+        {
+            indexDirectory(root, path + '/', index);
+        }
+        else
+        {
+            index.insert(root + path);
+        }
+    }
+    closedir(dir);
+    return true;
+}
+
+bool FileUtils::addPathIndexFromDirectory(const std::string& rootPath)
+{
+    std::string root = isAbsolutePath(rootPath) ? rootPath : _defaultResRootPath + rootPath;
+    if (!root.empty() && root[root.length()-1] != '/')
+    {
+        root += '/';
+    }
+
+    // the apk assets can't be enumerated with opendir, don't index them as empty
+    std::unordered_set<std::string> files;
+    if (!indexDirectory(root, "", files))
+    {
+        CCLOG("cocos2d: FileUtils: can't index directory %s", root.c_str());
+        return false;
+    }
+
+    addPathIndexRoot(rootPath);
+    _pathIndex.insert(files.begin(), files.end());
+    return true;
+}
+
 bool FileUtils::createDirectory(const std::string& path)
 {
     CCASSERT(!path.empty(), "Invalid path");
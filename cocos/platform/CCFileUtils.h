@@ -28,6 +28,8 @@ THE SOFTWARE.
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
+#include <atomic>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/ccTypes.h"
@@ -477,6 +479,55 @@ public:
     /** Returns the full path cache. */
     const std::unordered_map<std::string, std::string>& getFullPathCache() const { return _fullPathCache; }
 
+    /**
+     *  Adds a path index for a directory from a manifest file, so that searching files under that directory
+     *  doesn't touch the file system.
+     *  The manifest is a text file with one path per line, relative to the indexed directory, e.g. "images/hero.png".
+     *  Once a directory is indexed, files under it which aren't listed in the manifest are considered missing.
+     *
+     *  @param manifestFile The manifest file, it could be a relative or absolute path.
+     *  @param rootPath The indexed directory. If it is a relative path, it will be inserted a default root path at the beginning.
+     *  @return True if the manifest was loaded, false if not.
+     */
+    virtual bool addPathIndexFromManifest(const std::string& manifestFile, const std::string& rootPath);
+
+    /**
+     *  Adds a path index for a directory by enumerating its files once.
+     *
+     *  @note Only directories of the file system can be enumerated, not the assets inside an apk.
+     *        Use addPathIndexFromManifest() for those.
+     *  @param rootPath The indexed directory. If it is a relative path, it will be inserted a default root path at the beginning.
+     *  @return True if the directory was enumerated, false if not.
+     */
+    virtual bool addPathIndexFromDirectory(const std::string& rootPath);
+
+    /**
+     *  Removes all the path indexes. The file system is checked again when searching files.
+     */
+    virtual void removeAllPathIndexes();
+
+    /** Number of files in the path indexes. */
+    ssize_t getPathIndexCount() const { return _pathIndex.size(); }
+
+    /** Counters of the file searches done by fullPathForFilename(), which may be called from several threads. */
+    struct PathLookupStats
+    {
+        /** searches answered by the full path cache */
+        std::atomic<unsigned int> cacheHits;
+        /** searches which missed the full path cache */
+        std::atomic<unsigned int> cacheMisses;
+        /** candidate paths answered by the path indexes */
+        std::atomic<unsigned int> indexLookups;
+        /** candidate paths checked on the file system */
+        std::atomic<unsigned int> fileSystemLookups;
+    };
+
+    /** Returns the counters of the file searches. */
+    const PathLookupStats& getPathLookupStats() const { return _pathLookupStats; }
+
+    /** Resets the counters of the file searches. */
+    void resetPathLookupStats();
+
 protected:
     /**
      *  The default constructor.
@@ -538,6 +589,20 @@ protected:
      */
     virtual std::string getFullPathForDirectoryAndFilename(const std::string& directory, const std::string& filename) const;
 
+    /**
+     *  Looks up a path in the path indexes.
+     *
+     *  @param fullpath The path of the file.
+     *  @param exists Set to whether the file is in the index, if the path is under an indexed directory.
+     *  @return True if the path is under an indexed directory, false if the file system has to be checked.
+     */
+    bool findInPathIndex(const std::string& fullpath, bool* exists) const;
+
+    /**
+     *  Adds an indexed directory, returns it with a default root path and a trailing '/'.
+     */
+    std::string addPathIndexRoot(const std::string& rootPath);
+
     /** Dictionary used to lookup filenames based on a key.
      *  It is used internally by the following methods:
      *
@@ -574,6 +639,18 @@ protected:
      */
     mutable std::unordered_map<std::string, std::string> _fullPathCache;
 
+    /**
+     *  The paths of the files under the indexed directories.
+     */
+    std::unordered_set<std::string> _pathIndex;
+
+    /**
+     *  The indexed directories, with a trailing '/'.
+     */
+    std::vector<std::string> _pathIndexRoots;
+
+    mutable PathLookupStats _pathLookupStats;
+
     /**
      * Writable path.
      */
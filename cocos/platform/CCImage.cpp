@@ -28,6 +28,8 @@ THE SOFTWARE.
 
 #include <string>
 #include <ctype.h>
+#include <mutex>
+#include <vector>
 
 #include "base/CCData.h"
 #include "base/ccConfig.h" // CC_USE_JPEG, CC_USE_TIFF, CC_USE_WEBP
@@ -85,6 +87,7 @@ extern "C"
 #include "base/CCConfiguration.h"
 #include "base/ccUtils.h"
 #include "base/ZipUtils.h"
+#include "xxhash.h"
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 #include "android/CCFileUtils-android.h"
 #endif
@@ -103,6 +106,8 @@ namespace
     static const int PVR_TEXTURE_FLAG_TYPE_MASK = 0xff;
     
     static bool _PVRHaveAlphaPremultiplied = false;
+
+    static bool _ETCTranscodeCacheEnabled = false;
     
     // Values taken from PVRTexture.h from http://www.imgtec.com
     enum class PVR2TextureFlag
@@ -431,6 +436,91 @@ namespace
 #endif //CC_USE_PNG
 }
 
+namespace
+{
+    // Keeps a few recently released decode buffers, so loading a run of textures
+    // reuses the same memory instead of allocating every image again.
+    class DecodeBufferPool
+    {
+    public:
+        static const size_t MAX_BUFFERS = 4;
+        static const ssize_t MAX_POOLED_BYTES = 16 * 1024 * 1024;
+
+        DecodeBufferPool() : _pooledBytes(0) {}
+        ~DecodeBufferPool() { purge(); }
+
+        // returns the smallest pooled buffer holding len bytes, or a new one
+        unsigned char* acquire(ssize_t len, ssize_t* capacity)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto best = _buffers.end();
+                for (auto it = _buffers.begin(); it != _buffers.end(); ++it)
+                {
+                    // don't hand out a buffer much larger than needed, it would stay alive with the image
+                    if (it->second >= len && it->second <= len * 2
+                        && (best == _buffers.end() || it->second < best->second))
+                    {
+                        best = it;
+                    }
+                }
+                if (best != _buffers.end())
+                {
+                    unsigned char* buffer = best->first;
+                    *capacity = best->second;
+                    _pooledBytes -= best->second;
+                    _buffers.erase(best);
+                    return buffer;
+                }
+            }
+            *capacity = len;
+            return static_cast<unsigned char*>(malloc(len));
+        }
+
+        void release(unsigned char* buffer, ssize_t capacity)
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_buffers.size() < MAX_BUFFERS && _pooledBytes + capacity <= MAX_POOLED_BYTES)
+                {
+                    _buffers.push_back(std::make_pair(buffer, capacity));
+                    _pooledBytes += capacity;
+                    return;
+                }
+            }
+            free(buffer);
+        }
+
+        void purge()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto& buffer : _buffers)
+            {
+                free(buffer.first);
+            }
+            _buffers.clear();
+            _pooledBytes = 0;
+        }
+
+    private:
+        std::mutex _mutex;
+        std::vector<std::pair<unsigned char*, ssize_t>> _buffers;
+        ssize_t _pooledBytes;
+    };
+
+    static DecodeBufferPool s_decodeBufferPool;
+}
+
+static void premultiplyAlphaRow(unsigned char* data, int pixels)
+{
+    unsigned int* fourBytes = (unsigned int*)data;
+    for (int i = 0; i < pixels; i++)
+    {
+        unsigned char* p = data + i * 4;
+        fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
+    }
+}
+
 Texture2D::PixelFormat getDevicePixelFormat(Texture2D::PixelFormat format)
 {
     switch (format) {
@@ -466,6 +556,11 @@ Image::Image()
 , _renderFormat(Texture2D::PixelFormat::NONE)
 , _numberOfMipmaps(0)
 , _hasPremultipliedAlpha(true)
+, _ownsData(true)
+, _decodeFormat(Texture2D::PixelFormat::NONE)
+, _decodeBuffer(nullptr)
+, _decodeBufferLen(0)
+, _pooledCapacity(0)
 {
 
 }
@@ -478,7 +573,74 @@ Image::~Image()
             CC_SAFE_DELETE_ARRAY(_mipmaps[i].address);
     }
     else
-        CC_SAFE_FREE(_data);
+        releaseData();
+}
+
+void Image::releaseData()
+{
+    if (_pooledCapacity > 0)
+    {
+        s_decodeBufferPool.release(_data, _pooledCapacity);
+    }
+    else if (_ownsData)
+    {
+        free(_data);
+    }
+    _data = nullptr;
+    _ownsData = true;
+    _pooledCapacity = 0;
+}
+
+void Image::purgeDecodeBufferPool()
+{
+    s_decodeBufferPool.purge();
+}
+
+void Image::setDecodeTarget(Texture2D::PixelFormat format, unsigned char* buffer, ssize_t bufferLen)
+{
+    _decodeFormat = format;
+    _decodeBuffer = buffer;
+    _decodeBufferLen = buffer ? bufferLen : 0;
+}
+
+bool Image::hasDecodeTarget() const
+{
+    return _decodeBuffer != nullptr
+        || (_decodeFormat != Texture2D::PixelFormat::NONE && _decodeFormat != Texture2D::PixelFormat::AUTO);
+}
+
+// Chooses the format the decoded rows are stored in and allocates _data for them.
+// Returns the per row conversion, or nullptr if rows are stored as they are decoded.
+Texture2D::ConvertFunction Image::prepareDecodeData(Texture2D::PixelFormat decodedFormat, ssize_t* rowBytes)
+{
+    Texture2D::ConvertFunction convert = nullptr;
+    _renderFormat = decodedFormat;
+    if (_decodeFormat != Texture2D::PixelFormat::NONE
+        && _decodeFormat != Texture2D::PixelFormat::AUTO
+        && _decodeFormat != decodedFormat)
+    {
+        convert = Texture2D::getConvertFunction(decodedFormat, _decodeFormat);
+        if (convert)
+        {
+            _renderFormat = _decodeFormat;
+        }
+    }
+
+    *rowBytes = _width * Texture2D::getPixelFormatInfoMap().at(_renderFormat).bpp / 8;
+    _dataLen = *rowBytes * _height;
+
+    if (_decodeBuffer && _decodeBufferLen >= _dataLen)
+    {
+        _data = _decodeBuffer;
+        _ownsData = false;
+    }
+    else
+    {
+        _data = s_decodeBufferPool.acquire(_dataLen, &_pooledCapacity);
+        _ownsData = true;
+    }
+
+    return convert;
 }
 
 bool Image::initWithImageFile(const std::string& path)
@@ -490,7 +652,7 @@ bool Image::initWithImageFile(const std::string& path)
 
     if (!data.isNull())
     {
-        ret = initWithImageData(data.getBytes(), data.getSize());
+        ret = _ETCTranscodeCacheEnabled ? initWithImageDataTranscoded(data) : initWithImageData(data.getBytes(), data.getSize());
     }
 
     return ret;
@@ -505,12 +667,119 @@ bool Image::initWithImageFileThreadSafe(const std::string& fullpath)
 
     if (!data.isNull())
     {
-        ret = initWithImageData(data.getBytes(), data.getSize());
+        ret = _ETCTranscodeCacheEnabled ? initWithImageDataTranscoded(data) : initWithImageData(data.getBytes(), data.getSize());
     }
 
     return ret;
 }
 
+// Formats with an alpha channel are opaque if every alpha value is at its maximum.
+// Packed alpha formats can't be converted to RGB888 anyway, so they are reported as not opaque.
+static bool isOpaqueData(const unsigned char* data, ssize_t dataLen, Texture2D::PixelFormat format)
+{
+    ssize_t stride = 0;
+    switch (format)
+    {
+    case Texture2D::PixelFormat::RGB888:
+    case Texture2D::PixelFormat::RGB565:
+    case Texture2D::PixelFormat::I8:
+        return true;
+    case Texture2D::PixelFormat::RGBA8888:
+        stride = 4;
+        break;
+    case Texture2D::PixelFormat::AI88:
+        stride = 2;
+        break;
+    default:
+        return false;
+    }
+
+    for (ssize_t i = stride - 1; i < dataLen; i += stride)
+    {
+        if (data[i] != 0xff)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string Image::getETCTranscodeCachePath(const Data& data)
+{
+    char name[32];
+    unsigned int hash = XXH32(data.getBytes(), data.getSize(), 0);
+    snprintf(name, sizeof(name), "%08x_%x.pkm", hash, static_cast<unsigned int>(data.getSize()));
+    return FileUtils::getInstance()->getWritablePath() + "etc1cache/" + name;
+}
+
+bool Image::initWithImageDataTranscoded(const Data& data)
+{
+    if (!Configuration::getInstance()->supportsETC())
+    {
+        return initWithImageData(data.getBytes(), data.getSize());
+    }
+
+    // a previous launch already transcoded this content
+    auto fileUtils = FileUtils::getInstance();
+    std::string cachePath = getETCTranscodeCachePath(data);
+    if (fileUtils->isFileExist(cachePath))
+    {
+        Data cached = fileUtils->getDataFromFile(cachePath);
+        if (!cached.isNull() && initWithImageData(cached.getBytes(), cached.getSize()))
+        {
+            return true;
+        }
+    }
+
+    if (!initWithImageData(data.getBytes(), data.getSize()))
+    {
+        return false;
+    }
+    if (_fileType != Format::PNG && _fileType != Format::JPG)
+    {
+        return true;
+    }
+
+    // ETC1 has no alpha, so only opaque images are transcoded
+    if (!isOpaqueData(_data, _dataLen, _renderFormat))
+    {
+        return true;
+    }
+    unsigned char* rgbData = nullptr;
+    ssize_t rgbDataLen = 0;
+    Texture2D::PixelFormat format = Texture2D::convertDataToFormat(_data, _dataLen, _renderFormat, Texture2D::PixelFormat::RGB888, &rgbData, &rgbDataLen);
+    if (format != Texture2D::PixelFormat::RGB888)
+    {
+        return true;
+    }
+
+    ssize_t pkmLen = ETC_PKM_HEADER_SIZE + etc1_get_encoded_data_size(_width, _height);
+    unsigned char* pkm = static_cast<unsigned char*>(malloc(pkmLen));
+    etc1_pkm_format_header(pkm, _width, _height);
+    int error = etc1_encode_image(rgbData, _width, _height, 3, _width * 3, pkm + ETC_PKM_HEADER_SIZE);
+    if (rgbData != _data)
+    {
+        free(rgbData);
+    }
+    if (error != 0)
+    {
+        free(pkm);
+        return true;
+    }
+
+    Data pkmData;
+    pkmData.fastSet(pkm, pkmLen);
+    fileUtils->createDirectory(fileUtils->getWritablePath() + "etc1cache/");
+    if (!fileUtils->writeDataToFile(pkmData, cachePath))
+    {
+        CCLOG("cocos2d: Image: failed to write ETC1 cache %s", cachePath.c_str());
+    }
+
+    // use the compressed data for this load too
+    releaseData();
+    return initWithETCData(pkmData.getBytes(), pkmData.getSize());
+}
+
 bool Image::initWithImageData(const unsigned char * data, ssize_t dataLen)
 {
     bool ret = false;
@@ -965,18 +1234,44 @@ bool Image::initWithJpgData(const unsigned char * data, ssize_t dataLen)
         _height = cinfo.output_height;
         _hasPremultipliedAlpha = false;
 
-        _dataLen = cinfo.output_width*cinfo.output_height*cinfo.output_components;
-        _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+        ssize_t srcRowBytes = cinfo.output_width*cinfo.output_components;
+        ssize_t dstRowBytes = srcRowBytes;
+        Texture2D::ConvertFunction convert = nullptr;
+        if (hasDecodeTarget())
+        {
+            convert = prepareDecodeData(_renderFormat, &dstRowBytes);
+        }
+        else
+        {
+            _dataLen = cinfo.output_width*cinfo.output_height*cinfo.output_components;
+            _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+        }
         CC_BREAK_IF(! _data);
 
+        // scanlines which need converting are decoded into a single row, then converted into _data
+        unsigned char* rowData = convert ? static_cast<unsigned char*>(malloc(srcRowBytes)) : nullptr;
+        // rowData is never reassigned below, so it is still valid when a decode error jumps back here
+        if (setjmp(jerr.setjmp_buffer))
+        {
+            free(rowData);
+            jpeg_destroy_decompress(&cinfo);
+            break;
+        }
+
         /* now actually read the jpeg into the raw buffer */
         /* read one scan line at a time */
         while (cinfo.output_scanline < cinfo.output_height)
         {
-            row_pointer[0] = _data + location;
-            location += cinfo.output_width*cinfo.output_components;
+            unsigned char* dst = _data + location;
+            row_pointer[0] = convert ? rowData : dst;
+            location += dstRowBytes;
             jpeg_read_scanlines(&cinfo, row_pointer, 1);
+            if (convert)
+            {
+                convert(rowData, srcRowBytes, dst);
+            }
         }
+        free(rowData);
 
     /* When read image file with broken data, jpeg_finish_decompress() may cause error.
      * Besides, jpeg_destroy_decompress() shall deallocate and release all memory associated
@@ -1101,10 +1396,49 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
 
         // read png data
         png_size_t rowbytes;
-        png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * _height );
-
         rowbytes = png_get_rowbytes(png_ptr, info_ptr);
 
+        // interlaced images are decoded in several passes, so they can't be converted row by row
+        if (hasDecodeTarget() && png_get_interlace_type(png_ptr, info_ptr) == PNG_INTERLACE_NONE)
+        {
+            ssize_t dstRowBytes = 0;
+            Texture2D::ConvertFunction convert = prepareDecodeData(_renderFormat, &dstRowBytes);
+            CC_BREAK_IF(!_data);
+
+            bool premultiply = (color_type == PNG_COLOR_TYPE_RGB_ALPHA);
+            unsigned char* rowData = convert ? static_cast<unsigned char*>(malloc(rowbytes)) : nullptr;
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_BADA && CC_TARGET_PLATFORM != CC_PLATFORM_NACL)
+            // rowData is never reassigned below, so it is still valid when a decode error jumps back here
+            if (setjmp(png_jmpbuf(png_ptr)))
+            {
+                free(rowData);
+                break;
+            }
+#endif
+            for (int i = 0; i < _height; ++i)
+            {
+                unsigned char* dst = _data + i * dstRowBytes;
+                unsigned char* src = convert ? rowData : dst;
+                png_read_row(png_ptr, src, nullptr);
+                if (premultiply)
+                {
+                    premultiplyAlphaRow(src, _width);
+                }
+                if (convert)
+                {
+                    convert(src, rowbytes, dst);
+                }
+            }
+            free(rowData);
+
+            png_read_end(png_ptr, nullptr);
+            _hasPremultipliedAlpha = premultiply;
+            ret = true;
+            break;
+        }
+
+        png_bytep* row_pointers = (png_bytep*)malloc( sizeof(png_bytep) * _height );
+
         _dataLen = rowbytes * _height;
         _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
         if (!_data)
@@ -1116,6 +1450,14 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
             break;
         }
 
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_BADA && CC_TARGET_PLATFORM != CC_PLATFORM_NACL)
+        if (setjmp(png_jmpbuf(png_ptr)))
+        {
+            free(row_pointers);
+            break;
+        }
+#endif
+
         for (unsigned short i = 0; i < _height; ++i)
         {
             row_pointers[i] = _data + i*rowbytes;
@@ -2451,12 +2793,7 @@ void Image::premultipliedAlpha()
 {
     CCASSERT(_renderFormat == Texture2D::PixelFormat::RGBA8888, "The pixel format should be RGBA8888!");
     
-    unsigned int* fourBytes = (unsigned int*)_data;
-    for(int i = 0; i < _width * _height; i++)
-    {
-        unsigned char* p = _data + i * 4;
-        fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
-    }
+    premultiplyAlphaRow(_data, _width * _height);
     
     _hasPremultipliedAlpha = true;
 }
@@ -2467,5 +2804,15 @@ void Image::setPVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied)
     _PVRHaveAlphaPremultiplied = haveAlphaPremultiplied;
 }
 
+void Image::setETCTranscodeCacheEnabled(bool enabled)
+{
+    _ETCTranscodeCacheEnabled = enabled;
+}
+
+bool Image::isETCTranscodeCacheEnabled()
+{
+    return _ETCTranscodeCacheEnabled;
+}
+
 NS_CC_END
 
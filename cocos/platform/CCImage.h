@@ -28,6 +28,7 @@ THE SOFTWARE.
 /// @cond DO_NOT_SHOW
 
 #include "base/CCRef.h"
+#include "base/CCData.h"
 #include "renderer/CCTexture2D.h"
 
 #if defined(CC_USE_WIC)
@@ -120,6 +121,24 @@ public:
     // @warning kFmtRawData only support RGBA8888
     bool initWithRawData(const unsigned char * data, ssize_t dataLen, int width, int height, int bitsPerComponent, bool preMulti = false);
 
+    /**
+    @brief Make PNG and JPEG decoding write rows straight in the pixel format the texture will use.
+    Each row is premultiplied and converted while it is still in cache, so Texture2D::initWithImage
+    doesn't need another full-size conversion buffer. Other formats ignore it and decode as before.
+    Call it before any init method.
+    @param format  the final pixel format, PixelFormat::NONE or PixelFormat::AUTO keeps the decoded format.
+    @param buffer  optional caller-owned destination, only used if bufferLen is big enough. Image never frees it.
+    @param bufferLen  buffer length expressed in bytes.
+    */
+    void setDecodeTarget(Texture2D::PixelFormat format, unsigned char* buffer = nullptr, ssize_t bufferLen = 0);
+
+    /**
+    @brief Frees the decode buffers kept for reuse.
+    When setDecodeTarget is used without a caller buffer, the pixels are decoded into a pooled
+    buffer which is given back to the pool when the Image is destroyed, so the next load can reuse it.
+    */
+    static void purgeDecodeBufferPool();
+
     // Getters
     inline unsigned char *   getData()               { return _data; }
     inline ssize_t           getDataLen()            { return _dataLen; }
@@ -153,6 +172,19 @@ public:
      */
     static void setPVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied);
 
+
+    /** Transcodes opaque PNG and JPEG files to ETC1 the first time they are loaded from file.
+     The compressed result is stored in the writable path, keyed by the file content hash,
+     and is loaded instead of the original on the next launch. It uses 1/6 of the memory of
+     an RGB888 texture (1/8 of RGBA8888) and skips decoding entirely.
+     Only used if the device supports ETC1. Images with alpha are loaded as before, since the
+     renderer has no separate alpha plane for ETC1.
+
+     By default it is disabled.
+     */
+    static void setETCTranscodeCacheEnabled(bool enabled);
+    static bool isETCTranscodeCacheEnabled();
+
 protected:
 #if defined(CC_USE_WIC)
     bool encodeWithWIC(const std::string& filePath, bool isToRGB, GUID containerFormat);
@@ -175,6 +207,10 @@ protected:
     bool saveImageToJPG(const std::string& filePath);
     
     void premultipliedAlpha();
+    void releaseData();
+
+    bool hasDecodeTarget() const;
+    Texture2D::ConvertFunction prepareDecodeData(Texture2D::PixelFormat decodedFormat, ssize_t* rowBytes);
     
 protected:
     /**
@@ -194,6 +230,13 @@ protected:
     // false if we cann't auto detect the image is premultiplied or not.
     bool _hasPremultipliedAlpha;
     std::string _filePath;
+    // false if _data points to the caller's decode buffer
+    bool _ownsData;
+    Texture2D::PixelFormat _decodeFormat;
+    unsigned char* _decodeBuffer;
+    ssize_t _decodeBufferLen;
+    // size of _data if it was taken from the decode buffer pool, 0 otherwise
+    ssize_t _pooledCapacity;
 
 
 protected:
@@ -209,6 +252,9 @@ protected:
      @return  true if loaded correctly.
      */
     bool initWithImageFileThreadSafe(const std::string& fullpath);
+
+    bool initWithImageDataTranscoded(const Data& data);
+    static std::string getETCTranscodeCachePath(const Data& data);
     
     Format detectFormat(const unsigned char * data, ssize_t dataLen);
     bool isPng(const unsigned char * data, ssize_t dataLen);
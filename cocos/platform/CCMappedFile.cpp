@@ -0,0 +1,98 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "platform/CCMappedFile.h"
+#include "platform/CCFileUtils.h"
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+NS_CC_BEGIN
+
+MappedFile* MappedFile::create(const std::string& fullPath)
+{
+    auto file = new (std::nothrow) MappedFile();
+    if (file && file->init(fullPath))
+    {
+        file->autorelease();
+        return file;
+    }
+    CC_SAFE_DELETE(file);
+    return nullptr;
+}
+
+MappedFile::MappedFile()
+: _bytes(nullptr)
+, _size(0)
+, _mapped(nullptr)
+{
+}
+
+MappedFile::~MappedFile()
+{
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+    if (_mapped)
+    {
+        munmap(_mapped, _size);
+    }
+#endif
+}
+
+bool MappedFile::init(const std::string& fullPath)
+{
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+    // files packed in an archive (e.g. the apk on Android) can't be mapped, they are read below
+    int fd = open(fullPath.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED)
+            {
+                _mapped = mapped;
+                _bytes = static_cast<const unsigned char*>(mapped);
+                _size = st.st_size;
+            }
+        }
+        close(fd);
+        if (_mapped)
+        {
+            return true;
+        }
+    }
+#endif
+    _data = FileUtils::getInstance()->getDataFromFile(fullPath);
+    _bytes = _data.getBytes();
+    _size = _data.getSize();
+    return !_data.isNull();
+}
+
+NS_CC_END
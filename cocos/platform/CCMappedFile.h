@@ -0,0 +1,80 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __CC_MAPPED_FILE_H__
+#define __CC_MAPPED_FILE_H__
+
+#include <string>
+
+#include "base/CCRef.h"
+#include "base/CCData.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+
+/**
+ * @brief A read only view of a file, mapped into memory where the platform allows it.
+ *
+ * Files which can't be mapped, e.g. on Windows or packed in the apk on Android, are read with
+ * FileUtils::getDataFromFile(). Readers which point into the file instead of copying its content retain it.
+ */
+class CC_DLL MappedFile : public Ref
+{
+public:
+    /**
+     * Maps or reads a file.
+     * @param fullPath The full path of the file.
+     * @return An autoreleased MappedFile, or nullptr if the file can't be read.
+     */
+    static MappedFile* create(const std::string& fullPath);
+
+    const unsigned char* getBytes() const { return _bytes; }
+    ssize_t getSize() const { return _size; }
+    /** Returns true if the file is mapped, false if it was read into memory. */
+    bool isMapped() const { return _mapped != nullptr; }
+
+CC_CONSTRUCTOR_ACCESS:
+    MappedFile();
+    virtual ~MappedFile();
+
+    bool init(const std::string& fullPath);
+
+private:
+    const unsigned char* _bytes;
+    ssize_t _size;
+    void* _mapped;
+    Data _data;
+};
+
+// end of platform group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_MAPPED_FILE_H__
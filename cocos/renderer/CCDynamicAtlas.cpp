@@ -0,0 +1,589 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "renderer/CCDynamicAtlas.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "2d/CCSpriteFrame.h"
+#include "platform/CCImage.h"
+#include "platform/CCFileUtils.h"
+#include "renderer/CCTexture2D.h"
+#include "renderer/CCTextureCache.h"
+#include "base/ccMacros.h"
+#include "base/CCDirector.h"
+
+NS_CC_BEGIN
+
+// border kept around each packed image, filled with its edge pixels so linear filtering
+// neither bleeds the neighbours in nor fades the edges to transparent
+static const int ATLAS_PADDING = 1;
+static const int BYTES_PER_PIXEL = 4;
+
+DynamicAtlas::DynamicAtlas()
+: _pageSize(1024)
+, _maxPages(4)
+, _maxImageSize(256)
+{
+}
+
+DynamicAtlas::~DynamicAtlas()
+{
+    removeAll();
+    purgeRetiredPages(true);
+}
+
+bool DynamicAtlas::init(int pageSize, int maxPages)
+{
+    CCASSERT(pageSize > 0 && maxPages > 0, "Invalid DynamicAtlas size");
+
+    removeAll();
+    _pageSize = pageSize;
+    _maxPages = maxPages;
+    _maxImageSize = std::min(_maxImageSize, _pageSize - 2 * ATLAS_PADDING);
+    return true;
+}
+
+SpriteFrame* DynamicAtlas::addImage(const std::string& filepath)
+{
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(filepath);
+    if (fullpath.empty())
+    {
+        return nullptr;
+    }
+
+    auto it = _entries.find(fullpath);
+    if (it != _entries.end())
+    {
+        return it->second.frame;
+    }
+
+    SpriteFrame* frame = nullptr;
+    Image* image = new (std::nothrow) Image();
+    if (image)
+    {
+        image->setDecodeTarget(Texture2D::PixelFormat::RGBA8888);
+        if (image->initWithImageFile(fullpath))
+        {
+            frame = addImage(image, fullpath);
+        }
+        image->release();
+    }
+    return frame;
+}
+
+SpriteFrame* DynamicAtlas::addImage(Image* image, const std::string& key)
+{
+    CCASSERT(image != nullptr, "DynamicAtlas: image MUST not be nil");
+
+    auto it = _entries.find(key);
+    if (it != _entries.end())
+    {
+        return it->second.frame;
+    }
+
+    int width = image->getWidth();
+    int height = image->getHeight();
+    if (image->isCompressed() || image->getNumberOfMipmaps() > 1
+        || width <= 0 || height <= 0
+        || width > _maxImageSize || height > _maxImageSize)
+    {
+        return nullptr;
+    }
+
+    unsigned char* rgbaData = nullptr;
+    ssize_t rgbaDataLen = 0;
+    Texture2D::PixelFormat format = Texture2D::convertDataToFormat(image->getData(), image->getDataLen(),
+        image->getRenderFormat(), Texture2D::PixelFormat::RGBA8888, &rgbaData, &rgbaDataLen);
+    if (format != Texture2D::PixelFormat::RGBA8888)
+    {
+        if (rgbaData != image->getData())
+        {
+            free(rgbaData);
+        }
+        return nullptr;
+    }
+
+    // find room, freeing the unused frames or adding a page if the existing pages are full
+    PackRect rect;
+    int pageIndex = -1;
+    int paddedWidth = width + 2 * ATLAS_PADDING;
+    int paddedHeight = height + 2 * ATLAS_PADDING;
+    for (int pass = 0; pass < 2 && pageIndex < 0; ++pass)
+    {
+        for (size_t i = 0; i < _pages.size(); ++i)
+        {
+            if (insert(_pages[i], paddedWidth, paddedHeight, &rect))
+            {
+                pageIndex = static_cast<int>(i);
+                break;
+            }
+        }
+        if (pageIndex < 0 && pass == 0)
+        {
+            removeUnusedSpriteFrames();
+        }
+    }
+    if (pageIndex < 0 && static_cast<int>(_pages.size()) < _maxPages)
+    {
+        Page* page = createPage();
+        if (page && insert(page, paddedWidth, paddedHeight, &rect))
+        {
+            pageIndex = static_cast<int>(_pages.size()) - 1;
+        }
+    }
+    if (pageIndex < 0)
+    {
+        if (rgbaData != image->getData())
+        {
+            free(rgbaData);
+        }
+        CCLOG("cocos2d: DynamicAtlas: no room for %s", key.c_str());
+        return nullptr;
+    }
+
+    // pad the image with its edge pixels and premultiply it like the rest of the page
+    unsigned char* padded = static_cast<unsigned char*>(malloc(paddedWidth * paddedHeight * BYTES_PER_PIXEL));
+    for (int row = 0; row < height; ++row)
+    {
+        memcpy(padded + ((row + ATLAS_PADDING) * paddedWidth + ATLAS_PADDING) * BYTES_PER_PIXEL,
+               rgbaData + row * width * BYTES_PER_PIXEL,
+               width * BYTES_PER_PIXEL);
+    }
+    if (rgbaData != image->getData())
+    {
+        free(rgbaData);
+    }
+    int lineBytes = paddedWidth * BYTES_PER_PIXEL;
+    for (int row = ATLAS_PADDING; row < ATLAS_PADDING + height; ++row)
+    {
+        unsigned char* line = padded + row * lineBytes;
+        for (int i = 0; i < ATLAS_PADDING; ++i)
+        {
+            memcpy(line + i * BYTES_PER_PIXEL, line + ATLAS_PADDING * BYTES_PER_PIXEL, BYTES_PER_PIXEL);
+            memcpy(line + (paddedWidth - 1 - i) * BYTES_PER_PIXEL,
+                   line + (paddedWidth - 1 - ATLAS_PADDING) * BYTES_PER_PIXEL, BYTES_PER_PIXEL);
+        }
+    }
+    for (int i = 0; i < ATLAS_PADDING; ++i)
+    {
+        memcpy(padded + i * lineBytes, padded + ATLAS_PADDING * lineBytes, lineBytes);
+        memcpy(padded + (paddedHeight - 1 - i) * lineBytes,
+               padded + (paddedHeight - 1 - ATLAS_PADDING) * lineBytes, lineBytes);
+    }
+    if (!image->hasPremultipliedAlpha())
+    {
+        unsigned int* fourBytes = reinterpret_cast<unsigned int*>(padded);
+        for (int i = 0; i < paddedWidth * paddedHeight; ++i)
+        {
+            unsigned char* p = padded + i * BYTES_PER_PIXEL;
+            fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
+        }
+    }
+
+    Page* page = _pages[pageIndex];
+    copyRect(page, rect, padded, paddedWidth * BYTES_PER_PIXEL);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    page->texture->updateWithData(padded, rect.x, rect.y, rect.width, rect.height);
+    free(padded);
+
+    Rect frameRect(rect.x + ATLAS_PADDING, rect.y + ATLAS_PADDING, width, height);
+    SpriteFrame* frame = SpriteFrame::createWithTexture(page->texture, CC_RECT_PIXELS_TO_POINTS(frameRect));
+    frame->retain();
+
+    Entry entry;
+    entry.frame = frame;
+    entry.page = pageIndex;
+    entry.rect = rect;
+    _entries.insert(std::make_pair(key, entry));
+
+    return frame;
+}
+
+SpriteFrame* DynamicAtlas::getSpriteFrame(const std::string& key) const
+{
+    auto it = _entries.find(key);
+    if (it != _entries.end())
+    {
+        return it->second.frame;
+    }
+    return nullptr;
+}
+
+void DynamicAtlas::removeSpriteFrame(const std::string& key)
+{
+    auto it = _entries.find(key);
+    if (it == _entries.end())
+    {
+        return;
+    }
+
+    int pageIndex = it->second.page;
+    releaseEntry(it->second);
+    _entries.erase(it);
+
+    if (_pages[pageIndex]->usedArea == 0)
+    {
+        releasePage(pageIndex);
+    }
+}
+
+void DynamicAtlas::removeUnusedSpriteFrames()
+{
+    for (auto it = _entries.begin(); it != _entries.end(); /* nothing */)
+    {
+        if (it->second.frame->getReferenceCount() == 1)
+        {
+            CCLOG("cocos2d: DynamicAtlas: removing unused frame: %s", it->first.c_str());
+            releaseEntry(it->second);
+            it = _entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (int i = static_cast<int>(_pages.size()) - 1; i >= 0; --i)
+    {
+        if (_pages[i]->usedArea == 0)
+        {
+            releasePage(i);
+        }
+    }
+    purgeRetiredPages(false);
+}
+
+void DynamicAtlas::removeAll()
+{
+    for (auto& item : _entries)
+    {
+        item.second.frame->release();
+    }
+    _entries.clear();
+
+    while (!_pages.empty())
+    {
+        releasePage(static_cast<int>(_pages.size()) - 1);
+    }
+}
+
+void DynamicAtlas::defragment()
+{
+    removeUnusedSpriteFrames();
+    if (_pages.size() < 2)
+    {
+        return;
+    }
+
+    // repack the biggest images first into fresh pages
+    std::vector<Entry*> entries;
+    entries.reserve(_entries.size());
+    for (auto& item : _entries)
+    {
+        entries.push_back(&item.second);
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) {
+        return a->rect.height != b->rect.height ? a->rect.height > b->rect.height : a->rect.width > b->rect.width;
+    });
+
+    std::vector<Page*> oldPages;
+    oldPages.swap(_pages);
+
+    for (auto entry : entries)
+    {
+        Page* oldPage = oldPages[entry->page];
+        PackRect rect;
+        int pageIndex = -1;
+        for (size_t i = 0; i < _pages.size() && pageIndex < 0; ++i)
+        {
+            if (insert(_pages[i], entry->rect.width, entry->rect.height, &rect))
+            {
+                pageIndex = static_cast<int>(i);
+            }
+        }
+        if (pageIndex < 0)
+        {
+            // the pages are emptier than before, so a new page always has room
+            Page* page = createPage();
+            insert(page, entry->rect.width, entry->rect.height, &rect);
+            pageIndex = static_cast<int>(_pages.size()) - 1;
+        }
+
+        Page* page = _pages[pageIndex];
+        copyRect(page, rect, oldPage->pixels + (entry->rect.y * _pageSize + entry->rect.x) * BYTES_PER_PIXEL,
+                 _pageSize * BYTES_PER_PIXEL);
+
+        entry->frame->setTexture(page->texture);
+        entry->frame->setRectInPixels(Rect(rect.x + ATLAS_PADDING, rect.y + ATLAS_PADDING,
+                                           rect.width - 2 * ATLAS_PADDING, rect.height - 2 * ATLAS_PADDING));
+        entry->page = pageIndex;
+        entry->rect = rect;
+    }
+
+    for (size_t i = 0; i < _pages.size(); ++i)
+    {
+        uploadPage(static_cast<int>(i));
+    }
+
+    for (auto page : oldPages)
+    {
+        destroyPage(page);
+    }
+}
+
+float DynamicAtlas::getOccupancy() const
+{
+    if (_pages.empty())
+    {
+        return 0.0f;
+    }
+
+    double used = 0;
+    for (auto page : _pages)
+    {
+        used += page->usedArea;
+    }
+    return static_cast<float>(used / (static_cast<double>(_pageSize) * _pageSize * _pages.size()));
+}
+
+DynamicAtlas::Page* DynamicAtlas::createPage()
+{
+    Page* page = new (std::nothrow) Page();
+    page->pixels = static_cast<unsigned char*>(calloc(_pageSize * _pageSize, BYTES_PER_PIXEL));
+    page->texture = new (std::nothrow) Texture2D();
+    page->usedArea = 0;
+    PackRect all = { 0, 0, _pageSize, _pageSize };
+    page->freeRects.push_back(all);
+
+    _pages.push_back(page);
+    uploadPage(static_cast<int>(_pages.size()) - 1);
+    return page;
+}
+
+void DynamicAtlas::releasePage(int index)
+{
+    destroyPage(_pages[index]);
+    _pages.erase(_pages.begin() + index);
+
+    for (auto& item : _entries)
+    {
+        CCASSERT(item.second.page != index, "Releasing a page which still has frames");
+        if (item.second.page > index)
+        {
+            --item.second.page;
+        }
+    }
+}
+
+void DynamicAtlas::destroyPage(Page* page)
+{
+    // sprites still showing the page keep its pixels, so the texture can be restored after a context loss
+    if (page->texture->getReferenceCount() > 1)
+    {
+        _retiredPages.push_back(page);
+        return;
+    }
+    page->texture->release();
+    free(page->pixels);
+    delete page;
+}
+
+void DynamicAtlas::purgeRetiredPages(bool force)
+{
+    for (auto it = _retiredPages.begin(); it != _retiredPages.end(); /* nothing */)
+    {
+        Page* page = *it;
+        if (force || page->texture->getReferenceCount() == 1)
+        {
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+            // a texture outliving the atlas mustn't be reloaded from the freed pixels
+            VolatileTextureMgr::removeTexture(page->texture);
+#endif
+            page->texture->release();
+            free(page->pixels);
+            delete page;
+            it = _retiredPages.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void DynamicAtlas::uploadPage(int index)
+{
+    Page* page = _pages[index];
+    ssize_t dataLen = _pageSize * _pageSize * BYTES_PER_PIXEL;
+    page->texture->initWithData(page->pixels, dataLen, Texture2D::PixelFormat::RGBA8888,
+                                _pageSize, _pageSize, Size(_pageSize, _pageSize));
+    page->texture->_hasPremultipliedAlpha = true;
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // the page pixels are kept up to date, so they can be uploaded again after the context is lost
+    VolatileTextureMgr::addDataTexture(page->texture, page->pixels, static_cast<int>(dataLen),
+                                       Texture2D::PixelFormat::RGBA8888, Size(_pageSize, _pageSize));
+#endif
+}
+
+bool DynamicAtlas::insert(Page* page, int width, int height, PackRect* outRect)
+{
+    // best short side fit
+    int bestShortSide = INT_MAX;
+    int bestLongSide = INT_MAX;
+    bool found = false;
+    for (const auto& free : page->freeRects)
+    {
+        if (free.width >= width && free.height >= height)
+        {
+            int leftoverX = free.width - width;
+            int leftoverY = free.height - height;
+            int shortSide = std::min(leftoverX, leftoverY);
+            int longSide = std::max(leftoverX, leftoverY);
+            if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+            {
+                outRect->x = free.x;
+                outRect->y = free.y;
+                outRect->width = width;
+                outRect->height = height;
+                bestShortSide = shortSide;
+                bestLongSide = longSide;
+                found = true;
+            }
+        }
+    }
+
+    if (found)
+    {
+        placeRect(page, *outRect);
+    }
+    return found;
+}
+
+void DynamicAtlas::placeRect(Page* page, const PackRect& used)
+{
+    // split every free rect overlapping the used one into its up to four remaining sides
+    std::vector<PackRect> splits;
+    for (auto it = page->freeRects.begin(); it != page->freeRects.end(); /* nothing */)
+    {
+        const PackRect free = *it;
+        if (used.x >= free.x + free.width || used.x + used.width <= free.x
+            || used.y >= free.y + free.height || used.y + used.height <= free.y)
+        {
+            ++it;
+            continue;
+        }
+
+        if (used.x > free.x)
+        {
+            PackRect r = { free.x, free.y, used.x - free.x, free.height };
+            splits.push_back(r);
+        }
+        if (used.x + used.width < free.x + free.width)
+        {
+            PackRect r = { used.x + used.width, free.y, free.x + free.width - used.x - used.width, free.height };
+            splits.push_back(r);
+        }
+        if (used.y > free.y)
+        {
+            PackRect r = { free.x, free.y, free.width, used.y - free.y };
+            splits.push_back(r);
+        }
+        if (used.y + used.height < free.y + free.height)
+        {
+            PackRect r = { free.x, used.y + used.height, free.width, free.y + free.height - used.y - used.height };
+            splits.push_back(r);
+        }
+        it = page->freeRects.erase(it);
+    }
+
+    page->freeRects.insert(page->freeRects.end(), splits.begin(), splits.end());
+    page->usedArea += used.width * used.height;
+    pruneFreeRects(page);
+}
+
+void DynamicAtlas::freeRect(Page* page, const PackRect& rect)
+{
+    page->usedArea -= rect.width * rect.height;
+    if (page->usedArea == 0)
+    {
+        page->freeRects.clear();
+        PackRect all = { 0, 0, _pageSize, _pageSize };
+        page->freeRects.push_back(all);
+        return;
+    }
+
+    page->freeRects.push_back(rect);
+    pruneFreeRects(page);
+}
+
+void DynamicAtlas::pruneFreeRects(Page* page)
+{
+    auto contains = [](const PackRect& a, const PackRect& b) {
+        return b.x >= a.x && b.y >= a.y
+            && b.x + b.width <= a.x + a.width
+            && b.y + b.height <= a.y + a.height;
+    };
+
+    auto& rects = page->freeRects;
+    for (size_t i = 0; i < rects.size(); ++i)
+    {
+        for (size_t j = i + 1; j < rects.size(); /* nothing */)
+        {
+            if (contains(rects[i], rects[j]))
+            {
+                rects.erase(rects.begin() + j);
+            }
+            else if (contains(rects[j], rects[i]))
+            {
+                rects.erase(rects.begin() + i);
+                --i;
+                break;
+            }
+            else
+            {
+                ++j;
+            }
+        }
+    }
+}
+
+void DynamicAtlas::copyRect(Page* page, const PackRect& rect, const unsigned char* data, int stride)
+{
+    for (int row = 0; row < rect.height; ++row)
+    {
+        memcpy(page->pixels + ((rect.y + row) * _pageSize + rect.x) * BYTES_PER_PIXEL,
+               data + row * stride,
+               rect.width * BYTES_PER_PIXEL);
+    }
+}
+
+void DynamicAtlas::releaseEntry(Entry& entry)
+{
+    freeRect(_pages[entry.page], entry.rect);
+    entry.frame->release();
+}
+
+NS_CC_END
@@ -0,0 +1,174 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCDYNAMIC_ATLAS_H__
+#define __CCDYNAMIC_ATLAS_H__
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "base/CCRef.h"
+#include "math/CCGeometry.h"
+
+NS_CC_BEGIN
+
+class Image;
+class Texture2D;
+class SpriteFrame;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @brief DynamicAtlas packs small, individually loaded images into shared RGBA8888 texture pages at runtime.
+ *
+ * Sprites whose frames come from the same page share one texture, so their QuadCommands and
+ * TrianglesCommands get the same material id and are batched together.
+ * Pages are packed with the MaxRects algorithm (best short side fit). Each page keeps a CPU copy
+ * of its pixels, used to restore the texture after a context loss and to defragment. A released
+ * page whose texture is still retained, e.g. by a sprite, keeps that copy until the texture is only
+ * retained by the atlas.
+ *
+ * It is owned by TextureCache, use TextureCache::getDynamicAtlas() to get it.
+ */
+class CC_DLL DynamicAtlas : public Ref
+{
+public:
+    /**
+     * @js ctor
+     */
+    DynamicAtlas();
+    /**
+     * @js NA
+     * @lua NA
+     */
+    virtual ~DynamicAtlas();
+
+    /** Sets the page size and how many pages can be created. Removes the packed images.
+     @param pageSize Width and height of the pages in pixels.
+     @param maxPages The maximum number of pages.
+     */
+    bool init(int pageSize, int maxPages);
+
+    /** Returns the frame of an image file packed into a page.
+     * If the file was not packed before it is loaded and packed, otherwise the packed frame is returned.
+     * Returns nullptr if the image is compressed, bigger than getMaxImageSize(), or doesn't fit
+     * even after removing unused frames. Load it with TextureCache::addImage in that case.
+     @param filepath The image file.
+     */
+    SpriteFrame* addImage(const std::string& filepath);
+
+    /** Returns the frame of an image packed into a page, using key to identify it.
+     @param image The image, it isn't retained.
+     @param key The key of the image.
+     */
+    SpriteFrame* addImage(Image* image, const std::string& key);
+
+    /** Returns the frame packed for key, or nullptr. */
+    SpriteFrame* getSpriteFrame(const std::string& key) const;
+
+    /** Frees the space of a packed image. Sprites still using its frame will show whatever is packed there next. */
+    void removeSpriteFrame(const std::string& key);
+
+    /** Frees the space of the packed images whose frame is only retained by the atlas.
+     * Pages which become empty are released.
+     */
+    void removeUnusedSpriteFrames();
+
+    /** Removes all the packed images and releases the pages. */
+    void removeAll();
+
+    /** Removes the unused frames. If more than one page is left, the remaining images are copied,
+     * tallest first, into new pages, which usually needs fewer of them, and the old pages are released.
+     * The frames are updated in place with their new texture and rect. Sprites copy the texture and
+     * rect when the frame is set, so they keep showing the old page until their frame is set again.
+     */
+    void defragment();
+
+    /** Images whose width or height is bigger than this aren't packed. Default is 256. */
+    void setMaxImageSize(int size) { _maxImageSize = size; }
+    int getMaxImageSize() const { return _maxImageSize; }
+
+    int getPageSize() const { return _pageSize; }
+    /** Number of pages currently allocated. */
+    ssize_t getPageCount() const { return _pages.size(); }
+    /** Number of packed images. */
+    ssize_t getSpriteFrameCount() const { return _entries.size(); }
+    /** Fraction of the allocated page area used by packed images, padding included. */
+    float getOccupancy() const;
+
+protected:
+    struct PackRect
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    struct Page
+    {
+        Texture2D* texture;
+        unsigned char* pixels;
+        std::vector<PackRect> freeRects;
+        int usedArea;
+    };
+
+    struct Entry
+    {
+        SpriteFrame* frame;
+        int page;
+        // includes the padding around the image
+        PackRect rect;
+    };
+
+    Page* createPage();
+    void releasePage(int index);
+    void destroyPage(Page* page);
+    void purgeRetiredPages(bool force);
+    void uploadPage(int index);
+    bool insert(Page* page, int width, int height, PackRect* outRect);
+    void placeRect(Page* page, const PackRect& rect);
+    void freeRect(Page* page, const PackRect& rect);
+    void pruneFreeRects(Page* page);
+    void copyRect(Page* page, const PackRect& rect, const unsigned char* data, int stride);
+    void releaseEntry(Entry& entry);
+
+    int _pageSize;
+    int _maxPages;
+    int _maxImageSize;
+    std::vector<Page*> _pages;
+    // released pages whose texture is still retained by someone else
+    std::vector<Page*> _retiredPages;
+    std::unordered_map<std::string, Entry> _entries;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__CCDYNAMIC_ATLAS_H__
@@ -177,6 +177,8 @@ public:
     static const char* SHADER_NAME_POSITION_U_COLOR;
     /**Built in shader for draw a sector with 90 degrees with center at bottom left point.*/
     static const char* SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR;
+    /**Built in shader for DrawNode batching. Same as SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR, but the vertices are already transformed by the model view matrix.*/
+    static const char* SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR_NO_MVP;
 
     /**Built in shader for ui effects */
     static const char* SHADER_NAME_POSITION_GRAYSCALE;
@@ -187,6 +189,7 @@ public:
     static const char* SHADER_NAME_LABEL_OUTLINE;
     static const char* SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL;
     static const char* SHADER_NAME_LABEL_DISTANCEFIELD_GLOW;
+    static const char* SHADER_NAME_LABEL_DISTANCEFIELD_MULTICHANNEL;
 
     /**Built in shader used for 3D, support Position vertex attribute, with color specified by a uniform.*/
     static const char* SHADER_3D_POSITION;
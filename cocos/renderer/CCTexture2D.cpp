@@ -998,6 +998,61 @@ Texture2D::PixelFormat Texture2D::convertRGBA8888ToFormat(const unsigned char* d
     return format;
 }
 
+Texture2D::ConvertFunction Texture2D::getConvertFunction(PixelFormat originFormat, PixelFormat format)
+{
+    switch (originFormat)
+    {
+    case PixelFormat::I8:
+        switch (format)
+        {
+        case PixelFormat::RGBA8888: return convertI8ToRGBA8888;
+        case PixelFormat::RGB888:   return convertI8ToRGB888;
+        case PixelFormat::RGB565:   return convertI8ToRGB565;
+        case PixelFormat::AI88:     return convertI8ToAI88;
+        case PixelFormat::RGBA4444: return convertI8ToRGBA4444;
+        case PixelFormat::RGB5A1:   return convertI8ToRGB5A1;
+        default:                    return nullptr;
+        }
+    case PixelFormat::AI88:
+        switch (format)
+        {
+        case PixelFormat::RGBA8888: return convertAI88ToRGBA8888;
+        case PixelFormat::RGB888:   return convertAI88ToRGB888;
+        case PixelFormat::RGB565:   return convertAI88ToRGB565;
+        case PixelFormat::A8:       return convertAI88ToA8;
+        case PixelFormat::I8:       return convertAI88ToI8;
+        case PixelFormat::RGBA4444: return convertAI88ToRGBA4444;
+        case PixelFormat::RGB5A1:   return convertAI88ToRGB5A1;
+        default:                    return nullptr;
+        }
+    case PixelFormat::RGB888:
+        switch (format)
+        {
+        case PixelFormat::RGBA8888: return convertRGB888ToRGBA8888;
+        case PixelFormat::RGB565:   return convertRGB888ToRGB565;
+        case PixelFormat::I8:       return convertRGB888ToI8;
+        case PixelFormat::AI88:     return convertRGB888ToAI88;
+        case PixelFormat::RGBA4444: return convertRGB888ToRGBA4444;
+        case PixelFormat::RGB5A1:   return convertRGB888ToRGB5A1;
+        default:                    return nullptr;
+        }
+    case PixelFormat::RGBA8888:
+        switch (format)
+        {
+        case PixelFormat::RGB888:   return convertRGBA8888ToRGB888;
+        case PixelFormat::RGB565:   return convertRGBA8888ToRGB565;
+        case PixelFormat::A8:       return convertRGBA8888ToA8;
+        case PixelFormat::I8:       return convertRGBA8888ToI8;
+        case PixelFormat::AI88:     return convertRGBA8888ToAI88;
+        case PixelFormat::RGBA4444: return convertRGBA8888ToRGBA4444;
+        case PixelFormat::RGB5A1:   return convertRGBA8888ToRGB5A1;
+        default:                    return nullptr;
+        }
+    default:
+        return nullptr;
+    }
+}
+
 /*
 convert map:
 1.PixelFormat::RGBA8888
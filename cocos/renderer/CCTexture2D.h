@@ -468,6 +468,13 @@ private:
     static PixelFormat convertRGB888ToFormat(const unsigned char* data, ssize_t dataLen, PixelFormat format, unsigned char** outData, ssize_t* outDataLen);
     static PixelFormat convertRGBA8888ToFormat(const unsigned char* data, ssize_t dataLen, PixelFormat format, unsigned char** outData, ssize_t* outDataLen);
 
+    typedef void (*ConvertFunction)(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    /**
+    Get the function which converts originFormat pixels to format into a caller-provided buffer.
+    It allocates nothing, so it can be applied row by row while decoding. Returns nullptr if the conversion isn't supported.
+    */
+    static ConvertFunction getConvertFunction(PixelFormat originFormat, PixelFormat format);
+
     //I8 to XXX
     static void convertI8ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
     static void convertI8ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
@@ -539,6 +546,8 @@ protected:
     NinePatchInfo* _ninePatchInfo;
     friend class SpriteFrameCache;
     friend class TextureCache;
+    friend class Image;
+    friend class DynamicAtlas;
     friend class ui::Scale9Sprite;
 };
 
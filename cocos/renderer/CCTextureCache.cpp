@@ -41,6 +41,7 @@ THE SOFTWARE.
 
 #include "deprecated/CCString.h"
 #include "base/CCNinePatchImageParser.h"
+#include "renderer/CCDynamicAtlas.h"
 
 
 
@@ -59,6 +60,8 @@ TextureCache::TextureCache()
 : _loadingThread(nullptr)
 , _needQuit(false)
 , _asyncRefCount(0)
+, _dynamicAtlas(nullptr)
+, _dynamicAtlasEnabled(false)
 {
 }
 
@@ -69,6 +72,7 @@ TextureCache::~TextureCache()
     for( auto it=_textures.begin(); it!=_textures.end(); ++it)
         (it->second)->release();
 
+    CC_SAFE_RELEASE(_dynamicAtlas);
     CC_SAFE_DELETE(_loadingThread);
 }
 
@@ -93,10 +97,13 @@ std::string TextureCache::getDescription() const
 struct TextureCache::AsyncStruct
 {
 public:
-    AsyncStruct(const std::string& fn, std::function<void(Texture2D*)> f) : filename(fn), callback(f), loadSuccess(false) {}
+    AsyncStruct(const std::string& fn, std::function<void(Texture2D*)> f, Texture2D::PixelFormat format)
+    : filename(fn), callback(f), pixelFormat(format), loadSuccess(false) {}
     
     std::string filename;
     std::function<void(Texture2D*)> callback;
+    // format the texture is created with, the load thread decodes straight into it
+    Texture2D::PixelFormat pixelFormat;
     Image image;
     bool loadSuccess;
 };
@@ -165,7 +172,7 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
     ++_asyncRefCount;
 
     // generate async struct
-    AsyncStruct *data = new (std::nothrow) AsyncStruct(fullpath, callback);
+    AsyncStruct *data = new (std::nothrow) AsyncStruct(fullpath, callback, Texture2D::getDefaultAlphaPixelFormat());
     
     // add async struct into queue
     _asyncStructQueue.push_back(data);
@@ -230,6 +237,10 @@ void TextureCache::loadImage()
         }
         
         // load image
+        if (!NinePatchImageParser::isNinePatchImage(asyncStruct->filename))
+        {
+            asyncStruct->image.setDecodeTarget(asyncStruct->pixelFormat);
+        }
         asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileThreadSafe(asyncStruct->filename);
 
         // push the asyncStruct to response queue
@@ -280,7 +291,7 @@ void TextureCache::addImageAsyncCallBack(float dt)
                 // generate texture in render thread
                 texture = new (std::nothrow) Texture2D();
                 
-                texture->initWithImage(image);
+                texture->initWithImage(image, asyncStruct->pixelFormat);
                 //parse 9-patch info
                 this->parseNinePatchImage(image, texture, asyncStruct->filename);
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -340,6 +351,11 @@ Texture2D * TextureCache::addImage(const std::string &path)
             image = new (std::nothrow) Image();
             CC_BREAK_IF(nullptr == image);
 
+            // 9-patch parsing reads the RGBA8888 pixels, the others are decoded in their texture format
+            if (!NinePatchImageParser::isNinePatchImage(path))
+            {
+                image->setDecodeTarget(Texture2D::getDefaultAlphaPixelFormat());
+            }
             bool bRet = image->initWithImageFile(fullpath);
             CC_BREAK_IF(!bRet);
 
@@ -466,6 +482,11 @@ void TextureCache::removeAllTextures()
         (it->second)->release();
     }
     _textures.clear();
+
+    if (_dynamicAtlas)
+    {
+        _dynamicAtlas->removeAll();
+    }
 }
 
 void TextureCache::removeUnusedTextures()
@@ -482,6 +503,11 @@ void TextureCache::removeUnusedTextures()
         }
 
     }
+
+    if (_dynamicAtlas)
+    {
+        _dynamicAtlas->removeUnusedSpriteFrames();
+    }
 }
 
 void TextureCache::removeTexture(Texture2D* texture)
@@ -553,6 +579,15 @@ const std::string TextureCache::getTextureFilePath( cocos2d::Texture2D *texture
     return "";
 }
 
+DynamicAtlas* TextureCache::getDynamicAtlas()
+{
+    if (_dynamicAtlas == nullptr)
+    {
+        _dynamicAtlas = new (std::nothrow) DynamicAtlas();
+    }
+    return _dynamicAtlas;
+}
+
 void TextureCache::waitForQuit()
 {
     // notify sub thread to quick
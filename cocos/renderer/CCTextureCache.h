@@ -48,6 +48,8 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+class DynamicAtlas;
+
 /**
  * @addtogroup _2d
  * @{
@@ -204,6 +206,19 @@ public:
      */
     const std::string getTextureFilePath(Texture2D* texture)const;
 
+    /** Get the dynamic atlas, which packs small individually loaded images into shared texture pages.
+     * It is created the first time it is needed.
+     */
+    DynamicAtlas* getDynamicAtlas();
+
+    /** Enables or disables packing the images of Sprite::create(filename) into the dynamic atlas.
+     * Sprites created from packed images share a texture, so they can be batched.
+     * Images the atlas can't pack are loaded with addImage as usual.
+     * By default it is disabled.
+     */
+    void setDynamicAtlasEnabled(bool enabled) { _dynamicAtlasEnabled = enabled; }
+    bool isDynamicAtlasEnabled() const { return _dynamicAtlasEnabled; }
+
 private:
     void addImageAsyncCallBack(float dt);
     void loadImage();
@@ -228,6 +243,9 @@ protected:
     int _asyncRefCount;
 
     std::unordered_map<std::string, Texture2D*> _textures;
+
+    DynamicAtlas* _dynamicAtlas;
+    bool _dynamicAtlasEnabled;
 };
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -0,0 +1,26 @@
+const char* ccLabelDistanceFieldMultiChannel_frag = STRINGIFY(
+
+\n#ifdef GL_ES\n
+precision lowp float; 
+\n#endif\n
+ 
+varying vec4 v_fragmentColor; 
+varying vec2 v_texCoord;
+
+uniform vec4 u_textColor;
+
+float median(float r, float g, float b)
+{
+    return max(min(r, g), min(max(r, g), b));
+}
+ 
+void main() 
+{
+    vec4 color = texture2D(CC_Texture0, v_texCoord);
+    // the median of the 3 channels gives the distance, keeping the corners of the glyph sharp \n
+    float dist = median(color.r, color.g, color.b);
+    float width = 0.04; 
+    float alpha = smoothstep(0.5-width, 0.5+width, dist) * u_textColor.a; 
+    gl_FragColor = v_fragmentColor * vec4(u_textColor.rgb,alpha);
+}
+);
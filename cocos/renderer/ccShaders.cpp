@@ -75,12 +75,14 @@ NS_CC_BEGIN
 
 #include "ccShader_PositionColorLengthTexture.frag"
 #include "ccShader_PositionColorLengthTexture.vert"
+#include "ccShader_PositionColorLengthTexture_noMVP.vert"
 
 #include "ccShader_UI_Gray.frag"
 //
 #include "ccShader_Label.vert"
 #include "ccShader_Label_df.frag"
 #include "ccShader_Label_df_glow.frag"
+#include "ccShader_Label_df_multichannel.frag"
 #include "ccShader_Label_normal.frag"
 #include "ccShader_Label_outline.frag"
 
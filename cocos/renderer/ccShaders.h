@@ -65,11 +65,13 @@ extern CC_DLL const GLchar * ccPositionTexture_uColor_vert;
 
 extern CC_DLL const GLchar * ccPositionColorLengthTexture_frag;
 extern CC_DLL const GLchar * ccPositionColorLengthTexture_vert;
+extern CC_DLL const GLchar * ccPositionColorLengthTexture_noMVP_vert;
 
 extern CC_DLL const GLchar * ccPositionTexture_GrayScale_frag;
 
 extern CC_DLL const GLchar * ccLabelDistanceFieldNormal_frag;
 extern CC_DLL const GLchar * ccLabelDistanceFieldGlow_frag;
+extern CC_DLL const GLchar * ccLabelDistanceFieldMultiChannel_frag;
 extern CC_DLL const GLchar * ccLabelNormal_frag;
 extern CC_DLL const GLchar * ccLabelOutline_frag;
 
@@ -0,0 +1,92 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "Benchmark.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    struct RegisteredBenchmark
+    {
+        const char* name;
+        benchmark::BenchmarkFunction function;
+    };
+
+    std::vector<RegisteredBenchmark>& getBenchmarks()
+    {
+        static std::vector<RegisteredBenchmark> benchmarks;
+        return benchmarks;
+    }
+}
+
+namespace benchmark
+{
+    bool registerBenchmark(const char* name, BenchmarkFunction function)
+    {
+        getBenchmarks().push_back({ name, function });
+        return true;
+    }
+
+    double measure(const char* label, double itemsPerRun, const std::function<void()>& work, double minSeconds)
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        // one untimed run to warm up caches and allocators
+        work();
+
+        long runs = 0;
+        double seconds = 0.0;
+        auto start = Clock::now();
+        do
+        {
+            work();
+            ++runs;
+            seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (seconds < minSeconds);
+
+        double rate = runs * itemsPerRun / seconds;
+        printf("  %-40s %12.1f /s  (%.3f ms per run)\n", label, rate, seconds * 1000.0 / runs);
+        return rate;
+    }
+}
+
+// Runs every benchmark, or only those whose names contain the first argument.
+int main(int argc, char* argv[])
+{
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    for (const auto& entry : getBenchmarks())
+    {
+        if (filter && strstr(entry.name, filter) == nullptr)
+            continue;
+
+        printf("%s\n", entry.name);
+        entry.function();
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <functional>
+
+/**
+ * A minimal headless benchmark harness. Benchmarks register themselves with BENCHMARK and report
+ * their rates with benchmark::measure, which repeats a workload until it ran for a while.
+ */
+namespace benchmark
+{
+    typedef void (*BenchmarkFunction)();
+
+    /** Registers a benchmark, used by BENCHMARK. */
+    bool registerBenchmark(const char* name, BenchmarkFunction function);
+
+    /**
+     * Runs work until at least minSeconds passed and prints how many items per second it processed.
+     * @param label What is measured, printed before the rate.
+     * @param itemsPerRun How many items one call of work processes.
+     * @return Items per second.
+     */
+    double measure(const char* label, double itemsPerRun, const std::function<void()>& work, double minSeconds = 1.0);
+}
+
+#define BENCHMARK(name) \
+    static void benchmark_##name(); \
+    static bool benchmarkRegistered_##name = benchmark::registerBenchmark(#name, benchmark_##name); \
+    static void benchmark_##name()
+
+#endif // __BENCHMARK_H__
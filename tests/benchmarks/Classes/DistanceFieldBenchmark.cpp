@@ -0,0 +1,153 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "Benchmark.h"
+#include "2d/CCFontFreeType.h"
+#include "edtaa3func.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+USING_NS_CC;
+
+namespace
+{
+    struct GlyphBitmap
+    {
+        int width;
+        int height;
+        std::vector<unsigned char> pixels;
+    };
+
+    // Glyph sized coverage bitmaps, as FreeType renders a 32px font: rings, stems and bowls of varying
+    // stroke width, antialiased with 4x4 supersampling.
+    std::vector<GlyphBitmap> makeGlyphs(int count)
+    {
+        std::vector<GlyphBitmap> glyphs;
+        for (int i = 0; i < count; ++i)
+        {
+            GlyphBitmap glyph;
+            glyph.width = 14 + i % 9;
+            glyph.height = 18 + i % 7;
+            glyph.pixels.resize(glyph.width * glyph.height);
+
+            float stroke = 2.0f + (i % 3);
+            float centerX = glyph.width * 0.5f;
+            float centerY = glyph.height * 0.5f;
+            float radius = std::min(centerX, centerY) - 1.0f;
+            for (int y = 0; y < glyph.height; ++y)
+            {
+                for (int x = 0; x < glyph.width; ++x)
+                {
+                    int covered = 0;
+                    for (int s = 0; s < 16; ++s)
+                    {
+                        float px = x + (s % 4 + 0.5f) / 4;
+                        float py = y + (s / 4 + 0.5f) / 4;
+                        float distance = sqrtf((px - centerX) * (px - centerX) + (py - centerY) * (py - centerY));
+                        bool ring = fabsf(distance - radius + stroke * 0.5f) < stroke * 0.5f;
+                        bool stem = (i & 1) && px > 1.0f && px < 1.0f + stroke;
+                        bool bar = (i & 2) && fabsf(py - centerY) < stroke * 0.5f;
+                        if (ring || stem || bar)
+                            ++covered;
+                    }
+                    glyph.pixels[y * glyph.width + x] = (unsigned char)std::min(255, covered * 16);
+                }
+            }
+            glyphs.push_back(glyph);
+        }
+        return glyphs;
+    }
+
+    // The edtaa3 based makeDistanceMap that FontFreeType used before, kept as the baseline.
+    unsigned char* makeDistanceMapEdtaa3(const unsigned char* img, long width, long height)
+    {
+        const long spread = FontFreeType::DistanceMapSpread;
+        long outWidth = width + 2 * spread;
+        long outHeight = height + 2 * spread;
+        long pixelAmount = outWidth * outHeight;
+
+        std::vector<short> xdist(pixelAmount);
+        std::vector<short> ydist(pixelAmount);
+        std::vector<double> gx(pixelAmount);
+        std::vector<double> gy(pixelAmount);
+        std::vector<double> data(pixelAmount);
+        std::vector<double> outside(pixelAmount);
+        std::vector<double> inside(pixelAmount);
+
+        for (long j = 0; j < height; ++j)
+        {
+            for (long i = 0; i < width; ++i)
+            {
+                data[(j + spread) * outWidth + spread + i] = img[j * width + i] / 255.0;
+            }
+        }
+
+        computegradient(data.data(), (int)outWidth, (int)outHeight, gx.data(), gy.data());
+        edtaa3(data.data(), gx.data(), gy.data(), (int)outWidth, (int)outHeight, xdist.data(), ydist.data(), outside.data());
+        for (long i = 0; i < pixelAmount; ++i)
+        {
+            outside[i] = std::max(0.0, outside[i]);
+            data[i] = 1 - data[i];
+        }
+        computegradient(data.data(), (int)outWidth, (int)outHeight, gx.data(), gy.data());
+        edtaa3(data.data(), gx.data(), gy.data(), (int)outWidth, (int)outHeight, xdist.data(), ydist.data(), inside.data());
+
+        unsigned char* out = new unsigned char[pixelAmount];
+        for (long i = 0; i < pixelAmount; ++i)
+        {
+            double dist = 128.0 - (outside[i] - std::max(0.0, inside[i])) * 16;
+            out[i] = (unsigned char)std::max(0.0, std::min(255.0, dist));
+        }
+        return out;
+    }
+}
+
+BENCHMARK(DistanceField)
+{
+    const int glyphCount = 64;
+    auto glyphs = makeGlyphs(glyphCount);
+
+    double paddedPixels = 0.0;
+    for (const auto& glyph : glyphs)
+    {
+        paddedPixels += (glyph.width + 2.0 * FontFreeType::DistanceMapSpread) * (glyph.height + 2.0 * FontFreeType::DistanceMapSpread);
+    }
+
+    double baseline = benchmark::measure("edtaa3 glyphs", glyphCount, [&]() {
+        for (const auto& glyph : glyphs)
+            delete [] makeDistanceMapEdtaa3(glyph.pixels.data(), glyph.width, glyph.height);
+    });
+    double current = benchmark::measure("FontFreeType::makeDistanceMap glyphs", glyphCount, [&]() {
+        for (const auto& glyph : glyphs)
+            delete [] FontFreeType::makeDistanceMap(glyph.pixels.data(), glyph.width, glyph.height);
+    });
+
+    printf("  speedup %.1fx\n", current / baseline);
+    // SDF pages store one byte per pixel, MSDF pages are RGBA8888
+    printf("  atlas bytes per glyph: SDF %.0f, MSDF %.0f\n", paddedPixels / glyphCount, paddedPixels * 4 / glyphCount);
+}
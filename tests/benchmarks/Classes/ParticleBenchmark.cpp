@@ -0,0 +1,209 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "Benchmark.h"
+#include "2d/CCParticleSystem.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+USING_NS_CC;
+
+namespace
+{
+    const int PARTICLE_COUNT = 100000;
+    const float FRAME_TIME = 1.0f / 60;
+
+    // The particle struct and update loop ParticleSystem used before it stored particles as arrays, kept as the
+    // baseline. updateQuadWithParticle is left out, the benchmark measures the simulation only.
+    struct LegacyParticle
+    {
+        Vec2 pos;
+        Vec2 startPos;
+        Color4F color;
+        Color4F deltaColor;
+        float size;
+        float deltaSize;
+        float rotation;
+        float deltaRotation;
+        float timeToLive;
+        unsigned int atlasIndex;
+        struct {
+            Vec2 dir;
+            float radialAccel;
+            float tangentialAccel;
+        } modeA;
+        struct {
+            float angle;
+            float degreesPerSecond;
+            float radius;
+            float deltaRadius;
+        } modeB;
+    };
+
+    void updateLegacyParticles(std::vector<LegacyParticle>& particles, bool gravityMode, const Vec2& gravity, float dt)
+    {
+        const float yCoordFlipped = 1.0f;
+        for (auto& particle : particles)
+        {
+            LegacyParticle* p = &particle;
+            p->timeToLive -= dt;
+            if (p->timeToLive <= 0)
+                continue;
+
+            if (gravityMode)
+            {
+                Vec2 tmp, radial, tangential;
+                if (p->pos.x || p->pos.y)
+                {
+                    radial = p->pos.getNormalized();
+                }
+                tangential = radial;
+                radial = radial * p->modeA.radialAccel;
+
+                float newy = tangential.x;
+                tangential.x = -tangential.y;
+                tangential.y = newy;
+                tangential = tangential * p->modeA.tangentialAccel;
+
+                tmp = radial + tangential + gravity;
+                tmp = tmp * dt;
+                p->modeA.dir = p->modeA.dir + tmp;
+                tmp = p->modeA.dir * dt * yCoordFlipped;
+                p->pos = p->pos + tmp;
+            }
+            else
+            {
+                p->modeB.angle += p->modeB.degreesPerSecond * dt;
+                p->modeB.radius += p->modeB.deltaRadius * dt;
+                p->pos.x = - cosf(p->modeB.angle) * p->modeB.radius;
+                p->pos.y = - sinf(p->modeB.angle) * p->modeB.radius;
+                p->pos.y *= yCoordFlipped;
+            }
+
+            p->color.r += (p->deltaColor.r * dt);
+            p->color.g += (p->deltaColor.g * dt);
+            p->color.b += (p->deltaColor.b * dt);
+            p->color.a += (p->deltaColor.a * dt);
+
+            p->size += (p->deltaSize * dt);
+            p->size = MAX(0, p->size);
+
+            p->rotation += (p->deltaRotation * dt);
+        }
+    }
+
+    // exposes the simulation step, without a texture or quads it only runs the integration passes
+    class BenchmarkParticleSystem : public ParticleSystem
+    {
+    public:
+        static BenchmarkParticleSystem* create(ParticleSystem::Mode mode)
+        {
+            auto system = new (std::nothrow) BenchmarkParticleSystem();
+            if (system && system->initWithTotalParticles(PARTICLE_COUNT))
+            {
+                system->autorelease();
+                system->setEmitterMode(mode);
+                system->setPositionType(PositionType::GROUPED);
+                system->setLife(1e6f);
+                system->setEmissionRate(0);
+                system->setSpeed(50.0f);
+                system->setAngleVar(180.0f);
+                system->setGravity(Vec2(0.0f, -10.0f));
+                system->setRadialAccel(5.0f);
+                system->setTangentialAccel(3.0f);
+                system->setStartRadius(100.0f);
+                system->setEndRadius(0.0f);
+                system->setRotatePerSecond(60.0f);
+                system->setStartSize(16.0f);
+                system->setEndSize(4.0f);
+                system->setStartColor(Color4F(1.0f, 0.5f, 0.25f, 1.0f));
+                system->setEndColor(Color4F(0.0f, 0.0f, 0.0f, 0.0f));
+                system->setEndSpin(360.0f);
+                system->addParticles(PARTICLE_COUNT);
+                return system;
+            }
+            CC_SAFE_DELETE(system);
+            return nullptr;
+        }
+
+        using ParticleSystem::simulate;
+
+        // the same particles, as the legacy structs
+        std::vector<LegacyParticle> makeLegacyParticles() const
+        {
+            const ParticleData& data = _particleData;
+            std::vector<LegacyParticle> particles(_particleCount);
+            for (int i = 0; i < _particleCount; ++i)
+            {
+                LegacyParticle& p = particles[i];
+                p.pos = Vec2(data.posx[i], data.posy[i]);
+                p.startPos = Vec2(data.startPosX[i], data.startPosY[i]);
+                p.color = Color4F(data.colorR[i], data.colorG[i], data.colorB[i], data.colorA[i]);
+                p.deltaColor = Color4F(data.deltaColorR[i], data.deltaColorG[i], data.deltaColorB[i], data.deltaColorA[i]);
+                p.size = data.size[i];
+                p.deltaSize = data.deltaSize[i];
+                p.rotation = data.rotation[i];
+                p.deltaRotation = data.deltaRotation[i];
+                p.timeToLive = data.timeToLive[i];
+                p.atlasIndex = data.atlasIndex[i];
+                p.modeA.dir = Vec2(data.modeA.dirX[i], data.modeA.dirY[i]);
+                p.modeA.radialAccel = data.modeA.radialAccel[i];
+                p.modeA.tangentialAccel = data.modeA.tangentialAccel[i];
+                p.modeB.angle = data.modeB.angle[i];
+                p.modeB.degreesPerSecond = data.modeB.degreesPerSecond[i];
+                p.modeB.radius = data.modeB.radius[i];
+                p.modeB.deltaRadius = data.modeB.deltaRadius[i];
+            }
+            return particles;
+        }
+    };
+}
+
+BENCHMARK(ParticleSimulation)
+{
+    const Vec2 gravity(0.0f, -10.0f);
+    auto gravitySystem = BenchmarkParticleSystem::create(ParticleSystem::Mode::GRAVITY);
+    auto radiusSystem = BenchmarkParticleSystem::create(ParticleSystem::Mode::RADIUS);
+    auto gravityParticles = gravitySystem->makeLegacyParticles();
+    auto radiusParticles = radiusSystem->makeLegacyParticles();
+
+    double gravityBaseline = benchmark::measure("AoS loop, gravity mode, frames", 1, [&]() {
+        updateLegacyParticles(gravityParticles, true, gravity, FRAME_TIME);
+    });
+    double gravityCurrent = benchmark::measure("ParticleSystem, gravity mode, frames", 1, [&]() {
+        gravitySystem->simulate(FRAME_TIME);
+    });
+    printf("  gravity mode speedup %.1fx\n", gravityCurrent / gravityBaseline);
+
+    double radiusBaseline = benchmark::measure("AoS loop, radius mode, frames", 1, [&]() {
+        updateLegacyParticles(radiusParticles, false, Vec2::ZERO, FRAME_TIME);
+    });
+    double radiusCurrent = benchmark::measure("ParticleSystem, radius mode, frames", 1, [&]() {
+        radiusSystem->simulate(FRAME_TIME);
+    });
+    printf("  radius mode speedup %.1fx\n", radiusCurrent / radiusBaseline);
+}
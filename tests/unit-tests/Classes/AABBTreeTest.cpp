@@ -0,0 +1,220 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "UnitTest.h"
+#include "3d/CCAABBTree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+USING_NS_CC;
+
+namespace
+{
+    unsigned int s_seed = 1;
+
+    float randomFloat(float low, float high)
+    {
+        s_seed = s_seed * 1664525u + 1013904223u;
+        return low + (high - low) * ((s_seed >> 8) / float(1 << 24));
+    }
+
+    AABB randomAABB(float range, float maxSize)
+    {
+        Vec3 min(randomFloat(-range, range), randomFloat(-range, range), randomFloat(-range, range));
+        Vec3 size(randomFloat(0.1f, maxSize), randomFloat(0.1f, maxSize), randomFloat(0.1f, maxSize));
+        return AABB(min, min + size);
+    }
+
+    bool overlaps(const AABB& a, const AABB& b)
+    {
+        return a._min.x <= b._max.x && a._max.x >= b._min.x
+            && a._min.y <= b._max.y && a._max.y >= b._min.y
+            && a._min.z <= b._max.z && a._max.z >= b._min.z;
+    }
+
+    bool contains(const AABB& outer, const AABB& inner)
+    {
+        return outer._min.x <= inner._min.x && outer._min.y <= inner._min.y && outer._min.z <= inner._min.z
+            && outer._max.x >= inner._max.x && outer._max.y >= inner._max.y && outer._max.z >= inner._max.z;
+    }
+
+    // the proxies of the tree, checked against brute force queries of their fat aabbs
+    struct Objects
+    {
+        AABBTree tree;
+        std::vector<int> proxies;
+        std::vector<AABB> aabbs;
+
+        void add(const AABB& aabb)
+        {
+            int proxy = tree.createProxy(aabb, (void*)(intptr_t)(proxies.size() + 1));
+            proxies.push_back(proxy);
+            aabbs.push_back(aabb);
+        }
+
+        void remove(size_t index)
+        {
+            tree.destroyProxy(proxies[index]);
+            proxies[index] = proxies.back();
+            aabbs[index] = aabbs.back();
+            proxies.pop_back();
+            aabbs.pop_back();
+        }
+
+        int countQueryMismatches(const AABB& aabb) const
+        {
+            std::vector<int> result;
+            tree.query(aabb, result);
+            std::vector<int> expected;
+            for (auto proxy : proxies)
+            {
+                if (overlaps(tree.getFatAABB(proxy), aabb))
+                    expected.push_back(proxy);
+            }
+            return countMismatches(result, expected);
+        }
+
+        int countQueryMismatches(const Frustum& frustum) const
+        {
+            std::vector<int> result;
+            tree.query(frustum, result);
+            std::vector<int> expected;
+            for (auto proxy : proxies)
+            {
+                if (!frustum.isOutOfFrustum(tree.getFatAABB(proxy)))
+                    expected.push_back(proxy);
+            }
+            return countMismatches(result, expected);
+        }
+
+        static int countMismatches(std::vector<int>& result, std::vector<int>& expected)
+        {
+            std::sort(result.begin(), result.end());
+            std::sort(expected.begin(), expected.end());
+            if (result == expected)
+                return 0;
+            return std::max(1, std::abs((int)result.size() - (int)expected.size()));
+        }
+    };
+}
+
+UNIT_TEST(AABBTreeQueriesMatchBruteForce)
+{
+    s_seed = 3;
+    Objects objects;
+    for (int i = 0; i < 2000; ++i)
+        objects.add(randomAABB(500.f, 20.f));
+    EXPECT_EQ(2000, objects.tree.getProxyCount());
+
+    // the fat aabbs contain the objects, the user data is kept
+    int wrong = 0;
+    for (size_t i = 0; i < objects.proxies.size(); ++i)
+    {
+        if (!contains(objects.tree.getFatAABB(objects.proxies[i]), objects.aabbs[i]))
+            ++wrong;
+        if (objects.tree.getUserData(objects.proxies[i]) == nullptr)
+            ++wrong;
+    }
+    EXPECT_EQ(0, wrong);
+
+    int mismatches = 0;
+    for (int i = 0; i < 200; ++i)
+        mismatches += objects.countQueryMismatches(randomAABB(500.f, 150.f));
+    EXPECT_EQ(0, mismatches);
+
+    Mat4 projection;
+    Mat4::createPerspective(60.f, 1.5f, 1.f, 400.f, &projection);
+    for (int i = 0; i < 20; ++i)
+    {
+        Vec3 eye(randomFloat(-300.f, 300.f), randomFloat(-300.f, 300.f), randomFloat(-300.f, 300.f));
+        Vec3 target(randomFloat(-300.f, 300.f), randomFloat(-300.f, 300.f), randomFloat(-300.f, 300.f));
+        Mat4 view;
+        Mat4::createLookAt(eye, target, Vec3(0.f, 1.f, 0.f), &view);
+        Frustum frustum;
+        frustum.initFrustum(projection * view);
+        mismatches += objects.countQueryMismatches(frustum);
+    }
+    EXPECT_EQ(0, mismatches);
+
+    // balanced, 2000 leaves need 11 levels
+    EXPECT_TRUE(objects.tree.getHeight() <= 24);
+}
+
+UNIT_TEST(AABBTreeMovesAndDestroysProxies)
+{
+    s_seed = 5;
+    Objects objects;
+    for (int i = 0; i < 500; ++i)
+        objects.add(randomAABB(200.f, 10.f));
+
+    // a move within the margin keeps the fat aabb
+    AABB fat = objects.tree.getFatAABB(objects.proxies[0]);
+    AABB moved = objects.aabbs[0];
+    Vec3 nudge(0.1f * (moved._max.x - moved._min.x) * 0.5f, 0.f, 0.f);
+    moved._min += nudge;
+    moved._max += nudge;
+    EXPECT_FALSE(objects.tree.moveProxy(objects.proxies[0], moved));
+    EXPECT_TRUE(contains(fat, objects.tree.getFatAABB(objects.proxies[0])) && contains(objects.tree.getFatAABB(objects.proxies[0]), fat));
+
+    // far moves reinsert the proxies, removed ones leave the queries
+    int mismatches = 0;
+    for (int round = 0; round < 20; ++round)
+    {
+        for (size_t i = 0; i < objects.proxies.size(); i += 3)
+        {
+            AABB aabb = randomAABB(200.f, 10.f);
+            objects.tree.moveProxy(objects.proxies[i], aabb);
+            objects.aabbs[i] = aabb;
+        }
+        for (int i = 0; i < 10; ++i)
+            objects.remove((size_t)randomFloat(0.f, (float)objects.proxies.size() - 1.f));
+        for (int i = 0; i < 5; ++i)
+            objects.add(randomAABB(200.f, 10.f));
+
+        for (int i = 0; i < 20; ++i)
+            mismatches += objects.countQueryMismatches(randomAABB(200.f, 80.f));
+    }
+    EXPECT_EQ(0, mismatches);
+    EXPECT_EQ((int)objects.proxies.size(), objects.tree.getProxyCount());
+
+    int wrong = 0;
+    for (size_t i = 0; i < objects.proxies.size(); ++i)
+    {
+        if (!contains(objects.tree.getFatAABB(objects.proxies[i]), objects.aabbs[i]))
+            ++wrong;
+    }
+    EXPECT_EQ(0, wrong);
+    EXPECT_TRUE(objects.tree.getHeight() <= 20);
+
+    while (!objects.proxies.empty())
+        objects.remove(objects.proxies.size() - 1);
+    EXPECT_EQ(0, objects.tree.getProxyCount());
+    EXPECT_EQ(0, objects.tree.getHeight());
+    std::vector<int> result;
+    objects.tree.query(AABB(Vec3(-1e4f, -1e4f, -1e4f), Vec3(1e4f, 1e4f, 1e4f)), result);
+    EXPECT_EQ(0, (int)result.size());
+}
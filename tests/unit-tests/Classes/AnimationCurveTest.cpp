@@ -0,0 +1,198 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "UnitTest.h"
+#include "3d/CCAnimationCurve.h"
+
+#include <cmath>
+#include <vector>
+
+USING_NS_CC;
+
+namespace
+{
+    // a smooth path with a few sharp turns
+    void makePositionKeys(int count, std::vector<float>& keytime, std::vector<float>& value)
+    {
+        keytime.resize(count);
+        value.resize(count * 3);
+        for (int i = 0; i < count; ++i)
+        {
+            float t = (float)i / (count - 1);
+            keytime[i] = t;
+            value[i * 3] = 10.f * sinf(t * 6.f);
+            value[i * 3 + 1] = t < 0.5f ? t * 4.f : 4.f - t * 4.f;
+            value[i * 3 + 2] = -3.f + 2.f * t * t;
+        }
+    }
+
+    // random values, interpolating neighbours never reproduces a key
+    void makeNoiseKeys(int count, std::vector<float>& keytime, std::vector<float>& value)
+    {
+        keytime.resize(count);
+        value.resize(count * 3);
+        unsigned int seed = 12345;
+        for (int i = 0; i < count; ++i)
+        {
+            keytime[i] = (float)i / (count - 1);
+            for (int j = 0; j < 3; ++j)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                value[i * 3 + j] = (float)(seed >> 8) / (1 << 24);
+            }
+        }
+    }
+
+    float distance3(const float* a, const float* b)
+    {
+        return sqrtf((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+    }
+
+    // largest distance between the curve and the keys at the key times
+    float getErrorAtKeys(AnimationCurve<3>* curve, const std::vector<float>& keytime, const std::vector<float>& value)
+    {
+        float maxError = 0.f;
+        float result[3];
+        for (size_t i = 0; i < keytime.size(); ++i)
+        {
+            curve->evaluate(keytime[i], result, EvaluateType::INT_LINEAR);
+            maxError = std::max(maxError, distance3(result, &value[i * 3]));
+        }
+        return maxError;
+    }
+}
+
+UNIT_TEST(AnimationCurveCompressedPositionsRoundTrip)
+{
+    std::vector<float> keytime, value;
+    makePositionKeys(600, keytime, value);
+
+    const float tolerance = 0.01f;
+    auto curve = AnimationCurve<3>::createCompressed(keytime.data(), value.data(), (int)keytime.size(), tolerance);
+    EXPECT_TRUE(curve->isCompressed());
+    EXPECT_EQ(600, curve->getSourceKeyCount());
+    EXPECT_TRUE(curve->getKeyCount() < 600);
+    EXPECT_TRUE(curve->getKeyCount() >= 2);
+    EXPECT_NEAR(0.f, curve->getStartTime(), 1e-6f);
+    EXPECT_NEAR(1.f, curve->getEndTime(), 1e-6f);
+
+    // reduction error plus 16 bit quantization of a 20 units range
+    float errorAtKeys = getErrorAtKeys(curve, keytime, value);
+    EXPECT_TRUE(errorAtKeys <= tolerance + 0.001f);
+    EXPECT_NEAR(curve->getMaxError(), errorAtKeys, 1e-5f);
+
+    // between the keys it stays close to the uncompressed curve
+    auto source = AnimationCurve<3>::create(keytime.data(), value.data(), (int)keytime.size());
+    float compressedValue[3], sourceValue[3];
+    float maxError = 0.f;
+    for (int i = 0; i <= 1000; ++i)
+    {
+        float time = i / 1000.f;
+        curve->evaluate(time, compressedValue, EvaluateType::INT_LINEAR);
+        source->evaluate(time, sourceValue, EvaluateType::INT_LINEAR);
+        maxError = std::max(maxError, distance3(compressedValue, sourceValue));
+    }
+    EXPECT_TRUE(maxError <= tolerance + 0.001f);
+
+    // out of the keys, the first and last keys
+    curve->evaluate(-1.f, compressedValue, EvaluateType::INT_LINEAR);
+    EXPECT_TRUE(distance3(compressedValue, &value[0]) < 0.001f);
+    curve->evaluate(2.f, compressedValue, EvaluateType::INT_LINEAR);
+    EXPECT_TRUE(distance3(compressedValue, &value[599 * 3]) < 0.001f);
+
+    EXPECT_TRUE(curve->getMemorySize() < source->getMemorySize());
+}
+
+UNIT_TEST(AnimationCurveCompressedRotationsRoundTrip)
+{
+    const int count = 300;
+    std::vector<float> keytime(count), value(count * 4);
+    for (int i = 0; i < count; ++i)
+    {
+        float t = (float)i / (count - 1);
+        keytime[i] = t;
+        // turns around a changing axis, every component is the largest at some point
+        Vec3 axis(sinf(t * 3.f), cosf(t * 2.f), 0.5f);
+        axis.normalize();
+        Quaternion quat(axis, t * 6.f);
+        value[i * 4] = quat.x, value[i * 4 + 1] = quat.y, value[i * 4 + 2] = quat.z, value[i * 4 + 3] = quat.w;
+    }
+
+    const float tolerance = 0.005f;
+    auto curve = AnimationCurve<4>::createCompressed(keytime.data(), value.data(), count, tolerance);
+    EXPECT_TRUE(curve->isCompressed());
+    EXPECT_TRUE(curve->getKeyCount() < count);
+
+    float maxAngle = 0.f;
+    float result[4];
+    for (int i = 0; i < count; ++i)
+    {
+        curve->evaluate(keytime[i], result, EvaluateType::INT_QUAT_SLERP);
+        const float* key = &value[i * 4];
+        float dot = fabsf(result[0] * key[0] + result[1] * key[1] + result[2] * key[2] + result[3] * key[3]);
+        maxAngle = std::max(maxAngle, 2.f * acosf(std::min(dot, 1.f)));
+    }
+    // reduction error plus the smallest three quantization
+    EXPECT_TRUE(maxAngle <= tolerance + 0.002f);
+    EXPECT_TRUE(curve->getMaxError() <= tolerance + 0.002f);
+}
+
+UNIT_TEST(AnimationCurveCompressesUpTo65535Keys)
+{
+    // nothing can be removed, indices past 32767 go through the lookup table
+    std::vector<float> keytime, value;
+    makeNoiseKeys(60000, keytime, value);
+    auto curve = AnimationCurve<3>::createCompressed(keytime.data(), value.data(), (int)keytime.size(), 0.f);
+    EXPECT_TRUE(curve->isCompressed());
+    EXPECT_EQ(60000, curve->getKeyCount());
+
+    // the keys are closer than the 16 bit time steps, so they are read back at their quantized times
+    float maxError = 0.f;
+    float result[3];
+    for (size_t i = 0; i < keytime.size(); ++i)
+    {
+        float quantizedTime = floorf(keytime[i] * 65535.f + 0.5f) / 65535.f;
+        curve->evaluate(quantizedTime, result, EvaluateType::INT_LINEAR);
+        maxError = std::max(maxError, distance3(result, &value[i * 3]));
+    }
+    EXPECT_TRUE(maxError < 0.001f);
+}
+
+UNIT_TEST(AnimationCurveDoesNotCompressMoreThan65535Keys)
+{
+    std::vector<float> keytime, value;
+    makeNoiseKeys(70000, keytime, value);
+    auto curve = AnimationCurve<3>::createCompressed(keytime.data(), value.data(), (int)keytime.size(), 0.f);
+    EXPECT_FALSE(curve->isCompressed());
+    EXPECT_EQ(70000, curve->getKeyCount());
+    EXPECT_NEAR(0.f, getErrorAtKeys(curve, keytime, value), 1e-6f);
+
+    // reduced below the limit, it is compressed
+    makePositionKeys(70000, keytime, value);
+    curve = AnimationCurve<3>::createCompressed(keytime.data(), value.data(), (int)keytime.size(), 0.01f);
+    EXPECT_TRUE(curve->isCompressed());
+    EXPECT_EQ(70000, curve->getSourceKeyCount());
+    EXPECT_TRUE(getErrorAtKeys(curve, keytime, value) <= 0.011f);
+}
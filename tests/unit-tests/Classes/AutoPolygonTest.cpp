@@ -0,0 +1,196 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "UnitTest.h"
+#include "2d/CCAutoPolygon.h"
+#include "platform/CCFileUtils.h"
+#include "platform/CCImage.h"
+
+#include <cstring>
+#include <vector>
+
+USING_NS_CC;
+
+namespace
+{
+    const int IMAGE_SIZE = 32;
+
+    // writes an image that is opaque where inside(x, y) is true, transparent elsewhere
+    template <typename Inside>
+    std::string writeImage(const std::string& name, Inside inside)
+    {
+        std::vector<unsigned char> pixels(IMAGE_SIZE * IMAGE_SIZE * 4, 0);
+        for (int y = 0; y < IMAGE_SIZE; ++y)
+        {
+            for (int x = 0; x < IMAGE_SIZE; ++x)
+            {
+                if (inside(x, y))
+                {
+                    memset(&pixels[(y * IMAGE_SIZE + x) * 4], 255, 4);
+                }
+            }
+        }
+
+        std::string path = unittest::getWritableFilePath(name);
+        Image image;
+        image.initWithRawData(pixels.data(), pixels.size(), IMAGE_SIZE, IMAGE_SIZE, 8);
+        EXPECT_TRUE(image.saveToFile(path, false));
+        return path;
+    }
+
+    std::string writeTriangle()
+    {
+        return writeImage("unit-tests-polygon-triangle.png", [](int x, int y) {
+            return x >= 4 && x < 28 && y >= 4 && y <= x;
+        });
+    }
+
+    std::string writeDisc()
+    {
+        return writeImage("unit-tests-polygon-disc.png", [](int x, int y) {
+            return (x - 16) * (x - 16) + (y - 16) * (y - 16) < 12 * 12;
+        });
+    }
+
+    bool writeBytes(const std::string& path, const unsigned char* bytes, ssize_t size)
+    {
+        Data data;
+        data.copy(bytes, size);
+        return FileUtils::getInstance()->writeDataToFile(data, path);
+    }
+}
+
+UNIT_TEST(AutoPolygonBakedRoundTrip)
+{
+    AutoPolygon::removeCachedPolygons();
+    auto triangle = writeTriangle();
+    auto generated = AutoPolygon::generatePolygon(triangle);
+    EXPECT_TRUE(generated.triangles.vertCount > 0);
+    EXPECT_EQ(1, (int)AutoPolygon::getCachedPolygonCount());
+
+    std::string baked = unittest::getWritableFilePath("unit-tests-polygons.bin");
+    AutoPolygon::Frame frame;
+    frame.filename = triangle;
+    EXPECT_TRUE(AutoPolygon::bakePolygons(std::vector<AutoPolygon::Frame>(1, frame), baked));
+
+    AutoPolygon::removeCachedPolygons();
+    EXPECT_EQ(0, (int)AutoPolygon::getCachedPolygonCount());
+    EXPECT_TRUE(AutoPolygon::loadBakedPolygons(baked));
+    EXPECT_EQ(1, (int)AutoPolygon::getCachedPolygonCount());
+
+    // served from the baked polygon, and equal to the generated one
+    auto loaded = AutoPolygon::generatePolygon(triangle);
+    EXPECT_EQ(1, (int)AutoPolygon::getCachedPolygonCount());
+    EXPECT_EQ(generated.triangles.vertCount, loaded.triangles.vertCount);
+    EXPECT_EQ(generated.triangles.indexCount, loaded.triangles.indexCount);
+    EXPECT_TRUE(memcmp(generated.triangles.verts, loaded.triangles.verts, generated.triangles.vertCount * sizeof(V3F_C4B_T2F)) == 0);
+    EXPECT_TRUE(memcmp(generated.triangles.indices, loaded.triangles.indices, generated.triangles.indexCount * sizeof(unsigned short)) == 0);
+    EXPECT_TRUE(generated.rect.equals(loaded.rect));
+}
+
+UNIT_TEST(AutoPolygonRejectsDamagedBakedFiles)
+{
+    AutoPolygon::removeCachedPolygons();
+    AutoPolygon::Frame frame;
+    frame.filename = writeDisc();
+    std::string baked = unittest::getWritableFilePath("unit-tests-polygons.bin");
+    EXPECT_TRUE(AutoPolygon::bakePolygons(std::vector<AutoPolygon::Frame>(1, frame), baked));
+    AutoPolygon::removeCachedPolygons();
+
+    Data data = FileUtils::getInstance()->getDataFromFile(baked);
+    std::vector<unsigned char> bytes(data.getBytes(), data.getBytes() + data.getSize());
+    std::string damaged = unittest::getWritableFilePath("unit-tests-polygons-damaged.bin");
+
+    // header: magic, version, count, then the entries
+    const size_t countOffset = 8;
+    const size_t headerSize = 12;
+
+    // truncated at every length, including inside the header
+    for (size_t size = 0; size < bytes.size(); ++size)
+    {
+        writeBytes(damaged, bytes.data(), size);
+        EXPECT_FALSE(AutoPolygon::loadBakedPolygons(damaged));
+    }
+
+    // trailing bytes
+    std::vector<unsigned char> longer(bytes);
+    longer.push_back(0);
+    writeBytes(damaged, longer.data(), longer.size());
+    EXPECT_FALSE(AutoPolygon::loadBakedPolygons(damaged));
+
+    // a count larger than the file can hold
+    std::vector<unsigned char> counted(bytes);
+    unsigned int count = 0xffffffff;
+    memcpy(&counted[countOffset], &count, sizeof(count));
+    writeBytes(damaged, counted.data(), counted.size());
+    EXPECT_FALSE(AutoPolygon::loadBakedPolygons(damaged));
+
+    // a vertex count past the end of the file, the entry starts with keyLength, vertCount
+    std::vector<unsigned char> vertices(bytes);
+    unsigned int vertCount = 0x40000000;
+    memcpy(&vertices[headerSize + 4], &vertCount, sizeof(vertCount));
+    writeBytes(damaged, vertices.data(), vertices.size());
+    EXPECT_FALSE(AutoPolygon::loadBakedPolygons(damaged));
+
+    // a bad magic
+    std::vector<unsigned char> magic(bytes);
+    magic[0] = 'X';
+    writeBytes(damaged, magic.data(), magic.size());
+    EXPECT_FALSE(AutoPolygon::loadBakedPolygons(damaged));
+
+    EXPECT_EQ(0, (int)AutoPolygon::getCachedPolygonCount());
+    EXPECT_TRUE(AutoPolygon::loadBakedPolygons(baked));
+    EXPECT_EQ(1, (int)AutoPolygon::getCachedPolygonCount());
+}
+
+UNIT_TEST(AutoPolygonCacheEvictsLeastRecentlyUsed)
+{
+    AutoPolygon::removeCachedPolygons();
+    auto triangle = writeTriangle();
+    auto disc = writeDisc();
+
+    AutoPolygon::generatePolygon(triangle);
+    size_t triangleBytes = AutoPolygon::getCachedPolygonBytes();
+    AutoPolygon::generatePolygon(disc);
+    size_t discBytes = AutoPolygon::getCachedPolygonBytes() - triangleBytes;
+    EXPECT_TRUE(triangleBytes > 0 && discBytes > 0 && triangleBytes != discBytes);
+
+    // the triangle is used again, so the disc goes first
+    AutoPolygon::generatePolygon(triangle);
+    AutoPolygon::removeCachedPolygons(triangleBytes);
+    EXPECT_EQ(1, (int)AutoPolygon::getCachedPolygonCount());
+    EXPECT_EQ(triangleBytes, AutoPolygon::getCachedPolygonBytes());
+
+    // the budget trims when a polygon is added
+    AutoPolygon::setPolygonCacheBudget(discBytes);
+    AutoPolygon::generatePolygon(disc);
+    EXPECT_EQ(1, (int)AutoPolygon::getCachedPolygonCount());
+    EXPECT_EQ(discBytes, AutoPolygon::getCachedPolygonBytes());
+
+    AutoPolygon::setPolygonCacheBudget(0);
+    AutoPolygon::removeCachedPolygons();
+    EXPECT_EQ(0, (int)AutoPolygon::getCachedPolygonCount());
+    EXPECT_EQ((size_t)0, AutoPolygon::getCachedPolygonBytes());
+}
@@ -0,0 +1,179 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "UnitTest.h"
+#include "2d/CCFontFreeType.h"
+
+#include <algorithm>
+#include <vector>
+
+USING_NS_CC;
+
+namespace
+{
+    // an antialiased disc, coverage estimated with 4x4 supersampling
+    std::vector<unsigned char> makeDisc(int width, int height, float centerX, float centerY, float radius)
+    {
+        std::vector<unsigned char> bitmap(width * height);
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                int covered = 0;
+                for (int sy = 0; sy < 4; ++sy)
+                {
+                    for (int sx = 0; sx < 4; ++sx)
+                    {
+                        float dx = x + (sx + 0.5f) / 4 - centerX;
+                        float dy = y + (sy + 0.5f) / 4 - centerY;
+                        if (dx * dx + dy * dy <= radius * radius)
+                            ++covered;
+                    }
+                }
+                bitmap[y * width + x] = (unsigned char)std::min(255, covered * 16);
+            }
+        }
+        return bitmap;
+    }
+
+    // The same field as makeDistanceMap, searching every seed pixel instead of a window.
+    std::vector<unsigned char> bruteForceDistanceMap(const std::vector<unsigned char>& bitmap, int width, int height)
+    {
+        const int spread = FontFreeType::DistanceMapSpread;
+        const float inf = 1e20f;
+        int outWidth = width + 2 * spread;
+        int outHeight = height + 2 * spread;
+        std::vector<float> outsideSeed(outWidth * outHeight, inf);
+        std::vector<float> insideSeed(outWidth * outHeight, 0.0f);
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                int index = (y + spread) * outWidth + x + spread;
+                float coverage = bitmap[y * width + x] / 255.0f;
+                if (coverage >= 1.0f)
+                {
+                    outsideSeed[index] = 0.0f;
+                    insideSeed[index] = inf;
+                }
+                else if (coverage > 0.0f)
+                {
+                    float out = std::max(0.0f, 0.5f - coverage);
+                    float in = std::max(0.0f, coverage - 0.5f);
+                    outsideSeed[index] = out * out;
+                    insideSeed[index] = in * in;
+                }
+            }
+        }
+
+        std::vector<unsigned char> result(outWidth * outHeight);
+        for (int y = 0; y < outHeight; ++y)
+        {
+            for (int x = 0; x < outWidth; ++x)
+            {
+                float outside = inf;
+                float inside = inf;
+                for (int qy = 0; qy < outHeight; ++qy)
+                {
+                    for (int qx = 0; qx < outWidth; ++qx)
+                    {
+                        float d = (float)((qx - x) * (qx - x) + (qy - y) * (qy - y));
+                        outside = std::min(outside, outsideSeed[qy * outWidth + qx] + d);
+                        inside = std::min(inside, insideSeed[qy * outWidth + qx] + d);
+                    }
+                }
+                float value = 128.0f + (sqrtf(inside) - sqrtf(outside)) * 16.0f;
+                result[y * outWidth + x] = (unsigned char)std::max(0.0f, std::min(255.0f, value));
+            }
+        }
+        return result;
+    }
+
+    void expectMatchesBruteForce(const std::vector<unsigned char>& bitmap, int width, int height)
+    {
+        const int spread = FontFreeType::DistanceMapSpread;
+        int pixelCount = (width + 2 * spread) * (height + 2 * spread);
+        unsigned char* distanceMap = FontFreeType::makeDistanceMap(bitmap.data(), width, height);
+        std::vector<unsigned char> expected = bruteForceDistanceMap(bitmap, width, height);
+
+        int worst = 0;
+        for (int i = 0; i < pixelCount; ++i)
+        {
+            worst = std::max(worst, std::abs((int)distanceMap[i] - (int)expected[i]));
+        }
+        // float rounding may move a value across an integer boundary
+        EXPECT_TRUE(worst <= 1);
+        delete [] distanceMap;
+    }
+}
+
+UNIT_TEST(DistanceFieldMatchesBruteForceOnDisc)
+{
+    expectMatchesBruteForce(makeDisc(24, 20, 11.3f, 9.7f, 7.6f), 24, 20);
+}
+
+UNIT_TEST(DistanceFieldMatchesBruteForceOnThinShapes)
+{
+    // one pixel wide strokes and an odd width, so the vector loops leave a scalar tail
+    const int width = 13;
+    const int height = 11;
+    std::vector<unsigned char> bitmap(width * height, 0);
+    for (int y = 1; y < height - 1; ++y)
+        bitmap[y * width + 3] = 255;
+    for (int x = 5; x < width - 1; ++x)
+        bitmap[6 * width + x] = 128;
+    bitmap[2 * width + 9] = 40;
+    expectMatchesBruteForce(bitmap, width, height);
+}
+
+UNIT_TEST(DistanceFieldEdgesAndSaturation)
+{
+    const int size = 40;
+    const int spread = FontFreeType::DistanceMapSpread;
+    const int outSize = size + 2 * spread;
+    auto bitmap = makeDisc(size, size, 20.0f, 20.0f, 15.0f);
+    unsigned char* distanceMap = FontFreeType::makeDistanceMap(bitmap.data(), size, size);
+
+    // far inside and far outside saturate
+    EXPECT_EQ(255, (int)distanceMap[(20 + spread) * outSize + 20 + spread]);
+    EXPECT_EQ(0, (int)distanceMap[0]);
+    // the outline at x = 5 lies between the pixel centers 4.5 and 5.5, which read 16 per pixel above and below 128
+    int inside = distanceMap[(20 + spread) * outSize + 5 + spread];
+    int outside = distanceMap[(20 + spread) * outSize + 4 + spread];
+    EXPECT_TRUE(inside > 128 && outside < 128);
+    EXPECT_NEAR(128.0, (inside + outside) * 0.5, 8.0);
+    EXPECT_NEAR(outside - 16.0, distanceMap[(20 + spread) * outSize + 3 + spread], 2.0);
+    delete [] distanceMap;
+}
+
+UNIT_TEST(DistanceFieldOfEmptyBitmapIsOutside)
+{
+    std::vector<unsigned char> bitmap(7 * 5, 0);
+    const int spread = FontFreeType::DistanceMapSpread;
+    int pixelCount = (7 + 2 * spread) * (5 + 2 * spread);
+    unsigned char* distanceMap = FontFreeType::makeDistanceMap(bitmap.data(), 7, 5);
+    EXPECT_EQ(pixelCount, (int)std::count(distanceMap, distanceMap + pixelCount, 0));
+    delete [] distanceMap;
+}
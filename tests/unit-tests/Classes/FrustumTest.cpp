@@ -0,0 +1,192 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "UnitTest.h"
+#include "3d/CCFrustum.h"
+
+#include <cmath>
+
+USING_NS_CC;
+
+namespace
+{
+    unsigned int s_seed = 1;
+
+    float randomFloat(float low, float high)
+    {
+        s_seed = s_seed * 1664525u + 1013904223u;
+        return low + (high - low) * ((s_seed >> 8) / float(1 << 24));
+    }
+
+    AABB randomAABB(float range, float maxSize)
+    {
+        Vec3 min(randomFloat(-range, range), randomFloat(-range, range), randomFloat(-range, range));
+        Vec3 size(randomFloat(0.f, maxSize), randomFloat(0.f, maxSize), randomFloat(0.f, maxSize));
+        return AABB(min, min + size);
+    }
+
+    // scalar reference: the planes of the view projection matrix tested against the eight corners
+    struct ReferenceFrustum
+    {
+        Vec3 normals[6];
+        float dists[6];
+
+        explicit ReferenceFrustum(const Mat4& mat)
+        {
+            const float* m = mat.m;
+            // left, right, bottom, top, near, far, normals point out of the frustum, outside where normal . p > dist
+            for (int i = 0; i < 3; ++i)
+            {
+                float sign = 1.f;
+                for (int j = 0; j < 2; ++j, sign = -sign)
+                {
+                    Vec3 normal = -Vec3(m[3] + sign * m[i], m[7] + sign * m[4 + i], m[11] + sign * m[8 + i]);
+                    float dist = m[15] + sign * m[12 + i];
+                    float length = normal.length();
+                    normals[i * 2 + j] = normal / length;
+                    dists[i * 2 + j] = dist / length;
+                }
+            }
+        }
+
+        // the smallest distance of a corner to a plane, to skip the boxes touching one
+        Frustum::Intersection intersect(const AABB& aabb, int planeCount, float* nearest) const
+        {
+            Vec3 corners[8];
+            aabb.getCorners(corners);
+            bool inside = true;
+            *nearest = FLT_MAX;
+            for (int i = 0; i < planeCount; ++i)
+            {
+                int out = 0;
+                for (const auto& corner : corners)
+                {
+                    float dist = normals[i].dot(corner) - dists[i];
+                    *nearest = std::min(*nearest, fabsf(dist));
+                    if (dist > 0.f)
+                        ++out;
+                }
+                if (out == 8)
+                    return Frustum::Intersection::OUTSIDE;
+                if (out > 0)
+                    inside = false;
+            }
+            return inside ? Frustum::Intersection::INSIDE : Frustum::Intersection::INTERSECTING;
+        }
+    };
+
+    // a perspective camera at (10, 20, 30) looking towards (-50, 0, -100)
+    Mat4 createViewProjection()
+    {
+        Mat4 projection, view;
+        Mat4::createPerspective(60.f, 1.5f, 1.f, 500.f, &projection);
+        Mat4::createLookAt(Vec3(10.f, 20.f, 30.f), Vec3(-50.f, 0.f, -100.f), Vec3(0.f, 1.f, 0.f), &view);
+        return projection * view;
+    }
+}
+
+UNIT_TEST(FrustumIntersectAABBMatchesCornerTest)
+{
+    Mat4 viewProjection = createViewProjection();
+    ReferenceFrustum reference(viewProjection);
+    Frustum frustum;
+    frustum.initFrustum(viewProjection);
+
+    int counts[3] = { 0, 0, 0 };
+    int mismatches = 0;
+    for (int clipZ = 0; clipZ < 2; ++clipZ)
+    {
+        frustum.setClipZ(clipZ != 0);
+        s_seed = 1;
+        for (int i = 0; i < 20000; ++i)
+        {
+            AABB aabb = randomAABB(400.f, i % 2 ? 5.f : 100.f);
+            float nearest;
+            auto expected = reference.intersect(aabb, clipZ ? 6 : 4, &nearest);
+            if (nearest < 1e-2f)
+                continue;
+
+            auto result = frustum.intersectAABB(aabb);
+            if (result != expected)
+                ++mismatches;
+            if (frustum.isOutOfFrustum(aabb) != (expected == Frustum::Intersection::OUTSIDE))
+                ++mismatches;
+            ++counts[(int)expected];
+        }
+    }
+    EXPECT_EQ(0, mismatches);
+    // every case was covered
+    EXPECT_TRUE(counts[0] > 100 && counts[1] > 100 && counts[2] > 100);
+}
+
+UNIT_TEST(FrustumPlaneMaskSkipsThePlanesOfTheParent)
+{
+    Mat4 viewProjection = createViewProjection();
+    ReferenceFrustum reference(viewProjection);
+    Frustum frustum;
+    frustum.initFrustum(viewProjection);
+
+    s_seed = 7;
+    int checked = 0;
+    int mismatches = 0;
+    for (int i = 0; i < 5000; ++i)
+    {
+        // around the view direction, so that most parents aren't outside
+        Vec3 center = Vec3(10.f, 20.f, 30.f) + Vec3(-60.f, -20.f, -130.f) * randomFloat(0.f, 3.5f);
+        Vec3 halfSize(randomFloat(1.f, 80.f), randomFloat(1.f, 80.f), randomFloat(1.f, 80.f));
+        AABB parent(center - halfSize, center + halfSize);
+        unsigned int mask = frustum.getAllPlanesMask();
+        EXPECT_EQ(0x3fu, mask);
+        auto parentResult = frustum.intersectAABB(parent, &mask);
+        if (parentResult == Frustum::Intersection::OUTSIDE)
+            continue;
+        if (parentResult == Frustum::Intersection::INSIDE)
+            EXPECT_EQ(0u, mask);
+
+        // a box inside the parent gives the same result with the parent's mask as with all the planes
+        Vec3 size = parent._max - parent._min;
+        Vec3 min = parent._min + Vec3(size.x * randomFloat(0.f, 0.5f), size.y * randomFloat(0.f, 0.5f), size.z * randomFloat(0.f, 0.5f));
+        AABB child(min, min + size * 0.4f);
+        float nearest;
+        auto expected = reference.intersect(child, 6, &nearest);
+        if (nearest < 1e-2f)
+            continue;
+
+        unsigned int childMask = mask;
+        if (frustum.intersectAABB(child, &childMask) != expected)
+            ++mismatches;
+        EXPECT_EQ(0u, childMask & ~mask);
+        ++checked;
+    }
+    EXPECT_EQ(0, mismatches);
+    EXPECT_TRUE(checked > 1000);
+}
+
+UNIT_TEST(FrustumWithoutCameraContainsEverything)
+{
+    Frustum frustum;
+    EXPECT_TRUE(frustum.intersectAABB(AABB(Vec3(1e6f, 1e6f, 1e6f), Vec3(2e6f, 2e6f, 2e6f))) == Frustum::Intersection::INSIDE);
+    EXPECT_FALSE(frustum.isOutOfFrustum(AABB(Vec3(-1.f, -1.f, -1.f), Vec3(1.f, 1.f, 1.f))));
+}
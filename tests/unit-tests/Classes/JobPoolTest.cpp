@@ -0,0 +1,123 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "UnitTest.h"
+#include "base/CCJobPool.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+USING_NS_CC;
+
+namespace
+{
+    // runs a batch and checks each job ran exactly once
+    void expectEachJobOnce(int count)
+    {
+        std::vector<std::atomic<int>> runs(count);
+        for (auto& run : runs)
+            run = 0;
+
+        JobPool::getInstance()->parallelFor(count, [&runs](int index) {
+            ++runs[index];
+        });
+
+        int wrong = 0;
+        for (const auto& run : runs)
+        {
+            if (run != 1)
+                ++wrong;
+        }
+        EXPECT_EQ(0, wrong);
+    }
+}
+
+UNIT_TEST(JobPoolRunsEachJobOnce)
+{
+    auto pool = JobPool::getInstance();
+    int threadCount = pool->getThreadCount();
+
+    pool->setThreadCount(3);
+    EXPECT_EQ(3, pool->getThreadCount());
+    for (int batch = 0; batch < 200; ++batch)
+    {
+        expectEachJobOnce(batch % 37);
+    }
+
+    // on the calling thread only
+    pool->setThreadCount(0);
+    expectEachJobOnce(10);
+    std::thread::id caller = std::this_thread::get_id();
+    bool otherThread = false;
+    pool->parallelFor(10, [&](int) {
+        if (std::this_thread::get_id() != caller)
+            otherThread = true;
+    });
+    EXPECT_FALSE(otherThread);
+
+    pool->setThreadCount(threadCount);
+}
+
+UNIT_TEST(JobPoolRunsNestedBatchesInline)
+{
+    auto pool = JobPool::getInstance();
+    int threadCount = pool->getThreadCount();
+    pool->setThreadCount(2);
+
+    std::atomic<int> innerJobs(0);
+    pool->parallelFor(8, [&](int) {
+        // would wait for the threads running the outer batch
+        pool->parallelFor(4, [&](int) {
+            ++innerJobs;
+        });
+    });
+    EXPECT_EQ(32, (int)innerJobs);
+
+    pool->setThreadCount(threadCount);
+}
+
+UNIT_TEST(JobPoolAcceptsBatchesFromOtherThreads)
+{
+    auto pool = JobPool::getInstance();
+    int threadCount = pool->getThreadCount();
+    pool->setThreadCount(2);
+
+    std::atomic<int> jobs(0);
+    auto submit = [&]() {
+        for (int batch = 0; batch < 100; ++batch)
+        {
+            pool->parallelFor(16, [&](int) {
+                ++jobs;
+            });
+        }
+    };
+    std::thread other(submit);
+    submit();
+    other.join();
+    EXPECT_EQ(2 * 100 * 16, (int)jobs);
+
+    pool->setThreadCount(threadCount);
+}
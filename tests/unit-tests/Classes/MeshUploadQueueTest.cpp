@@ -0,0 +1,125 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "UnitTest.h"
+#include "3d/CCMeshUploadQueue.h"
+#include "3d/CCMeshVertexIndexData.h"
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+
+#include <vector>
+
+USING_NS_CC;
+
+UNIT_TEST(MeshUploadQueueCallsBackAfterTheUpload)
+{
+    std::vector<bool> results;
+    auto queue = MeshUploadQueue::getInstance();
+    // batches without meshes complete on the next upload, in order
+    queue->enqueue(Vector<MeshVertexData*>(), new (std::nothrow) MeshDatas(), [&](bool uploaded) {
+        results.push_back(uploaded);
+    });
+    queue->enqueue(Vector<MeshVertexData*>(), new (std::nothrow) MeshDatas(), [&](bool uploaded) {
+        results.push_back(uploaded);
+    });
+    EXPECT_EQ(0, (int)results.size());
+
+    queue->uploadAll();
+    EXPECT_EQ(2, (int)results.size());
+    EXPECT_TRUE(results[0] && results[1]);
+    EXPECT_EQ(0, (int)queue->getPendingBytes());
+    MeshUploadQueue::destroyInstance();
+    EXPECT_EQ(2, (int)results.size());
+}
+
+UNIT_TEST(MeshUploadQueueReleasesPendingBatchesWhenDestroyed)
+{
+    int uploadedCount = 0;
+    int droppedCount = 0;
+    auto callback = [&](bool uploaded) {
+        if (uploaded)
+            ++uploadedCount;
+        else
+            ++droppedCount;
+    };
+
+    auto queue = MeshUploadQueue::getInstance();
+    queue->enqueue(Vector<MeshVertexData*>(), new (std::nothrow) MeshDatas(), callback);
+    queue->enqueue(Vector<MeshVertexData*>(), new (std::nothrow) MeshDatas(), [&](bool uploaded) {
+        callback(uploaded);
+        // queued while the queue is destroyed, dropped as well
+        MeshUploadQueue::getInstance()->enqueue(Vector<MeshVertexData*>(), new (std::nothrow) MeshDatas(), callback);
+    });
+
+    MeshUploadQueue::destroyInstance();
+    EXPECT_EQ(0, uploadedCount);
+    EXPECT_EQ(3, droppedCount);
+}
+
+UNIT_TEST(MeshUploadQueueSpreadsCustomUploadsOverFrames)
+{
+    auto queue = MeshUploadQueue::getInstance();
+    queue->setBytesPerFrame(100);
+
+    // 30 bytes per step, like the chunks of a terrain
+    int steps = 0;
+    bool done = false;
+    queue->enqueue(300, [&](ssize_t budget) -> ssize_t {
+        ++steps;
+        return 30;
+    }, [&](bool uploaded) {
+        done = uploaded;
+    });
+    EXPECT_EQ(300, (int)queue->getPendingBytes());
+
+    // enabled with the GL view
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    bool enabled = dispatcher->isEnabled();
+    dispatcher->setEnabled(true);
+    int frames = 0;
+    while (!done && frames < 10)
+    {
+        dispatcher->dispatchCustomEvent(Director::EVENT_AFTER_UPDATE);
+        ++frames;
+        // at least one step a frame, up to the budget
+        EXPECT_TRUE(steps <= frames * 4);
+    }
+    dispatcher->setEnabled(enabled);
+    EXPECT_TRUE(done);
+    EXPECT_EQ(10, steps);
+    EXPECT_EQ(3, frames);
+    EXPECT_EQ(0, (int)queue->getPendingBytes());
+
+    // an upload with nothing left ends its batch
+    done = false;
+    queue->enqueue(50, [](ssize_t) -> ssize_t { return 0; }, [&](bool uploaded) {
+        done = uploaded;
+    });
+    queue->uploadAll();
+    EXPECT_TRUE(done);
+    EXPECT_EQ(0, (int)queue->getPendingBytes());
+
+    MeshUploadQueue::destroyInstance();
+}
@@ -0,0 +1,172 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "UnitTest.h"
+#include "3d/CCOcclusionCuller.h"
+
+#include <algorithm>
+
+USING_NS_CC;
+
+namespace
+{
+    // with an identity view projection the clip coordinates are the world coordinates, w is 1
+    const int WIDTH = 64;
+    const int HEIGHT = 32;
+
+    float toWorldX(float screenX) { return screenX / WIDTH * 2.f - 1.f; }
+    float toWorldY(float screenY) { return screenY / HEIGHT * 2.f - 1.f; }
+    float toWorldZ(float depth) { return depth * 2.f - 1.f; }
+
+    // a rectangle in screen pixels at a depth in [0, 1]
+    void addQuad(OcclusionCuller& culler, float x0, float y0, float x1, float y1, float depth)
+    {
+        float z = toWorldZ(depth);
+        Vec3 positions[4] = {
+            Vec3(toWorldX(x0), toWorldY(y0), z), Vec3(toWorldX(x1), toWorldY(y0), z),
+            Vec3(toWorldX(x1), toWorldY(y1), z), Vec3(toWorldX(x0), toWorldY(y1), z)
+        };
+        unsigned short indices[6] = { 0, 1, 2, 0, 2, 3 };
+        culler.addOccluder(positions, 4, indices, 6, Mat4::IDENTITY);
+    }
+
+    AABB makeAABB(float x0, float y0, float x1, float y1, float nearDepth, float farDepth)
+    {
+        return AABB(Vec3(toWorldX(x0), toWorldY(y0), toWorldZ(nearDepth)), Vec3(toWorldX(x1), toWorldY(y1), toWorldZ(farDepth)));
+    }
+
+    void initCuller(OcclusionCuller& culler)
+    {
+        culler.setResolution(WIDTH, HEIGHT);
+        culler.begin(Mat4::IDENTITY);
+    }
+}
+
+UNIT_TEST(OcclusionCullerHidesObjectsBehindOccluders)
+{
+    OcclusionCuller culler;
+    initCuller(culler);
+    EXPECT_EQ(WIDTH, culler.getWidth());
+
+    // nothing rasterized, everything is visible
+    EXPECT_TRUE(culler.isVisible(makeAABB(10.f, 10.f, 20.f, 20.f, 0.8f, 0.9f)));
+
+    addQuad(culler, 8.f, 4.f, 40.f, 28.f, 0.5f);
+    EXPECT_EQ(1, culler.getStats().occluders);
+    EXPECT_EQ(2, culler.getStats().rasterizedTriangles);
+
+    // behind and within the occluder
+    EXPECT_FALSE(culler.isVisible(makeAABB(10.f, 6.f, 38.f, 26.f, 0.6f, 0.9f)));
+    // in front of it
+    EXPECT_TRUE(culler.isVisible(makeAABB(10.f, 6.f, 38.f, 26.f, 0.4f, 0.9f)));
+    // sticking out of a side
+    EXPECT_TRUE(culler.isVisible(makeAABB(30.f, 6.f, 45.f, 26.f, 0.6f, 0.9f)));
+    EXPECT_TRUE(culler.isVisible(makeAABB(10.f, 2.f, 20.f, 10.f, 0.6f, 0.9f)));
+    // out of the screen
+    EXPECT_TRUE(culler.isVisible(makeAABB(70.f, 6.f, 80.f, 26.f, 0.6f, 0.9f)));
+    // crossing the near plane
+    EXPECT_TRUE(culler.isVisible(AABB(Vec3(-0.5f, -0.5f, -2.f), Vec3(0.f, 0.f, 0.5f))));
+
+    EXPECT_EQ(1, culler.getStats().culledObjects);
+}
+
+UNIT_TEST(OcclusionCullerKeepsObjectsInPartlyCoveredPixels)
+{
+    OcclusionCuller culler;
+    initCuller(culler);
+
+    // the right edge covers the center of pixel 40 but not all of it, the bottom edge the center of row 4
+    addQuad(culler, 8.f, 4.4f, 40.6f, 28.f, 0.5f);
+    const float* depth = culler.getDepthBuffer();
+    EXPECT_NEAR(0.5f, depth[16 * WIDTH + 40], 1e-4f);
+    EXPECT_NEAR(1.f, depth[16 * WIDTH + 41], 1e-6f);
+    EXPECT_NEAR(0.5f, depth[4 * WIDTH + 20], 1e-4f);
+    EXPECT_NEAR(1.f, depth[3 * WIDTH + 20], 1e-6f);
+
+    // visible in the parts of pixel 40 and row 4 the occluder leaves
+    EXPECT_TRUE(culler.isVisible(makeAABB(40.7f, 10.f, 40.9f, 20.f, 0.6f, 0.9f)));
+    EXPECT_TRUE(culler.isVisible(makeAABB(20.f, 4.1f, 30.f, 4.3f, 0.6f, 0.9f)));
+    // a pixel away from the edges
+    EXPECT_FALSE(culler.isVisible(makeAABB(30.f, 10.f, 38.9f, 20.f, 0.6f, 0.9f)));
+    EXPECT_FALSE(culler.isVisible(makeAABB(20.f, 5.1f, 30.f, 10.f, 0.6f, 0.9f)));
+
+    // the screen borders are the end of the rectangle
+    OcclusionCuller fullScreen;
+    initCuller(fullScreen);
+    addQuad(fullScreen, -1.f, -1.f, WIDTH + 1.f, HEIGHT + 1.f, 0.5f);
+    EXPECT_FALSE(fullScreen.isVisible(makeAABB(0.f, 0.f, 10.f, 10.f, 0.6f, 0.9f)));
+    EXPECT_FALSE(fullScreen.isVisible(makeAABB(WIDTH - 10.f, HEIGHT - 10.f, WIDTH + 5.f, HEIGHT + 5.f, 0.6f, 0.9f)));
+}
+
+UNIT_TEST(OcclusionCullerWritesTheFarthestDepthOverPixels)
+{
+    OcclusionCuller culler;
+    initCuller(culler);
+
+    // a sloped triangle, depth = 0.2 + 0.01 * x + 0.005 * y in pixels
+    Vec3 screen[3] = { Vec3(3.3f, 2.7f, 0.f), Vec3(60.2f, 9.1f, 0.f), Vec3(17.6f, 30.4f, 0.f) };
+    auto depthAt = [](float x, float y) { return 0.2f + 0.01f * x + 0.005f * y; };
+    Vec3 positions[3];
+    for (int i = 0; i < 3; ++i)
+        positions[i] = Vec3(toWorldX(screen[i].x), toWorldY(screen[i].y), toWorldZ(depthAt(screen[i].x, screen[i].y)));
+    unsigned short indices[3] = { 0, 1, 2 };
+    culler.addOccluder(positions, 3, indices, 3, Mat4::IDENTITY);
+
+    auto inside = [&screen](float x, float y) {
+        for (int i = 0; i < 3; ++i)
+        {
+            const Vec3& a = screen[i];
+            const Vec3& b = screen[(i + 1) % 3];
+            // counter clockwise
+            if ((b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x) < -1e-4f)
+                return false;
+        }
+        return true;
+    };
+
+    const float* depth = culler.getDepthBuffer();
+    int written = 0;
+    int wrong = 0;
+    for (int y = 0; y < HEIGHT; ++y)
+    {
+        for (int x = 0; x < WIDTH; ++x)
+        {
+            float value = depth[y * WIDTH + x];
+            if (value == 1.f)
+                continue;
+            ++written;
+            // the center is covered, and the triangle's plane is nowhere farther over the pixel than the depth written
+            if (!inside(x + 0.5f, y + 0.5f))
+                ++wrong;
+            float farthest = 0.f;
+            for (int corner = 0; corner < 4; ++corner)
+                farthest = std::max(farthest, depthAt((float)(x + (corner & 1)), (float)(y + (corner >> 1))));
+            if (value < farthest - 1e-4f)
+                ++wrong;
+        }
+    }
+    EXPECT_EQ(0, wrong);
+    EXPECT_TRUE(written > 400);
+}
@@ -0,0 +1,197 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "UnitTest.h"
+#include "3d/CCSprite3D.h"
+#include "3d/CCBundle3DData.h"
+#include "3d/CCMeshVertexIndexData.h"
+#include "base/CCAutoreleasePool.h"
+
+USING_NS_CC;
+
+namespace
+{
+    // vertex data without buffers, which need GL, the index datas are added as Sprite3D does
+    class TestVertexData : public MeshVertexData
+    {
+    public:
+        static TestVertexData* create()
+        {
+            auto vertexData = new (std::nothrow) TestVertexData();
+            vertexData->autorelease();
+            return vertexData;
+        }
+
+        MeshIndexData* addIndexData()
+        {
+            auto indexData = new (std::nothrow) MeshIndexData();
+            indexData->autorelease();
+            _indexs.pushBack(indexData);
+            return indexData;
+        }
+    };
+
+    // the size of the data comes from the id of its node, which the cache counts as CPU bytes
+    Sprite3DCache::Sprite3DData* createData(size_t idLength, MeshVertexData* vertexData = nullptr)
+    {
+        auto data = new (std::nothrow) Sprite3DCache::Sprite3DData();
+        data->nodedatas = new (std::nothrow) NodeDatas();
+        auto node = new (std::nothrow) NodeData();
+        node->id.assign(idLength, 'x');
+        data->nodedatas->nodes.push_back(node);
+        data->materialdatas = new (std::nothrow) MaterialDatas();
+        auto meshVertexData = vertexData ? vertexData : TestVertexData::create();
+        data->meshVertexDatas.pushBack(meshVertexData);
+        return data;
+    }
+
+    // the autoreleased objects are released at the end of the frame
+    void endFrame()
+    {
+        PoolManager::getInstance()->getCurrentPool()->clear();
+    }
+
+    size_t getCachedBytes(Sprite3DCache* cache)
+    {
+        return cache->getGPUBytes() + cache->getCPUBytes();
+    }
+}
+
+UNIT_TEST(Sprite3DCacheCountsTheBytesOfItsData)
+{
+    auto cache = Sprite3DCache::getInstance();
+    cache->removeAllSprite3DData();
+    EXPECT_EQ(0, (int)getCachedBytes(cache));
+
+    auto small = createData(1000);
+    auto big = createData(10000);
+    EXPECT_TRUE(cache->addSprite3DData("small.c3b", small));
+    EXPECT_TRUE(cache->addSprite3DData("big.c3b", big));
+    // a key is added once
+    auto duplicate = createData(10);
+    EXPECT_FALSE(cache->addSprite3DData("small.c3b", duplicate));
+    delete duplicate;
+
+    EXPECT_EQ(0, (int)cache->getGPUBytes());
+    EXPECT_TRUE(small->cpuBytes >= 1000 && small->cpuBytes < 2000);
+    EXPECT_TRUE(big->cpuBytes >= 10000 && big->cpuBytes < 11000);
+    EXPECT_EQ((int)(small->cpuBytes + big->cpuBytes), (int)cache->getCPUBytes());
+
+    cache->removeSprite3DData("big.c3b");
+    EXPECT_EQ((int)small->cpuBytes, (int)cache->getCPUBytes());
+    cache->removeSprite3DData("missing.c3b");
+    cache->removeAllSprite3DData();
+    EXPECT_EQ(0, (int)getCachedBytes(cache));
+    EXPECT_TRUE(cache->getSpriteData("small.c3b") == nullptr);
+
+    Sprite3DCache::destroyInstance();
+}
+
+UNIT_TEST(Sprite3DCacheRemovesLeastRecentlyUsedFirst)
+{
+    auto cache = Sprite3DCache::getInstance();
+    const char* keys[4] = { "a.c3b", "b.c3b", "c.c3b", "d.c3b" };
+    for (auto key : keys)
+        cache->addSprite3DData(key, createData(1000));
+    endFrame();
+    size_t dataBytes = cache->getSpriteData("a.c3b")->cpuBytes;
+
+    // b, then d, were used last
+    cache->getSpriteData("b.c3b");
+    cache->getSpriteData("d.c3b");
+
+    // fits, nothing is removed
+    cache->removeUnusedSprite3DData(4 * dataBytes);
+    EXPECT_EQ((int)(4 * dataBytes), (int)getCachedBytes(cache));
+
+    // room for two and a half, a and c go
+    cache->removeUnusedSprite3DData(dataBytes * 5 / 2);
+    EXPECT_TRUE(cache->getSpriteData("a.c3b") == nullptr);
+    EXPECT_TRUE(cache->getSpriteData("c.c3b") == nullptr);
+    EXPECT_EQ((int)(2 * dataBytes), (int)getCachedBytes(cache));
+
+    // getSpriteData above made b the last used, d goes
+    cache->getSpriteData("b.c3b");
+    cache->removeUnusedSprite3DData(dataBytes);
+    EXPECT_TRUE(cache->getSpriteData("d.c3b") == nullptr);
+    EXPECT_TRUE(cache->getSpriteData("b.c3b") != nullptr);
+
+    // 0 removes everything unused
+    cache->removeUnusedSprite3DData();
+    EXPECT_EQ(0, (int)getCachedBytes(cache));
+
+    // the budget trims on add
+    cache->setMemoryBudget(dataBytes * 2);
+    for (auto key : keys)
+    {
+        cache->addSprite3DData(key, createData(1000));
+        endFrame();
+    }
+    EXPECT_TRUE(getCachedBytes(cache) <= dataBytes * 2);
+    EXPECT_TRUE(cache->getSpriteData("c.c3b") != nullptr);
+    EXPECT_TRUE(cache->getSpriteData("d.c3b") != nullptr);
+
+    Sprite3DCache::destroyInstance();
+}
+
+UNIT_TEST(Sprite3DCacheKeepsDataInUse)
+{
+    auto cache = Sprite3DCache::getInstance();
+
+    // used by a sprite through its vertex data
+    auto usedVertexData = TestVertexData::create();
+    usedVertexData->retain();
+    cache->addSprite3DData("vertices.c3b", createData(1000, usedVertexData));
+
+    // used by a mesh through a shared index data only
+    auto sharedVertexData = TestVertexData::create();
+    auto sharedIndexData = sharedVertexData->addIndexData();
+    sharedIndexData->retain();
+    cache->addSprite3DData("indices.c3b", createData(1000, sharedVertexData));
+
+    cache->addSprite3DData("unused.c3b", createData(1000));
+    endFrame();
+    // the used data are the least recently used ones
+    cache->getSpriteData("unused.c3b");
+
+    cache->removeUnusedSprite3DData();
+    EXPECT_TRUE(cache->getSpriteData("vertices.c3b") != nullptr);
+    EXPECT_TRUE(cache->getSpriteData("indices.c3b") != nullptr);
+    EXPECT_TRUE(cache->getSpriteData("unused.c3b") == nullptr);
+
+    // a budget doesn't remove them either, the cache stays above it
+    cache->setMemoryBudget(1);
+    EXPECT_TRUE(cache->getSpriteData("vertices.c3b") != nullptr);
+    EXPECT_TRUE(cache->getSpriteData("indices.c3b") != nullptr);
+    EXPECT_TRUE(getCachedBytes(cache) > 1);
+
+    // released by their users
+    usedVertexData->release();
+    sharedIndexData->release();
+    cache->removeUnusedSprite3DData();
+    EXPECT_EQ(0, (int)getCachedBytes(cache));
+
+    Sprite3DCache::destroyInstance();
+}
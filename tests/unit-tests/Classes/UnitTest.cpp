@@ -0,0 +1,98 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#include "UnitTest.h"
+#include "platform/CCFileUtils.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    struct RegisteredTest
+    {
+        const char* name;
+        unittest::TestFunction function;
+    };
+
+    std::vector<RegisteredTest>& getTests()
+    {
+        static std::vector<RegisteredTest> tests;
+        return tests;
+    }
+
+    int s_failures = 0;
+}
+
+namespace unittest
+{
+    bool registerTest(const char* name, TestFunction function)
+    {
+        getTests().push_back({ name, function });
+        return true;
+    }
+
+    void fail(const char* file, int line, const std::string& message)
+    {
+        ++s_failures;
+        printf("%s:%d: %s\n", file, line, message.c_str());
+    }
+
+    std::string getWritableFilePath(const std::string& name)
+    {
+        auto fileUtils = cocos2d::FileUtils::getInstance();
+        std::string directory = fileUtils->getWritablePath();
+        if (!fileUtils->isDirectoryExist(directory))
+        {
+            fileUtils->createDirectory(directory);
+        }
+        return directory + name;
+    }
+}
+
+// Runs every test, or only those whose names contain the first argument. Returns nonzero if any expectation failed.
+int main(int argc, char* argv[])
+{
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int failedTests = 0;
+    int testCount = 0;
+    for (const auto& test : getTests())
+    {
+        if (filter && strstr(test.name, filter) == nullptr)
+            continue;
+
+        int failuresBefore = s_failures;
+        test.function();
+        ++testCount;
+        bool passed = s_failures == failuresBefore;
+        if (!passed)
+            ++failedTests;
+        printf("[%s] %s\n", passed ? "  OK  " : " FAIL ", test.name);
+    }
+
+    printf("%d of %d tests passed\n", testCount - failedTests, testCount);
+    return failedTests == 0 ? 0 : 1;
+}
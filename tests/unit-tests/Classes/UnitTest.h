@@ -0,0 +1,86 @@
+/****************************************************************************
+Copyright (c) 2015 Chukong Technologies Inc.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+
+#ifndef __UNIT_TEST_H__
+#define __UNIT_TEST_H__
+
+#include <cmath>
+#include <sstream>
+#include <string>
+
+/**
+ * A minimal headless test harness. Tests register themselves with UNIT_TEST and run without a GL context,
+ * so they may only use engine code that needs no Director, renderer or file system.
+ */
+namespace unittest
+{
+    typedef void (*TestFunction)();
+
+    /** Registers a test, used by UNIT_TEST. */
+    bool registerTest(const char* name, TestFunction function);
+
+    /** Records a failed expectation of the running test. */
+    void fail(const char* file, int line, const std::string& message);
+
+    /** Returns the path of a file the tests may write, in the writable path of FileUtils, which is created if needed. */
+    std::string getWritableFilePath(const std::string& name);
+}
+
+#define UNIT_TEST(name) \
+    static void unitTest_##name(); \
+    static bool unitTestRegistered_##name = unittest::registerTest(#name, unitTest_##name); \
+    static void unitTest_##name()
+
+#define EXPECT_TRUE(condition) \
+    do { if (!(condition)) unittest::fail(__FILE__, __LINE__, "expected true: " #condition); } while (0)
+
+#define EXPECT_FALSE(condition) \
+    do { if (condition) unittest::fail(__FILE__, __LINE__, "expected false: " #condition); } while (0)
+
+#define EXPECT_EQ(expected, actual) \
+    do { \
+        auto unitTestExpected = (expected); \
+        auto unitTestActual = (actual); \
+        if (!(unitTestExpected == unitTestActual)) \
+        { \
+            std::ostringstream unitTestMessage; \
+            unitTestMessage << #actual << " is " << unitTestActual << ", expected " << unitTestExpected; \
+            unittest::fail(__FILE__, __LINE__, unitTestMessage.str()); \
+        } \
+    } while (0)
+
+#define EXPECT_NEAR(expected, actual, tolerance) \
+    do { \
+        double unitTestExpected = (expected); \
+        double unitTestActual = (actual); \
+        if (std::fabs(unitTestExpected - unitTestActual) > (tolerance)) \
+        { \
+            std::ostringstream unitTestMessage; \
+            unitTestMessage << #actual << " is " << unitTestActual << ", expected " << unitTestExpected << " +- " << (tolerance); \
+            unittest::fail(__FILE__, __LINE__, unitTestMessage.str()); \
+        } \
+    } while (0)
+
+#endif // __UNIT_TEST_H__
@@ -0,0 +1,133 @@
+#!/usr/bin/python
+#convert_plist_to_binary.py
+#
+#Converts sprite frame plists (Zwoptex / TexturePacker, formats 0 to 3) to the
+#binary format loaded by SpriteFrameCache::addSpriteFramesWithFile.
+#The binary file is built straight into SpriteFrames, without XML parsing.
+#
+#Layout, little endian:
+#  header  : 'CCSF', version, frameCount, aliasCount, stringTableOffset,
+#            stringTableSize, textureFileName (string offset or 0xffffffff), reserved
+#  frames  : name, x, y, width, height, offsetX, offsetY, originalWidth, originalHeight, rotated
+#  aliases : name, frameIndex
+#  strings : null terminated utf-8 strings
+
+import plistlib
+import os.path
+import argparse
+import re
+import struct
+
+MAGIC = b'CCSF'
+VERSION = 1
+NO_STRING = 0xffffffff
+
+HEADER_FORMAT = '<4s7I'
+FRAME_FORMAT = '<I8fI'
+ALIAS_FORMAT = '<2I'
+
+#parse '{1,2}' and '{{1,2},{3,4}}' the way cocos2d-x does
+def parseNumbers(value):
+    return [float(n) for n in re.findall(r'[-+]?[0-9]*\.?[0-9]+(?:[eE][-+]?[0-9]+)?', value)]
+
+class StringTable:
+    def __init__(self):
+        self.data = bytearray()
+        self.offsets = {}
+
+    def add(self, value):
+        if value not in self.offsets:
+            self.offsets[value] = len(self.data)
+            self.data += value.encode('utf-8') + b'\0'
+        return self.offsets[value]
+
+#returns (x, y, width, height, offsetX, offsetY, originalWidth, originalHeight, rotated, aliases)
+def parseFrame(frameFormat, frameDict):
+    if frameFormat == 0:
+        return (float(frameDict['x']), float(frameDict['y']),
+                float(frameDict['width']), float(frameDict['height']),
+                float(frameDict.get('offsetX', 0)), float(frameDict.get('offsetY', 0)),
+                float(abs(int(frameDict.get('originalWidth', 0)))),
+                float(abs(int(frameDict.get('originalHeight', 0)))),
+                False, [])
+    elif frameFormat == 1 or frameFormat == 2:
+        rect = parseNumbers(frameDict['frame'])
+        offset = parseNumbers(frameDict['offset'])
+        sourceSize = parseNumbers(frameDict['sourceSize'])
+        rotated = frameFormat == 2 and bool(frameDict.get('rotated', False))
+        return (rect[0], rect[1], rect[2], rect[3], offset[0], offset[1],
+                sourceSize[0], sourceSize[1], rotated, [])
+    elif frameFormat == 3:
+        spriteSize = parseNumbers(frameDict['spriteSize'])
+        spriteOffset = parseNumbers(frameDict['spriteOffset'])
+        sourceSize = parseNumbers(frameDict['spriteSourceSize'])
+        textureRect = parseNumbers(frameDict['textureRect'])
+        rotated = bool(frameDict.get('textureRotated', False))
+        return (textureRect[0], textureRect[1], spriteSize[0], spriteSize[1],
+                spriteOffset[0], spriteOffset[1], sourceSize[0], sourceSize[1],
+                rotated, list(frameDict.get('aliases', [])))
+    raise ValueError('unsupported sprite frame format %d' % frameFormat)
+
+def readPlist(filename):
+    fp = open(filename, 'rb')
+    try:
+        if hasattr(plistlib, 'load'):
+            return plistlib.load(fp)
+        return plistlib.readPlist(fp)
+    finally:
+        fp.close()
+
+def convertFile(filename, outFilename):
+    plistDict = readPlist(filename)
+    metadata = plistDict.get('metadata', {})
+    frameFormat = int(metadata.get('format', 0))
+
+    strings = StringTable()
+    textureFileName = metadata.get('textureFileName', '')
+    textureOffset = strings.add(textureFileName) if textureFileName else NO_STRING
+
+    frames = bytearray()
+    aliases = bytearray()
+    frameCount = 0
+    aliasCount = 0
+    for name in sorted(plistDict['frames'].keys()):
+        values = parseFrame(frameFormat, plistDict['frames'][name])
+        frames += struct.pack(FRAME_FORMAT, strings.add(name),
+                              values[0], values[1], values[2], values[3],
+                              values[4], values[5], values[6], values[7],
+                              1 if values[8] else 0)
+        for alias in values[9]:
+            aliases += struct.pack(ALIAS_FORMAT, strings.add(alias), frameCount)
+            aliasCount += 1
+        frameCount += 1
+
+    stringTableOffset = struct.calcsize(HEADER_FORMAT) + len(frames) + len(aliases)
+    header = struct.pack(HEADER_FORMAT, MAGIC, VERSION, frameCount, aliasCount,
+                         stringTableOffset, len(strings.data), textureOffset, 0)
+
+    out = open(outFilename, 'wb')
+    out.write(header)
+    out.write(frames)
+    out.write(aliases)
+    out.write(strings.data)
+    out.close()
+    print('%s -> %s (%d frames, %d aliases)' % (filename, outFilename, frameCount, aliasCount))
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert sprite frame plists to the cocos2d-x binary sprite frame format.')
+    parser.add_argument('files', nargs='+', help='sprite frame plist files')
+    parser.add_argument('-o', '--output', help='output file, only valid with a single input. Defaults to the input with a .ccsf extension')
+    args = parser.parse_args()
+
+    if args.output and len(args.files) != 1:
+        parser.error('--output needs a single input file')
+
+    for filename in args.files:
+        if not os.path.isfile(filename):
+            print(filename + ' does not exist!')
+            continue
+        outFilename = args.output or os.path.splitext(filename)[0] + '.ccsf'
+        convertFile(filename, outFilename)
+
+if __name__ == '__main__':
+    main()